@@ -1,10 +1,20 @@
 /********************************************************************************
 * main.c: Skriver samtliga heltal 0 - 1023 ett i taget till lysdiodernas
 *         basadress LEDS_BASE via en loop. En kort fördröjning genereras mellan
-*         varje skrivning.
+*         varje skrivning via intervalltimern, så att fördröjningen blir
+*         densamma oavsett kompilatorflaggor och hårdvara.
 *
-*         Simulera programmet på följande länk:
-*         https://cpulator.01xz.net/?sys=nios-de10-lite
+*         Skrivningarna kan spelas in via trace.h genom att kompilera med
+*         makrot MMIO_TRACE. Vid kompilering för Linux ersätts LEDS_BASE av
+*         en variabel och skrivningarna sparas i filen mmio_trace.bin, som
+*         sedan avkodas via Verktyg/trace_decode.c:
+*         gcc -DNIOS2_HOST -DMMIO_TRACE main.c -o main && ./main
+*
+*         Programmet inkluderar drivrutiner från katalogen Drivrutiner och
+*         kan därmed inte klistras in i CPUlator som enskild fil. Kompilera
+*         i stället programmet för Linux enligt ovan, eller simulera
+*         motsvarande main.s via Verktyg/nios2sim.c:
+*         ./nios2sim "../2. Loop/main.s"
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
 ********************************************************************************/
@@ -16,47 +26,46 @@
 ********************************************************************************/
 #define GPIO_CASE_GOLD_HW
 
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include "../Drivrutiner/timer.h"
+#include "../Drivrutiner/trace.h"
+
 /********************************************************************************
 * Makrodefinitioner:
 ********************************************************************************/
-#ifdef GPIO_CASE_GOLD_HW
+#if defined(NIOS2_HOST)
+static volatile uint32_t leds_host;                /* Ersättning för lysdioderna. */
+#define LEDS_BASE (&leds_host)                     /* Basadress för lysdioder (Linux). */
+#elif defined(GPIO_CASE_GOLD_HW)
 #define LEDS_BASE (volatile uint32_t*)(0x8091740)  /* Basadress för lysdioder (CASE GOLD). */
-#define DELAY_CONSTANT 100000UL                    /* Fördröjningskonstant (CASE GOLD). */
 #else
 #define LEDS_BASE (volatile uint32_t*)(0xFF200000) /* Basadress för lysdioder (simulering). */
-#define DELAY_CONSTANT 1000000UL                   /* Fördröjningskonstant simulering. */
-#endif /* GPIO_CASE_GOLD_HW */
+#endif /* NIOS2_HOST */
+
+#define DELAY_MS 10 /* Fördröjning mellan varje skrivning i millisekunder. */
 
 /********************************************************************************
 * Pekare till basadresser:
 ********************************************************************************/
 static volatile uint32_t* const leds_base = LEDS_BASE; /* Pekar på LEDS_BASE. */
 
-/********************************************************************************
-* delay: Genererar fördröjning genom att räkna upp från 0 till DELAY_CONSTANT
-*        via en loop. För att säkerhetsställa att kompilatorn inte slopar
-*        uppräkningen (för optimering av koden) används instruktionen
-*        nop (no operation) varje varv i loopen.
-********************************************************************************/
-static inline void delay(void)
-{
-   for (uint32_t i = 0; i < DELAY_CONSTANT; ++i)
-   {
-      asm volatile("nop");
-   }
-   return;
-}
-
 /********************************************************************************
 * main: Skriver samtliga heltal 0 - 1023 till lysdiodernas basadress LEDS_BASE
-*       med en kort fördröjning mellan varje skrivning.
+*       med en kort fördröjning mellan varje skrivning. Intervalltimern
+*       startas innan första fördröjningen, varefter inspelningen av
+*       skrivningarna startas (endast vid kompilering med MMIO_TRACE).
 ********************************************************************************/
 int main(void)
 {
+   timer_init();
+   TRACE_INIT(leds_base);
+
    for (uint32_t i = 0; i < 1024; ++i)
    {
-      *leds_base = i;
-      delay();
+      TRACE_WRITE(leds_base, i);
+      delay_ms(DELAY_MS);
    }
    return 0;
 }
@@ -1,12 +1,16 @@
 /********************************************************************************
 * main.s: Skriver samtliga heltal 0 - 1023 ett i taget till lysdiodernas
 *         basadress LEDS_BASE via en loop. En kort fördröjning genereras mellan
-*         varje skrivning. För att hålla programmet enkelt sparas inte värden
-*         undan på stacken vid anrop av subrutiner, vilket hade varit med
-*         eller mindre nödvändigt ifall programmet var större.
+*         varje skrivning via intervalltimern, så att fördröjningen blir
+*         densamma oavsett exekveringshastighet. För att hålla programmet
+*         enkelt sparas inte värden undan på stacken vid anrop av subrutiner,
+*         vilket hade varit med eller mindre nödvändigt ifall programmet var
+*         större.
 *
-*         Simulera programmet på följande länk:
-*         https://cpulator.01xz.net/?sys=nios-de10-lite
+*         Programmet inkluderar drivrutiner från katalogen Drivrutiner och kan
+*         därmed inte klistras in i CPUlator som enskild fil. Simulera i stället
+*         programmet via Verktyg/nios2sim.c:
+*         ./nios2sim "../2. Loop/main.s"
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
 ********************************************************************************/
@@ -16,11 +20,6 @@
 ********************************************************************************/
 .text
 
-/********************************************************************************
-* Globala subrutiner:
-********************************************************************************/
-.global _start
-
 /********************************************************************************
 * GPIO_CASE_GOLD_HW: Makro för att definiera basadresser för CASE GOLD hårdvara.
 *                    Kommentera ut detta makro vid simulering.
@@ -31,47 +30,44 @@
 * Makrodefinitioner:
 ********************************************************************************/
 .ifdef GPIO_CASE_GOLD_HW
-.equ LEDS_BASE, 0x8091740      /* Basadress för lysdioder (CASE GOLD). */
-.equ DELAY_CONSTANT, 100000UL  /* Fördröjningskonstant (CASE GOLD). */
+.equ LEDS_BASE, 0x8091740  /* Basadress för lysdioder (CASE GOLD). */
 .else
-.equ LEDS_BASE, 0xFF200000     /* Basadress för lysdioder (simulering). */
-.equ DELAY_CONSTANT, 1000000UL /* Fördröjningskonstant (simulering). */
+.equ LEDS_BASE, 0xFF200000 /* Basadress för lysdioder (simulering). */
 .endif /* GPIO_CASE_GOLD_HW */
 
+.equ DELAY_MS, 10 /* Fördröjning mellan varje skrivning i millisekunder. */
+
 /********************************************************************************
-* _start: Initierar stackpekaren samt rampekaren vid start (sätts till 1024).
-*         Subrutinen main anropas sedan för att köra programmet. Efter återhopp
-*         görs ingenting genom att programmet försätts i en tom loop.
+* Inkluderingsdirektiv:
 ********************************************************************************/
-_start:
-   movi sp, 1024 /* Initierar stackpekaren till adress 1024. */
-   mov fp, sp    /* Initerar rampekaren till adress 1024. */
-   call main     /* Anropar subrutinen main för att köra programmet. */
-_end:
-   br _end       /* Gör ingenting efter återhopp från subrutinen main. */
+.include "../Drivrutiner/start.s"
+.include "../Drivrutiner/timer.s"
 
 /********************************************************************************
-* delay: Genererar fördröjning genom att räkna upp från 0 till DELAY_CONSTANT
-*        via en loop.
+* delay: Genererar fördröjning på DELAY_MS millisekunder via intervalltimern.
+*        Innehållet i r2 samt återhoppsadressen i ra sparas undan, eftersom
+*        r2 används som argument till delay_ms.
 ********************************************************************************/
 delay:
-   movhi r5, %hi(DELAY_CONSTANT)    /* Läser in DELAY_CONSTANT[15:8] i r5. */
-   addi r5, r5, %lo(DELAY_CONSTANT) /* Lägger till DELAY_CONSTANT[7:0] i r5. */
-   movi r6, 0                       /* Tilldelar startvärde för varvräknaren i r6. */
-delay_loop:
-   beq r5, r6, delay_end            /* Efter DELAY_CONSTANT antal varv avslutas loopen. */
-   addi r6, r6, 1                   /* Räknar upp antalet genomförda varv. */
-   br delay_loop                    /* Återstartar loopen tills fördröjningen är genomförd. */
-delay_end:
-   ret                              /* Avslutar subrutinen när fördröjningen är genomförd. */
+   addi sp, sp, -8   /* Allokerar minne för nya element på stacken. */
+   stw ra, 4(sp)     /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 0(sp)     /* Sparar undan innehållet i r2 (LEDS_BASE). */
+   movi r2, DELAY_MS /* Läser in fördröjningens längd i millisekunder i r2. */
+   call delay_ms     /* Väntar in fördröjningen via intervalltimern. */
+   ldw r2, 0(sp)     /* Återställer innehållet i r2. */
+   ldw ra, 4(sp)     /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 8    /* Återställer stackpekaren. */
+   ret               /* Avslutar subrutinen när fördröjningen är genomförd. */
 
 /********************************************************************************
 * main: Skriver samtliga heltal 0 - 1023 till lysdiodernas basadress LEDS_BASE
 *       med en kort fördröjning mellan varje skrivning. Efter att samtliga
 *       tal har skrivits till LEDS_BASE avslutas subrutinen med returkod 0
-*       för att indikera lyckad programexekvering.
+*       för att indikera lyckad programexekvering. Intervalltimern startas
+*       först inför fördröjningarna.
 ********************************************************************************/
 main:
+   call timer_init             /* Startar intervalltimern inför fördröjningar. */
    movhi r2, %hi(LEDS_BASE)    /* Läser in LEDS_BASE[31:16] i r2. */
    addi r2, r2, %lo(LEDS_BASE) /* Läser in LEDS_BASE[15:0] i r2. */
    movi r3, 0                  /* Läser in startvärde 0 för loopräknare i r3. */
@@ -0,0 +1,70 @@
+/********************************************************************************
+* sequence.c: Spelar upp mönstertabellen pattern_counter, dvs. samtliga heltal
+*             0 - 1023, till lysdiodernas basadress LEDS_BASE med en kort
+*             fördröjning mellan varje skrivning, motsvarande main.c men
+*             utan att heltalen beräknas i en loop.
+*
+*             Mönstertabellerna genereras i förväg via Verktyg/pattern_gen.c
+*             och lagras i .rodata. Uppspelningen sker via pattern_play i
+*             filen pattern.h, där varje skrivning kräver en läsning från
+*             tabellen. Tiden mellan skrivningarna mäts via intervalltimern,
+*             så att bildrutorna ligger exakt DELAY_MS millisekunder isär.
+*             Byt exempelvis till pattern_knight för att spela upp ett annat
+*             mönster utan att ändra programmet.
+*
+*             Skrivningarna kan spelas in via trace.h genom att kompilera med
+*             makrot MMIO_TRACE. Vid kompilering för Linux ersätts LEDS_BASE
+*             av en variabel och skrivningarna sparas i filen mmio_trace.bin,
+*             som sedan avkodas via Verktyg/trace_decode.c:
+*             gcc -DNIOS2_HOST -DMMIO_TRACE sequence.c -o sequence && ./sequence
+*
+*             Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
+********************************************************************************/
+#include <stdint.h>
+
+/********************************************************************************
+* GPIO_CASE_GOLD_HW: Makro för att definiera basadresser för CASE GOLD hårdvara.
+*                    Kommentera ut detta makro vid simulering.
+********************************************************************************/
+#define GPIO_CASE_GOLD_HW
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include "../Drivrutiner/pattern.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#if defined(NIOS2_HOST)
+static volatile uint32_t leds_host;                /* Ersättning för lysdioderna. */
+#define LEDS_BASE (&leds_host)                     /* Basadress för lysdioder (Linux). */
+#elif defined(GPIO_CASE_GOLD_HW)
+#define LEDS_BASE (volatile uint32_t*)(0x8091740)  /* Basadress för lysdioder (CASE GOLD). */
+#else
+#define LEDS_BASE (volatile uint32_t*)(0xFF200000) /* Basadress för lysdioder (simulering). */
+#endif /* NIOS2_HOST */
+
+#define DELAY_MS 10 /* Fördröjning mellan varje skrivning i millisekunder. */
+
+/********************************************************************************
+* Pekare till basadresser:
+********************************************************************************/
+static volatile uint32_t* const leds_base = LEDS_BASE; /* Pekar på LEDS_BASE. */
+
+/********************************************************************************
+* main: Spelar upp mönstertabellen pattern_counter till lysdiodernas
+*       basadress LEDS_BASE med en kort fördröjning mellan varje bildruta.
+*       Intervalltimern startas innan första fördröjningen, varefter
+*       inspelningen av skrivningarna startas (endast vid kompilering med
+*       MMIO_TRACE).
+********************************************************************************/
+int main(void)
+{
+   timer_init();
+   TRACE_INIT(leds_base);
+   pattern_play(leds_base, pattern_counter, PATTERN_COUNTER_SIZE, DELAY_MS * 1000);
+   return 0;
+}
+
+
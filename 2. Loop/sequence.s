@@ -0,0 +1,69 @@
+/********************************************************************************
+* sequence.s: Spelar upp mönstertabellen pattern_counter, dvs. samtliga heltal
+*             0 - 1023, till lysdiodernas basadress LEDS_BASE med en kort
+*             fördröjning mellan varje skrivning, motsvarande main.s men
+*             utan att heltalen beräknas i en loop.
+*
+*             Mönstertabellerna genereras i förväg via Verktyg/pattern_gen.c
+*             och lagras som .word i sektionen .rodata. Uppspelningen sker
+*             via pattern_play i filen pattern.s, där varje skrivning kräver
+*             en läsning (ldw) från tabellen följd av en skrivning (stwio).
+*             Tiden mellan skrivningarna mäts via intervalltimern, så att
+*             bildrutorna ligger exakt DELAY_MS millisekunder isär. Byt
+*             exempelvis till pattern_knight samt PATTERN_KNIGHT_SIZE för att
+*             spela upp ett annat mönster utan att ändra programmet.
+*
+*             Programmet inkluderar drivrutiner från katalogen Drivrutiner
+*             och kan därmed inte klistras in i CPUlator som enskild fil.
+*             Simulera i stället programmet via Verktyg/nios2sim.c:
+*             ./nios2sim -n 20000000 "../2. Loop/sequence.s"
+*
+*             Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
+********************************************************************************/
+
+/********************************************************************************
+* .text: Kodsegment, lagringsplats för programkoden.
+********************************************************************************/
+.text
+
+/********************************************************************************
+* GPIO_CASE_GOLD_HW: Makro för att definiera basadresser för CASE GOLD hårdvara.
+*                    Kommentera ut detta makro vid simulering.
+********************************************************************************/
+.equ GPIO_CASE_GOLD_HW, 0
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.ifdef GPIO_CASE_GOLD_HW
+.equ LEDS_BASE, 0x8091740  /* Basadress för lysdioder (CASE GOLD). */
+.else
+.equ LEDS_BASE, 0xFF200000 /* Basadress för lysdioder (simulering). */
+.endif /* GPIO_CASE_GOLD_HW */
+
+.equ DELAY_MS     , 10     /* Fördröjning mellan varje skrivning i millisekunder. */
+.equ STACK_ADDRESS, 0x8000 /* Stackens startadress, placerad efter mönstertabellerna. */
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/start.s"
+.include "../Drivrutiner/pattern.s"
+
+/********************************************************************************
+* main: Spelar upp mönstertabellen pattern_counter till lysdiodernas
+*       basadress LEDS_BASE med en kort fördröjning mellan varje bildruta.
+*       Intervalltimern startas först inför fördröjningarna. Efter att
+*       samtliga bildrutor har skrivits avslutas subrutinen med returkod 0
+*       för att indikera lyckad programexekvering.
+********************************************************************************/
+main:
+   call timer_init               /* Startar intervalltimern inför fördröjningar. */
+   movhi r2, %hi(LEDS_BASE)      /* Läser in LEDS_BASE[31:16] i r2. */
+   addi r2, r2, %lo(LEDS_BASE)   /* Läser in LEDS_BASE[15:0] i r2. */
+   movia r3, pattern_counter     /* Läser in adressen till mönstertabellen i r3. */
+   movi r4, PATTERN_COUNTER_SIZE /* Läser in antalet bildrutor i r4. */
+   movia r5, DELAY_MS * 1000     /* Läser in tiden mellan bildrutorna i mikrosekunder i r5. */
+   call pattern_play             /* Spelar upp tabellen till LEDS_BASE. */
+   movi r2, 0                    /* Läser in returkod 0 i r2. */
+   ret                           /* Genomför återhopp med returkod 0. */
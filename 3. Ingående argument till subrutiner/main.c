@@ -1,11 +1,50 @@
 /********************************************************************************
 * main.c: Demonstration av tändning och släckning av en lysdiod via nedtryckning
-*         av en tryckknapp. Lysdiod LED1 ansluts till LED[0] och tryckknapp
-*         BUTTON1 ansluts till KEY[0]. Vid nedtryckning av BUTTON1 tänds
-*         LED1, annars hålls den släckt.
+*         av en tryckknapp. Lysdioder LED1 - LED2 ansluts till LED[0:1] och
+*         tryckknapp BUTTON1 ansluts till KEY[0]. Vid nedtryckning av BUTTON1
+*         tänds LED1, annars hålls den släckt. Vid varje nedtryckning av
+*         BUTTON1 togglas LED2. Lysdiod LED3 ansluts till LED[2] och blinkar
+*         med frekvensen 5 Hz (toggling var 100 ms), oberoende av tryckknappen.
 *
-*         Simulera programmet på följande länk:
-*         https://cpulator.01xz.net/?sys=nios-de10-lite
+*         Tryckknappen studsar vid nedtryckning, vilket utan avstudsning hade
+*         gett flera togglingar av LED2 per nedtryckning. Samtliga
+*         slide-switchar samt tryckknappar avläses därför var
+*         DEBOUNCE_PERIOD_MS millisekund och avstudsas samtidigt via
+*         drivrutinerna i debounce.h.
+*
+*         Avläsningen samt blinkningen körs som två periodiska uppgifter via
+*         schemaläggaren i sched.h, i stället för en huvudloop med
+*         fördröjningar. Uppgifterna körs därmed med var sin period utan att
+*         påverka varandras tidsbas. Blinkningen förskjuts BLINK_PHASE_MS
+*         millisekunder, så att uppgifterna inte körs vid samma tick.
+*
+*         Schemaläggaren testas vid kompilering för Linux via sched_test.c
+*         i katalogen Verktyg.
+*
+*         Skrivningarna till lysdioderna kan spelas in via trace.h genom att
+*         kompilera med makrot MMIO_TRACE, där tidsstämplarna anges i
+*         schemaläggarens tick då intervalltimern används av schemaläggaren.
+*
+*         Fördröjningen från BUTTON1 till LED1 kan mätas via profile.h genom
+*         att kompilera med makrot PROFILE. Mätningen startar vid den
+*         avläsning där BUTTON1 först skiljer sig från avstudsat tillstånd
+*         och avslutas när LED1 har skrivits efter avstudsningen, vilket
+*         med avstudsningen i debounce.h motsvarar tre avläsningsperioder
+*         plus programmets egen fördröjning. Tiden mäts i klockpulser via
+*         sched_cycles. Profileringen testas vid kompilering för Linux via
+*         profile_test.c i katalogen Verktyg.
+*
+*         Vid varje nedtryckning av BUTTON1 skrivs även antalet
+*         nedtryckningar samt lysdiodernas tillstånd ut till konsolen via
+*         console.h, exempelvis "BUTTON1: 3 nedtryckningar, lysdioder
+*         0x006". Utskriften läggs i en ringbuffert, som töms via JTAG
+*         UART:ens avbrott, så att avläsningen inte fördröjs i väntan på
+*         UART:en. Konsolen testas vid kompilering för Linux via
+*         console_test.c i katalogen Verktyg.
+*
+*         Programmet inkluderar drivrutiner från katalogen Drivrutiner och
+*         kan därmed inte klistras in i CPUlator som enskild fil. Simulera
+*         i stället motsvarande main.s via Verktyg/nios2sim.c, se main.s.
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
 ********************************************************************************/
@@ -21,35 +60,105 @@
 /********************************************************************************
 * Makrodefinitioner för basadresser:
 ********************************************************************************/
-#ifdef GPIO_CASE_GOLD_HW
-#define LEDS_BASE    (volatile uint32_t*)(0x8091740)  /* Basadress för lysdioder (CASE GOLD). */
-#define BUTTONS_BASE (volatile uint32_t*)(0x8091760)  /* Basadress för tryckknappar (CASE GOLD). */
+#if defined(GPIO_CASE_GOLD_HW)
+#define LEDS_BASE     (volatile uint32_t*)(0x8091740)  /* Basadress för lysdioder (CASE GOLD). */
+#define SWITCHES_BASE (volatile uint32_t*)(0x8091750)  /* Basadress för slide-switchar (CASE GOLD). */
+#define BUTTONS_BASE  (volatile uint32_t*)(0x8091760)  /* Basadress för tryckknappar (CASE GOLD). */
 #else
-#define LEDS_BASE (volatile uint32_t*)(0xFF200000)    /* Basadress för lysdioder (simulering). */
-#define BUTTONS_BASE (volatile uint32_t*)(0xFF200050) /* Basadress för tryckknappar (simulering). */
+#define LEDS_BASE     (volatile uint32_t*)(0xFF200000) /* Basadress för lysdioder (simulering). */
+#define SWITCHES_BASE (volatile uint32_t*)(0xFF200040) /* Basadress för slide-switchar (simulering). */
+#define BUTTONS_BASE  (volatile uint32_t*)(0xFF200050) /* Basadress för tryckknappar (simulering). */
 #endif /* GPIO_CASE_GOLD_HW */
 
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include "../Drivrutiner/sched.h"
+#include "../Drivrutiner/debounce.h"
+
+#define TRACE_TIME()  sched_time()           /* Tidsstämplar i antal tick. */
+#define TRACE_TIME_NS (SCHED_TICK_US * 1000) /* Nanosekunder per tick. */
+#include "../Drivrutiner/trace.h"
+
+#define PROFILE_REGIONS 1 /* Antal regioner som mäts via profile.h. */
+#include "../Drivrutiner/profile.h"
+
+#include "../Drivrutiner/console.h"
+
 /********************************************************************************
 * Makrodefinitioner för pin-nummer:
 ********************************************************************************/
 #define LED1    0 /* Lysdiod 1 ansluten till pin LED[0]. */
+#define LED2    1 /* Lysdiod 2 ansluten till pin LED[1]. */
+#define LED3    2 /* Lysdiod 3 ansluten till pin LED[2]. */
 #define BUTTON1 0 /* Tryckknapp 1 ansluten till KEY[0]. */
 
+/********************************************************************************
+* Makrodefinitioner för uppgifterna:
+********************************************************************************/
+#define BLINK_PERIOD_MS  100 /* Toggling av LED3 var 100 ms (5 Hz blinkning). */
+#define BLINK_PHASE_MS   2   /* Förskjutning av blinkningen relativt avläsningen. */
+#define CLICKS_LINE_SIZE 52  /* Maximal längd på utskriften från clicks_print. */
+
+/********************************************************************************
+* Makrodefinitioner för profileringen:
+********************************************************************************/
+#define PROFILE_BUTTON1 0 /* Region för fördröjningen från BUTTON1 till LED1. */
+
 /********************************************************************************
 * Pekare till basadresser:
 ********************************************************************************/
-static volatile uint32_t* const leds_base = LEDS_BASE;       /* Pekar på LEDS_BASE. */
-static volatile uint32_t* const buttons_base = BUTTONS_BASE; /* Pekar på BUTTONS_BASE. */
+static volatile uint32_t* const leds_base = LEDS_BASE;         /* Pekar på LEDS_BASE. */
+static volatile uint32_t* const switches_base = SWITCHES_BASE; /* Pekar på SWITCHES_BASE. */
+static volatile uint32_t* const buttons_base = BUTTONS_BASE;   /* Pekar på BUTTONS_BASE. */
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static struct debounce inputs; /* Avstudsade slide-switchar samt tryckknappar. */
+static uint32_t clicks;        /* Antal nedtryckningar av BUTTON1. */
 
 /********************************************************************************
-* button_pressed: Indikerar ifall specifik tryckknapp är nedtryckt genom att
-*                 returnera 1 (sant) eller 0 (falskt).
+* inputs_read: Returnerar aktuella insignaler från samtliga slide-switchar
+*              samt tryckknappar packade i ett ord, se DEBOUNCE_SAMPLE.
+********************************************************************************/
+static inline uint32_t inputs_read(void)
+{
+   return DEBOUNCE_SAMPLE(*switches_base, *buttons_base);
+}
+
+/********************************************************************************
+* inputs_update: Avläser samtliga slide-switchar samt tryckknappar en gång
+*                och uppdaterar deras avstudsade tillstånd. Bör anropas var
+*                DEBOUNCE_PERIOD_MS millisekund.
+********************************************************************************/
+static inline void inputs_update(void)
+{
+   debounce_update(&inputs, inputs_read());
+   return;
+}
+
+/********************************************************************************
+* button_pressed: Indikerar ifall specifik tryckknapp är nedtryckt efter
+*                 avstudsning genom att returnera 1 (sant) eller 0 (falskt).
 *
 *                 - pin: Tryckknappens pin-nummer.
 ********************************************************************************/
 static inline bool button_pressed(const uint8_t pin)
 {
-   return !(bool)(*buttons_base & (1 << pin));
+   return (bool)(inputs.state & DEBOUNCE_KEY(pin));
+}
+
+/********************************************************************************
+* button_clicked: Indikerar ifall specifik tryckknapp trycktes ned vid
+*                 senaste avläsningen genom att returnera 1 (sant) eller
+*                 0 (falskt). Varje nedtryckning indikeras därmed en gång.
+*
+*                 - pin: Tryckknappens pin-nummer.
+********************************************************************************/
+static inline bool button_clicked(const uint8_t pin)
+{
+   return (bool)(inputs.pressed & DEBOUNCE_KEY(pin));
 }
 
 /********************************************************************************
@@ -60,7 +169,7 @@ static inline bool button_pressed(const uint8_t pin)
 ********************************************************************************/
 static inline void led_on(const uint8_t pin)
 {
-   *leds_base |= (1 << pin);
+   TRACE_WRITE(leds_base, *leds_base | (1 << pin));
    return;
 }
 
@@ -73,7 +182,19 @@ static inline void led_on(const uint8_t pin)
 ********************************************************************************/
 static inline void led_off(const uint8_t pin)
 {
-   *leds_base &= ~(1 << pin);
+   TRACE_WRITE(leds_base, *leds_base & ~(1 << pin));
+   return;
+}
+
+/********************************************************************************
+* led_toggle: Togglar lysdiod ansluten till specifierad pin utan att påverka
+*             övriga lysdioder.
+*
+*             - pin: Lysdiodens pin-nummer.
+********************************************************************************/
+static inline void led_toggle(const uint8_t pin)
+{
+   TRACE_WRITE(leds_base, *leds_base ^ (1 << pin));
    return;
 }
 
@@ -82,33 +203,104 @@ static inline void led_off(const uint8_t pin)
 ********************************************************************************/
 static inline void leds_reset(void)
 {
-   *leds_base = 0x00;
+   TRACE_WRITE(leds_base, 0x00);
    return;
 }
 
 /********************************************************************************
-* main: Ser till att samtliga lysdioder är släckta vid start. Programmet
-*       hålls i gång så länge matningsspänning tillförs. Vid nedtryckning
-*       av BUTTON1 tänds LED1, annars hålls den släckt.
+* clicks_print: Räknar upp antalet nedtryckningar av BUTTON1 och skriver ut
+*               antalet samt lysdiodernas tillstånd till konsolen. Raden
+*               skrivs via flera anrop, så utrymme för hela raden reserveras
+*               först. Är bufferten full kastas hela raden, medan antalet
+*               nedtryckningar ändå räknas upp.
 ********************************************************************************/
-int main(void)
+static void clicks_print(void)
 {
-   leds_reset();
+   clicks++;
+   if (!console_reserve(CLICKS_LINE_SIZE)) return;
+   console_print("BUTTON1: ");
+   console_print_uint(clicks);
+   console_print(" nedtryckningar, lysdioder 0x");
+   console_print_hex(*leds_base, 3);
+   console_print("\n");
+   return;
+}
 
-   while (1)
+/********************************************************************************
+* inputs_task: Uppgift som avläser samtliga insignaler var
+*              DEBOUNCE_PERIOD_MS millisekund. Vid nedtryckning av BUTTON1
+*              tänds LED1, annars hålls den släckt. Vid varje nedtryckning
+*              av BUTTON1 togglas LED2, varefter nedtryckningen skrivs ut
+*              till konsolen. Vid profilering startas mätningen när BUTTON1
+*              först skiljer sig från avstudsat tillstånd, dvs. när dess
+*              räknare har räknats upp en gång, och avslutas när LED1 har
+*              skrivits efter att BUTTON1 bytt tillstånd.
+********************************************************************************/
+static void inputs_task(void)
+{
+   inputs_update();
+
+   if (inputs.cnt0 & ~inputs.cnt1 & DEBOUNCE_KEY(BUTTON1)) PROFILE_BEGIN(PROFILE_BUTTON1);
+
+   if (button_clicked(BUTTON1))
    {
-      if (button_pressed(BUTTON1))
-      {
-         led_on(LED1);
-      }
-      else
-      {
-         led_off(LED1);
-      }
+      led_toggle(LED2);
+      clicks_print();
    }
 
-   return 0;
+   if (button_pressed(BUTTON1))
+   {
+      led_on(LED1);
+   }
+   else
+   {
+      led_off(LED1);
+   }
+
+   if ((inputs.pressed | inputs.released) & DEBOUNCE_KEY(BUTTON1)) PROFILE_END(PROFILE_BUTTON1);
+   return;
+}
+
+/********************************************************************************
+* blink_task: Uppgift som togglar LED3 var BLINK_PERIOD_MS millisekund.
+********************************************************************************/
+static void blink_task(void)
+{
+   led_toggle(LED3);
+   return;
 }
 
+/********************************************************************************
+* tasks: Tabell med programmets periodiska uppgifter, där ett tick motsvarar
+*        en millisekund.
+********************************************************************************/
+static struct sched_task tasks[] =
+{
+   SCHED_TASK(inputs_task, DEBOUNCE_PERIOD_MS, 0),
+   SCHED_TASK(blink_task, BLINK_PERIOD_MS, BLINK_PHASE_MS),
+};
 
+/********************************************************************************
+* main: Startar inspelningen av skrivningar (endast vid kompilering med
+*       MMIO_TRACE) samt profileringen (endast vid kompilering med PROFILE)
+*       och ser till att samtliga lysdioder är släckta vid start samt
+*       initierar avstudsningen med aktuella insignaler och konsolen med
+*       avbrottsdriven tömning. Därefter startas schemaläggaren, som kör
+*       uppgifterna i tabellen tasks så länge matningsspänning tillförs.
+********************************************************************************/
+int main(void)
+{
+   TRACE_INIT(leds_base);
+   PROFILE_INIT();
+   leds_reset();
+   debounce_init(&inputs, inputs_read());
+   console_init(true);
+   sched_init(tasks, sizeof(tasks) / sizeof(tasks[0]));
+   irq_global_enable();
 
+   while (1)
+   {
+      sched_run();
+   }
+   return 0;
+}
@@ -1,15 +1,56 @@
 /********************************************************************************
 * main.s: Demonstration av tändning och släckning av en lysdiod via nedtryckning
-*         av en tryckknapp. Lysdiod LED1 ansluts till LED[0] och tryckknapp
-*         BUTTON1 ansluts till KEY[0]. Vid nedtryckning av BUTTON1 tänds
-*         LED1, annars hålls den släckt.
+*         av en tryckknapp. Lysdioder LED1 - LED2 ansluts till LED[0:1] och
+*         tryckknapp BUTTON1 ansluts till KEY[0]. Vid nedtryckning av BUTTON1
+*         tänds LED1, annars hålls den släckt. Vid varje nedtryckning av
+*         BUTTON1 togglas LED2. Lysdiod LED3 ansluts till LED[2] och blinkar
+*         med frekvensen 5 Hz (toggling var 100 ms), oberoende av tryckknappen.
+*
+*         Tryckknappen studsar vid nedtryckning, vilket utan avstudsning hade
+*         gett flera togglingar av LED2 per nedtryckning. Samtliga
+*         slide-switchar samt tryckknappar avläses därför var
+*         DEBOUNCE_PERIOD_MS millisekund och avstudsas samtidigt via
+*         drivrutinerna i debounce.s.
+*
+*         Avläsningen samt blinkningen körs som två periodiska uppgifter via
+*         schemaläggaren i sched.s, i stället för en huvudloop med
+*         fördröjningar. Uppgifterna körs därmed med var sin period utan att
+*         påverka varandras tidsbas. Blinkningen förskjuts BLINK_PHASE_MS
+*         millisekunder, så att uppgifterna inte körs vid samma tick.
+*
+*         Basadresserna samt de avstudsade insignalerna lagras i .sdata
+*         respektive .sbss, så att de nås via en enda instruktion relativt
+*         gp, som initieras av startkoden i start.s. Därmed behöver varje
+*         anrop av exempelvis led_on inte bygga upp LEDS_BASE via movhi
+*         samt addi, medan button_pressed läser in fältet via en enda ldw,
+*         eftersom även fältets offset ryms i instruktionen. Anropen av
+*         led_on, led_off samt button_pressed kräver därmed 7, 9
+*         respektive 7 instruktioner (uppmätt via nios2sim, se
+*         bench_baseline.json).
 *
 *         För att hålla programmet enkelt sparas inte värden undan på stacken
 *         vid anrop av subrutiner, vilket hade varit med eller mindre nödvändigt
-*         ifall programmet var större.
+*         ifall programmet var större. Undantaget är uppgifterna, som anropas
+*         av schemaläggaren och därmed sparar undan samtliga register de
+*         använder.
+*
+*         Fördröjningen från BUTTON1 till LED1 kan mätas via profile.s genom
+*         att assemblera med symbolen PROFILE, se main.c. Tabellen skrivs
+*         exempelvis ut av simulatorn efter en nedtryckning samt ett
+*         uppsläpp av BUTTON1 enligt nedan:
+*         ./nios2sim -D PROFILE=1 -p -n 10000000 -e 1000000:key=1 \
+*            -e 5000000:key=0 "../3. Ingående argument till subrutiner/main.s"
 *
-*         Simulera programmet på följande länk:
-*         https://cpulator.01xz.net/?sys=nios-de10-lite
+*         Vid varje nedtryckning av BUTTON1 skrivs även antalet
+*         nedtryckningar samt lysdiodernas tillstånd ut till konsolen via
+*         console.s, där ringbufferten töms via JTAG UART:ens avbrott.
+*         Utskrifterna visas exempelvis av simulatorn enligt nedan:
+*         ./nios2sim -n 10000000 -e 1000000:key=1 -e 2000000:key=0 \
+*            -e 3000000:key=1 "../3. Ingående argument till subrutiner/main.s"
+*
+*         Programmet inkluderar drivrutiner från katalogen Drivrutiner och kan
+*         därmed inte klistras in i CPUlator som enskild fil. Simulera i stället
+*         programmet via Verktyg/nios2sim.c enligt ovan.
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
 ********************************************************************************/
@@ -19,11 +60,6 @@
 ********************************************************************************/
 .text
 
-/********************************************************************************
-* Globala subrutiner:
-********************************************************************************/
-.global _start
-
 /********************************************************************************
 * GPIO_CASE_GOLD_HW: Makro för att definiera basadresser för CASE GOLD hårdvara.
 *                    Kommentera ut detta makro vid simulering.
@@ -34,46 +70,117 @@
 * Makrodefinitioner för basadresser:
 ********************************************************************************/
 .ifdef GPIO_CASE_GOLD_HW
-.equ LEDS_BASE   , 0x8091740  /* Basadress för lysdioder (CASE GOLD). */
-.equ BUTTONS_BASE, 0x8091760  /* Basadress för tryckknappar (CASE GOLD). */
+.equ LEDS_BASE    , 0x8091740  /* Basadress för lysdioder (CASE GOLD). */
+.equ SWITCHES_BASE, 0x8091750  /* Basadress för slide-switchar (CASE GOLD). */
+.equ BUTTONS_BASE , 0x8091760  /* Basadress för tryckknappar (CASE GOLD). */
 .else
-.equ LEDS_BASE   , 0xFF200000 /* Basadress för lysdioder (simulering). */
-.equ BUTTONS_BASE, 0xFF200050 /* Basadress för tryckknappar (simulering). */
+.equ LEDS_BASE    , 0xFF200000 /* Basadress för lysdioder (simulering). */
+.equ SWITCHES_BASE, 0xFF200040 /* Basadress för slide-switchar (simulering). */
+.equ BUTTONS_BASE , 0xFF200050 /* Basadress för tryckknappar (simulering). */
 .endif /* GPIO_CASE_GOLD_HW */
 
 /********************************************************************************
 * Makrodefinitioner för pin-nummer:
 ********************************************************************************/
 .equ LED1   , 0 /* Lysdiod 1 ansluten till pin LED[0]. */
+.equ LED2   , 1 /* Lysdiod 2 ansluten till pin LED[1]. */
+.equ LED3   , 2 /* Lysdiod 3 ansluten till pin LED[2]. */
 .equ BUTTON1, 0 /* Tryckknapp 1 ansluten till KEY[0]. */
 
 /********************************************************************************
-* _start: Initierar stackpekaren samt rampekaren vid start (sätts till 1024).
-*         Subrutinen main anropas sedan för att köra programmet. Efter återhopp
-*         görs ingenting genom att programmet försätts i en tom loop.
+* Makrodefinitioner för uppgifterna:
+********************************************************************************/
+.equ BLINK_PERIOD_MS , 100 /* Toggling av LED3 var 100 ms (5 Hz blinkning). */
+.equ BLINK_PHASE_MS  , 2   /* Förskjutning av blinkningen relativt avläsningen. */
+.equ CLICKS_LINE_SIZE, 52  /* Maximal längd på utskriften från clicks_print. */
+.equ TASK_COUNT      , 2   /* Antalet uppgifter i tabellen tasks. */
+
+/********************************************************************************
+* Makrodefinitioner för stacken:
+********************************************************************************/
+.equ STACK_ADDRESS, 8192 /* Stackens startadress, placerad efter konsolens ringbuffert. */
+
+/********************************************************************************
+* Makrodefinitioner för profileringen:
 ********************************************************************************/
-_start:
-   movi sp, 1024 /* Initierar stackpekaren till adress 1024. */
-   mov fp, sp    /* Initerar rampekaren till adress 1024. */
-   call main     /* Anropar subrutinen main för att köra programmet. */
-_end:
-   br _end       /* Gör ingenting efter återhopp från subrutinen main. */
+.equ PROFILE_REGIONS, 1 /* Antal regioner som mäts via profile.s. */
+.equ PROFILE_BUTTON1, 0 /* Region för fördröjningen från BUTTON1 till LED1. */
 
 /********************************************************************************
-* button_pressed: Indikerar ifall specificerad tryckknapp är nedtryckt genom
-*                 att returnera 1 (sant) eller 0 (falskt) i r2.
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/start.s"
+.include "../Drivrutiner/sched.s"
+.include "../Drivrutiner/debounce.s"
+.include "../Drivrutiner/profile.s"
+.include "../Drivrutiner/console.s"
+
+/********************************************************************************
+* inputs_read: Returnerar aktuella insignaler från samtliga slide-switchar
+*              samt tryckknappar packade i ett ord via r2, se
+*              debounce_sample. Återhoppsadressen i ra sparas undan, eftersom
+*              debounce_sample anropas.
+********************************************************************************/
+inputs_read:
+   addi sp, sp, -4                   /* Allokerar minne för nya element på stacken. */
+   stw ra, 0(sp)                     /* Sparar undan återhoppsadressen i ra. */
+   ldw r3, %gprel(switches_base)(gp) /* Läser in SWITCHES_BASE i r3 relativt gp. */
+   ldwio r2, 0(r3)                   /* Läser insignaler från SWITCHES_BASE i r2. */
+   ldw r3, %gprel(buttons_base)(gp)  /* Läser in BUTTONS_BASE i r3 relativt gp. */
+   ldwio r3, 0(r3)                   /* Läser insignaler från BUTTONS_BASE i r3. */
+   call debounce_sample              /* Packar insignalerna i r2. */
+   ldw ra, 0(sp)                     /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 4                    /* Återställer stackpekaren. */
+   ret                               /* Genomför återhopp. */
+
+/********************************************************************************
+* inputs_update: Avläser samtliga slide-switchar samt tryckknappar en gång
+*                och uppdaterar deras avstudsade tillstånd. Bör anropas var
+*                DEBOUNCE_PERIOD_MS millisekund. Återhoppsadressen i ra
+*                sparas undan, eftersom andra subrutiner anropas.
+********************************************************************************/
+inputs_update:
+   addi sp, sp, -4             /* Allokerar minne för nya element på stacken. */
+   stw ra, 0(sp)               /* Sparar undan återhoppsadressen i ra. */
+   call inputs_read            /* Läser in packade insignaler i r2. */
+   mov r3, r2                  /* Flyttar insignalerna till r3 som argument. */
+   addi r2, gp, %gprel(inputs) /* Läser in adressen till inputs i r2 relativt gp. */
+   call debounce_update        /* Uppdaterar avstudsat tillstånd samt flanker. */
+   ldw ra, 0(sp)               /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 4              /* Återställer stackpekaren. */
+   ret                         /* Genomför återhopp. */
+
+/********************************************************************************
+* button_pressed: Indikerar ifall specificerad tryckknapp är nedtryckt efter
+*                 avstudsning genom att returnera 1 (sant) eller 0 (falskt)
+*                 i r2.
 *
 *                 - r2: Tryckknappens pin-nummer.
 ********************************************************************************/
 button_pressed:
-   movhi r3, %hi(BUTTONS_BASE)    /* Läser in BUTTONS_BASE[31:16] i r3. */
-   addi r3, r3, %lo(BUTTONS_BASE) /* Lägger till BUTTONS_BASE[15:0] i r3. */
-   movi r4, 0x01                  /* Läser in tal som ska bitskiftas i r4. */
-   sll r2, r4, r2                 /* Skiftar tryckknappens pin, lagrar i r2. */
-   ldwio r4, 0(r3)                /* Läser insignaler från BUTTONS_BASE. */
-   and r4, r4, r2                 /* Maskerar alla bitar förutom tryckknappens i r4. */
-   cmpeqi r2, r4, 0               /* Om resterande värde är 0 är knappen nedtryckt. */
-   ret                            /* Genomför återhopp. */
+   ldw r3, %gprel(inputs + DEBOUNCE_STATE_OFFSET)(gp) /* Läser in avstudsade insignaler i r3. */
+   addi r2, r2, DEBOUNCE_KEYS_SHIFT                   /* Beräknar tryckknappens bit i packad insignal. */
+   movi r4, 0x01                                      /* Läser in tal som ska bitskiftas i r4. */
+   sll r2, r4, r2                                     /* Skiftar tryckknappens bit, lagrar i r2. */
+   and r4, r3, r2                                     /* Maskerar alla bitar förutom tryckknappens i r4. */
+   cmpnei r2, r4, 0                                   /* Om resterande värde inte är 0 är knappen nedtryckt. */
+   ret                                                /* Genomför återhopp. */
+
+/********************************************************************************
+* button_clicked: Indikerar ifall specificerad tryckknapp trycktes ned vid
+*                 senaste avläsningen genom att returnera 1 (sant) eller
+*                 0 (falskt) i r2. Varje nedtryckning indikeras därmed en gång.
+*
+*                 - r2: Tryckknappens pin-nummer.
+********************************************************************************/
+button_clicked:
+   ldw r3, %gprel(inputs + DEBOUNCE_PRESSED_OFFSET)(gp) /* Läser in nedtryckta pinnar i r3. */
+   addi r2, r2, DEBOUNCE_KEYS_SHIFT                     /* Beräknar tryckknappens bit i packad insignal. */
+   movi r4, 0x01                                        /* Läser in tal som ska bitskiftas i r4. */
+   sll r2, r4, r2                                       /* Skiftar tryckknappens bit, lagrar i r2. */
+   and r4, r3, r2                                       /* Maskerar alla bitar förutom tryckknappens i r4. */
+   cmpnei r2, r4, 0                                     /* Om resterande värde inte är 0 trycktes knappen ned. */
+   ret                                                  /* Genomför återhopp. */
 
 /********************************************************************************
 * led_on: Tänder lysdiod ansluten till specificerad pin utan att påverka
@@ -82,14 +189,13 @@ button_pressed:
 *         - r2: Lysdiodens pin-nummer.
 ********************************************************************************/
 led_on:
-   movhi r3, %hi(LEDS_BASE)    /* Läser in LEDS_BASE[31:16] i r3. */
-   addi r3, r3, %lo(LEDS_BASE) /* Lägger till LEDS_BASE[15:0] i r3. */
-   movi r4, 0x01               /* Läser in tal som ska bitskiftas i r4. */
-   sll r2, r4, r2              /* Skiftar lysdiodens pin-nummer, lagrar i r2. */
-   ldwio r4, 0(r3)             /* Läser in aktuellt värde från LEDS_BASE. */
-   or r4, r4, r2               /* Ettställer lysdiodens pin i hämtat värde. */
-   stwio r4, 0(r3)             /* Skriver uppdaterat värde till LEDS_BASE. */
-   ret                         /* Genomför återhopp. */
+   ldw r3, %gprel(leds_base)(gp) /* Läser in LEDS_BASE i r3 relativt gp. */
+   movi r4, 0x01                 /* Läser in tal som ska bitskiftas i r4. */
+   sll r2, r4, r2                /* Skiftar lysdiodens pin-nummer, lagrar i r2. */
+   ldwio r4, 0(r3)               /* Läser in aktuellt värde från LEDS_BASE. */
+   or r4, r4, r2                 /* Ettställer lysdiodens pin i hämtat värde. */
+   stwio r4, 0(r3)               /* Skriver uppdaterat värde till LEDS_BASE. */
+   ret                           /* Genomför återhopp. */
 
 /********************************************************************************
 * led_off: Släcker lysdiod ansluten till specificerad pin utan att påverka
@@ -98,42 +204,203 @@ led_on:
 *          - r2: Lysdiodens pin-nummer.
 ********************************************************************************/
 led_off:
-   movhi r3, %hi(LEDS_BASE)    /* Läser in LEDS_BASE[15:8] i r3. */
-   addi r3, r3, %lo(LEDS_BASE) /* Lägger till LEDS_BASE[15:0] i r3. */
-   movi r4, 0x01               /* Läser in tal som ska bitskiftas i r4. */
-   sll r2, r4, r2              /* Skiftar lysdiodens pin-nummer, lagrar i r2. */
-   movi r4, -1                 /* Tilldelar -1 till r4 för invertering med XOR. */
-   xor r2, r2, r4              /* Inverterar pin-numret för släckning. */
-   ldwio r4, 0(r3)             /* Läser in aktuellt värde från LEDS_BASE i r4. */
-   and r4, r4, r2              /* Nollställer lysdiodens pin i hämtat värde. */
-   stwio r4, 0(r3)             /* Skriver uppdaterat värde till LEDS_BASE. */
-   ret                         /* Genomför återhopp. */
+   ldw r3, %gprel(leds_base)(gp) /* Läser in LEDS_BASE i r3 relativt gp. */
+   movi r4, 0x01                 /* Läser in tal som ska bitskiftas i r4. */
+   sll r2, r4, r2                /* Skiftar lysdiodens pin-nummer, lagrar i r2. */
+   movi r4, -1                   /* Tilldelar -1 till r4 för invertering med XOR. */
+   xor r2, r2, r4                /* Inverterar pin-numret för släckning. */
+   ldwio r4, 0(r3)               /* Läser in aktuellt värde från LEDS_BASE i r4. */
+   and r4, r4, r2                /* Nollställer lysdiodens pin i hämtat värde. */
+   stwio r4, 0(r3)               /* Skriver uppdaterat värde till LEDS_BASE. */
+   ret                           /* Genomför återhopp. */
+
+/********************************************************************************
+* led_toggle: Togglar lysdiod ansluten till specificerad pin utan att påverka
+*             övriga lysdioder.
+*
+*             - r2: Lysdiodens pin-nummer.
+********************************************************************************/
+led_toggle:
+   ldw r3, %gprel(leds_base)(gp) /* Läser in LEDS_BASE i r3 relativt gp. */
+   movi r4, 0x01                 /* Läser in tal som ska bitskiftas i r4. */
+   sll r2, r4, r2                /* Skiftar lysdiodens pin-nummer, lagrar i r2. */
+   ldwio r4, 0(r3)               /* Läser in aktuellt värde från LEDS_BASE. */
+   xor r4, r4, r2                /* Togglar lysdiodens pin i hämtat värde. */
+   stwio r4, 0(r3)               /* Skriver uppdaterat värde till LEDS_BASE. */
+   ret                           /* Genomför återhopp. */
 
 /********************************************************************************
 * leds_reset: Släcker samtliga lysdioder.
 ********************************************************************************/
 leds_reset:
-   movhi r3, %hi(LEDS_BASE)    /* Läser in LEDS_BASE[31:16] i r3. */
-   addi r3, r3, %lo(LEDS_BASE) /* Lägger till LEDS_BASE[15:0] i r3. */
-   stwio zero, 0(r3)           /* Nollställer lysdioderna för släckning. */
-   ret                         /* Genomför återhopp. */
+   ldw r3, %gprel(leds_base)(gp) /* Läser in LEDS_BASE i r3 relativt gp. */
+   stwio zero, 0(r3)             /* Nollställer lysdioderna för släckning. */
+   ret                           /* Genomför återhopp. */
+
+/********************************************************************************
+* clicks_print: Räknar upp antalet nedtryckningar av BUTTON1 och skriver ut
+*               antalet samt lysdiodernas tillstånd till konsolen. Raden
+*               skrivs via flera anrop, så utrymme för hela raden reserveras
+*               först. Är bufferten full kastas hela raden, medan antalet
+*               nedtryckningar ändå räknas upp. Återhoppsadressen i ra
+*               sparas undan, eftersom subrutinerna i console.s anropas.
+********************************************************************************/
+clicks_print:
+   addi sp, sp, -4                /* Allokerar minne för nya element på stacken. */
+   stw ra, 0(sp)                  /* Sparar undan återhoppsadressen i ra. */
+   ldw r2, %gprel(clicks)(gp)     /* Läser in antalet nedtryckningar i r2 relativt gp. */
+   addi r2, r2, 1                 /* Räknar upp antalet nedtryckningar. */
+   stw r2, %gprel(clicks)(gp)     /* Lagrar antalet nedtryckningar. */
+   movi r2, CLICKS_LINE_SIZE      /* Läser in radens maximala längd i r2. */
+   call console_reserve           /* Reserverar utrymme för hela raden. */
+   beq r2, zero, clicks_print_end /* Ryms inte raden kastas den i sin helhet. */
+   movia r2, clicks_text          /* Läser in adressen till inledande text i r2. */
+   call console_print             /* Skriver ut inledande text. */
+   ldw r2, %gprel(clicks)(gp)     /* Läser in antalet nedtryckningar i r2 relativt gp. */
+   call console_print_uint        /* Skriver ut antalet nedtryckningar. */
+   movia r2, clicks_leds_text     /* Läser in adressen till text före lysdioderna i r2. */
+   call console_print             /* Skriver ut text före lysdioderna. */
+   ldw r2, %gprel(leds_base)(gp)  /* Läser in LEDS_BASE i r2 relativt gp. */
+   ldwio r2, 0(r2)                /* Läser in lysdiodernas tillstånd i r2. */
+   movi r3, 3                     /* Lysdioderna skrivs ut med tre hexadecimala siffror. */
+   call console_print_hex         /* Skriver ut lysdiodernas tillstånd. */
+   movia r2, clicks_end_text      /* Läser in adressen till radslut i r2. */
+   call console_print             /* Avslutar raden. */
+clicks_print_end:
+   ldw ra, 0(sp)                  /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 4                 /* Återställer stackpekaren. */
+   ret                            /* Genomför återhopp. */
+
+/********************************************************************************
+* inputs_task: Uppgift som avläser samtliga insignaler var
+*              DEBOUNCE_PERIOD_MS millisekund. Vid nedtryckning av BUTTON1
+*              tänds LED1, annars hålls den släckt. Vid varje nedtryckning
+*              av BUTTON1 togglas LED2, varefter nedtryckningen skrivs ut
+*              till konsolen. Vid profilering startas mätningen när BUTTON1
+*              först skiljer sig från avstudsat tillstånd, dvs. när dess
+*              räknare har räknats upp en gång, och avslutas när LED1 har
+*              skrivits efter att BUTTON1 bytt tillstånd.
+********************************************************************************/
+inputs_task:
+   addi sp, sp, -16                                      /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 12(sp)                                        /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 8(sp)                                         /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)                                         /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                                         /* Sparar undan innehållet i r4 inför användning. */
+   call inputs_update                                    /* Avläser och avstudsar samtliga insignaler. */
+.ifdef PROFILE
+   ldw r2, %gprel(inputs + DEBOUNCE_CNT1_OFFSET)(gp)     /* Läser in räknarnas högre bitar i r2. */
+   ldw r3, %gprel(inputs + DEBOUNCE_CNT0_OFFSET)(gp)     /* Läser in räknarnas lägre bitar i r3. */
+   nor r2, r2, r2                                        /* Inverterar de högre bitarna. */
+   and r2, r2, r3                                        /* Räknare som har räknats upp en gång. */
+   andi r2, r2, 1 << (DEBOUNCE_KEYS_SHIFT + BUTTON1)     /* Maskerar alla bitar förutom BUTTON1. */
+   beq r2, zero, inputs_task_led2                        /* Annars pågår ingen ny flank. */
+   PROFILE_BEGIN PROFILE_BUTTON1                         /* Startar mätningen vid flanken. */
+.endif /* PROFILE */
+inputs_task_led2:
+   movi r2, BUTTON1                                      /* Läser in pin-numret för BUTTON1 i r2. */
+   call button_clicked                                   /* Kontrollerar ifall BUTTON1 trycktes ned. */
+   beq r2, zero, inputs_task_led1                        /* Om BUTTON1 inte trycktes ned lämnas LED2 orörd. */
+   movi r2, LED2                                         /* Läser in pin-numret för LED2 i r2. */
+   call led_toggle                                       /* Togglar LED2. */
+   call clicks_print                                     /* Skriver ut nedtryckningen till konsolen. */
+inputs_task_led1:
+   movi r2, BUTTON1                                      /* Läser in pin-numret för BUTTON1 i r2. */
+   call button_pressed                                   /* Kontrollerar ifall BUTTON1 är nedtryckt. */
+   mov r4, r2                                            /* Flyttar returvärdet till r4 för senare läsning. */
+   movi r2, LED1                                         /* Läser in pin-numret för LED1 i r2. */
+   bne r4, zero, inputs_task_led1_on                     /* Om BUTTON1 är nedtryckt tänds LED1. */
+inputs_task_led1_off:
+   call led_off                                          /* Släcker LED1. */
+   br inputs_task_end                                    /* Avslutar uppgiften. */
+inputs_task_led1_on:
+   call led_on                                           /* Tänder LED1. */
+inputs_task_end:
+.ifdef PROFILE
+   ldw r2, %gprel(inputs + DEBOUNCE_PRESSED_OFFSET)(gp)  /* Läser in nedtryckta pinnar i r2. */
+   ldw r3, %gprel(inputs + DEBOUNCE_RELEASED_OFFSET)(gp) /* Läser in uppsläppta pinnar i r3. */
+   or r2, r2, r3                                         /* Pinnar som bytte tillstånd. */
+   andi r2, r2, 1 << (DEBOUNCE_KEYS_SHIFT + BUTTON1)     /* Maskerar alla bitar förutom BUTTON1. */
+   beq r2, zero, inputs_task_return                      /* Annars skrevs LED1 inte efter en flank. */
+   PROFILE_END PROFILE_BUTTON1                           /* Avslutar mätningen. */
+.endif /* PROFILE */
+inputs_task_return:
+   ldw r4, 0(sp)                                         /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                                         /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)                                         /* Återställer r2 efter användning. */
+   ldw ra, 12(sp)                                        /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 16                                       /* Återställer stackpekaren. */
+   ret                                                   /* Genomför återhopp. */
 
 /********************************************************************************
-* main: Ser till att samtliga lysdioder är släckta vid start. Programmet
-*       hålls igång så länge matningsspänning tillförs. Vid nedtryckning
-*       av BUTTON1 tänds LED1, annars hålls den släckt.
+* blink_task: Uppgift som togglar LED3 var BLINK_PERIOD_MS millisekund.
+********************************************************************************/
+blink_task:
+   addi sp, sp, -16 /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 12(sp)   /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 8(sp)    /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)    /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)    /* Sparar undan innehållet i r4 inför användning. */
+   movi r2, LED3    /* Läser in pin-numret för LED3 i r2. */
+   call led_toggle  /* Togglar LED3. */
+   ldw r4, 0(sp)    /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)    /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)    /* Återställer r2 efter användning. */
+   ldw ra, 12(sp)   /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 16  /* Återställer stackpekaren. */
+   ret              /* Genomför återhopp. */
+
+/********************************************************************************
+* main: Ser till att samtliga lysdioder är släckta vid start och initierar
+*       avstudsningen med aktuella insignaler, profileringen (endast vid
+*       assemblering med PROFILE) samt konsolen med avbrottsdriven
+*       tömning. Därefter startas schemaläggaren, som kör uppgifterna i
+*       tabellen tasks så länge matningsspänning tillförs.
 ********************************************************************************/
 main:
-   call leds_reset            /* Släcker samtliga lysdioder vid start. */
+   call leds_reset             /* Släcker samtliga lysdioder vid start. */
+   call inputs_read            /* Läser in packade insignaler i r2. */
+   mov r3, r2                  /* Flyttar insignalerna till r3 som argument. */
+   addi r2, gp, %gprel(inputs) /* Läser in adressen till inputs i r2 relativt gp. */
+   call debounce_init          /* Initierar avstudsningen med aktuella insignaler. */
+   PROFILE_INIT                /* Nollställer profileringens tabell. */
+   movi r2, 1                  /* Läser in 1 i r2 för avbrottsdriven tömning. */
+   call console_init           /* Initierar konsolen. */
+   movhi r2, %hiadj(tasks)     /* Läser in adressen till tabellen tasks i r2. */
+   addi r2, r2, %lo(tasks)     /* Lägger till adressens lägre bitar i r2. */
+   movi r3, TASK_COUNT         /* Läser in antalet uppgifter i r3. */
+   call sched_init             /* Startar schemaläggaren. */
+   call irq_global_enable      /* Aktiverar avbrott globalt. */
 main_loop:
-   movi r2, BUTTON1           /* Läser in pin-numret för BUTTON1 i r2. */
-   call button_pressed        /* Kontrollerar ifall BUTTON1 är nedtryckt. */
-   mov r4, r2                 /* Flyttar returvärdet till r4 för senare läsning. */
-   movi r2, LED1              /* Läser in pin-numret för LED1 i r2. */
-   bne r4, zero, main_led1_on /* Om BUTTON1 är nedtryckt tänds LED1. */
-main_led1_off:
-   call led_off               /* Släcker LED1. */
-   br main_loop               /* Återstartar loopen. */
-main_led1_on:
-   call led_on                /* Tänder LED1. */
-   br main_loop               /* Återstartar loopen. */
+   call sched_run              /* Kör uppgifter som har blivit aktuella. */
+   br main_loop                /* Återstartar loopen. */
+
+/********************************************************************************
+* .sdata: Datasegment för små data, lagringsplats för basadresserna, som
+*         därmed läses via en enda instruktion relativt gp.
+********************************************************************************/
+.section .sdata, "aw"
+leds_base:     .word LEDS_BASE     /* Basadress för lysdioder. */
+switches_base: .word SWITCHES_BASE /* Basadress för slide-switchar. */
+buttons_base:  .word BUTTONS_BASE  /* Basadress för tryckknappar. */
+
+/********************************************************************************
+* .sbss: Datasegment för små nollställda data, lagringsplats för avstudsade
+*        insignaler samt antalet nedtryckningar, som därmed nås relativt gp.
+********************************************************************************/
+.section .sbss, "aw", @nobits
+inputs: .skip DEBOUNCE_SIZE /* Avstudsade slide-switchar samt tryckknappar. */
+clicks: .skip 4             /* Antal nedtryckningar av BUTTON1. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats för tabellen med programmets periodiska
+*        uppgifter, där ett tick motsvarar en millisekund, samt texterna som
+*        skrivs ut vid nedtryckning av BUTTON1.
+********************************************************************************/
+.data
+tasks:
+   SCHED_TASK inputs_task, DEBOUNCE_PERIOD_MS, 0          /* Avläsning av insignaler. */
+   SCHED_TASK blink_task, BLINK_PERIOD_MS, BLINK_PHASE_MS /* Blinkning av LED3. */
+clicks_text:      .asciz "BUTTON1: "                     /* Text före antalet nedtryckningar. */
+clicks_leds_text: .asciz " nedtryckningar, lysdioder 0x" /* Text före lysdiodernas tillstånd. */
+clicks_end_text:  .asciz "\n"                            /* Radslut. */
@@ -1,10 +1,26 @@
 /********************************************************************************
-* main.c: Demonstration av array i C. Samtliga udda tal 1 – 31 lagras i en
-*         statisk array. Samtliga element lagrade i arrayen hämtas sedan en
-*         efter en och skrivs till lysdiodernas basadress LEDS_BASE.
+* main.c: Demonstration av array i C. Udda heltal 1, 3, 5 ... lagras i två
+*         statiska arrayer om ARRAY_SIZE element vardera. Arrayernas element
+*         skrivs en efter en till lysdiodernas basadress LEDS_BASE, med
+*         PERIOD_MS millisekunder mellan varje skrivning.
 *
-*         Simulera programmet på följande länk:
-*         https://cpulator.01xz.net/?sys=nios-de10-lite
+*         Utmatningen sker via intervalltimerns avbrott i filen stream.h,
+*         så att processorn inte väntar under utmatningen. Medan en array
+*         matas ut fylls den andra med nästa följd av udda heltal (dubbel
+*         buffring), varefter den lämnas in för utmatning direkt efter
+*         den första. Därmed matas ett obegränsat antal element ut utan
+*         uppehåll, oavsett arrayernas storlek.
+*
+*         Vid kompilering för Linux ersätts LEDS_BASE av en variabel och
+*         STREAM_TEST_ARRAYS arrayer matas ut via simulerade avbrott, där
+*         varje skrivet element kontrolleras:
+*         gcc -DNIOS2_HOST main.c -o main && ./main
+*
+*         Programmet inkluderar drivrutiner från katalogen Drivrutiner och
+*         kan därmed inte klistras in i CPUlator som enskild fil. Kompilera
+*         i stället programmet för Linux enligt ovan, eller simulera
+*         motsvarande main.s via Verktyg/nios2sim.c:
+*         ./nios2sim -n 10000000 "../5. Array/main.s"
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
 ********************************************************************************/
@@ -17,34 +33,37 @@
 #define GPIO_CASE_GOLD_HW
 
 /********************************************************************************
-* Makrodefinitioner:
+* Inkluderingsdirektiv:
 ********************************************************************************/
-#ifdef GPIO_CASE_GOLD_HW
-#define LEDS_BASE (volatile uint32_t*)(0x8091740)  /* Basadress för lysdioder (CASE GOLD). */
-#define DELAY_CONSTANT 100000UL                    /* Fördröjningskonstant (CASE GOLD). */
-#else
-#define LEDS_BASE (volatile uint32_t*)(0xFF200000) /* Basadress för lysdioder (simulering). */
-#define DELAY_CONSTANT 1000000UL                   /* Fördröjningskonstant simulering. */
-#endif /* GPIO_CASE_GOLD_HW */
+#include "../Drivrutiner/stream.h"
+#include "../Drivrutiner/block.h"
+
+#ifdef NIOS2_HOST
+#include <stdio.h>
+#endif /* NIOS2_HOST */
 
 /********************************************************************************
-* delay: Genererar fördröjning genom att räkna upp från 0 till DELAY_CONSTANT
-*        via en loop. För att säkerhetsställa att kompilatorn inte slopar
-*        uppräkningen (för optimering av koden) används instruktionen
-*        nop (no operation) varje varv i loopen.
+* Makrodefinitioner:
 ********************************************************************************/
-static inline void delay(void)
-{
-   for (uint32_t i = 0; i < DELAY_CONSTANT; ++i)
-   {
-      asm volatile("nop");
-   }
-   return;
-}
+#if defined(NIOS2_HOST)
+static volatile uint32_t leds_host;                            /* Ersättning för lysdioderna. */
+#define LEDS_BASE (&leds_host)                                 /* Basadress för lysdioder (Linux). */
+#elif defined(GPIO_CASE_GOLD_HW)
+#define LEDS_BASE (volatile uint32_t*)(0x8091740)              /* Basadress för lysdioder (CASE GOLD). */
+#else
+#define LEDS_BASE (volatile uint32_t*)(0xFF200000)             /* Basadress för lysdioder (simulering). */
+#endif /* NIOS2_HOST */
+
+#define PERIOD_MS          100  /* Tid mellan varje skrivning i millisekunder. */
+#define ARRAY_SIZE         1024 /* Antalet element per array. */
+#define STREAM_TEST_ARRAYS 8    /* Antal arrayer som matas ut vid kompilering för Linux. */
 
 /********************************************************************************
 * assign: Fyller array av angiven storlek till bredden med heltal. Startvärde
-*         samt stegvärde kan väljas godtyckligt.
+*         samt stegvärde kan väljas godtyckligt. Ingen fördröjning sker, så
+*         att arrayen hinner fyllas medan föregående array matas ut.
+*         Fyllningen sker via block_assign, vars loop är utrullad så att
+*         åtta element skrivs per varv.
 *
 *         - data     : Referens till arrayen (pekar på första elementet).
 *         - size     : Arrayens storlek, dvs. antalet element den rymmer.
@@ -56,47 +75,83 @@ static inline void assign(uint32_t* data,
                           const uint32_t start_val,
                           const uint32_t step_val)
 {
-   uint32_t val = start_val;
-
-   for (uint32_t* i = data; i < data + size; ++i)
-   {
-      *i = val;
-      val += step_val;
-     delay();
-   }
+   block_assign(data, size, start_val, step_val);
    return;
 }
 
 /********************************************************************************
-* write: Skriver samtliga element lagrade i refererad array en efter en till
-*        refererat destinationsregister. En kort fördröjning genereras
-*        mellan varje skrivning.
+* write: Lämnar in refererad array för utmatning till destinationsregistret
+*        angivet vid anrop av stream_init. Funktionen returnerar direkt,
+*        varefter elementen skrivs ett i taget från intervalltimerns
+*        avbrott. Arrayen får inte ändras förrän stream_ready indikerar
+*        att dess buffert har frigjorts. Om samtliga buffertar är upptagna
+*        returneras false, annars true.
 *
-*        - data       : Referens till arrayen (pekar på första elementet).
-*        - size       : Arrayens storlek, dvs. antalet element den rymmer.
-*        - destination: Referens till destinationsregistret.
+*        - data: Referens till arrayen (pekar på första elementet).
+*        - size: Arrayens storlek, dvs. antalet element den rymmer.
 ********************************************************************************/
-static inline void write(const uint32_t* data,
-                         const uint32_t size,
-                         volatile uint32_t* destination)
+static inline bool write(const uint32_t* data,
+                         const uint32_t size)
 {
-   for (const uint32_t* i = data; i < data + size; ++i)
-   {
-      *destination = *i;
-      delay();
-   }
+   return stream_submit(data, size);
+}
+
+/********************************************************************************
+* fill_next: Fyller nästa lediga array med efterföljande udda heltal och
+*            lämnar in den för utmatning, ifall en buffert är ledig.
+*            Arrayerna används växelvis, då den äldsta inlämnade arrayen
+*            alltid frigörs först.
+*
+*            - data     : Referens till arrayerna.
+*            - next     : Referens till index för nästa array att fylla.
+*            - start_val: Referens till nästa udda heltal att lagra.
+********************************************************************************/
+static void fill_next(uint32_t data[][ARRAY_SIZE],
+                      uint8_t* next,
+                      uint32_t* start_val)
+{
+   if (!stream_ready()) return;
+   assign(data[*next], ARRAY_SIZE, *start_val, 2);
+   write(data[*next], ARRAY_SIZE);
+   *start_val += 2 * ARRAY_SIZE;
+   *next ^= 1;
    return;
 }
 
 /********************************************************************************
-* main: Deklarerar en statisk array som rymmer 16 heltal. Arrayen tilldelas
-*       samtliga udda heltal 1 - 31. Arrayens element hämtas var för sig
-*       och skrivs till lysdiodernas basadress LEDS_BASE.
+* main: Deklarerar två statiska arrayer som rymmer ARRAY_SIZE heltal vardera
+*       och startar utmatningen till lysdiodernas basadress LEDS_BASE. I
+*       huvudloopen fylls och lämnas en array in så fort en buffert är
+*       ledig, medan utmatningen sköts av intervalltimerns avbrott.
 ********************************************************************************/
 int main(void)
 {
-   uint32_t data[16];
-   assign(data, 16, 1, 2);
-   write(data, 16, LEDS_BASE);
+   static uint32_t data[STREAM_BUFFERS][ARRAY_SIZE];
+   uint32_t start_val = 1;
+   uint8_t next = 0;
+
+   stream_init(LEDS_BASE, PERIOD_MS * 1000);
+   irq_global_enable();
+
+#ifdef NIOS2_HOST
+   uint32_t errors = 0;
+
+   for (uint32_t n = 0; n < STREAM_TEST_ARRAYS * ARRAY_SIZE; ++n)
+   {
+      fill_next(data, &next, &start_val);
+      irq_host_raise(TIMER_IRQ, true);
+      irq_host_raise(TIMER_IRQ, false);
+      if (*LEDS_BASE != 2 * n + 1) errors++;
+   }
+   printf("%lu element utmatade via %u arrayer om %u element: %lu fel\n",
+          (unsigned long)(STREAM_TEST_ARRAYS * ARRAY_SIZE), STREAM_TEST_ARRAYS, ARRAY_SIZE,
+          (unsigned long)errors);
+   return errors ? 1 : 0;
+#else
+   while (1)
+   {
+      fill_next(data, &next, &start_val);
+   }
    return 0;
+#endif /* NIOS2_HOST */
 }
@@ -0,0 +1,47 @@
+/********************************************************************************
+* const.c: Demonstration av GPIO-enheter med konstant PIO-enhet samt pin,
+*          definierade via makrot GPIO_DEFINE. CASE GOLD hrdvara anvnds.
+*
+*          Programmet r funktionellt identiskt med main.c i version utan
+*          strukten gpio_port: Tv lysdioder led1 - led2 ansluts till
+*          LED[0:1], en slide-switch switch1 ansluts till SWITCH[0] och en
+*          tryckknapp button1 ansluts till KEY[0]. Insignalen frn switch1
+*          matas direkt till led1. Vid nedtryckning av button1 tnds led2,
+*          annars hlls led2 slckt.
+*
+*          Till skillnad frn strukten gpio lagras inga objekt i RAM, utan
+*          adress samt bitmask r knda vid kompilering. Varje lsning blir
+*          drmed en instruktion ldwio fljd av andi, i stllet fr att
+*          pekare samt pin-nummer lses in frn minnet vid varje anrop.
+*          Motsvarande assemblerprogram terfinns i filen const.s.
+*
+*          Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW i
+*          filen gpio.h.
+********************************************************************************/
+#include "gpio.h"
+
+/********************************************************************************
+* GPIO-enheter med konstant PIO-enhet samt pin:
+********************************************************************************/
+GPIO_DEFINE(led1, LEDS, 0)
+GPIO_DEFINE(led2, LEDS, 1)
+GPIO_DEFINE(switch1, SWITCHES, 0)
+GPIO_DEFINE(button1, BUTTONS, 0)
+
+/********************************************************************************
+* main: Genomfr kontinuerligt polling (avlsning) av tryckknapp button1 samt
+*       slide-switch switch1. Ingen initiering krvs, eftersom GPIO-enheterna
+*       saknar tillstnd i RAM. Lysdiod led1 tilldelas kontinuerligt
+*       insignalen frn switch1. Vid nedtryckning av button1 tnds lysdiod
+*       led2, annars hlls led2 slckt.
+********************************************************************************/
+int main(void)
+{
+   while (1)
+   {
+      led1_write(switch1_read());
+      led2_write(!button1_read());
+   }
+
+   return 0;
+}
@@ -0,0 +1,90 @@
+/********************************************************************************
+* const.s: Demonstration av GPIO-enheter med konstant PIO-enhet samt pin,
+*          motsvarande const.c. Basadresser samt bitmasker r knda vid
+*          assemblering, s inga GPIO-objekt lagras p stacken.
+*
+*          Tv lysdioder led1 - led2 ansluts till LED[0:1], en slide-switch
+*          switch1 ansluts till SWITCH[0] och en tryckknapp button1 ansluts
+*          till KEY[0]. Polling (avlsning) sker kontinuerligt av switch1
+*          samt button1. Insignalen frn switch1 matas direkt till led1.
+*          Vid nedtryckning av button1 tnds led2, annars hlls led2 slckt.
+*
+*          Lsning samt skrivning sker via makrona i gpio_macro.s, som
+*          expanderas p plats med basadressen lagrad i ett register och
+*          pin-numret som konstant, i stllet fr anrop av gpio_read, som
+*          lser in pekare samt pin-nummer frn minnet och berknar bitmasken
+*          via sll. Utsignalerna fr led1 och led2 sammanstlls i ett
+*          register och skrivs via GPIO_WRITE_MASK, som saknar hopp, s att
+*          lysdioderna lses samt skrivs en gng per varv.
+*
+*          Ett varv i huvudloopen krver drmed 14 instruktioner, oavsett
+*          insignaler, jmfrt med 70 instruktioner fr struct.s, som
+*          anropar gpio_read, gpio_port_write samt gpio_port_commit
+*          (uppmtt via nios2sim, antal instruktioner per tv avlsningar).
+*
+*          Programmet inkluderar drivrutiner frn katalogen Drivrutiner och kan
+*          drmed inte klistras in i CPUlator som enskild fil. Simulera i
+*          stllet programmet via Verktyg/nios2sim.c:
+*          ./nios2sim -n 2000000 -e 100000:sw=1 -e 300000:key=1 \
+*             -e 700000:key=0 "../6. Strukt/const.s"
+*
+*          Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW i
+*          filen gpio.s.
+********************************************************************************/
+
+/********************************************************************************
+* .text: Kodsegment, lagringsplats fr programkoden.
+********************************************************************************/
+.text
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/start.s"
+.include "gpio.s"
+.include "../Drivrutiner/gpio_macro.s"
+
+/********************************************************************************
+* Pin-nummer fr GPIO-enheterna:
+********************************************************************************/
+.equ LED1_PIN   , 0 /* Pin-nummer fr led1 ansluten till LED[0]. */
+.equ LED2_PIN   , 1 /* Pin-nummer fr led2 ansluten till LED[1]. */
+.equ SWITCH1_PIN, 0 /* Pin-nummer fr switch1 ansluten till SWITCH[0]. */
+.equ BUTTON1_PIN, 0 /* Pin-nummer fr button1 ansluten till KEY[0]. */
+
+.equ LEDS_MASK, (1 << LED1_PIN) | (1 << LED2_PIN) /* Bitmask fr led1 och led2. */
+
+/********************************************************************************
+* main: Lser in basadresserna fr lysdioder, slide-switchar samt tryckknappar
+*       i r5, r6 respektive r7 innan huvudloopen startas. Inga GPIO-objekt
+*       lagras p stacken, eftersom adresser samt bitmasker r konstanta.
+********************************************************************************/
+main:
+   GPIO_LOAD_BASE r5, LEDS_BASE     /* Lser in basadressen fr lysdioderna i r5. */
+   GPIO_LOAD_BASE r6, SWITCHES_BASE /* Lser in basadressen fr slide-switcharna i r6. */
+   GPIO_LOAD_BASE r7, BUTTONS_BASE  /* Lser in basadressen fr tryckknapparna i r7. */
+
+/********************************************************************************
+* main_loop: Genomfr kontinuerlig polling (avlsning) av switch1 samt button1
+*            via makron som expanderas p plats. Insignalen frn switch1 samt
+*            indikeringen av nedtryckt button1 skiftas till led1 respektive
+*            led2 och sammanstlls i r2, varefter bda lysdioderna skrivs
+*            via en enda maskerad skrivning utan hopp.
+********************************************************************************/
+main_loop:
+   GPIO_READ r2, r6, SWITCH1_PIN      /* Lser av insignalen frn switch1 till bit 0. */
+   BUTTON_PRESSED r3, r7, BUTTON1_PIN /* Lser av ifall button1 r nedtryckt till bit 0. */
+.if LED1_PIN
+   slli r2, r2, LED1_PIN /* Skiftar upp insignalen till led1. */
+.endif
+   slli r3, r3, LED2_PIN                 /* Skiftar upp nedtryckningen till led2. */
+   or r2, r2, r3                         /* Sammanstller utsignalerna fr led1 och led2. */
+   GPIO_WRITE_MASK r5, LEDS_MASK, r2, r3 /* Skriver led1 och led2 utan hopp. */
+   br main_loop                          /* terstartar loopen. */
+
+/********************************************************************************
+* main_end: Genomfr terhopp innan subrutinen main avslutas.
+********************************************************************************/
+main_end:
+   movi r2, 0 /* Laddar returvrde 0 i r2. */
+   ret        /* Genomfr terhopp. */
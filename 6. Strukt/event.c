@@ -0,0 +1,192 @@
+/********************************************************************************
+* event.c: Demonstration av verfring av GPIO-hndelser frn avbrottsrutiner
+*          till huvudloopen via den lsfria ringbufferten i gpio_event.h.
+*          CASE GOLD hrdvara anvnds.
+*
+*          Tv lysdioder led1 - led2 ansluts till LED[0:1], en slide-switch
+*          switch1 ansluts till SWITCH[0] och en tryckknapp button1 ansluts
+*          till KEY[0]. Vid avbrott lagrar callback-rutinerna en
+*          tidsstmplad hndelse i ringbufferten, utan att avbrott behver
+*          inaktiveras. Huvudloopen hmtar sedan hndelserna i tur och
+*          ordning: Vid flank p switch1 matas insignalen till led1 och vid
+*          varje nedtryckning av button1 togglas led2, ven om flera
+*          nedtryckningar sker innan huvudloopen hinner hmta hndelserna.
+*
+*          Vid kompilering fr Linux matas frst ett antal insignaler in via
+*          gpio_host_set_input. Drefter genomfrs ett stresstest, dr en
+*          producenttrd lagrar EVENT_STRESS_COUNT hndelser som samtidigt
+*          hmtas och kontrolleras av en konsumenttrd:
+*          gcc -DNIOS2_HOST -pthread event.c -o event && ./event
+*
+*          Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW i
+*          filen gpio.h.
+********************************************************************************/
+#include "gpio.h"
+#include "gpio_event.h"
+#include "../Drivrutiner/timer.h"
+
+#ifdef NIOS2_HOST
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* EVENT_STRESS_COUNT: Antal hndelser som verfrs vid stresstestet.
+********************************************************************************/
+#define EVENT_STRESS_COUNT 10000000UL
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static struct gpio led1, led2, switch1, button1;
+static struct gpio_event_queue events;
+
+/********************************************************************************
+* gpio_callback: Anropas vid flank p switch1 eller button1. En hndelse
+*                med aktuell tidpunkt samt typ av flank lagras i
+*                ringbufferten. Vid full buffert frkastas hndelsen.
+*
+*                - self: Referens till GPIO-enheten dr flanken detekterades.
+********************************************************************************/
+static void gpio_callback(struct gpio* self)
+{
+   struct gpio_event event;
+   event.tick = timer_ticks();
+   event.unit_sel = self->unit_sel;
+   event.pin = self->pin;
+   event.edge = gpio_read(self) ? GPIO_EDGE_RISING : GPIO_EDGE_FALLING;
+   event.reserved = 0;
+   gpio_event_push(&events, &event);
+   return;
+}
+
+/********************************************************************************
+* process_events: Hmtar samtliga lagrade hndelser frn ringbufferten.
+*                 Vid flank p switch1 matas insignalen till led1. Vid
+*                 nedtryckning av button1 (fallande flank) togglas led2.
+********************************************************************************/
+static void process_events(void)
+{
+   struct gpio_event event;
+
+   while (gpio_event_pop(&events, &event))
+   {
+      if (event.unit_sel == GPIO_SELECTION_SWITCH && event.pin == switch1.pin)
+      {
+         gpio_write(&led1, event.edge == GPIO_EDGE_RISING);
+      }
+      else if (event.unit_sel == GPIO_SELECTION_BUTTON && event.pin == button1.pin &&
+               event.edge == GPIO_EDGE_FALLING)
+      {
+         gpio_write(&led2, !gpio_read(&led2));
+      }
+   }
+   return;
+}
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* stress_producer: Producenttrd som lagrar EVENT_STRESS_COUNT hndelser med
+*                  lpnummer som tidsstmpel. Vid full buffert lmnas
+*                  processorn ver till konsumenten innan ett nytt frsk
+*                  grs, s att samtliga hndelser verfrs.
+*
+*                  - arg: Referens till ringbufferten.
+********************************************************************************/
+static void* stress_producer(void* arg)
+{
+   struct gpio_event_queue* queue = arg;
+   struct gpio_event event = { 0, GPIO_SELECTION_BUTTON, 0, GPIO_EDGE_FALLING, 0 };
+
+   for (uint32_t i = 0; i < EVENT_STRESS_COUNT; ++i)
+   {
+      event.tick = i;
+      event.pin = (uint8_t)(i & 3);
+      while (!gpio_event_push(queue, &event))
+      {
+         sched_yield();
+      }
+   }
+   return 0;
+}
+
+/********************************************************************************
+* stress_test: verfr EVENT_STRESS_COUNT hndelser frn en producenttrd
+*              till anropande trd, som kontrollerar att samtliga hndelser
+*              mottas i rtt ordning och med korrekt innehll. Antalet fel,
+*              antalet frsk vid full buffert samt verfringshastigheten
+*              skrivs ut. Vid felfri verfring returneras 0, annars 1.
+********************************************************************************/
+static int stress_test(void)
+{
+   static struct gpio_event_queue queue;
+   struct gpio_event event;
+   pthread_t producer;
+   uint32_t expected = 0, errors = 0;
+   const uint32_t start = timer_ticks();
+
+   gpio_event_queue_init(&queue);
+   pthread_create(&producer, 0, stress_producer, &queue);
+
+   while (expected < EVENT_STRESS_COUNT)
+   {
+      if (!gpio_event_pop(&queue, &event))
+      {
+         sched_yield();
+         continue;
+      }
+      if (event.tick != expected || event.pin != (expected & 3)) errors++;
+      expected++;
+   }
+   pthread_join(producer, 0);
+
+   const double seconds = (double)(timer_ticks() - start) / TIMER_CLOCK_HZ;
+   printf("Stresstest: %lu hndelser, %lu fel, %lu frsk vid full buffert, "
+          "%.1f miljoner hndelser per sekund\n", (unsigned long)expected,
+          (unsigned long)errors, (unsigned long)queue.dropped,
+          seconds > 0 ? expected / seconds / 1e6 : 0.0);
+   return errors ? 1 : 0;
+}
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* main: Initierar GPIO-enheterna samt ringbufferten och aktiverar avbrott
+*       fr switch1 samt button1 vid start. Drefter hmtas och hanteras
+*       lagrade hndelser kontinuerligt i huvudloopen.
+********************************************************************************/
+int main(void)
+{
+   gpio_init(&led1, 0, GPIO_SELECTION_LED);
+   gpio_init(&led2, 1, GPIO_SELECTION_LED);
+   gpio_init(&switch1, 0, GPIO_SELECTION_SWITCH);
+   gpio_init(&button1, 0, GPIO_SELECTION_BUTTON);
+   gpio_event_queue_init(&events);
+   timer_init();
+
+   gpio_enable_interrupt(&switch1, gpio_callback);
+   gpio_enable_interrupt(&button1, gpio_callback);
+   irq_global_enable();
+
+#ifdef NIOS2_HOST
+   gpio_host_set_input(GPIO_SELECTION_SWITCH, 0x01);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0E);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0F);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0E);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0F);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0E);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0F);
+   printf("SW[0] = 1 samt tre nedtryckningar av KEY[0]: %lu hndelser lagrade\n",
+          (unsigned long)gpio_event_count(&events));
+   process_events();
+   printf("Efter hantering av hndelserna:             LEDS = 0x%03x\n",
+          (unsigned)*GPIO_LEDS_BASE);
+   return stress_test();
+#else
+   while (1)
+   {
+      process_events();
+   }
+   return 0;
+#endif /* NIOS2_HOST */
+}
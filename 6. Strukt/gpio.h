@@ -7,6 +7,57 @@
 *         https://cpulator.01xz.net/?sys=nios-de10-lite
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
+*
+*         Slide-switchar och tryckknappar kan antingen lsas av via polling
+*         (gpio_read) eller via avbrott, dr en callback-rutin registreras
+*         per pin via gpio_enable_interrupt. Avbrott genereras vid flanker
+*         som detekteras via PIO-enhetens register edgecapture.
+*
+*         Flera lysdioder kan uppdateras samtidigt via strukten gpio_port,
+*         som lagrar portens utsignaler i ett skuggregister i RAM. Pinnar
+*         ettstlls, nollstlls eller togglas via bitmasker utan tkomst till
+*         PIO-enheten, varefter samtliga ndringar skrivs ut med en enda
+*         skrivning via gpio_port_commit.
+*
+*         GPIO-enheter vars PIO-enhet och pin r knda vid kompilering kan
+*         i stllet definieras via makrot GPIO_DEFINE. D genereras
+*         funktioner med konstant adress och bitmask, s att varje lsning
+*         eller skrivning kompileras till en enda tkomst av PIO-enheten
+*         utan att ngot objekt lagras i RAM.
+*
+*         Vid kompilering med makrot GPIO_SNAPSHOT (-DGPIO_SNAPSHOT) lses
+*         slide-switcharnas och tryckknapparnas dataregister av en gng per
+*         varv via gpio_snapshot_update, varefter samtliga anrop av
+*         gpio_read fr dessa enheter besvaras frn kopian i RAM. Drmed
+*         krvs tv lsningar av PIO-enheterna per varv oavsett antalet
+*         GPIO-enheter, samtidigt som samtliga insignaler under ett varv
+*         hrrr frn samma avlsning. Bitar som ndrades vid senaste
+*         avlsningen lagras samtidigt och kan lsas av via gpio_changed.
+*
+*         Vid kompilering med makrot GPIO_ASM (-DGPIO_ASM) deklareras i stllet
+*         gpio_init, gpio_write, gpio_read, gpio_mask samt funktionerna fr
+*         strukten gpio_port som externa funktioner, vilka implementeras i
+*         assembler i filen gpio_abi.s enligt processorns anropskonvention.
+*
+*         Vid kompilering fr Linux (gcc -DNIOS2_HOST) erstts PIO-enheterna
+*         av variabler och nya insignaler matas in via gpio_host_set_input.
+*
+*         Vid kompilering fr Linux med makrot GPIO_HOST_MMIO
+*         (gcc -DNIOS2_HOST -DGPIO_HOST_MMIO) placeras PIO-enheternas
+*         register i stllet i en delad fil, som mappas in i minnet via mmap
+*         innan main anropas. Filens skvg anges via miljvariabeln
+*         GPIO_HOST_FILE, annars anvnds GPIO_HOST_DEFAULT_FILE. Drmed kan
+*         lektionernas program kras ofrndrade, medan en annan process,
+*         exempelvis Verktyg/gpio_panel.c, lser av lysdioderna samt stller
+*         in slide-switchar och tryckknappar direkt i samma minne. Filen
+*         innehller tre PIO-enheter om fyra 32-bitars register vardera
+*         (lysdioder, slide-switchar och tryckknappar), med samma avstnd p
+*         16 byte som i hrdvaran. Avbrott genereras inte vid ndringar frn
+*         andra processer, utan insignalerna avlses via polling.
+*
+*         Vid kompilering med makrot MMIO_TRACE (-DMMIO_TRACE) lagras samtliga
+*         skrivningar till PIO-enheternas register via inspelaren i trace.h,
+*         frutsatt att inspelningen har startats via TRACE_INIT.
 ********************************************************************************/
 #ifndef GPIO_H_
 #define GPIO_H_
@@ -16,6 +67,16 @@
 ********************************************************************************/
 #include <stdint.h>
 #include <stdbool.h>
+#include "../Drivrutiner/irq.h"
+
+#if defined(NIOS2_HOST) && defined(GPIO_HOST_MMIO)
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* GPIO_HOST_MMIO */
 
 /********************************************************************************
 * GPIO_CASE_GOLD_HW: Makro fr att definiera basadresser fr CASE GOLD hrdvara.
@@ -26,7 +87,18 @@
 /********************************************************************************
 * Basadresser fr olika valbara in- och utenheter:
 ********************************************************************************/
-#ifdef GPIO_CASE_GOLD_HW
+#if defined(NIOS2_HOST) && defined(GPIO_HOST_MMIO)
+#define GPIO_HOST_DEFAULT_FILE "/dev/shm/nios2_gpio" /* Frvald delad fil fr PIO-registren. */
+static volatile uint32_t (*gpio_host_regs)[4];       /* PIO-register i delad fil. */
+#define GPIO_LEDS_BASE     (&gpio_host_regs[0][0])  /* Basadress fr lysdioder. */
+#define GPIO_SWITCHES_BASE (&gpio_host_regs[1][0])  /* Basadress fr slide-switchar. */
+#define GPIO_BUTTONS_BASE  (&gpio_host_regs[2][0])  /* Basadress fr tryckknappar. */
+#elif defined(NIOS2_HOST)
+static volatile uint32_t gpio_host_regs[3][4] = { { 0 }, { 0 }, { 0xF } }; /* Ersttning fr PIO-register. */
+#define GPIO_LEDS_BASE     (&gpio_host_regs[0][0])  /* Basadress fr lysdioder. */
+#define GPIO_SWITCHES_BASE (&gpio_host_regs[1][0])  /* Basadress fr slide-switchar. */
+#define GPIO_BUTTONS_BASE  (&gpio_host_regs[2][0])  /* Basadress fr tryckknappar. */
+#elif defined(GPIO_CASE_GOLD_HW)
 #define GPIO_LEDS_BASE     (volatile uint32_t*)(0x8091740)  /* Basadress fr lysdioder. */
 #define GPIO_SWITCHES_BASE (volatile uint32_t*)(0x8091750)  /* Basadress fr slide-switchar. */
 #define GPIO_BUTTONS_BASE  (volatile uint32_t*)(0x8091760)  /* Basadress fr tryckknappar. */
@@ -36,6 +108,26 @@
 #define GPIO_BUTTONS_BASE  (volatile uint32_t*)(0xFF200050) /* Basadress fr tryckknappar. */
 #endif /* GPIO_CASE_GOLD_HW_ */
 
+/********************************************************************************
+* Inkluderingsdirektiv fr inspelning av skrivningar (krver basadresserna):
+********************************************************************************/
+#include "../Drivrutiner/trace.h"
+
+/********************************************************************************
+* Index fr PIO-enheternas register relativt basadressen:
+********************************************************************************/
+#define GPIO_DATA_REG          0 /* Dataregister. */
+#define GPIO_DIRECTION_REG     1 /* Riktningsregister. */
+#define GPIO_INTERRUPTMASK_REG 2 /* Avbrottsmask, ettstlld bit aktiverar avbrott. */
+#define GPIO_EDGECAPTURE_REG   3 /* Detekterade flanker, nollstlls via skrivning av 1. */
+
+/********************************************************************************
+* Avbrottsnummer samt antal pinnar fr PIO-enheter med avbrott:
+********************************************************************************/
+#define GPIO_BUTTONS_IRQ  1  /* Avbrottsnummer fr tryckknappar. */
+#define GPIO_SWITCHES_IRQ 2  /* Avbrottsnummer fr slide-switchar. */
+#define GPIO_MAX_IRQ_PINS 10 /* Maximalt antal pinnar per PIO-enhet med avbrott. */
+
 /********************************************************************************
 * gpio_selection: Enumeration fr val av GPIO-enhet fr strukten gpio:
 ********************************************************************************/
@@ -49,15 +141,112 @@ enum gpio_selection
 /********************************************************************************
 * gpio: Strukt fr GPIO-enheter i form av lysdioder, slide-switchar och
 *       tryckknappar. Basadressen fr vald enhet sparas fr enkel
-*       skrivning/lsning.
+*       skrivning/lsning. Vid avbrott anropas lagrad callback-rutin.
 ********************************************************************************/
 struct gpio
 {
-   volatile uint32_t* base_ptr;  /* Pekare till enhetens basadress. */
-   enum gpio_selection unit_sel; /* Val av GPIO-enhet. */
-   uint8_t pin;                  /* Enhetens pin-nummer. */
+   volatile uint32_t* base_ptr;         /* Pekare till enhetens basadress. */
+   enum gpio_selection unit_sel;        /* Val av GPIO-enhet. */
+   uint8_t pin;                         /* Enhetens pin-nummer. */
+   void (*callback)(struct gpio* self); /* Callback-rutin vid avbrott, NULL om avbrott saknas. */
+};
+
+/********************************************************************************
+* gpio_port: Strukt fr samtliga pinnar i en PIO-enhet fr utsignaler. Nya
+*            utsignaler lagras i skuggregistret shadow och skrivs till
+*            PIO-enheten frst vid anrop av gpio_port_commit. Senast skrivna
+*            utsignaler lagras i output, s att skrivning endast sker vid
+*            ndring.
+********************************************************************************/
+struct gpio_port
+{
+   volatile uint32_t* base_ptr; /* Pekare till PIO-enhetens basadress. */
+   uint32_t shadow;             /* Skuggregister med vntande utsignaler. */
+   uint32_t output;             /* Utsignaler senast skrivna till PIO-enheten. */
+};
+
+/********************************************************************************
+* gpio_irq_table: Registrerade GPIO-enheter med avbrott, dr frsta index
+*                 anger enhet (0 = slide-switchar, 1 = tryckknappar) och
+*                 andra index anger pin-nummer.
+********************************************************************************/
+static struct gpio* gpio_irq_table[2][GPIO_MAX_IRQ_PINS];
+
+#ifdef GPIO_SNAPSHOT
+/********************************************************************************
+* gpio_snapshot: Strukt fr slide-switcharnas och tryckknapparnas insignaler
+*                vid senaste avlsning, dr index anger enhet
+*                (0 = slide-switchar, 1 = tryckknappar).
+********************************************************************************/
+struct gpio_snapshot
+{
+   uint32_t inputs[2];  /* Insignaler vid senaste avlsning. */
+   uint32_t changed[2]; /* Bitar som ndrades vid senaste avlsning. */
 };
 
+#ifdef GPIO_ASM
+/********************************************************************************
+* Externa funktioner implementerade i filen gpio_abi.s (assemblerad med
+* symbolen GPIO_SNAPSHOT), se motsvarande inline-funktioner nedan:
+********************************************************************************/
+void gpio_snapshot_update(void);
+void gpio_snapshot_init(void);
+bool gpio_changed(const struct gpio* self);
+#else
+/********************************************************************************
+* gpio_inputs: Senast avlsta insignaler, uppdateras via gpio_snapshot_update.
+********************************************************************************/
+static struct gpio_snapshot gpio_inputs;
+
+/********************************************************************************
+* gpio_snapshot_update: Lser av slide-switcharnas och tryckknapparnas
+*                       dataregister en gng vardera, direkt efter varandra,
+*                       och lagrar insignalerna samt vilka bitar som har
+*                       ndrats sedan fregende avlsning. Anropas en gng
+*                       per varv i huvudloopen, innan gpio_read anropas.
+********************************************************************************/
+static inline void gpio_snapshot_update(void)
+{
+   const uint32_t switches = GPIO_SWITCHES_BASE[GPIO_DATA_REG];
+   const uint32_t buttons = GPIO_BUTTONS_BASE[GPIO_DATA_REG];
+   gpio_inputs.changed[0] = gpio_inputs.inputs[0] ^ switches;
+   gpio_inputs.changed[1] = gpio_inputs.inputs[1] ^ buttons;
+   gpio_inputs.inputs[0] = switches;
+   gpio_inputs.inputs[1] = buttons;
+   return;
+}
+
+/********************************************************************************
+* gpio_snapshot_init: Lser av insignalerna en frsta gng, s att
+*                     gpio_read kan anropas direkt. Inga bitar indikeras som
+*                     ndrade efter initieringen.
+********************************************************************************/
+static inline void gpio_snapshot_init(void)
+{
+   gpio_snapshot_update();
+   gpio_inputs.changed[0] = 0;
+   gpio_inputs.changed[1] = 0;
+   return;
+}
+#endif /* GPIO_ASM */
+#endif /* GPIO_SNAPSHOT */
+
+#ifdef GPIO_ASM
+/********************************************************************************
+* Externa funktioner implementerade i filen gpio_abi.s, se motsvarande
+* inline-funktioner nedan fr beskrivning av respektive funktion:
+********************************************************************************/
+int gpio_init(struct gpio* self, const uint8_t pin, const enum gpio_selection unit_sel);
+void gpio_write(struct gpio* self, const uint8_t val);
+bool gpio_read(const struct gpio* self);
+uint32_t gpio_mask(const struct gpio* self);
+int gpio_port_init(struct gpio_port* self, const enum gpio_selection unit_sel);
+void gpio_port_set(struct gpio_port* self, const uint32_t mask);
+void gpio_port_clear(struct gpio_port* self, const uint32_t mask);
+void gpio_port_toggle(struct gpio_port* self, const uint32_t mask);
+void gpio_port_write(struct gpio_port* self, const uint32_t mask, const uint32_t value);
+void gpio_port_commit(struct gpio_port* self);
+#else
 /********************************************************************************
 * gpio_init: Initierar godtycklig GPIO-enhet ansluten till angiven pin.
 *            Vid fel sker ingen initiering och felkod 1 returneras.
@@ -67,12 +256,13 @@ struct gpio
 *            - pin     : GPIO-enhetens pin-nummer.
 *            - unit_sel: Val av enhet (lysdiod, slide-switch eller tryckknapp).
 ********************************************************************************/
-static int gpio_init(struct gpio* self,
-                     const uint8_t pin,
-                     const enum gpio_selection unit_sel)
+static inline int gpio_init(struct gpio* self,
+                            const uint8_t pin,
+                            const enum gpio_selection unit_sel)
 {
    self->pin = pin;
    self->unit_sel = unit_sel;
+   self->callback = 0;
 
    if (unit_sel == GPIO_SELECTION_LED)
    {
@@ -104,24 +294,382 @@ static inline void gpio_write(struct gpio* self,
 {
    if (val)
    {
-      *(self->base_ptr) |= (1 << self->pin);
+      TRACE_WRITE(self->base_ptr, *(self->base_ptr) | (1 << self->pin));
    }
    else
    {
-      *(self->base_ptr) &= ~(1 << self->pin);
+      TRACE_WRITE(self->base_ptr, *(self->base_ptr) & ~(1 << self->pin));
    }
    return;
 }
 
 /********************************************************************************
 * gpio_read: Returnerar insignalen frn refererad GPIO-enhet.
-*            Vid hg insignal returneras true, annars false.
+*            Vid hg insignal returneras true, annars false. Vid
+*            kompilering med makrot GPIO_SNAPSHOT returneras insignalen vid
+*            senaste anrop av gpio_snapshot_update fr slide-switchar och
+*            tryckknappar, medan lysdioder lses av direkt.
 *
 *            - self Referens till GPIO-enheten.
 ********************************************************************************/
 static inline bool gpio_read(const struct gpio* self)
 {
+#ifdef GPIO_SNAPSHOT
+   if (self->unit_sel != GPIO_SELECTION_LED)
+   {
+      return gpio_inputs.inputs[self->unit_sel - GPIO_SELECTION_SWITCH] & (1UL << self->pin);
+   }
+#endif /* GPIO_SNAPSHOT */
    return (*(self->base_ptr) & (1 << self->pin));
 }
 
+#ifdef GPIO_SNAPSHOT
+/********************************************************************************
+* gpio_changed: Indikerar ifall insignalen frn refererad slide-switch eller
+*               tryckknapp ndrades vid senaste anrop av
+*               gpio_snapshot_update. Fr lysdioder returneras false.
+*
+*               - self: Referens till GPIO-enheten.
+********************************************************************************/
+static inline bool gpio_changed(const struct gpio* self)
+{
+   if (self->unit_sel == GPIO_SELECTION_LED) return false;
+   return gpio_inputs.changed[self->unit_sel - GPIO_SELECTION_SWITCH] & (1UL << self->pin);
+}
+#endif /* GPIO_SNAPSHOT */
+
+/********************************************************************************
+* gpio_mask: Returnerar bitmask fr refererad GPIO-enhets pin, fr anvndning
+*            tillsammans med strukten gpio_port.
+*
+*            - self: Referens till GPIO-enheten.
+********************************************************************************/
+static inline uint32_t gpio_mask(const struct gpio* self)
+{
+   return 1UL << self->pin;
+}
+
+/********************************************************************************
+* gpio_port_init: Initierar port fr samtliga lysdioder. Skuggregistret
+*                 tilldelas lysdiodernas aktuella utsignaler. Vid fel sker
+*                 ingen initiering och felkod 1 returneras, annars 0.
+*
+*                 - self    : Referens till porten.
+*                 - unit_sel: Val av enhet (endast lysdioder stds).
+********************************************************************************/
+static inline int gpio_port_init(struct gpio_port* self,
+                                 const enum gpio_selection unit_sel)
+{
+   if (unit_sel != GPIO_SELECTION_LED) return 1;
+   self->base_ptr = GPIO_LEDS_BASE;
+   self->shadow = self->base_ptr[GPIO_DATA_REG];
+   self->output = self->shadow;
+   return 0;
+}
+
+/********************************************************************************
+* gpio_port_set: Ettstller angivna pinnar i portens skuggregister.
+*
+*                - self: Referens till porten.
+*                - mask: Pinnar som ska ettstllas.
+********************************************************************************/
+static inline void gpio_port_set(struct gpio_port* self,
+                                 const uint32_t mask)
+{
+   self->shadow |= mask;
+   return;
+}
+
+/********************************************************************************
+* gpio_port_clear: Nollstller angivna pinnar i portens skuggregister.
+*
+*                  - self: Referens till porten.
+*                  - mask: Pinnar som ska nollstllas.
+********************************************************************************/
+static inline void gpio_port_clear(struct gpio_port* self,
+                                   const uint32_t mask)
+{
+   self->shadow &= ~mask;
+   return;
+}
+
+/********************************************************************************
+* gpio_port_toggle: Togglar angivna pinnar i portens skuggregister.
+*
+*                   - self: Referens till porten.
+*                   - mask: Pinnar som ska togglas.
+********************************************************************************/
+static inline void gpio_port_toggle(struct gpio_port* self,
+                                    const uint32_t mask)
+{
+   self->shadow ^= mask;
+   return;
+}
+
+/********************************************************************************
+* gpio_port_write: Tilldelar angivna pinnar i portens skuggregister nya
+*                  vrden, vriga pinnar lmnas opverkade.
+*
+*                  - self : Referens till porten.
+*                  - mask : Pinnar som ska tilldelas.
+*                  - value: Nya vrden fr pinnarna i mask.
+********************************************************************************/
+static inline void gpio_port_write(struct gpio_port* self,
+                                   const uint32_t mask,
+                                   const uint32_t value)
+{
+   self->shadow = (self->shadow & ~mask) | (value & mask);
+   return;
+}
+
+/********************************************************************************
+* gpio_port_commit: Skriver portens vntande utsignaler till PIO-enheten med
+*                   en enda skrivning. Om utsignalerna inte har ndrats sedan
+*                   fregende skrivning sker ingen tkomst av PIO-enheten.
+*
+*                   - self: Referens till porten.
+********************************************************************************/
+static inline void gpio_port_commit(struct gpio_port* self)
+{
+   if (self->shadow != self->output)
+   {
+      TRACE_WRITE(&self->base_ptr[GPIO_DATA_REG], self->shadow);
+      self->output = self->shadow;
+   }
+   return;
+}
+
+#endif /* GPIO_ASM */
+
+/********************************************************************************
+* GPIO_DEFINE: Genererar funktioner fr en GPIO-enhet med konstant PIO-enhet
+*              samt pin, utan att ngot objekt lagras i RAM. Adressen samt
+*              bitmasken r knda vid kompilering, vilket innebr att lsning
+*              kompileras till en instruktion ldwio fljd av en instruktion
+*              andi, medan skrivning kompileras till ldwio, ori/and samt
+*              stwio. Fljande funktioner genereras fr angivet namn:
+*
+*              - name_mask  : Returnerar bitmasken fr enhetens pin.
+*              - name_read  : Returnerar enhetens insignal (true vid hg).
+*              - name_write : Skriver utsignal till enheten.
+*              - name_toggle: Togglar enhetens utsignal.
+*
+*              - name: Namnet p GPIO-enheten, exempelvis led1.
+*              - unit: PIO-enheten (LEDS, SWITCHES eller BUTTONS).
+*              - pin : Enhetens pin-nummer (0 - 31).
+********************************************************************************/
+#define GPIO_DEFINE(name, unit, pin)                                           \
+static inline uint32_t name##_mask(void)                                       \
+{                                                                              \
+   return 1UL << (pin);                                                        \
+}                                                                              \
+                                                                               \
+static inline bool name##_read(void)                                           \
+{                                                                              \
+   return (GPIO_##unit##_BASE)[GPIO_DATA_REG] & (1UL << (pin));                \
+}                                                                              \
+                                                                               \
+static inline void name##_write(const bool val)                                \
+{                                                                              \
+   if (val)                                                                    \
+   {                                                                           \
+      TRACE_WRITE(&(GPIO_##unit##_BASE)[GPIO_DATA_REG],                        \
+                  (GPIO_##unit##_BASE)[GPIO_DATA_REG] | (1UL << (pin)));       \
+   }                                                                           \
+   else                                                                        \
+   {                                                                           \
+      TRACE_WRITE(&(GPIO_##unit##_BASE)[GPIO_DATA_REG],                        \
+                  (GPIO_##unit##_BASE)[GPIO_DATA_REG] & ~(1UL << (pin)));      \
+   }                                                                           \
+   return;                                                                     \
+}                                                                              \
+                                                                               \
+static inline void name##_toggle(void)                                         \
+{                                                                              \
+   TRACE_WRITE(&(GPIO_##unit##_BASE)[GPIO_DATA_REG],                           \
+               (GPIO_##unit##_BASE)[GPIO_DATA_REG] ^ (1UL << (pin)));          \
+   return;                                                                     \
+}
+
+/********************************************************************************
+* gpio_clear_edges: Nollstller angivna bitar i PIO-enhetens register
+*                   edgecapture, vilket grs genom att skriva 1 till bitarna.
+*
+*                   - base_ptr: Pekare till PIO-enhetens basadress.
+*                   - mask    : Bitar som ska nollstllas.
+********************************************************************************/
+static inline void gpio_clear_edges(volatile uint32_t* base_ptr,
+                                    const uint32_t mask)
+{
+#ifdef NIOS2_HOST
+   TRACE_WRITE(&base_ptr[GPIO_EDGECAPTURE_REG], base_ptr[GPIO_EDGECAPTURE_REG] & ~mask);
+#else
+   TRACE_WRITE(&base_ptr[GPIO_EDGECAPTURE_REG], mask);
+#endif /* NIOS2_HOST */
+   return;
+}
+
+/********************************************************************************
+* gpio_irq_dispatch: Lser av och nollstller detekterade flanker fr angiven
+*                    PIO-enhet. Registrerad callback-rutin anropas fr varje
+*                    pin dr en flank har detekterats.
+*
+*                    - base_ptr: Pekare till PIO-enhetens basadress.
+*                    - table   : Registrerade GPIO-enheter fr PIO-enheten.
+********************************************************************************/
+static void gpio_irq_dispatch(volatile uint32_t* base_ptr,
+                              struct gpio* table[])
+{
+   const uint32_t edges = base_ptr[GPIO_EDGECAPTURE_REG] & base_ptr[GPIO_INTERRUPTMASK_REG];
+   gpio_clear_edges(base_ptr, edges);
+
+   for (uint8_t i = 0; i < GPIO_MAX_IRQ_PINS; ++i)
+   {
+      if ((edges & (1UL << i)) && table[i] && table[i]->callback)
+      {
+         table[i]->callback(table[i]);
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* gpio_switches_irq: Avbrottsrutin fr slide-switchar.
+********************************************************************************/
+static void gpio_switches_irq(void)
+{
+   gpio_irq_dispatch(GPIO_SWITCHES_BASE, gpio_irq_table[0]);
+   return;
+}
+
+/********************************************************************************
+* gpio_buttons_irq: Avbrottsrutin fr tryckknappar.
+********************************************************************************/
+static void gpio_buttons_irq(void)
+{
+   gpio_irq_dispatch(GPIO_BUTTONS_BASE, gpio_irq_table[1]);
+   return;
+}
+
+/********************************************************************************
+* gpio_enable_interrupt: Aktiverar avbrott fr refererad slide-switch eller
+*                        tryckknapp. Angiven callback-rutin anropas vid varje
+*                        flank (nedtryckning eller uppslppning). Tidigare
+*                        detekterade flanker nollstlls innan avbrott aktiveras.
+*                        Vid fel returneras felkod 1, annars 0.
+*
+*                        - self    : Referens till GPIO-enheten.
+*                        - callback: Callback-rutin som anropas vid avbrott.
+********************************************************************************/
+static inline int gpio_enable_interrupt(struct gpio* self,
+                                        void (*callback)(struct gpio* self))
+{
+   if (self->unit_sel == GPIO_SELECTION_SWITCH && self->pin < GPIO_MAX_IRQ_PINS)
+   {
+      gpio_irq_table[0][self->pin] = self;
+      irq_register(GPIO_SWITCHES_IRQ, gpio_switches_irq);
+   }
+   else if (self->unit_sel == GPIO_SELECTION_BUTTON && self->pin < GPIO_MAX_IRQ_PINS)
+   {
+      gpio_irq_table[1][self->pin] = self;
+      irq_register(GPIO_BUTTONS_IRQ, gpio_buttons_irq);
+   }
+   else
+   {
+      return 1;
+   }
+
+   self->callback = callback;
+   gpio_clear_edges(self->base_ptr, 1UL << self->pin);
+   TRACE_WRITE(&self->base_ptr[GPIO_INTERRUPTMASK_REG], self->base_ptr[GPIO_INTERRUPTMASK_REG] | (1UL << self->pin));
+   return 0;
+}
+
+/********************************************************************************
+* gpio_disable_interrupt: Inaktiverar avbrott fr refererad GPIO-enhet.
+*
+*                         - self: Referens till GPIO-enheten.
+********************************************************************************/
+static inline void gpio_disable_interrupt(struct gpio* self)
+{
+   if (self->unit_sel == GPIO_SELECTION_LED || self->pin >= GPIO_MAX_IRQ_PINS) return;
+   TRACE_WRITE(&self->base_ptr[GPIO_INTERRUPTMASK_REG], self->base_ptr[GPIO_INTERRUPTMASK_REG] & ~(1UL << self->pin));
+   gpio_irq_table[self->unit_sel - GPIO_SELECTION_SWITCH][self->pin] = 0;
+   self->callback = 0;
+   return;
+}
+
+#if defined(NIOS2_HOST) && defined(GPIO_HOST_MMIO)
+/********************************************************************************
+* gpio_host_map: Mappar in PIO-enheternas register frn den delade filen
+*                angiven via miljvariabeln GPIO_HOST_FILE, alternativt
+*                GPIO_HOST_DEFAULT_FILE. Anropas automatiskt innan main.
+*                Saknas filen skapas den med samtliga tryckknappar
+*                uppslppta och med ls- samt skrivrttighet enbart fr
+*                garen (0600), s att andra anvndare inte kan ndra
+*                insignalerna. En befintlig fil som gs av en annan
+*                anvndare eller r skrivbar fr andra anvnds inte. Om
+*                filen inte kan mappas in skrivs ett felmeddelande ut och
+*                lokala variabler anvnds i stllet.
+********************************************************************************/
+static void __attribute__((constructor)) gpio_host_map(void)
+{
+   static volatile uint32_t local_regs[3][4] = { { 0 }, { 0 }, { 0xF } };
+   const char* path = getenv("GPIO_HOST_FILE") ? getenv("GPIO_HOST_FILE") : GPIO_HOST_DEFAULT_FILE;
+   const int fd = open(path, O_RDWR | O_CREAT | O_NOFOLLOW, 0600);
+   struct stat st;
+   void* map = MAP_FAILED;
+   bool created = false;
+   gpio_host_regs = local_regs;
+
+   if (fd >= 0 && fstat(fd, &st) == 0 && st.st_uid == geteuid() && !(st.st_mode & S_IWOTH))
+   {
+      created = st.st_size < (off_t)sizeof(local_regs);
+      if (!created || ftruncate(fd, sizeof(local_regs)) == 0)
+      {
+         map = mmap(0, sizeof(local_regs), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      }
+   }
+   if (fd >= 0) close(fd);
+
+   if (map == MAP_FAILED)
+   {
+      fprintf(stderr, "gpio.h: kan inte mappa in %s, lokala register anvnds\n", path);
+      return;
+   }
+   gpio_host_regs = (volatile uint32_t (*)[4])map;
+   if (created) gpio_host_regs[GPIO_SELECTION_BUTTON][GPIO_DATA_REG] = 0xF;
+   return;
+}
+#endif /* GPIO_HOST_MMIO */
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* gpio_host_set_input: Matar in nya insignaler till angiven PIO-enhet vid
+*                      kompilering fr Linux. ndrade bitar registreras som
+*                      flanker i edgecapture och avbrott genereras ifall
+*                      motsvarande bit i interruptmask r ettstlld.
+*                      Avbrottssignalen uppdateras sedan p nytt, eftersom
+*                      avbrottsrutinen normalt har nollstllt flankerna.
+*                      Notera att tryckknapparna r aktivt lga, dvs. en
+*                      nedtryckt tryckknapp motsvaras av en nollstlld bit.
+*
+*                      - unit_sel: Val av enhet (slide-switch eller tryckknapp).
+*                      - value   : Nya insignaler fr samtliga pinnar.
+********************************************************************************/
+static inline void gpio_host_set_input(const enum gpio_selection unit_sel,
+                                       const uint32_t value)
+{
+   volatile uint32_t* regs = gpio_host_regs[unit_sel];
+   const uint8_t irq = unit_sel == GPIO_SELECTION_SWITCH ? GPIO_SWITCHES_IRQ : GPIO_BUTTONS_IRQ;
+   if (unit_sel == GPIO_SELECTION_LED) return;
+
+   regs[GPIO_EDGECAPTURE_REG] |= regs[GPIO_DATA_REG] ^ value;
+   regs[GPIO_DATA_REG] = value;
+   irq_host_raise(irq, regs[GPIO_EDGECAPTURE_REG] & regs[GPIO_INTERRUPTMASK_REG]);
+   irq_host_raise(irq, regs[GPIO_EDGECAPTURE_REG] & regs[GPIO_INTERRUPTMASK_REG]);
+   return;
+}
+#endif /* NIOS2_HOST */
+
 #endif /* GPIO_H_ */
@@ -7,10 +7,33 @@
 *         https://cpulator.01xz.net/?sys=nios-de10-lite
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
+*
+*         Slide-switchar och tryckknappar kan antingen lsas av via polling
+*         (gpio_read) eller via avbrott, dr en callback-rutin registreras
+*         per pin via gpio_enable_interrupt. Avbrott genereras vid flanker
+*         som detekteras via PIO-enhetens register edgecapture.
+*
+*         Flera lysdioder kan uppdateras samtidigt via en gpio_port, som
+*         lagrar portens utsignaler i ett skuggregister i RAM. Pinnar
+*         ettstlls, nollstlls eller togglas via bitmasker utan tkomst till
+*         PIO-enheten, varefter samtliga ndringar skrivs ut med en enda
+*         instruktion stwio via gpio_port_commit.
+*
+*         r symbolen GPIO_SNAPSHOT definierad innan gpio.s inkluderas lses
+*         slide-switcharnas och tryckknapparnas dataregister av en gng per
+*         varv via gpio_snapshot_update, varefter gpio_read fr dessa
+*         enheter besvaras frn kopian gpio_inputs i RAM, motsvarande gpio.h.
+*         Kopian placeras i .sbss och adresseras relativt gp, som initieras
+*         av startkoden i start.s.
 ********************************************************************************/
 .ifndef GPIO_S_
 .equ GPIO_S_, 0
 
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/irq.s"
+
 /********************************************************************************
 * GPIO_CASE_GOLD_HW: Makro fr att definiera basadresser fr CASE GOLD hrdvara.
 *                    Kommentera ut detta makro vid simulering.
@@ -30,6 +53,21 @@
 .equ BUTTONS_BASE , 0xFF200050 /* Basadress fr tryckknappar. */
 .endif /* GPIO_CASE_GOLD_HW */
 
+/********************************************************************************
+* Offsets fr PIO-enheternas register relativt basadressen:
+********************************************************************************/
+.equ GPIO_DATA_REG         , 0  /* Dataregister. */
+.equ GPIO_DIRECTION_REG    , 4  /* Riktningsregister. */
+.equ GPIO_INTERRUPTMASK_REG, 8  /* Avbrottsmask, ettstlld bit aktiverar avbrott. */
+.equ GPIO_EDGECAPTURE_REG  , 12 /* Detekterade flanker, nollstlls via skrivning av 1. */
+
+/********************************************************************************
+* Avbrottsnummer samt antal pinnar fr PIO-enheter med avbrott:
+********************************************************************************/
+.equ GPIO_BUTTONS_IRQ , 1  /* Avbrottsnummer fr tryckknappar. */
+.equ GPIO_SWITCHES_IRQ, 2  /* Avbrottsnummer fr slide-switchar. */
+.equ GPIO_MAX_IRQ_PINS, 10 /* Maximalt antal pinnar per PIO-enhet med avbrott. */
+
 /********************************************************************************
 * Makron fr val av GPIO-enhet fr strukten gpio:
 ********************************************************************************/
@@ -43,7 +81,16 @@
 .equ GPIO_BASE_PTR_OFFSET , 0  /* Offset fr pekare till GPIO-enhetens basadress. */
 .equ GPIO_UNIT_SEL_OFFSET , 4  /* Offset fr val av GPIO-enhet. */
 .equ GPIO_PIN_OFFSET      , 8  /* Offset fr GPIO-enhetens pin-nummer. */
-.equ GPIO_SIZE            , 12 /* Storleken fr ett GPIO-objekt i byte. */
+.equ GPIO_CALLBACK_OFFSET , 12 /* Offset fr adressen till callback-rutin vid avbrott. */
+.equ GPIO_SIZE            , 16 /* Storleken fr ett GPIO-objekt i byte. */
+
+/********************************************************************************
+* Offsets fr medlemmar av strukten gpio_port:
+********************************************************************************/
+.equ GPIO_PORT_BASE_PTR_OFFSET, 0  /* Offset fr pekare till PIO-enhetens basadress. */
+.equ GPIO_PORT_SHADOW_OFFSET  , 4  /* Offset fr skuggregistret med vntande utsignaler. */
+.equ GPIO_PORT_OUTPUT_OFFSET  , 8  /* Offset fr utsignaler senast skrivna till PIO-enheten. */
+.equ GPIO_PORT_SIZE           , 12 /* Storleken fr ett portobjekt i byte. */
 
 /********************************************************************************
 * gpio_init: Initierar godtycklig GPIO-enhet ansluten till angiven pin.
@@ -59,6 +106,7 @@ gpio_init:
    stw r5, 0(sp)                    /* Sparar undan innehllet i r5 infr anvndning. */
    stw r3, GPIO_PIN_OFFSET(r2)      /* Sparar angivet pin-nummer via offset. */
    stw r4, GPIO_UNIT_SEL_OFFSET(r2) /* Sparar val av GPIO-enhet via offset. */
+   stw zero, GPIO_CALLBACK_OFFSET(r2) /* Nollstller adressen till callback-rutinen. */
    movi r5, GPIO_SELECTION_LED      /* Om vald enhet r en lysdiod sparas */
    beq r4, r5, gpio_init_led        /* basadressen till lysdioderna. */
    movi r5, GPIO_SELECTION_SWITCH   /* Annars om vald enhet r en slide-switch */
@@ -139,8 +187,18 @@ gpio_read:
    stw r5, 4(sp)                    /* Sparar undan innehllet i r5 infr anvndning. */
    stw r6, 0(sp)                    /* Sparar undan innehllet i r6 infr anvndning. */
 gpio_read_load_data:
+.ifdef GPIO_SNAPSHOT
+   ldw r3, GPIO_UNIT_SEL_OFFSET(r2)    /* Laddar val av GPIO-enhet i r3. */
+   beq r3, zero, gpio_read_load_port   /* Lysdioder lses av direkt frn PIO-enheten. */
+   slli r3, r3, 2                      /* Berknar enhetens offset, ett ord per enhet. */
+   add r3, r3, gp                      /* Lgger till gp fr adressering relativt gp. */
+   ldw r4, %gprel(gpio_inputs - 4)(r3) /* Laddar enhetens insignaler i r4. */
+   br gpio_read_load_pin               /* Hoppar ver avlsningen av PIO-enheten. */
+gpio_read_load_port:
+.endif /* GPIO_SNAPSHOT */
    ldw r3, GPIO_BASE_PTR_OFFSET(r2) /* Laddar enhetens basadress i r3. */
    ldwio r4, 0(r3)                  /* Laddar aktuella signaler frn basadressen i r4. */
+gpio_read_load_pin:
    ldw r5, GPIO_PIN_OFFSET(r2)      /* Laddar enhetens pin-nummer i r5. */
 gpio_read_shift_left:
    movi r6, 1                       /* Lser in 0x01 i r6 fr bitvis skiftning av pin-numret. */
@@ -155,4 +213,444 @@ gpio_read_end:
    addi sp, sp, 16                  /* terstller stackpekaren. */
    ret                              /* Avslutar subrutinen efter att skrivningen har slutfrts. */
 
+.ifdef GPIO_SNAPSHOT
+/********************************************************************************
+* gpio_changed: Indikerar via r2 ifall insignalen frn refererad slide-switch
+*               eller tryckknapp ndrades vid senaste anrop av
+*               gpio_snapshot_update (1 = ndrad). Fr lysdioder returneras 0.
+*
+*               - r2: Referens till GPIO-enheten.
+********************************************************************************/
+gpio_changed:
+   addi sp, sp, -8                      /* Allokerar minne fr lokala variabler p stacken. */
+   stw r3, 4(sp)                        /* Sparar undan innehllet i r3 infr anvndning. */
+   stw r4, 0(sp)                        /* Sparar undan innehllet i r4 infr anvndning. */
+   ldw r3, GPIO_UNIT_SEL_OFFSET(r2)     /* Laddar val av GPIO-enhet i r3. */
+   ldw r4, GPIO_PIN_OFFSET(r2)          /* Laddar enhetens pin-nummer i r4. */
+   movi r2, 0                           /* Lagrar returvrde 0 i r2 infr lysdioder. */
+   beq r3, zero, gpio_changed_end       /* Fr lysdioder returneras 0. */
+   slli r3, r3, 2                       /* Berknar enhetens offset, ett ord per enhet. */
+   add r3, r3, gp                       /* Lgger till gp fr adressering relativt gp. */
+   ldw r3, %gprel(gpio_changes - 4)(r3) /* Laddar ndrade bitar i r3. */
+   srl r3, r3, r4                       /* Skiftar ned enhetens bit till bit 0. */
+   andi r2, r3, 1                       /* Returnerar 1 ifall insignalen har ndrats, annars 0. */
+gpio_changed_end:
+   ldw r4, 0(sp)                        /* terstller r4 efter anvndning. */
+   ldw r3, 4(sp)                        /* terstller r3 efter anvndning. */
+   addi sp, sp, 8                       /* terstller stackpekaren. */
+   ret                                  /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_snapshot_update: Lser av slide-switcharnas och tryckknapparnas
+*                       dataregister en gng vardera, direkt efter varandra,
+*                       och lagrar insignalerna samt vilka bitar som har
+*                       ndrats sedan fregende avlsning i gpio_inputs
+*                       respektive gpio_changes.
+*                       Anropas en gng per varv i huvudloopen, innan
+*                       gpio_read anropas.
+********************************************************************************/
+gpio_snapshot_update:
+   addi sp, sp, -16                           /* Allokerar minne fr lokala variabler p stacken. */
+   stw r2, 12(sp)                             /* Sparar undan innehllet i r2 infr anvndning. */
+   stw r3, 8(sp)                              /* Sparar undan innehllet i r3 infr anvndning. */
+   stw r4, 4(sp)                              /* Sparar undan innehllet i r4 infr anvndning. */
+   stw r5, 0(sp)                              /* Sparar undan innehllet i r5 infr anvndning. */
+   movhi r2, %hiadj(SWITCHES_BASE)            /* Lser in SWITCHES_BASE[31:16] i r2. */
+   addi r2, r2, %lo(SWITCHES_BASE)            /* Lgger till SWITCHES_BASE[15:0] i r2. */
+   ldwio r3, GPIO_DATA_REG(r2)                /* Lser av slide-switcharna i r3. */
+   ldwio r4, BUTTONS_BASE - SWITCHES_BASE(r2) /* Lser av tryckknapparna i r4 direkt eftert. */
+   ldw r2, %gprel(gpio_inputs)(gp)            /* Laddar fregende slide-switchar. */
+   ldw r5, %gprel(gpio_inputs + 4)(gp)        /* Laddar fregende tryckknappar. */
+   stw r3, %gprel(gpio_inputs)(gp)            /* Lagrar nya slide-switchar. */
+   stw r4, %gprel(gpio_inputs + 4)(gp)        /* Lagrar nya tryckknappar. */
+   xor r2, r2, r3                             /* Tar fram ndrade bitar fr slide-switcharna. */
+   xor r5, r5, r4                             /* Tar fram ndrade bitar fr tryckknapparna. */
+   stw r2, %gprel(gpio_changes)(gp)           /* Lagrar ndrade slide-switchar. */
+   stw r5, %gprel(gpio_changes + 4)(gp)       /* Lagrar ndrade tryckknappar. */
+   ldw r5, 0(sp)                              /* terstller r5 efter anvndning. */
+   ldw r4, 4(sp)                              /* terstller r4 efter anvndning. */
+   ldw r3, 8(sp)                              /* terstller r3 efter anvndning. */
+   ldw r2, 12(sp)                             /* terstller r2 efter anvndning. */
+   addi sp, sp, 16                            /* terstller stackpekaren. */
+   ret                                        /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_snapshot_init: Lser av insignalerna en frsta gng, s att gpio_read
+*                     kan anropas direkt. Inga bitar indikeras som ndrade
+*                     efter initieringen.
+********************************************************************************/
+gpio_snapshot_init:
+   addi sp, sp, -4                        /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 0(sp)                          /* Sparar undan terhoppsadressen i ra. */
+   call gpio_snapshot_update              /* Lser av insignalerna. */
+   stw zero, %gprel(gpio_changes)(gp)     /* Nollstller ndrade slide-switchar. */
+   stw zero, %gprel(gpio_changes + 4)(gp) /* Nollstller ndrade tryckknappar. */
+   ldw ra, 0(sp)                          /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 4                         /* terstller stackpekaren. */
+   ret                                    /* Genomfr terhopp. */
+.endif /* GPIO_SNAPSHOT */
+
+/********************************************************************************
+* gpio_mask: Returnerar bitmask fr refererad GPIO-enhets pin via r2, fr
+*            anvndning tillsammans med en gpio_port.
+*
+*            - r2: Referens till GPIO-enheten.
+********************************************************************************/
+gpio_mask:
+   addi sp, sp, -4             /* Allokerar minne fr lokala variabler p stacken. */
+   stw r3, 0(sp)               /* Sparar undan innehllet i r3 infr anvndning. */
+   ldw r3, GPIO_PIN_OFFSET(r2) /* Laddar enhetens pin-nummer i r3. */
+   movi r2, 1                  /* Lser in 0x01 i r2 fr bitvis skiftning. */
+   sll r2, r2, r3              /* Skiftar fram biten fr enhetens pin-nummer. */
+   ldw r3, 0(sp)               /* terstller r3 efter anvndning. */
+   addi sp, sp, 4              /* terstller stackpekaren. */
+   ret                         /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_init: Initierar port fr samtliga lysdioder. Skuggregistret
+*                 tilldelas lysdiodernas aktuella utsignaler. Vid fel sker
+*                 ingen initiering och felkod 1 returneras via r2, annars 0.
+*
+*                 - r2: Referens till porten.
+*                 - r3: Val av enhet (endast lysdioder stds).
+********************************************************************************/
+gpio_port_init:
+   addi sp, sp, -4                       /* Allokerar minne fr lokala variabler p stacken. */
+   stw r4, 0(sp)                         /* Sparar undan innehllet i r4 infr anvndning. */
+   movi r4, GPIO_SELECTION_LED           /* Om vald enhet inte r lysdioder */
+   bne r3, r4, gpio_port_init_error      /* returneras felkod 1. */
+   movhi r4, %hiadj(LEDS_BASE)           /* Lser in LEDS_BASE[31:16] i r4. */
+   addi r4, r4, %lo(LEDS_BASE)           /* Lgger till LEDS_BASE[15:0] i r4. */
+   stw r4, GPIO_PORT_BASE_PTR_OFFSET(r2) /* Sparar LEDS_BASE via offset. */
+   ldwio r4, GPIO_DATA_REG(r4)           /* Lser in lysdiodernas aktuella utsignaler i r4. */
+   stw r4, GPIO_PORT_SHADOW_OFFSET(r2)   /* Tilldelar skuggregistret aktuella utsignaler. */
+   stw r4, GPIO_PORT_OUTPUT_OFFSET(r2)   /* Lagrar aktuella utsignaler som senast skrivna. */
+   movi r2, 0                            /* Lagrar returkod 0 i r2. */
+   br gpio_port_init_end                 /* terstller stacken och avslutar subrutinen. */
+gpio_port_init_error:
+   movi r2, 1                            /* Lagrar returkod 1 i r2. */
+gpio_port_init_end:
+   ldw r4, 0(sp)                         /* terstller r4 efter anvndning. */
+   addi sp, sp, 4                        /* terstller stackpekaren. */
+   ret                                   /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_set: Ettstller angivna pinnar i portens skuggregister.
+*
+*                - r2: Referens till porten.
+*                - r3: Bitmask med pinnar som ska ettstllas.
+********************************************************************************/
+gpio_port_set:
+   addi sp, sp, -4                     /* Allokerar minne fr lokala variabler p stacken. */
+   stw r4, 0(sp)                       /* Sparar undan innehllet i r4 infr anvndning. */
+   ldw r4, GPIO_PORT_SHADOW_OFFSET(r2) /* Laddar skuggregistret i r4. */
+   or r4, r4, r3                       /* Ettstller angivna pinnar via bitvis OR. */
+   stw r4, GPIO_PORT_SHADOW_OFFSET(r2) /* Skriver tillbaka skuggregistret. */
+   ldw r4, 0(sp)                       /* terstller r4 efter anvndning. */
+   addi sp, sp, 4                      /* terstller stackpekaren. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_clear: Nollstller angivna pinnar i portens skuggregister.
+*
+*                  - r2: Referens till porten.
+*                  - r3: Bitmask med pinnar som ska nollstllas.
+********************************************************************************/
+gpio_port_clear:
+   addi sp, sp, -8                     /* Allokerar minne fr lokala variabler p stacken. */
+   stw r4, 4(sp)                       /* Sparar undan innehllet i r4 infr anvndning. */
+   stw r5, 0(sp)                       /* Sparar undan innehllet i r5 infr anvndning. */
+   ldw r4, GPIO_PORT_SHADOW_OFFSET(r2) /* Laddar skuggregistret i r4. */
+   nor r5, r3, r3                      /* Inverterar bitmasken i r5. */
+   and r4, r4, r5                      /* Nollstller angivna pinnar via bitvis AND. */
+   stw r4, GPIO_PORT_SHADOW_OFFSET(r2) /* Skriver tillbaka skuggregistret. */
+   ldw r5, 0(sp)                       /* terstller r5 efter anvndning. */
+   ldw r4, 4(sp)                       /* terstller r4 efter anvndning. */
+   addi sp, sp, 8                      /* terstller stackpekaren. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_toggle: Togglar angivna pinnar i portens skuggregister.
+*
+*                   - r2: Referens till porten.
+*                   - r3: Bitmask med pinnar som ska togglas.
+********************************************************************************/
+gpio_port_toggle:
+   addi sp, sp, -4                     /* Allokerar minne fr lokala variabler p stacken. */
+   stw r4, 0(sp)                       /* Sparar undan innehllet i r4 infr anvndning. */
+   ldw r4, GPIO_PORT_SHADOW_OFFSET(r2) /* Laddar skuggregistret i r4. */
+   xor r4, r4, r3                      /* Togglar angivna pinnar via bitvis XOR. */
+   stw r4, GPIO_PORT_SHADOW_OFFSET(r2) /* Skriver tillbaka skuggregistret. */
+   ldw r4, 0(sp)                       /* terstller r4 efter anvndning. */
+   addi sp, sp, 4                      /* terstller stackpekaren. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_write: Tilldelar angivna pinnar i portens skuggregister nya
+*                  vrden, vriga pinnar lmnas opverkade. Tilldelningen
+*                  genomfrs som shadow ^ ((shadow ^ value) & mask).
+*
+*                  - r2: Referens till porten.
+*                  - r3: Bitmask med pinnar som ska tilldelas.
+*                  - r4: Nya vrden fr pinnarna i bitmasken.
+********************************************************************************/
+gpio_port_write:
+   addi sp, sp, -8                     /* Allokerar minne fr lokala variabler p stacken. */
+   stw r5, 4(sp)                       /* Sparar undan innehllet i r5 infr anvndning. */
+   stw r6, 0(sp)                       /* Sparar undan innehllet i r6 infr anvndning. */
+   ldw r5, GPIO_PORT_SHADOW_OFFSET(r2) /* Laddar skuggregistret i r5. */
+   xor r6, r5, r4                      /* Tar fram pinnar vars vrde skiljer sig. */
+   and r6, r6, r3                      /* Behller enbart pinnar i bitmasken. */
+   xor r5, r5, r6                      /* Togglar pinnar som ska ndras. */
+   stw r5, GPIO_PORT_SHADOW_OFFSET(r2) /* Skriver tillbaka skuggregistret. */
+   ldw r6, 0(sp)                       /* terstller r6 efter anvndning. */
+   ldw r5, 4(sp)                       /* terstller r5 efter anvndning. */
+   addi sp, sp, 8                      /* terstller stackpekaren. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_commit: Skriver portens vntande utsignaler till PIO-enheten med
+*                   en enda instruktion stwio. Om utsignalerna inte har
+*                   ndrats sedan fregende skrivning sker ingen tkomst av
+*                   PIO-enheten.
+*
+*                   - r2: Referens till porten.
+********************************************************************************/
+gpio_port_commit:
+   addi sp, sp, -8                       /* Allokerar minne fr lokala variabler p stacken. */
+   stw r3, 4(sp)                         /* Sparar undan innehllet i r3 infr anvndning. */
+   stw r4, 0(sp)                         /* Sparar undan innehllet i r4 infr anvndning. */
+   ldw r3, GPIO_PORT_SHADOW_OFFSET(r2)   /* Laddar vntande utsignaler i r3. */
+   ldw r4, GPIO_PORT_OUTPUT_OFFSET(r2)   /* Laddar senast skrivna utsignaler i r4. */
+   beq r3, r4, gpio_port_commit_end      /* Vid ofrndrade utsignaler sker ingen skrivning. */
+   stw r3, GPIO_PORT_OUTPUT_OFFSET(r2)   /* Lagrar utsignalerna som senast skrivna. */
+   ldw r4, GPIO_PORT_BASE_PTR_OFFSET(r2) /* Laddar PIO-enhetens basadress i r4. */
+   stwio r3, GPIO_DATA_REG(r4)           /* Skriver samtliga utsignaler till PIO-enheten. */
+gpio_port_commit_end:
+   ldw r4, 0(sp)                         /* terstller r4 efter anvndning. */
+   ldw r3, 4(sp)                         /* terstller r3 efter anvndning. */
+   addi sp, sp, 8                        /* terstller stackpekaren. */
+   ret                                   /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_enable_interrupt: Aktiverar avbrott fr refererad slide-switch eller
+*                        tryckknapp. Angiven callback-rutin anropas vid varje
+*                        flank (nedtryckning eller uppslppning) med referens
+*                        till GPIO-enheten i r2. Tidigare detekterade flanker
+*                        nollstlls innan avbrott aktiveras. Vid fel returneras
+*                        felkod 1 via r2, annars 0.
+*
+*                        - r2: Referens till GPIO-enheten.
+*                        - r3: Adressen till callback-rutinen.
+********************************************************************************/
+gpio_enable_interrupt:
+   addi sp, sp, -28                       /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 24(sp)                         /* Sparar undan terhoppsadressen i ra. */
+   stw r3, 20(sp)                         /* Sparar undan innehllet i r3 infr anvndning. */
+   stw r4, 16(sp)                         /* Sparar undan innehllet i r4 infr anvndning. */
+   stw r5, 12(sp)                         /* Sparar undan innehllet i r5 infr anvndning. */
+   stw r6, 8(sp)                          /* Sparar undan innehllet i r6 infr anvndning. */
+   stw r7, 4(sp)                          /* Sparar undan innehllet i r7 infr anvndning. */
+   stw r8, 0(sp)                          /* Sparar undan innehllet i r8 infr anvndning. */
+   ldw r4, GPIO_UNIT_SEL_OFFSET(r2)       /* Laddar val av GPIO-enhet i r4. */
+   ldw r5, GPIO_PIN_OFFSET(r2)            /* Laddar enhetens pin-nummer i r5. */
+   movi r6, GPIO_MAX_IRQ_PINS             /* Om pin-numret r fr stort */
+   bgeu r5, r6, gpio_enable_interrupt_error /* returneras felkod 1. */
+   movi r6, GPIO_SELECTION_SWITCH         /* Om vald enhet r en slide-switch */
+   beq r4, r6, gpio_enable_interrupt_switch /* anvnds avbrott fr slide-switcharna. */
+   movi r6, GPIO_SELECTION_BUTTON         /* Annars om vald enhet r en tryckknapp */
+   beq r4, r6, gpio_enable_interrupt_button /* anvnds avbrott fr tryckknapparna. */
+gpio_enable_interrupt_error:
+   movi r2, 1                             /* Vid felaktigt vald enhet lagras returkod 1 i r2. */
+   br gpio_enable_interrupt_end           /* terstller stacken och avslutar subrutinen. */
+gpio_enable_interrupt_switch:
+   movi r4, 0                             /* Slide-switchar lagras frst i gpio_irq_table. */
+   movi r7, GPIO_SWITCHES_IRQ             /* Lser in avbrottsnumret i r7. */
+   movhi r8, %hiadj(gpio_switches_irq)    /* Lser in adressen till avbrottsrutinen i r8. */
+   addi r8, r8, %lo(gpio_switches_irq)    /* Lgger till adressens lgre bitar i r8. */
+   br gpio_enable_interrupt_register      /* Registrerar GPIO-enheten och avbrottsrutinen. */
+gpio_enable_interrupt_button:
+   movi r4, GPIO_MAX_IRQ_PINS * 4         /* Tryckknappar lagras efter slide-switcharna. */
+   movi r7, GPIO_BUTTONS_IRQ              /* Lser in avbrottsnumret i r7. */
+   movhi r8, %hiadj(gpio_buttons_irq)     /* Lser in adressen till avbrottsrutinen i r8. */
+   addi r8, r8, %lo(gpio_buttons_irq)     /* Lgger till adressens lgre bitar i r8. */
+gpio_enable_interrupt_register:
+   stw r3, GPIO_CALLBACK_OFFSET(r2)       /* Sparar adressen till callback-rutinen via offset. */
+   slli r6, r5, 2                         /* Berknar offset fr pin-numret i tabellen. */
+   add r4, r4, r6                         /* Lgger till offset fr vald enhet. */
+   movhi r6, %hiadj(gpio_irq_table)       /* Lser in adressen till gpio_irq_table i r6. */
+   addi r6, r6, %lo(gpio_irq_table)       /* Lgger till adressens lgre bitar i r6. */
+   add r6, r6, r4                         /* Pekar p elementet fr aktuell pin. */
+   stw r2, 0(r6)                          /* Registrerar GPIO-enheten i tabellen. */
+   movi r6, 1                             /* Lser in 0x01 i r6 fr bitvis skiftning av pin-numret. */
+   sll r6, r6, r5                         /* Skiftar fram biten fr aktuell pin. */
+   ldw r4, GPIO_BASE_PTR_OFFSET(r2)       /* Laddar enhetens basadress i r4. */
+   stwio r6, GPIO_EDGECAPTURE_REG(r4)     /* Nollstller tidigare detekterade flanker. */
+   ldwio r5, GPIO_INTERRUPTMASK_REG(r4)   /* Laddar aktuell avbrottsmask i r5. */
+   or r5, r5, r6                          /* Aktiverar avbrott fr aktuell pin. */
+   stwio r5, GPIO_INTERRUPTMASK_REG(r4)   /* Skriver tillbaka avbrottsmasken. */
+   mov r2, r7                             /* Kopierar avbrottsnumret till r2. */
+   mov r3, r8                             /* Kopierar avbrottsrutinens adress till r3. */
+   call irq_register                      /* Registrerar avbrottsrutinen och aktiverar avbrottet. */
+   movi r2, 0                             /* Lagrar returkod 0 i r2. */
+gpio_enable_interrupt_end:
+   ldw r8, 0(sp)                          /* terstller r8 efter anvndning. */
+   ldw r7, 4(sp)                          /* terstller r7 efter anvndning. */
+   ldw r6, 8(sp)                          /* terstller r6 efter anvndning. */
+   ldw r5, 12(sp)                         /* terstller r5 efter anvndning. */
+   ldw r4, 16(sp)                         /* terstller r4 efter anvndning. */
+   ldw r3, 20(sp)                         /* terstller r3 efter anvndning. */
+   ldw ra, 24(sp)                         /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 28                        /* terstller stackpekaren. */
+   ret                                    /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_disable_interrupt: Inaktiverar avbrott fr refererad GPIO-enhet.
+*
+*                         - r2: Referens till GPIO-enheten.
+********************************************************************************/
+gpio_disable_interrupt:
+   addi sp, sp, -16                       /* Allokerar minne fr lokala variabler p stacken. */
+   stw r3, 12(sp)                         /* Sparar undan innehllet i r3 infr anvndning. */
+   stw r4, 8(sp)                          /* Sparar undan innehllet i r4 infr anvndning. */
+   stw r5, 4(sp)                          /* Sparar undan innehllet i r5 infr anvndning. */
+   stw r6, 0(sp)                          /* Sparar undan innehllet i r6 infr anvndning. */
+   ldw r3, GPIO_UNIT_SEL_OFFSET(r2)       /* Laddar val av GPIO-enhet i r3. */
+   ldw r4, GPIO_PIN_OFFSET(r2)            /* Laddar enhetens pin-nummer i r4. */
+   movi r5, GPIO_MAX_IRQ_PINS             /* Om pin-numret r fr stort */
+   bgeu r4, r5, gpio_disable_interrupt_end /* avslutas subrutinen direkt. */
+   movi r5, GPIO_SELECTION_SWITCH         /* Lysdioder saknar avbrott, */
+   blt r3, r5, gpio_disable_interrupt_end /* varvid subrutinen avslutas direkt. */
+   movi r5, 1                             /* Lser in 0x01 i r5 fr bitvis skiftning av pin-numret. */
+   sll r5, r5, r4                         /* Skiftar fram biten fr aktuell pin. */
+   nor r5, r5, r5                         /* Inverterar biten fr nollstllning via AND. */
+   ldw r6, GPIO_BASE_PTR_OFFSET(r2)       /* Laddar enhetens basadress i r6. */
+   ldwio r3, GPIO_INTERRUPTMASK_REG(r6)   /* Laddar aktuell avbrottsmask i r3. */
+   and r3, r3, r5                         /* Inaktiverar avbrott fr aktuell pin. */
+   stwio r3, GPIO_INTERRUPTMASK_REG(r6)   /* Skriver tillbaka avbrottsmasken. */
+   slli r4, r4, 2                         /* Berknar offset fr pin-numret i tabellen. */
+   ldw r3, GPIO_UNIT_SEL_OFFSET(r2)       /* Laddar val av GPIO-enhet i r3 p nytt. */
+   movi r5, GPIO_SELECTION_SWITCH         /* Slide-switchar lagras frst i tabellen, */
+   beq r3, r5, gpio_disable_interrupt_clear /* tryckknappar efter slide-switcharna. */
+   addi r4, r4, GPIO_MAX_IRQ_PINS * 4     /* Lgger till offset fr tryckknapparna. */
+gpio_disable_interrupt_clear:
+   movhi r5, %hiadj(gpio_irq_table)       /* Lser in adressen till gpio_irq_table i r5. */
+   addi r5, r5, %lo(gpio_irq_table)       /* Lgger till adressens lgre bitar i r5. */
+   add r5, r5, r4                         /* Pekar p elementet fr aktuell pin. */
+   stw zero, 0(r5)                        /* Avregistrerar GPIO-enheten i tabellen. */
+   stw zero, GPIO_CALLBACK_OFFSET(r2)     /* Nollstller adressen till callback-rutinen. */
+gpio_disable_interrupt_end:
+   ldw r6, 0(sp)                          /* terstller r6 efter anvndning. */
+   ldw r5, 4(sp)                          /* terstller r5 efter anvndning. */
+   ldw r4, 8(sp)                          /* terstller r4 efter anvndning. */
+   ldw r3, 12(sp)                         /* terstller r3 efter anvndning. */
+   addi sp, sp, 16                        /* terstller stackpekaren. */
+   ret                                    /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_irq_dispatch: Lser av och nollstller detekterade flanker fr angiven
+*                    PIO-enhet. Registrerad callback-rutin anropas fr varje
+*                    pin dr en flank har detekterats, med referens till
+*                    GPIO-enheten i r2.
+*
+*                    - r2: PIO-enhetens basadress.
+*                    - r3: Adressen till registrerade GPIO-enheter i gpio_irq_table.
+********************************************************************************/
+gpio_irq_dispatch:
+   addi sp, sp, -20                       /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 16(sp)                         /* Sparar undan terhoppsadressen i ra. */
+   stw r16, 12(sp)                        /* Sparar undan innehllet i r16 infr anvndning. */
+   stw r17, 8(sp)                         /* Sparar undan innehllet i r17 infr anvndning. */
+   stw r18, 4(sp)                         /* Sparar undan innehllet i r18 infr anvndning. */
+   stw r19, 0(sp)                         /* Sparar undan innehllet i r19 infr anvndning. */
+   mov r16, r3                            /* Kopierar tabellens adress till r16. */
+   ldwio r17, GPIO_EDGECAPTURE_REG(r2)    /* Laddar detekterade flanker i r17. */
+   ldwio r18, GPIO_INTERRUPTMASK_REG(r2)  /* Laddar aktuell avbrottsmask i r18. */
+   and r17, r17, r18                      /* Behller enbart flanker med aktiverade avbrott. */
+   stwio r17, GPIO_EDGECAPTURE_REG(r2)    /* Nollstller flankerna som ska hanteras. */
+   movi r18, GPIO_MAX_IRQ_PINS            /* Lser in antalet pinnar som ska kontrolleras. */
+gpio_irq_dispatch_loop:
+   beq r18, zero, gpio_irq_dispatch_end   /* Avslutar nr samtliga pinnar har kontrollerats. */
+   andi r19, r17, 1                       /* Kontrollerar ifall en flank har detekterats. */
+   beq r19, zero, gpio_irq_dispatch_next  /* Om inte fortstter loopen med nsta pin. */
+   ldw r2, 0(r16)                         /* Laddar registrerad GPIO-enhet i r2. */
+   beq r2, zero, gpio_irq_dispatch_next   /* Saknas GPIO-enhet ignoreras flanken. */
+   ldw r19, GPIO_CALLBACK_OFFSET(r2)      /* Laddar adressen till callback-rutinen i r19. */
+   beq r19, zero, gpio_irq_dispatch_next  /* Saknas callback-rutin ignoreras flanken. */
+   callr r19                              /* Anropar callback-rutinen. */
+gpio_irq_dispatch_next:
+   srli r17, r17, 1                       /* Skiftar fram nsta pin till bit 0. */
+   addi r16, r16, 4                       /* Pekar p nsta element i tabellen. */
+   addi r18, r18, -1                      /* Rknar ned antalet kvarvarande pinnar. */
+   br gpio_irq_dispatch_loop              /* terstartar loopen. */
+gpio_irq_dispatch_end:
+   ldw r19, 0(sp)                         /* terstller r19 efter anvndning. */
+   ldw r18, 4(sp)                         /* terstller r18 efter anvndning. */
+   ldw r17, 8(sp)                         /* terstller r17 efter anvndning. */
+   ldw r16, 12(sp)                        /* terstller r16 efter anvndning. */
+   ldw ra, 16(sp)                         /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 20                        /* terstller stackpekaren. */
+   ret                                    /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_switches_irq: Avbrottsrutin fr slide-switchar.
+********************************************************************************/
+gpio_switches_irq:
+   addi sp, sp, -4                        /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 0(sp)                          /* Sparar undan terhoppsadressen i ra. */
+   movhi r2, %hi(SWITCHES_BASE)           /* Lser in SWITCHES_BASE[31:16] i r2. */
+   addi r2, r2, %lo(SWITCHES_BASE)        /* Lgger till SWITCHES_BASE[15:0] i r2. */
+   movhi r3, %hiadj(gpio_irq_table)       /* Lser in adressen till registrerade */
+   addi r3, r3, %lo(gpio_irq_table)       /* slide-switchar i r3. */
+   call gpio_irq_dispatch                 /* Anropar registrerade callback-rutiner. */
+   ldw ra, 0(sp)                          /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 4                         /* terstller stackpekaren. */
+   ret                                    /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_buttons_irq: Avbrottsrutin fr tryckknappar.
+********************************************************************************/
+gpio_buttons_irq:
+   addi sp, sp, -4                        /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 0(sp)                          /* Sparar undan terhoppsadressen i ra. */
+   movhi r2, %hi(BUTTONS_BASE)            /* Lser in BUTTONS_BASE[31:16] i r2. */
+   addi r2, r2, %lo(BUTTONS_BASE)         /* Lgger till BUTTONS_BASE[15:0] i r2. */
+   movhi r3, %hiadj(gpio_irq_table + GPIO_MAX_IRQ_PINS * 4) /* Lser in adressen till */
+   addi r3, r3, %lo(gpio_irq_table + GPIO_MAX_IRQ_PINS * 4) /* registrerade tryckknappar. */
+   call gpio_irq_dispatch                 /* Anropar registrerade callback-rutiner. */
+   ldw ra, 0(sp)                          /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 4                         /* terstller stackpekaren. */
+   ret                                    /* Genomfr terhopp. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats fr initierade variabler.
+********************************************************************************/
+.data
+
+/********************************************************************************
+* gpio_irq_table: Registrerade GPIO-enheter med avbrott. Frst lagras
+*                 slide-switchar och drefter tryckknappar, en adress per pin.
+********************************************************************************/
+gpio_irq_table:
+   .skip 2 * GPIO_MAX_IRQ_PINS * 4        /* Reserverar ett ord per pin och enhet. */
+
+.ifdef GPIO_SNAPSHOT
+/********************************************************************************
+* gpio_inputs: Senast avlsta insignaler samt ndrade bitar, motsvarande
+*              strukten gpio_snapshot i gpio.h, dr frsta ordet avser
+*              slide-switchar och andra ordet tryckknappar. Placeras i .sbss
+*              fr adressering relativt gp.
+********************************************************************************/
+.section .sbss, "aw", @nobits
+gpio_inputs:
+   .skip 2 * 4 /* Insignaler vid senaste avlsning. */
+gpio_changes:
+   .skip 2 * 4 /* Bitar som ndrades vid senaste avlsning. */
+.endif /* GPIO_SNAPSHOT */
+
+/********************************************************************************
+* tergr till kodsegmentet fr efterfljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+
 .endif /* GPIO_S_ */
@@ -0,0 +1,365 @@
+/********************************************************************************
+* gpio_abi.s: Innehller drivrutiner fr GPIO-enheter enligt Nios II-
+*             processorns anropskonvention (ABI), s att de kan lnkas
+*             direkt med C-program som inkluderar gpio.h.
+*
+*             Ingende argument verfrs via r4 - r7 och returvrde via r2.
+*             Samtliga subrutiner r lvrutiner som enbart anvnder de
+*             anroparsparade registren r2 - r7, vilket innebr att inga
+*             register behver sparas p stacken. Strukten gpio har samma
+*             minneslayout som i gpio.h, dr pin-numret lagras som en byte.
+*
+*             Jmfrt med gpio.s, dr fyra register sparas p stacken vid
+*             varje anrop, minskar gpio_read frn 16 till 6 instruktioner och
+*             gpio_write frn 21 - 24 till 10 - 11 instruktioner (inklusive
+*             ret). En inline-funktion frn gpio.h undviker dessutom call
+*             samt ret, men krver att anroparen har kompilerats med gpio.h.
+*
+*             Kompilera tillsammans med main.c enligt nedan, vilket erstter
+*             motsvarande inline-funktioner i gpio.h:
+*             nios2-elf-gcc -O2 -DGPIO_ASM main.c gpio_abi.s -o main.elf
+*
+*             Kompileras C-programmet med makrot GPIO_SNAPSHOT, vilket r
+*             avstngt som standard i main.c, definieras motsvarande symbol
+*             till assemblern via --defsym. D implementeras ven gpio_snapshot_init,
+*             gpio_snapshot_update samt gpio_changed, medan gpio_read
+*             besvaras frn kopian gpio_inputs i RAM fr slide-switchar och
+*             tryckknappar. Kopian placeras i .sbss och adresseras relativt
+*             gp, som initieras av C-programmets startkod:
+*             nios2-elf-gcc -O2 -DGPIO_ASM -DGPIO_SNAPSHOT \
+*                -Wa,--defsym,GPIO_SNAPSHOT=1 main.c gpio_abi.s -o main.elf
+*
+*             Makrot GPIO_CASE_GOLD_HW nedan mste verensstmma med
+*             motsvarande makro i filen gpio.h.
+********************************************************************************/
+
+/********************************************************************************
+* .text: Kodsegment, lagringsplats fr programkoden.
+********************************************************************************/
+.text
+
+/********************************************************************************
+* Globala subrutiner:
+********************************************************************************/
+.global gpio_init
+.global gpio_write
+.global gpio_read
+.global gpio_mask
+.global gpio_port_init
+.global gpio_port_set
+.global gpio_port_clear
+.global gpio_port_toggle
+.global gpio_port_write
+.global gpio_port_commit
+
+.ifdef GPIO_SNAPSHOT
+.global gpio_changed
+.global gpio_snapshot_update
+.global gpio_snapshot_init
+.endif /* GPIO_SNAPSHOT */
+
+/********************************************************************************
+* GPIO_CASE_GOLD_HW: Makro fr att definiera basadresser fr CASE GOLD hrdvara.
+*                    Kommentera ut detta makro vid simulering.
+********************************************************************************/
+.equ GPIO_CASE_GOLD_HW, 0
+
+/********************************************************************************
+* Basadresser fr olika valbara in- och utenheter:
+********************************************************************************/
+.ifdef GPIO_CASE_GOLD_HW
+.equ LEDS_BASE    , 0x8091740  /* Basadress fr lysdioder. */
+.equ SWITCHES_BASE, 0x8091750  /* Basadress fr slide-switchar. */
+.equ BUTTONS_BASE , 0x8091760  /* Basadress fr tryckknappar. */
+.else
+.equ LEDS_BASE    , 0xFF200000 /* Basadress fr lysdioder. */
+.equ SWITCHES_BASE, 0xFF200040 /* Basadress fr slide-switchar. */
+.equ BUTTONS_BASE , 0xFF200050 /* Basadress fr tryckknappar. */
+.endif
+
+/********************************************************************************
+* Offset fr PIO-enheternas dataregister relativt basadressen:
+********************************************************************************/
+.equ GPIO_DATA_REG, 0 /* Dataregister. */
+
+/********************************************************************************
+* Val av GPIO-enhet, motsvarar enumerationen gpio_selection i gpio.h:
+********************************************************************************/
+.equ GPIO_SELECTION_LED   , 0 /* Lysdiod. */
+.equ GPIO_SELECTION_SWITCH, 1 /* Slide-switch. */
+.equ GPIO_SELECTION_BUTTON, 2 /* Tryckknapp. */
+
+/********************************************************************************
+* Offsets fr medlemmar av strukten gpio, motsvarar layouten i gpio.h:
+********************************************************************************/
+.equ GPIO_BASE_PTR_OFFSET, 0  /* Offset fr pekare till GPIO-enhetens basadress. */
+.equ GPIO_UNIT_SEL_OFFSET, 4  /* Offset fr val av GPIO-enhet. */
+.equ GPIO_PIN_OFFSET     , 8  /* Offset fr GPIO-enhetens pin-nummer (en byte). */
+.equ GPIO_CALLBACK_OFFSET, 12 /* Offset fr adressen till callback-rutin vid avbrott. */
+
+/********************************************************************************
+* Offsets fr medlemmar av strukten gpio_port, motsvarar layouten i gpio.h:
+********************************************************************************/
+.equ GPIO_PORT_BASE_PTR_OFFSET, 0 /* Offset fr pekare till PIO-enhetens basadress. */
+.equ GPIO_PORT_SHADOW_OFFSET  , 4 /* Offset fr skuggregistret med vntande utsignaler. */
+.equ GPIO_PORT_OUTPUT_OFFSET  , 8 /* Offset fr utsignaler senast skrivna till PIO-enheten. */
+
+/********************************************************************************
+* gpio_init: Initierar godtycklig GPIO-enhet ansluten till angiven pin.
+*            Vid fel sker ingen initiering och felkod 1 returneras via r2.
+*            Annars returneras 0 via r2 efter slutfrd initiering.
+*
+*            - r4: Referens till GPIO-enheten.
+*            - r5: GPIO-enhetens pin-nummer.
+*            - r6: Val av enhet (lysdiod, slide-switch eller tryckknapp).
+********************************************************************************/
+gpio_init:
+   stb r5, GPIO_PIN_OFFSET(r4)        /* Sparar angivet pin-nummer via offset. */
+   stw r6, GPIO_UNIT_SEL_OFFSET(r4)   /* Sparar val av GPIO-enhet via offset. */
+   stw zero, GPIO_CALLBACK_OFFSET(r4) /* Nollstller adressen till callback-rutinen. */
+   movhi r2, %hiadj(LEDS_BASE)        /* Lser in LEDS_BASE[31:16] i r2. */
+   addi r2, r2, %lo(LEDS_BASE)        /* Lgger till LEDS_BASE[15:0] i r2. */
+   beq r6, zero, gpio_init_store      /* Om vald enhet r en lysdiod sparas LEDS_BASE. */
+   movhi r2, %hiadj(SWITCHES_BASE)    /* Lser in SWITCHES_BASE[31:16] i r2. */
+   addi r2, r2, %lo(SWITCHES_BASE)    /* Lgger till SWITCHES_BASE[15:0] i r2. */
+   movi r3, GPIO_SELECTION_SWITCH     /* Om vald enhet r en slide-switch */
+   beq r6, r3, gpio_init_store        /* sparas SWITCHES_BASE. */
+   movhi r2, %hiadj(BUTTONS_BASE)     /* Lser in BUTTONS_BASE[31:16] i r2. */
+   addi r2, r2, %lo(BUTTONS_BASE)     /* Lgger till BUTTONS_BASE[15:0] i r2. */
+   movi r3, GPIO_SELECTION_BUTTON     /* Om vald enhet r en tryckknapp */
+   beq r6, r3, gpio_init_store        /* sparas BUTTONS_BASE. */
+   movi r2, 1                         /* Vid felaktigt vald enhet lagras returkod 1 i r2. */
+   ret                                /* Genomfr terhopp. */
+gpio_init_store:
+   stw r2, GPIO_BASE_PTR_OFFSET(r4)   /* Sparar vald basadress via offset. */
+   movi r2, 0                         /* Lagrar returkod 0 i r2. */
+   ret                                /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_write: Skriver utsignal till refererad GPIO-enhet.
+*
+*             - r4: Referens till GPIO-enheten.
+*             - r5: Vrdet som ska skrivas (0 eller 1).
+********************************************************************************/
+gpio_write:
+   ldw r2, GPIO_BASE_PTR_OFFSET(r4) /* Laddar enhetens basadress i r2. */
+   ldbu r3, GPIO_PIN_OFFSET(r4)     /* Laddar enhetens pin-nummer i r3. */
+   movi r6, 1                       /* Lser in 0x01 i r6 fr bitvis skiftning. */
+   sll r3, r6, r3                   /* Skiftar fram biten fr enhetens pin-nummer. */
+   ldwio r6, GPIO_DATA_REG(r2)      /* Laddar aktuella signaler i r6. */
+   andi r5, r5, 0xFF                /* Behller enbart vrdets lgsta byte (uint8_t). */
+   beq r5, zero, gpio_write_low     /* Om vrdet r 0 stts utsignalen till lg. */
+   or r6, r6, r3                    /* Annars stts enhetens signal till hg. */
+   stwio r6, GPIO_DATA_REG(r2)      /* Skriver det uppdaterade vrdet till basadressen. */
+   ret                              /* Genomfr terhopp. */
+gpio_write_low:
+   nor r3, r3, r3                   /* Inverterar biten fr enhetens pin-nummer. */
+   and r6, r6, r3                   /* Stter enhetens signal till lg. */
+   stwio r6, GPIO_DATA_REG(r2)      /* Skriver det uppdaterade vrdet till basadressen. */
+   ret                              /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_read: Returnerar insignalen frn refererad GPIO-enhet via r2.
+*            Vid hg insignal returneras 1, annars 0.
+*
+*            - r4: Referens till GPIO-enheten.
+********************************************************************************/
+gpio_read:
+.ifdef GPIO_SNAPSHOT
+   ldw r2, GPIO_UNIT_SEL_OFFSET(r4)    /* Laddar val av GPIO-enhet i r2. */
+   beq r2, zero, gpio_read_port        /* Lysdioder lses av direkt frn PIO-enheten. */
+   slli r2, r2, 2                      /* Berknar enhetens offset, ett ord per enhet. */
+   add r2, r2, gp                      /* Lgger till gp fr adressering relativt gp. */
+   ldbu r3, GPIO_PIN_OFFSET(r4)        /* Laddar enhetens pin-nummer i r3. */
+   ldw r2, %gprel(gpio_inputs - 4)(r2) /* Laddar enhetens insignaler i r2. */
+   srl r2, r2, r3                      /* Skiftar ned enhetens bit till bit 0. */
+   andi r2, r2, 1                      /* Returnerar 1 vid hg insignal, annars 0. */
+   ret                                 /* Genomfr terhopp. */
+gpio_read_port:
+.endif /* GPIO_SNAPSHOT */
+   ldw r2, GPIO_BASE_PTR_OFFSET(r4) /* Laddar enhetens basadress i r2. */
+   ldbu r3, GPIO_PIN_OFFSET(r4)     /* Laddar enhetens pin-nummer i r3. */
+   ldwio r2, GPIO_DATA_REG(r2)      /* Laddar aktuella signaler i r2. */
+   srl r2, r2, r3                   /* Skiftar ned enhetens bit till bit 0. */
+   andi r2, r2, 1                   /* Returnerar 1 vid hg insignal, annars 0. */
+   ret                              /* Genomfr terhopp. */
+
+.ifdef GPIO_SNAPSHOT
+/********************************************************************************
+* gpio_changed: Indikerar via r2 ifall insignalen frn refererad slide-switch
+*               eller tryckknapp ndrades vid senaste anrop av
+*               gpio_snapshot_update (1 = ndrad). Fr lysdioder returneras 0.
+*
+*               - r4: Referens till GPIO-enheten.
+********************************************************************************/
+gpio_changed:
+   ldw r2, GPIO_UNIT_SEL_OFFSET(r4)     /* Laddar val av GPIO-enhet i r2. */
+   beq r2, zero, gpio_changed_end       /* Fr lysdioder returneras 0. */
+   slli r2, r2, 2                       /* Berknar enhetens offset, ett ord per enhet. */
+   add r2, r2, gp                       /* Lgger till gp fr adressering relativt gp. */
+   ldbu r3, GPIO_PIN_OFFSET(r4)         /* Laddar enhetens pin-nummer i r3. */
+   ldw r2, %gprel(gpio_changes - 4)(r2) /* Laddar enhetens ndrade bitar i r2. */
+   srl r2, r2, r3                       /* Skiftar ned enhetens bit till bit 0. */
+   andi r2, r2, 1                       /* Returnerar 1 ifall insignalen har ndrats, annars 0. */
+gpio_changed_end:
+   ret                                  /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_snapshot_update: Lser av slide-switcharnas och tryckknapparnas
+*                       dataregister en gng vardera, direkt efter varandra,
+*                       och lagrar insignalerna i gpio_inputs samt vilka
+*                       bitar som har ndrats sedan fregende avlsning i
+*                       gpio_changes.
+********************************************************************************/
+gpio_snapshot_update:
+   movhi r2, %hiadj(SWITCHES_BASE)            /* Lser in SWITCHES_BASE[31:16] i r2. */
+   addi r2, r2, %lo(SWITCHES_BASE)            /* Lgger till SWITCHES_BASE[15:0] i r2. */
+   ldwio r3, GPIO_DATA_REG(r2)                /* Lser av slide-switcharna i r3. */
+   ldwio r4, BUTTONS_BASE - SWITCHES_BASE(r2) /* Lser av tryckknapparna i r4 direkt eftert. */
+   ldw r5, %gprel(gpio_inputs)(gp)            /* Laddar fregende slide-switchar i r5. */
+   ldw r6, %gprel(gpio_inputs + 4)(gp)        /* Laddar fregende tryckknappar i r6. */
+   stw r3, %gprel(gpio_inputs)(gp)            /* Lagrar nya slide-switchar. */
+   stw r4, %gprel(gpio_inputs + 4)(gp)        /* Lagrar nya tryckknappar. */
+   xor r5, r5, r3                             /* Tar fram ndrade bitar fr slide-switcharna. */
+   xor r6, r6, r4                             /* Tar fram ndrade bitar fr tryckknapparna. */
+   stw r5, %gprel(gpio_changes)(gp)           /* Lagrar ndrade slide-switchar. */
+   stw r6, %gprel(gpio_changes + 4)(gp)       /* Lagrar ndrade tryckknappar. */
+   ret                                        /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_snapshot_init: Lser av insignalerna en frsta gng, s att gpio_read
+*                     kan anropas direkt. Inga bitar indikeras som ndrade
+*                     efter initieringen.
+********************************************************************************/
+gpio_snapshot_init:
+   movhi r2, %hiadj(SWITCHES_BASE)            /* Lser in SWITCHES_BASE[31:16] i r2. */
+   addi r2, r2, %lo(SWITCHES_BASE)            /* Lgger till SWITCHES_BASE[15:0] i r2. */
+   ldwio r3, GPIO_DATA_REG(r2)                /* Lser av slide-switcharna i r3. */
+   ldwio r4, BUTTONS_BASE - SWITCHES_BASE(r2) /* Lser av tryckknapparna i r4 direkt eftert. */
+   stw r3, %gprel(gpio_inputs)(gp)            /* Lagrar slide-switcharna. */
+   stw r4, %gprel(gpio_inputs + 4)(gp)        /* Lagrar tryckknapparna. */
+   stw zero, %gprel(gpio_changes)(gp)         /* Nollstller ndrade slide-switchar. */
+   stw zero, %gprel(gpio_changes + 4)(gp)     /* Nollstller ndrade tryckknappar. */
+   ret                                        /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_inputs: Senast avlsta insignaler samt ndrade bitar, motsvarande
+*              strukten gpio_snapshot i gpio.h, dr frsta ordet avser
+*              slide-switchar och andra ordet tryckknappar. Placeras i .sbss
+*              fr adressering relativt gp.
+********************************************************************************/
+.section .sbss, "aw", @nobits
+gpio_inputs:
+   .skip 2 * 4 /* Insignaler vid senaste avlsning. */
+gpio_changes:
+   .skip 2 * 4 /* Bitar som ndrades vid senaste avlsning. */
+
+/********************************************************************************
+* tergr till kodsegmentet fr efterfljande kod.
+********************************************************************************/
+.text
+.endif /* GPIO_SNAPSHOT */
+
+/********************************************************************************
+* gpio_mask: Returnerar bitmask fr refererad GPIO-enhets pin via r2, fr
+*            anvndning tillsammans med strukten gpio_port.
+*
+*            - r4: Referens till GPIO-enheten.
+********************************************************************************/
+gpio_mask:
+   ldbu r3, GPIO_PIN_OFFSET(r4) /* Laddar enhetens pin-nummer i r3. */
+   movi r2, 1                   /* Lser in 0x01 i r2 fr bitvis skiftning. */
+   sll r2, r2, r3               /* Skiftar fram biten fr enhetens pin-nummer. */
+   ret                          /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_init: Initierar port fr samtliga lysdioder. Skuggregistret
+*                 tilldelas lysdiodernas aktuella utsignaler. Vid fel sker
+*                 ingen initiering och felkod 1 returneras via r2, annars 0.
+*
+*                 - r4: Referens till porten.
+*                 - r5: Val av enhet (endast lysdioder stds).
+********************************************************************************/
+gpio_port_init:
+   movi r2, 1                            /* Lagrar returkod 1 i r2 infr eventuellt fel. */
+   bne r5, zero, gpio_port_init_end      /* Om vald enhet inte r lysdioder returneras 1. */
+   movhi r3, %hiadj(LEDS_BASE)           /* Lser in LEDS_BASE[31:16] i r3. */
+   addi r3, r3, %lo(LEDS_BASE)           /* Lgger till LEDS_BASE[15:0] i r3. */
+   stw r3, GPIO_PORT_BASE_PTR_OFFSET(r4) /* Sparar LEDS_BASE via offset. */
+   ldwio r3, GPIO_DATA_REG(r3)           /* Lser in lysdiodernas aktuella utsignaler i r3. */
+   stw r3, GPIO_PORT_SHADOW_OFFSET(r4)   /* Tilldelar skuggregistret aktuella utsignaler. */
+   stw r3, GPIO_PORT_OUTPUT_OFFSET(r4)   /* Lagrar aktuella utsignaler som senast skrivna. */
+   movi r2, 0                            /* Lagrar returkod 0 i r2. */
+gpio_port_init_end:
+   ret                                   /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_set: Ettstller angivna pinnar i portens skuggregister.
+*
+*                - r4: Referens till porten.
+*                - r5: Pinnar som ska ettstllas.
+********************************************************************************/
+gpio_port_set:
+   ldw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Laddar skuggregistret i r2. */
+   or r2, r2, r5                       /* Ettstller angivna pinnar. */
+   stw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Skriver tillbaka skuggregistret. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_clear: Nollstller angivna pinnar i portens skuggregister.
+*
+*                  - r4: Referens till porten.
+*                  - r5: Pinnar som ska nollstllas.
+********************************************************************************/
+gpio_port_clear:
+   ldw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Laddar skuggregistret i r2. */
+   nor r5, r5, r5                      /* Inverterar angivna pinnar. */
+   and r2, r2, r5                      /* Nollstller angivna pinnar. */
+   stw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Skriver tillbaka skuggregistret. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_toggle: Togglar angivna pinnar i portens skuggregister.
+*
+*                   - r4: Referens till porten.
+*                   - r5: Pinnar som ska togglas.
+********************************************************************************/
+gpio_port_toggle:
+   ldw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Laddar skuggregistret i r2. */
+   xor r2, r2, r5                      /* Togglar angivna pinnar. */
+   stw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Skriver tillbaka skuggregistret. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_write: Tilldelar angivna pinnar i portens skuggregister nya
+*                  vrden, vriga pinnar lmnas opverkade.
+*
+*                  - r4: Referens till porten.
+*                  - r5: Pinnar som ska tilldelas.
+*                  - r6: Nya vrden fr pinnarna i r5.
+********************************************************************************/
+gpio_port_write:
+   ldw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Laddar skuggregistret i r2. */
+   xor r3, r2, r6                      /* Tar fram bitar som skiljer sig frn nya vrden. */
+   and r3, r3, r5                      /* Behller enbart skillnader fr angivna pinnar. */
+   xor r2, r2, r3                      /* Tilldelar angivna pinnar nya vrden. */
+   stw r2, GPIO_PORT_SHADOW_OFFSET(r4) /* Skriver tillbaka skuggregistret. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_commit: Skriver portens vntande utsignaler till PIO-enheten med
+*                   en enda instruktion stwio. Om utsignalerna inte har
+*                   ndrats sedan fregende skrivning sker ingen tkomst av
+*                   PIO-enheten.
+*
+*                   - r4: Referens till porten.
+********************************************************************************/
+gpio_port_commit:
+   ldw r2, GPIO_PORT_SHADOW_OFFSET(r4)   /* Laddar skuggregistret i r2. */
+   ldw r3, GPIO_PORT_OUTPUT_OFFSET(r4)   /* Laddar senast skrivna utsignaler i r3. */
+   beq r2, r3, gpio_port_commit_end      /* Vid ofrndrade utsignaler sker ingen skrivning. */
+   ldw r3, GPIO_PORT_BASE_PTR_OFFSET(r4) /* Laddar PIO-enhetens basadress i r3. */
+   stwio r2, GPIO_DATA_REG(r3)           /* Skriver samtliga utsignaler till PIO-enheten. */
+   stw r2, GPIO_PORT_OUTPUT_OFFSET(r4)   /* Lagrar skrivna utsignaler. */
+gpio_port_commit_end:
+   ret                                   /* Genomfr terhopp. */
@@ -0,0 +1,145 @@
+/********************************************************************************
+* gpio_event.h: Innehller en lsfri ringbuffert fr verfring av
+*               tidsstmplade GPIO-hndelser frn avbrottsrutiner till
+*               huvudloopen, via strukten gpio_event_queue.
+*
+*               Bufferten har exakt en producent (avbrottsrutinen) samt
+*               exakt en konsument (huvudloopen). Producenten skriver enbart
+*               till head och konsumenten enbart till tail, s varken
+*               blockering eller inaktivering av avbrott krvs. Indexen rknas
+*               upp fritt och maskeras vid tkomst, vilket frutstter att
+*               kapaciteten r en tvpotens. r bufferten full frkastas nya
+*               hndelser och antalet frkastade hndelser rknas upp.
+*
+*               Korta nedtryckningar mellan tv avlsningar i huvudloopen gr
+*               drmed inte frlorade, till skillnad frn polling via
+*               gpio_read, som enbart returnerar aktuell insignal.
+********************************************************************************/
+#ifndef GPIO_EVENT_H_
+#define GPIO_EVENT_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************************************************************************
+* GPIO_EVENT_CAPACITY: Ringbuffertens kapacitet, mste vara en tvpotens.
+********************************************************************************/
+#ifndef GPIO_EVENT_CAPACITY
+#define GPIO_EVENT_CAPACITY 16
+#endif /* GPIO_EVENT_CAPACITY */
+
+#if (GPIO_EVENT_CAPACITY & (GPIO_EVENT_CAPACITY - 1)) != 0
+#error "GPIO_EVENT_CAPACITY mste vara en tvpotens!"
+#endif /* GPIO_EVENT_CAPACITY */
+
+/********************************************************************************
+* GPIO_EVENT_MASK: Bitmask fr omvandling av index till position i bufferten.
+********************************************************************************/
+#define GPIO_EVENT_MASK (GPIO_EVENT_CAPACITY - 1)
+
+/********************************************************************************
+* gpio_edge: Enumeration fr typ av flank.
+********************************************************************************/
+enum gpio_edge
+{
+   GPIO_EDGE_FALLING, /* Fallande flank (insignalen har gtt frn hg till lg). */
+   GPIO_EDGE_RISING   /* Stigande flank (insignalen har gtt frn lg till hg). */
+};
+
+/********************************************************************************
+* gpio_event: Strukt fr en tidsstmplad GPIO-hndelse om 8 byte.
+********************************************************************************/
+struct gpio_event
+{
+   uint32_t tick;    /* Tidpunkt fr hndelsen i antal klockpulser. */
+   uint8_t unit_sel; /* GPIO-enheten (enum gpio_selection). */
+   uint8_t pin;      /* Pin-numret dr flanken detekterades. */
+   uint8_t edge;     /* Typ av flank (enum gpio_edge). */
+   uint8_t reserved; /* Utfyllnad till 8 byte. */
+};
+
+/********************************************************************************
+* gpio_event_queue: Lsfri ringbuffert fr GPIO-hndelser med en producent
+*                   samt en konsument. Indexen head och tail rknas upp fritt,
+*                   dr antalet lagrade hndelser utgrs av head - tail.
+********************************************************************************/
+struct gpio_event_queue
+{
+   uint32_t head;                                 /* Nsta index att skriva, gs av producenten. */
+   uint32_t tail;                                 /* Nsta index att lsa, gs av konsumenten. */
+   uint32_t dropped;                              /* Antal frkastade hndelser, gs av producenten. */
+   struct gpio_event events[GPIO_EVENT_CAPACITY]; /* Lagrade hndelser. */
+};
+
+/********************************************************************************
+* gpio_event_queue_init: Initierar ringbufferten som tom. Fr enbart anropas
+*                        innan avbrott som anvnder bufferten aktiveras.
+*
+*                        - self: Referens till ringbufferten.
+********************************************************************************/
+static inline void gpio_event_queue_init(struct gpio_event_queue* self)
+{
+   self->head = 0;
+   self->tail = 0;
+   self->dropped = 0;
+   return;
+}
+
+/********************************************************************************
+* gpio_event_push: Lagrar en kopia av angiven hndelse i ringbufferten och
+*                  returnerar true. Om bufferten r full frkastas hndelsen,
+*                  antalet frkastade hndelser rknas upp och false
+*                  returneras. Fr enbart anropas av producenten.
+*
+*                  - self : Referens till ringbufferten.
+*                  - event: Referens till hndelsen som ska lagras.
+********************************************************************************/
+static inline bool gpio_event_push(struct gpio_event_queue* self,
+                                   const struct gpio_event* event)
+{
+   const uint32_t head = self->head;
+
+   if (head - __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE) >= GPIO_EVENT_CAPACITY)
+   {
+      self->dropped++;
+      return false;
+   }
+   self->events[head & GPIO_EVENT_MASK] = *event;
+   __atomic_store_n(&self->head, head + 1, __ATOMIC_RELEASE);
+   return true;
+}
+
+/********************************************************************************
+* gpio_event_pop: Kopierar ldsta hndelsen i ringbufferten till angiven
+*                 destination och returnerar true. Om bufferten r tom
+*                 returneras false. Fr enbart anropas av konsumenten.
+*
+*                 - self : Referens till ringbufferten.
+*                 - event: Referens till destinationen fr hndelsen.
+********************************************************************************/
+static inline bool gpio_event_pop(struct gpio_event_queue* self,
+                                  struct gpio_event* event)
+{
+   const uint32_t tail = self->tail;
+
+   if (__atomic_load_n(&self->head, __ATOMIC_ACQUIRE) == tail) return false;
+   *event = self->events[tail & GPIO_EVENT_MASK];
+   __atomic_store_n(&self->tail, tail + 1, __ATOMIC_RELEASE);
+   return true;
+}
+
+/********************************************************************************
+* gpio_event_count: Returnerar antalet lagrade hndelser i ringbufferten.
+*
+*                   - self: Referens till ringbufferten.
+********************************************************************************/
+static inline uint32_t gpio_event_count(const struct gpio_event_queue* self)
+{
+   return __atomic_load_n(&self->head, __ATOMIC_ACQUIRE) -
+          __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+}
+
+#endif /* GPIO_EVENT_H_ */
@@ -0,0 +1,139 @@
+/********************************************************************************
+* gpio_event.s: Innehller en lsfri ringbuffert fr verfring av
+*               tidsstmplade GPIO-hndelser frn avbrottsrutiner till
+*               huvudloopen, motsvarande gpio_event.h.
+*
+*               Bufferten har exakt en producent (avbrottsrutinen) samt
+*               exakt en konsument (huvudloopen). Producenten skriver enbart
+*               till head och konsumenten enbart till tail, s varken
+*               blockering eller inaktivering av avbrott krvs. Hndelsen
+*               skrivs till bufferten innan head rknas upp, s att
+*               konsumenten aldrig lser en ofullstndig hndelse.
+*
+*               Minneslayouten verensstmmer med strukterna gpio_event samt
+*               gpio_event_queue i gpio_event.h.
+********************************************************************************/
+.ifndef GPIO_EVENT_S_
+.equ GPIO_EVENT_S_, 0
+
+/********************************************************************************
+* Ringbuffertens kapacitet, mste vara en tvpotens:
+********************************************************************************/
+.equ GPIO_EVENT_CAPACITY, 16                      /* Ringbuffertens kapacitet. */
+.equ GPIO_EVENT_MASK    , GPIO_EVENT_CAPACITY - 1 /* Bitmask fr position i bufferten. */
+
+/********************************************************************************
+* Typ av flank:
+********************************************************************************/
+.equ GPIO_EDGE_FALLING, 0 /* Fallande flank. */
+.equ GPIO_EDGE_RISING , 1 /* Stigande flank. */
+
+/********************************************************************************
+* Offsets fr medlemmar av strukten gpio_event:
+********************************************************************************/
+.equ GPIO_EVENT_TICK_OFFSET    , 0 /* Offset fr tidpunkten i antal klockpulser. */
+.equ GPIO_EVENT_UNIT_SEL_OFFSET, 4 /* Offset fr GPIO-enheten (en byte). */
+.equ GPIO_EVENT_PIN_OFFSET     , 5 /* Offset fr pin-numret (en byte). */
+.equ GPIO_EVENT_EDGE_OFFSET    , 6 /* Offset fr typ av flank (en byte). */
+.equ GPIO_EVENT_SIZE           , 8 /* Storleken fr en hndelse i byte. */
+
+/********************************************************************************
+* Offsets fr medlemmar av strukten gpio_event_queue:
+********************************************************************************/
+.equ GPIO_EVENT_QUEUE_HEAD_OFFSET   , 0  /* Offset fr nsta index att skriva. */
+.equ GPIO_EVENT_QUEUE_TAIL_OFFSET   , 4  /* Offset fr nsta index att lsa. */
+.equ GPIO_EVENT_QUEUE_DROPPED_OFFSET, 8  /* Offset fr antal frkastade hndelser. */
+.equ GPIO_EVENT_QUEUE_EVENTS_OFFSET , 12 /* Offset fr lagrade hndelser. */
+.equ GPIO_EVENT_QUEUE_SIZE          , GPIO_EVENT_QUEUE_EVENTS_OFFSET + GPIO_EVENT_CAPACITY * GPIO_EVENT_SIZE
+
+/********************************************************************************
+* gpio_event_queue_init: Initierar ringbufferten som tom. Fr enbart anropas
+*                        innan avbrott som anvnder bufferten aktiveras.
+*
+*                        - r2: Referens till ringbufferten.
+********************************************************************************/
+gpio_event_queue_init:
+   stw zero, GPIO_EVENT_QUEUE_HEAD_OFFSET(r2)    /* Nollstller index fr skrivning. */
+   stw zero, GPIO_EVENT_QUEUE_TAIL_OFFSET(r2)    /* Nollstller index fr lsning. */
+   stw zero, GPIO_EVENT_QUEUE_DROPPED_OFFSET(r2) /* Nollstller antal frkastade hndelser. */
+   ret                                           /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_event_push: Lagrar en kopia av refererad hndelse i ringbufferten och
+*                  returnerar 1 via r2. Om bufferten r full frkastas
+*                  hndelsen, antalet frkastade hndelser rknas upp och 0
+*                  returneras via r2. Fr enbart anropas av producenten.
+*
+*                  - r2: Referens till ringbufferten.
+*                  - r3: Referens till hndelsen som ska lagras.
+********************************************************************************/
+gpio_event_push:
+   addi sp, sp, -12                               /* Allokerar minne fr lokala variabler p stacken. */
+   stw r4, 8(sp)                                  /* Sparar undan innehllet i r4 infr anvndning. */
+   stw r5, 4(sp)                                  /* Sparar undan innehllet i r5 infr anvndning. */
+   stw r6, 0(sp)                                  /* Sparar undan innehllet i r6 infr anvndning. */
+   ldw r4, GPIO_EVENT_QUEUE_HEAD_OFFSET(r2)       /* Lser in index fr skrivning i r4. */
+   ldw r5, GPIO_EVENT_QUEUE_TAIL_OFFSET(r2)       /* Lser in index fr lsning i r5. */
+   sub r5, r4, r5                                 /* Berknar antalet lagrade hndelser. */
+   movi r6, GPIO_EVENT_CAPACITY                   /* Lser in buffertens kapacitet i r6. */
+   bltu r5, r6, gpio_event_push_store             /* Om bufferten inte r full lagras hndelsen. */
+   ldw r5, GPIO_EVENT_QUEUE_DROPPED_OFFSET(r2)    /* Annars lses antal frkastade hndelser in, */
+   addi r5, r5, 1                                 /* rknas upp ett steg */
+   stw r5, GPIO_EVENT_QUEUE_DROPPED_OFFSET(r2)    /* och skrivs tillbaka. */
+   movi r2, 0                                     /* Lagrar returkod 0 i r2. */
+   br gpio_event_push_end                         /* terstller stacken och avslutar subrutinen. */
+gpio_event_push_store:
+   andi r5, r4, GPIO_EVENT_MASK                   /* Berknar hndelsens position i bufferten. */
+   slli r5, r5, 3                                 /* Multiplicerar positionen med GPIO_EVENT_SIZE. */
+   add r5, r5, r2                                 /* Adderar ringbuffertens adress. */
+   ldw r6, 0(r3)                                  /* Kopierar hndelsens frsta ord */
+   stw r6, GPIO_EVENT_QUEUE_EVENTS_OFFSET(r5)     /* till bufferten. */
+   ldw r6, 4(r3)                                  /* Kopierar hndelsens andra ord */
+   stw r6, GPIO_EVENT_QUEUE_EVENTS_OFFSET + 4(r5) /* till bufferten. */
+   addi r4, r4, 1                                 /* Rknar upp index fr skrivning. */
+   stw r4, GPIO_EVENT_QUEUE_HEAD_OFFSET(r2)       /* Publicerar hndelsen fr konsumenten. */
+   movi r2, 1                                     /* Lagrar returkod 1 i r2. */
+gpio_event_push_end:
+   ldw r6, 0(sp)                                  /* terstller r6 efter anvndning. */
+   ldw r5, 4(sp)                                  /* terstller r5 efter anvndning. */
+   ldw r4, 8(sp)                                  /* terstller r4 efter anvndning. */
+   addi sp, sp, 12                                /* terstller stackpekaren. */
+   ret                                            /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_event_pop: Kopierar ldsta hndelsen i ringbufferten till refererad
+*                 destination och returnerar 1 via r2. Om bufferten r tom
+*                 returneras 0 via r2. Fr enbart anropas av konsumenten.
+*
+*                 - r2: Referens till ringbufferten.
+*                 - r3: Referens till destinationen fr hndelsen.
+********************************************************************************/
+gpio_event_pop:
+   addi sp, sp, -12                               /* Allokerar minne fr lokala variabler p stacken. */
+   stw r4, 8(sp)                                  /* Sparar undan innehllet i r4 infr anvndning. */
+   stw r5, 4(sp)                                  /* Sparar undan innehllet i r5 infr anvndning. */
+   stw r6, 0(sp)                                  /* Sparar undan innehllet i r6 infr anvndning. */
+   ldw r4, GPIO_EVENT_QUEUE_TAIL_OFFSET(r2)       /* Lser in index fr lsning i r4. */
+   ldw r5, GPIO_EVENT_QUEUE_HEAD_OFFSET(r2)       /* Lser in index fr skrivning i r5. */
+   bne r4, r5, gpio_event_pop_load                /* Om bufferten inte r tom hmtas hndelsen. */
+   movi r2, 0                                     /* Annars lagras returkod 0 i r2. */
+   br gpio_event_pop_end                          /* terstller stacken och avslutar subrutinen. */
+gpio_event_pop_load:
+   andi r5, r4, GPIO_EVENT_MASK                   /* Berknar hndelsens position i bufferten. */
+   slli r5, r5, 3                                 /* Multiplicerar positionen med GPIO_EVENT_SIZE. */
+   add r5, r5, r2                                 /* Adderar ringbuffertens adress. */
+   ldw r6, GPIO_EVENT_QUEUE_EVENTS_OFFSET(r5)     /* Kopierar hndelsens frsta ord */
+   stw r6, 0(r3)                                  /* till destinationen. */
+   ldw r6, GPIO_EVENT_QUEUE_EVENTS_OFFSET + 4(r5) /* Kopierar hndelsens andra ord */
+   stw r6, 4(r3)                                  /* till destinationen. */
+   addi r4, r4, 1                                 /* Rknar upp index fr lsning. */
+   stw r4, GPIO_EVENT_QUEUE_TAIL_OFFSET(r2)       /* Frigr platsen fr producenten. */
+   movi r2, 1                                     /* Lagrar returkod 1 i r2. */
+gpio_event_pop_end:
+   ldw r6, 0(sp)                                  /* terstller r6 efter anvndning. */
+   ldw r5, 4(sp)                                  /* terstller r5 efter anvndning. */
+   ldw r4, 8(sp)                                  /* terstller r4 efter anvndning. */
+   addi sp, sp, 12                                /* terstller stackpekaren. */
+   ret                                            /* Genomfr terhopp. */
+
+.endif /* GPIO_EVENT_S_ */
@@ -0,0 +1,154 @@
+/********************************************************************************
+* interrupt.c: Demonstration av avbrottsstyrd avlsning av GPIO-enheter i form
+*              av slide-switchar samt tryckknappar via strukten gpio.
+*              CASE GOLD hrdvara anvnds.
+*
+*              Tre lysdioder led1 - led3 ansluts till LED[0:2], en slide-switch
+*              switch1 ansluts till SWITCH[0] och en tryckknapp button1 ansluts
+*              till KEY[0]. Avbrott aktiveras fr switch1 samt button1, s
+*              ingen polling sker i huvudloopen. Vid ndring av switch1 matas
+*              insignalen till led1. Vid nedtryckning av button1 togglas led2.
+*              Under tiden blinkar led3 i huvudloopen, dr blinkningen
+*              styrs av en icke-blockerande frdrjning via intervalltimern.
+*
+*              Bde huvudloopen och callback-rutinerna lser, modifierar
+*              och skriver lysdiodernas dataregister. Avbrott inaktiveras
+*              drfr under huvudloopens toggling av led3, s att ett
+*              avbrott mellan lsningen och skrivningen inte skriver ver
+*              callback-rutinernas uppdatering av led1 eller led2.
+*
+*              Vid kompilering fr Linux matas ett antal insignaler in via
+*              gpio_host_set_input och led3 togglas, varefter lysdiodernas
+*              tillstnd kontrolleras efter varje steg. Returkoden anger
+*              antalet fel:
+*              gcc -DNIOS2_HOST interrupt.c -o interrupt && ./interrupt
+*
+*              Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW i
+*              filen gpio.h.
+********************************************************************************/
+#include "gpio.h"
+#include "../Drivrutiner/timer.h"
+
+#ifdef NIOS2_HOST
+#include <stdio.h>
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* BLINK_PERIOD_MS: Tid mellan varje toggling av led3 i millisekunder.
+********************************************************************************/
+#define BLINK_PERIOD_MS 100
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static struct gpio led1, led2, led3, switch1, button1;
+
+/********************************************************************************
+* switch1_callback: Anropas vid flank p switch1. Insignalen frn switch1
+*                   matas till led1.
+*
+*                   - self: Referens till slide-switchen.
+********************************************************************************/
+static void switch1_callback(struct gpio* self)
+{
+   gpio_write(&led1, gpio_read(self));
+   return;
+}
+
+/********************************************************************************
+* button1_callback: Anropas vid flank p button1. Vid nedtryckning (lg
+*                   insignal) togglas led2, uppslppning ignoreras.
+*
+*                   - self: Referens till tryckknappen.
+********************************************************************************/
+static void button1_callback(struct gpio* self)
+{
+   if (!gpio_read(self))
+   {
+      gpio_write(&led2, !gpio_read(&led2));
+   }
+   return;
+}
+
+/********************************************************************************
+* led3_toggle: Togglar led3 med avbrott inaktiverade, s att lsningen och
+*              skrivningen av lysdiodernas dataregister inte kan avbrytas av
+*              callback-rutinerna, som skriver till samma register.
+********************************************************************************/
+static inline void led3_toggle(void)
+{
+   irq_global_disable();
+   gpio_write(&led3, !gpio_read(&led3));
+   irq_global_enable();
+   return;
+}
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* leds_check: Skriver ut lysdiodernas tillstnd efter angivet steg och
+*             returnerar 1 ifall tillstndet avviker frn frvntat vrde,
+*             annars 0.
+*
+*             - step    : Beskrivning av steget.
+*             - expected: Frvntat tillstnd fr lysdioderna.
+********************************************************************************/
+static uint32_t leds_check(const char* step,
+                           const uint32_t expected)
+{
+   const uint32_t leds = *GPIO_LEDS_BASE;
+   printf("%-18s LEDS = 0x%03x (frvntat 0x%03x)\n", step, (unsigned)leds, (unsigned)expected);
+   return leds != expected;
+}
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* main: Initierar GPIO-enheterna och aktiverar avbrott fr switch1 samt
+*       button1 vid start. Drefter blinkar led3 kontinuerligt, medan
+*       led1 och led2 uppdateras av callback-rutinerna vid avbrott.
+*       Frdrjningen fr led3 blockerar inte, s huvudloopen r fri att
+*       utfra annat arbete mellan varje toggling.
+********************************************************************************/
+int main(void)
+{
+   gpio_init(&led1, 0, GPIO_SELECTION_LED);
+   gpio_init(&led2, 1, GPIO_SELECTION_LED);
+   gpio_init(&led3, 2, GPIO_SELECTION_LED);
+   gpio_init(&switch1, 0, GPIO_SELECTION_SWITCH);
+   gpio_init(&button1, 0, GPIO_SELECTION_BUTTON);
+
+   gpio_enable_interrupt(&switch1, switch1_callback);
+   gpio_enable_interrupt(&button1, button1_callback);
+   irq_global_enable();
+
+#ifdef NIOS2_HOST
+   uint32_t errors = 0;
+   gpio_host_set_input(GPIO_SELECTION_SWITCH, 0x01);
+   errors += leds_check("SW[0] = 1:", 0x001);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0E);
+   errors += leds_check("KEY[0] nedtryckt:", 0x003);
+   led3_toggle();
+   errors += leds_check("led3 togglad:", 0x007);
+   gpio_host_set_input(GPIO_SELECTION_BUTTON, 0x0F);
+   errors += leds_check("KEY[0] uppslppt:", 0x007);
+   gpio_host_set_input(GPIO_SELECTION_SWITCH, 0x00);
+   errors += leds_check("SW[0] = 0:", 0x006);
+   led3_toggle();
+   errors += leds_check("led3 togglad:", 0x002);
+   printf("%lu fel\n", (unsigned long)errors);
+   return errors ? 1 : 0;
+#else
+   struct timer_deadline blink;
+   timer_init();
+   timer_deadline_init(&blink, BLINK_PERIOD_MS * 1000UL);
+
+   while (1)
+   {
+      if (timer_deadline_reached(&blink))
+      {
+         led3_toggle();
+         timer_deadline_restart(&blink);
+      }
+   }
+   return 0;
+#endif /* NIOS2_HOST */
+}
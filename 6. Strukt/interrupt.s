@@ -0,0 +1,186 @@
+/********************************************************************************
+* interrupt.s: Demonstration av avbrottsstyrd avlsning av GPIO-enheter i form
+*              av slide-switchar samt tryckknappar via strukten gpio.
+*
+*              Tre lysdioder led1 - led3 ansluts till LED[0:2], en slide-switch
+*              switch1 ansluts till SWITCH[0] och en tryckknapp button1 ansluts
+*              till KEY[0]. Avbrott aktiveras fr switch1 samt button1, s
+*              ingen polling sker i huvudloopen. Vid ndring av switch1 matas
+*              insignalen till led1. Vid nedtryckning av button1 togglas led2.
+*              Under tiden blinkar led3 i huvudloopen, dr blinkningen
+*              styrs av en icke-blockerande frdrjning via intervalltimern.
+*
+*              Bde huvudloopen och callback-rutinerna lser, modifierar
+*              och skriver lysdiodernas dataregister. Avbrott inaktiveras
+*              drfr under huvudloopens toggling av led3, s att ett
+*              avbrott mellan lsningen och skrivningen inte skriver ver
+*              callback-rutinernas uppdatering av led1 eller led2.
+*
+*              Programmet inkluderar drivrutiner frn katalogen Drivrutiner och
+*              kan drmed inte klistras in i CPUlator som enskild fil. Simulera
+*              i stllet programmet via Verktyg/nios2sim.c:
+*              ./nios2sim -n 2000000 -e 100000:sw=1 -e 300000:key=1 \
+*                 -e 700000:key=0 "../6. Strukt/interrupt.s"
+*
+*              Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW i
+*              filen gpio.s.
+********************************************************************************/
+
+/********************************************************************************
+* .text: Kodsegment, lagringsplats fr programkoden.
+********************************************************************************/
+.text
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/start.s"
+.include "gpio.s"
+.include "../Drivrutiner/timer.s"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ BLINK_PERIOD_US, 100000 /* Tid mellan varje toggling av led3 i mikrosekunder. */
+
+/********************************************************************************
+* switch1_callback: Anropas vid flank p switch1. Insignalen frn switch1
+*                   matas till led1.
+*
+*                   - r2: Referens till slide-switchen.
+********************************************************************************/
+switch1_callback:
+   addi sp, sp, -8        /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 4(sp)          /* Sparar undan terhoppsadressen i ra. */
+   stw r3, 0(sp)          /* Sparar undan innehllet i r3 infr anvndning. */
+   call gpio_read         /* Lser av slide-switchens insignal. */
+   mov r3, r2             /* Kopierar insignalen till r3 fr skrivning till led1. */
+   movhi r2, %hiadj(led1) /* Lser in adressen till led1 i r2. */
+   addi r2, r2, %lo(led1) /* Lgger till adressens lgre bitar i r2. */
+   call gpio_write        /* Skriver ny utsignal till led1. */
+   ldw r3, 0(sp)          /* terstller r3 efter anvndning. */
+   ldw ra, 4(sp)          /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 8         /* terstller stackpekaren. */
+   ret                    /* Genomfr terhopp. */
+
+/********************************************************************************
+* button1_callback: Anropas vid flank p button1. Vid nedtryckning (lg
+*                   insignal) togglas led2, uppslppning ignoreras.
+*
+*                   - r2: Referens till tryckknappen.
+********************************************************************************/
+button1_callback:
+   addi sp, sp, -8                    /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 4(sp)                      /* Sparar undan terhoppsadressen i ra. */
+   stw r3, 0(sp)                      /* Sparar undan innehllet i r3 infr anvndning. */
+   call gpio_read                     /* Lser av tryckknappens insignal. */
+   bne r2, zero, button1_callback_end /* Vid uppslppning sker ingen tgrd. */
+   movhi r2, %hiadj(led2)             /* Lser in adressen till led2 i r2. */
+   addi r2, r2, %lo(led2)             /* Lgger till adressens lgre bitar i r2. */
+   call gpio_read                     /* Lser av lysdiodens aktuella utsignal. */
+   xori r3, r2, 1                     /* Inverterar utsignalen fr toggling av led2. */
+   movhi r2, %hiadj(led2)             /* Lser in adressen till led2 i r2 p nytt. */
+   addi r2, r2, %lo(led2)             /* Lgger till adressens lgre bitar i r2. */
+   call gpio_write                    /* Skriver ny utsignal till led2. */
+button1_callback_end:
+   ldw r3, 0(sp)                      /* terstller r3 efter anvndning. */
+   ldw ra, 4(sp)                      /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 8                     /* terstller stackpekaren. */
+   ret                                /* Genomfr terhopp. */
+
+/********************************************************************************
+* main: Initierar GPIO-enheterna och aktiverar avbrott fr switch1 samt
+*       button1 vid start. Drefter blinkar led3 kontinuerligt, medan
+*       led1 och led2 uppdateras av callback-rutinerna vid avbrott.
+********************************************************************************/
+main:
+   call timer_init /* Startar intervalltimern infr frdrjningar. */
+
+   movhi r2, %hiadj(led1)      /* Lser in adressen till led1 i r2. */
+   addi r2, r2, %lo(led1)      /* Lgger till adressens lgre bitar i r2. */
+   movi r3, 0                  /* Laddar lysdiodens pin-nummer i r3. */
+   movi r4, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r4. */
+   call gpio_init              /* Initierar led1 ansluten till LED[0]. */
+
+   movhi r2, %hiadj(led2)      /* Lser in adressen till led2 i r2. */
+   addi r2, r2, %lo(led2)      /* Lgger till adressens lgre bitar i r2. */
+   movi r3, 1                  /* Laddar lysdiodens pin-nummer i r3. */
+   movi r4, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r4. */
+   call gpio_init              /* Initierar led2 ansluten till LED[1]. */
+
+   movhi r2, %hiadj(led3)      /* Lser in adressen till led3 i r2. */
+   addi r2, r2, %lo(led3)      /* Lgger till adressens lgre bitar i r2. */
+   movi r3, 2                  /* Laddar lysdiodens pin-nummer i r3. */
+   movi r4, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r4. */
+   call gpio_init              /* Initierar led3 ansluten till LED[2]. */
+
+   movhi r2, %hiadj(switch1)      /* Lser in adressen till switch1 i r2. */
+   addi r2, r2, %lo(switch1)      /* Lgger till adressens lgre bitar i r2. */
+   movi r3, 0                     /* Laddar slide-switchens pin-nummer i r3. */
+   movi r4, GPIO_SELECTION_SWITCH /* Laddar val av GPIO-enhet i r4. */
+   call gpio_init                 /* Initierar switch1 ansluten till SWITCH[0]. */
+
+   movhi r2, %hiadj(button1)      /* Lser in adressen till button1 i r2. */
+   addi r2, r2, %lo(button1)      /* Lgger till adressens lgre bitar i r2. */
+   movi r3, 0                     /* Laddar tryckknappens pin-nummer i r3. */
+   movi r4, GPIO_SELECTION_BUTTON /* Laddar val av GPIO-enhet i r4. */
+   call gpio_init                 /* Initierar button1 ansluten till KEY[0]. */
+
+/********************************************************************************
+* main_enable_interrupts: Registrerar callback-rutiner fr switch1 samt
+*                         button1 och aktiverar avbrott globalt.
+********************************************************************************/
+main_enable_interrupts:
+   movhi r2, %hiadj(switch1)          /* Lser in adressen till switch1 i r2. */
+   addi r2, r2, %lo(switch1)          /* Lgger till adressens lgre bitar i r2. */
+   movhi r3, %hiadj(switch1_callback) /* Lser in adressen till callback-rutinen i r3. */
+   addi r3, r3, %lo(switch1_callback) /* Lgger till adressens lgre bitar i r3. */
+   call gpio_enable_interrupt         /* Aktiverar avbrott fr switch1. */
+
+   movhi r2, %hiadj(button1)          /* Lser in adressen till button1 i r2. */
+   addi r2, r2, %lo(button1)          /* Lgger till adressens lgre bitar i r2. */
+   movhi r3, %hiadj(button1_callback) /* Lser in adressen till callback-rutinen i r3. */
+   addi r3, r3, %lo(button1_callback) /* Lgger till adressens lgre bitar i r3. */
+   call gpio_enable_interrupt         /* Aktiverar avbrott fr button1. */
+   call irq_global_enable             /* Aktiverar avbrott globalt. */
+   movhi r2, %hiadj(blink)            /* Lser in adressen till blink i r2. */
+   addi r2, r2, %lo(blink)            /* Lgger till adressens lgre bitar i r2. */
+   movhi r3, %hiadj(BLINK_PERIOD_US)  /* Lser in BLINK_PERIOD_US[31:16] i r3. */
+   addi r3, r3, %lo(BLINK_PERIOD_US)  /* Lgger till BLINK_PERIOD_US[15:0] i r3. */
+   call timer_deadline_init           /* Startar frdrjningen fr blinkning av led3. */
+
+/********************************************************************************
+* main_loop: Togglar led3 varje gng frdrjningen blink har passerat, varefter
+*            frdrjningen startas om. Frdrjningen blockerar inte och
+*            ingen polling sker av switch1 eller button1. Avbrott r
+*            inaktiverade under togglingen, se ovan.
+********************************************************************************/
+main_loop:
+   movhi r2, %hiadj(blink)     /* Lser in adressen till blink i r2. */
+   addi r2, r2, %lo(blink)     /* Lgger till adressens lgre bitar i r2. */
+   call timer_deadline_reached /* Kontrollerar ifall frdrjningen har passerat. */
+   beq r2, zero, main_loop     /* Om inte fortstter loopen utan toggling. */
+   movhi r2, %hiadj(blink)     /* Lser in adressen till blink i r2 p nytt. */
+   addi r2, r2, %lo(blink)     /* Lgger till adressens lgre bitar i r2. */
+   call timer_deadline_restart /* Startar om frdrjningen rknat frn sluttiden. */
+   movhi r2, %hiadj(led3)      /* Lser in adressen till led3 i r2. */
+   addi r2, r2, %lo(led3)      /* Lgger till adressens lgre bitar i r2. */
+   call irq_global_disable     /* Inaktiverar avbrott under lsning och skrivning. */
+   call gpio_read              /* Lser av lysdiodens aktuella utsignal. */
+   xori r3, r2, 1              /* Inverterar utsignalen fr toggling av led3. */
+   movhi r2, %hiadj(led3)      /* Lser in adressen till led3 i r2 p nytt. */
+   addi r2, r2, %lo(led3)      /* Lgger till adressens lgre bitar i r2. */
+   call gpio_write             /* Skriver ny utsignal till led3. */
+   call irq_global_enable      /* Aktiverar avbrott igen. */
+   br main_loop                /* terstartar loopen. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats fr GPIO-enheterna samt frdrjningen.
+********************************************************************************/
+.data
+led1:    .skip GPIO_SIZE           /* Lysdiod ansluten till LED[0]. */
+led2:    .skip GPIO_SIZE           /* Lysdiod ansluten till LED[1]. */
+led3:    .skip GPIO_SIZE           /* Lysdiod ansluten till LED[2]. */
+switch1: .skip GPIO_SIZE           /* Slide-switch ansluten till SWITCH[0]. */
+button1: .skip GPIO_SIZE           /* Tryckknapp ansluten till KEY[0]. */
+blink:   .skip TIMER_DEADLINE_SIZE /* Frdrjning fr blinkning av led3. */
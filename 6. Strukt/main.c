@@ -9,33 +9,112 @@
 *         samt button1. Insignalen frn switch1 matas direkt till led1.
 *         Vid nedtryckning av button1 tnds led2, annars hlls led2 slckt.
 *
-*         Simulera programmet p fljande lnk:
-*         https://cpulator.01xz.net/?sys=nios-de10-lite
+*         Lysdioderna uppdateras via porten leds, dr nya utsignaler samlas
+*         i ett skuggregister och skrivs ut med hgst en skrivning till
+*         LEDS_BASE per varv i huvudloopen.
+*
+*         Vid kompilering med makrot GPIO_SNAPSHOT lses insignalerna av en
+*         gng per varv via gpio_snapshot_update, s att switch1 och button1
+*         avlses vid samma tillflle och gpio_read besvaras frn en kopia i
+*         RAM i stllet fr att lsa PIO-enheten vid varje anrop.
+*
+*         Skrivningarna till PIO-enheterna kan spelas in via trace.h genom
+*         att kompilera med makrot MMIO_TRACE, se gpio.h.
+*
+*         Frdrjningen frn switch1 samt button1 till led1 respektive led2
+*         kan mtas via profile.h genom att kompilera med makrot PROFILE.
+*         Region PROFILE_EDGE mter tiden frn avlsningen av insignalerna
+*         till skrivningen av lysdioderna under varv dr lysdioderna
+*         ndrades, medan region PROFILE_LOOP mter varje varv i
+*         huvudloopen. En flank intrffar hgst ett varv fre avlsningen,
+*         s lngsta frdrjning frn flank till lysdiod r summan av
+*         regionernas lngsta tider. Tabellen lses av via debuggern.
+*
+*         Programmet inkluderar gpio.h samt drivrutiner frn katalogen
+*         Drivrutiner och kan drmed inte klistras in i CPUlator som
+*         enskild fil. Kompilera i stllet programmet fr Linux och flj
+*         lysdioderna via Verktyg/gpio_panel.c:
+*         gcc -DNIOS2_HOST -DGPIO_HOST_MMIO main.c -o main && ./main
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW i
 *         filen gpio.h.
 ********************************************************************************/
+
+/********************************************************************************
+* GPIO_SNAPSHOT: Makro fr att lsa av insignalerna en gng per varv i
+*                huvudloopen, se gpio.h. Avlsningen krver ett extra anrop
+*                per varv samt en extra gren i gpio_read och r drfr
+*                avstngd som standard. Ta bort kommentaren nedan (eller
+*                kompilera med -DGPIO_SNAPSHOT) fr att aktivera den.
+********************************************************************************/
+/* #define GPIO_SNAPSHOT */
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
 #include "gpio.h"
 
+#define PROFILE_REGIONS 2 /* Antal regioner som mts via profile.h. */
+#include "../Drivrutiner/profile.h"
+
+/********************************************************************************
+* Makrodefinitioner fr profileringen:
+********************************************************************************/
+#define PROFILE_EDGE 0 /* Region frn avlsning till skrivning vid ndrad insignal. */
+#define PROFILE_LOOP 1 /* Region fr ett varv i huvudloopen. */
+
 /********************************************************************************
-* main: Initierar GPIO-enheterna vid start. Sedan genomfrs kontinuerligt
-*       polling (avlsning) av tryckknapp button1 samt slide-switch switch1.
+* main: Startar inspelningen av skrivningar (endast vid kompilering med
+*       MMIO_TRACE) och initierar GPIO-enheterna vid start. Sedan genomfrs
+*       kontinuerligt polling (avlsning) av tryckknapp button1 samt
+*       slide-switch switch1. Vid kompilering med GPIO_SNAPSHOT lses
+*       samtliga insignaler av en gng i brjan av varje varv.
 *       Lysdiod led1 tilldelas kontinuerligt insignalen frn switch1.
 *       Vid nedtryckning av button1 tnds lysdiod led2, annars hlls led2 slckt.
+*       Utsignalerna fr led1 och led2 tilldelas porten leds via en maskerad
+*       skrivning, varefter ndringar skrivs till LEDS_BASE via en skrivning.
+*       Vid kompilering med PROFILE mts varje varv samt frdrjningen frn
+*       avlsning till skrivning d lysdioderna har ndrats.
 ********************************************************************************/
 int main(void)
 {
    struct gpio led1, led2, switch1, button1;
+   struct gpio_port leds;
 
+   TRACE_INIT(GPIO_LEDS_BASE);
    gpio_init(&led1, 0, GPIO_SELECTION_LED);
    gpio_init(&led2, 1, GPIO_SELECTION_LED);
    gpio_init(&switch1, 0, GPIO_SELECTION_SWITCH);
    gpio_init(&button1, 0, GPIO_SELECTION_BUTTON);
+   gpio_port_init(&leds, GPIO_SELECTION_LED);
+#ifdef GPIO_SNAPSHOT
+   gpio_snapshot_init();
+#endif /* GPIO_SNAPSHOT */
+   PROFILE_INIT();
 
    while (1)
    {
-      gpio_write(&led1, gpio_read(&switch1));
-      gpio_write(&led2, !gpio_read(&button1));
+      uint32_t outputs = 0;
+      const uint32_t previous = leds.output;
+      PROFILE_BEGIN(PROFILE_LOOP);
+      PROFILE_BEGIN(PROFILE_EDGE);
+#ifdef GPIO_SNAPSHOT
+      gpio_snapshot_update();
+#endif /* GPIO_SNAPSHOT */
+
+      if (gpio_read(&switch1))
+      {
+         outputs |= gpio_mask(&led1);
+      }
+      if (!gpio_read(&button1))
+      {
+         outputs |= gpio_mask(&led2);
+      }
+      gpio_port_write(&leds, gpio_mask(&led1) | gpio_mask(&led2), outputs);
+      gpio_port_commit(&leds);
+
+      if (leds.output != previous) PROFILE_END(PROFILE_EDGE);
+      PROFILE_END(PROFILE_LOOP);
    }
 
    return 0;
@@ -8,8 +8,27 @@
 *         samt button1. Insignalen frn switch1 matas direkt till led1.
 *         Vid nedtryckning av button1 tnds led2, annars hlls led2 slckt.
 *
-*         Simulera programmet p fljande lnk:
-*         https://cpulator.01xz.net/?sys=nios-de10-lite
+*         Varje GPIO-objekt initieras via gpio_init, varefter pekarna till
+*         PIO-enheternas basadresser lses in frn objekten till register
+*         innan huvudloopen startas. Lsning samt skrivning sker drefter
+*         via makrona i gpio_macro.s, som expanderas p plats i stllet fr
+*         anrop av gpio_read samt gpio_port_write. Utsignalerna fr led1 och
+*         led2 sammanstlls i ett register och skrivs via GPIO_WRITE_MASK,
+*         som saknar hopp, med en instruktion stwio per varv.
+*
+*         Ett varv i huvudloopen krver drmed 14 instruktioner (uppmtt
+*         via nios2sim utan PROFILE, antal instruktioner per tv
+*         avlsningar).
+*
+*         Frdrjningen frn switch1 samt button1 till led1 respektive led2
+*         kan mtas via profile.s genom att assemblera med symbolen PROFILE,
+*         se main.c. Tabellen skrivs exempelvis ut av simulatorn enligt nedan:
+*         ./nios2sim -D PROFILE=1 -p -n 2000000 -e 100000:sw=1 \
+*            -e 300000:key=1 -e 700000:key=0 "../6. Strukt/main.s"
+*
+*         Programmet inkluderar drivrutiner frn katalogen Drivrutiner och kan
+*         drmed inte klistras in i CPUlator som enskild fil. Simulera i stllet
+*         programmet via Verktyg/nios2sim.c enligt ovan.
 *
 *         Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW i
 *         filen gpio.s.
@@ -21,45 +40,68 @@
 .text
 
 /********************************************************************************
-* Globala subrutiner:
+* Makrodefinitioner:
+********************************************************************************/
+.ifdef PROFILE
+.equ STACK_ADDRESS, 8192 /* Stackens startadress, placerad efter profileringens tabell. */
+.else
+.equ STACK_ADDRESS, 4096 /* Stackens startadress, placerad efter programkoden. */
+.endif /* PROFILE */
+.equ STACK_SIZE, 1024    /* Stackens storlek i byte, fylls med STACK_CANARY vid start. */
+
+/********************************************************************************
+* GPIO_SNAPSHOT: Symbol fr att lsa av insignalerna via gpio_snapshot_update
+*                och besvara gpio_read frn en kopia i RAM, se gpio.s.
+*                Symbolen krver en extra gren i gpio_read och anvnds inte
+*                av huvudloopen, som lser PIO-enheterna direkt, s den r
+*                avstngd som standard. Ta bort kommentaren nedan (eller
+*                assemblera med -D GPIO_SNAPSHOT=1) fr att aktivera den.
 ********************************************************************************/
-.global _start
+/* .equ GPIO_SNAPSHOT, 0 */
+
+/********************************************************************************
+* Makrodefinitioner fr profileringen:
+********************************************************************************/
+.equ PROFILE_REGIONS, 2 /* Antal regioner som mts via profile.s. */
+.equ PROFILE_EDGE, 0    /* Region frn avlsning till skrivning vid ndrad insignal. */
+.equ PROFILE_LOOP, 1    /* Region fr ett varv i huvudloopen. */
 
 /********************************************************************************
 * Inkluderingsdirektiv:
 ********************************************************************************/
+.include "../Drivrutiner/start.s"
 .include "gpio.s"
+.include "../Drivrutiner/gpio_macro.s"
+.include "../Drivrutiner/profile.s"
 
 /********************************************************************************
-* _start: Initierar stackpekaren samt rampekaren vid start (stts till 1024).
-*         Subrutinen main anropas sedan fr att kra programmet. Efter terhopp
-*         grs ingenting genom att programmet frstts i en tom loop.
+* Pin-nummer fr GPIO-enheterna:
 ********************************************************************************/
-_start:
-   movi sp, 1024 /* Initierar stackpekaren till adress 1024. */
-   mov fp, sp    /* Initerar rampekaren till adress 1024. */
-   call main     /* Anropar subrutinen main fr att kra programmet. */
-_end:
-   br _end       /* Gr ingenting efter terhopp frn subrutinen main. */
+.equ LED1_PIN   , 0 /* Pin-nummer fr led1 ansluten till LED[0]. */
+.equ LED2_PIN   , 1 /* Pin-nummer fr led2 ansluten till LED[1]. */
+.equ SWITCH1_PIN, 0 /* Pin-nummer fr switch1 ansluten till SWITCH[0]. */
+.equ BUTTON1_PIN, 0 /* Pin-nummer fr button1 ansluten till KEY[0]. */
+
+.equ LEDS_MASK, (1 << LED1_PIN) | (1 << LED2_PIN) /* Bitmask fr led1 och led2. */
 
 /********************************************************************************
-* main: Lagrar minne fr GPIO-enheterna p stacken, varav led1 brjar p fp - 12,
-*       led2 brjar p fp - 24, switch1 brjar p fp - 36 och button1 p fp - 48.
+* main: Lagrar minne fr GPIO-enheterna p stacken, varav led1 brjar p fp - 16,
+*       led2 brjar p fp - 32, switch1 brjar p fp - 48 och button1 p fp - 64.
 *       Utrymme ges ocks t lagrad terhoppsadress i ra (brjar p fp + 4)
 *       samt rampekarens ordinarie adress (brjar p fp + 0).
 ********************************************************************************/
 main:
-   addi sp, sp, -56 /* Ger utrymme fr nya element p stacken. */
-   stw ra, 52(sp)   /* Lagrar frst terhoppsadressen lagrad i ra. */
-   stw fp, 48(sp)   /* Lagrar sedan rampekarens ordinarie adress. */
-   addi fp, sp, 48  /* Stter rampekaren till att peka dr objekten lagras. */
+   addi sp, sp, -72 /* Ger utrymme fr nya element p stacken. */
+   stw ra, 68(sp)   /* Lagrar frst terhoppsadressen lagrad i ra. */
+   stw fp, 64(sp)   /* Lagrar sedan rampekarens ordinarie adress. */
+   addi fp, sp, 64  /* Stter rampekaren till att peka dr objekten lagras. */
 
 /********************************************************************************
 * main_init_led1: Initierar lysdiod led1 ansluten till LED[0].
 ********************************************************************************/
 main_init_led1:
-   addi r2, fp, -12            /* Laddar (start)adressen fr led1 i r2. */
-   movi r3, 0                  /* Laddar lysdiodens pin-nummer i r3. */
+   addi r2, fp, -16            /* Laddar (start)adressen fr led1 i r2. */
+   movi r3, LED1_PIN           /* Laddar lysdiodens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r4. */
    call gpio_init              /* Anropar gpio_init fr att initiera led1. */
 
@@ -67,8 +109,8 @@ main_init_led1:
 * main_init_led2: Initierar lysdiod led2 ansluten till LED[1].
 ********************************************************************************/
 main_init_led2:
-   addi r2, fp, -24            /* Laddar (start)adressen fr led2 i r2. */
-   movi r3, 1                  /* Laddar lysdiodens pin-nummer i r3. */
+   addi r2, fp, -32            /* Laddar (start)adressen fr led2 i r2. */
+   movi r3, LED2_PIN           /* Laddar lysdiodens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r4. */
    call gpio_init              /* Anropar gpio_init fr att initiera led2. */
 
@@ -76,8 +118,8 @@ main_init_led2:
 * main_init_switch1: Initierar slide-switch switch1 ansluten till SWITCH[0].
 ********************************************************************************/
 main_init_switch1:
-   addi r2, fp, -36               /* Laddar (start)adressen fr switch1 i r2. */
-   movi r3, 0                     /* Laddar slide-switchens pin-nummer i r3. */
+   addi r2, fp, -48               /* Laddar (start)adressen fr switch1 i r2. */
+   movi r3, SWITCH1_PIN           /* Laddar slide-switchens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_SWITCH /* Laddar val av GPIO-enhet i r4. */
    call gpio_init                 /* Anropar gpio_init fr att initiera switch1. */
 
@@ -85,38 +127,63 @@ main_init_switch1:
 * main_init_button1: Initierar tryckknapp button1 ansluten till KEY[0].
 ********************************************************************************/
 main_init_button1:
-   addi r2, fp, -48               /* Laddar (start)adressen fr button1 i r2. */
-   movi r3, 0                     /* Laddar tryckknappens pin-nummer i r3. */
+   addi r2, fp, -64               /* Laddar (start)adressen fr button1 i r2. */
+   movi r3, BUTTON1_PIN           /* Laddar tryckknappens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_BUTTON /* Laddar val av GPIO-enhet i r4. */
    call gpio_init                 /* Anropar gpio_init fr att initiera button1. */
 
 /********************************************************************************
-* main_loop: Genomfr kontinuerlig polling (avlsning) av tryckknapp button1.
-*            Vid nedtryckning tnds lysdiod led2, annars hlls led2 slckt.
+* main_init_bases: Lser in pekarna till basadresserna fr lysdioderna,
+*                  slide-switcharna samt tryckknapparna frn led1, switch1
+*                  respektive button1 till r5, r6 och r7, s att inga
+*                  objekt lses frn minnet i huvudloopen. Lysdiodernas
+*                  aktuella utsignaler lagras i r11 fr profileringen.
 ********************************************************************************/
-main_loop:
-   addi r2, fp, -36 /* Laddar (start)adressen fr switch1 i r2. */
-   call gpio_read   /* Lser av slide-switchens insignal via anrop av gpio_read. */
-   mov r3, r2       /* Kopierar slide-switchens insignal till r3 fr skrivning till led2. */
-   addi r2, fp, -12 /* Laddar (start)adressen fr led1 i r2. */
-   call gpio_write  /* Skriver ny utsignal till led1 via anrop av gpio_write. */
+main_init_bases:
+   ldw r5, -16 + GPIO_BASE_PTR_OFFSET(fp) /* Lser in lysdiodernas basadress i r5. */
+   ldw r6, -48 + GPIO_BASE_PTR_OFFSET(fp) /* Lser in slide-switcharnas basadress i r6. */
+   ldw r7, -64 + GPIO_BASE_PTR_OFFSET(fp) /* Lser in tryckknapparnas basadress i r7. */
+   ldwio r11, 0(r5)                       /* Lser in lysdiodernas aktuella utsignaler. */
+   andi r11, r11, LEDS_MASK               /* Behller utsignalerna fr led1 och led2 i r11. */
+   PROFILE_INIT                           /* Nollstller profileringens tabell och startar timern. */
 
-   addi r2, fp, -48 /* Laddar (start)adressen fr button1 i r2. */
-   call gpio_read   /* Lser av tryckknappens insignal via anrop av gpio_read. */
-   movi r3, 1       /* Lser in 0x01 i r3 fr invertering av insignalen via XOR. */
-   xor r3, r3, r2   /* Inverterar insignalen fr skrivning till lysdioden. */
-   addi r2, fp, -24 /* Laddar (start)adressen fr led2 i r2. */
-   call gpio_write  /* Skriver ny utsignal till led2 via anrop av gpio_write. */
-   br main_loop     /* terstartar loopen.
+/********************************************************************************
+* main_loop: Genomfr kontinuerlig polling (avlsning) av switch1 samt button1
+*            via makron som expanderas p plats. Insignalen frn switch1 samt
+*            indikeringen av nedtryckt button1 skiftas till led1 respektive
+*            led2 och sammanstlls i r2, varefter bda lysdioderna skrivs
+*            via en enda maskerad skrivning utan hopp. Vid assemblering med
+*            PROFILE mts varje varv samt frdrjningen frn avlsning till
+*            skrivning d utsignalerna har ndrats jmfrt med fregende
+*            varv (lagrade i r11), se main.c.
+********************************************************************************/
+main_loop:
+   PROFILE_BEGIN PROFILE_LOOP            /* Startar mtningen av varvet. */
+   PROFILE_BEGIN PROFILE_EDGE            /* Startar mtningen frn avlsningen. */
+   GPIO_READ r2, r6, SWITCH1_PIN         /* Lser av insignalen frn switch1 till bit 0. */
+   BUTTON_PRESSED r3, r7, BUTTON1_PIN    /* Lser av ifall button1 r nedtryckt till bit 0. */
+.if LED1_PIN
+   slli r2, r2, LED1_PIN                 /* Skiftar upp insignalen till led1. */
+.endif
+   slli r3, r3, LED2_PIN                 /* Skiftar upp nedtryckningen till led2. */
+   or r2, r2, r3                         /* Sammanstller utsignalerna fr led1 och led2. */
+   GPIO_WRITE_MASK r5, LEDS_MASK, r2, r3 /* Skriver led1 och led2 utan hopp. */
+.ifdef PROFILE
+   beq r2, r11, main_loop_end            /* Vid ofrndrade utsignaler mts ingen flank. */
+   mov r11, r2                           /* Lagrar de nya utsignalerna i r11. */
+   PROFILE_END PROFILE_EDGE              /* Avslutar mtningen frn avlsningen. */
+.endif /* PROFILE */
+main_loop_end:
+   PROFILE_END PROFILE_LOOP              /* Avslutar mtningen av varvet. */
+   br main_loop                          /* terstartar loopen. */
 
 /********************************************************************************
 * main_end: terstller stackpekaren och rampekaren samt genomfr terhopp
 *           innan subrutinen main avslutas.
 ********************************************************************************/
 main_end:
-   ldw fp, 48(sp)  /* terstller rampekaren till startvrde 1024. */
-   ldw ra, 52(sp)  /* Lgger tillbaka utsprunglig terhoppsadress i ra. */
-   addi sp, sp, 56 /* terstller stackpekaren till startvrde 1024. */
+   ldw fp, 64(sp)  /* terstller rampekaren till startvrde 4096. */
+   ldw ra, 68(sp)  /* Lgger tillbaka utsprunglig terhoppsadress i ra. */
+   addi sp, sp, 72 /* terstller stackpekaren till startvrde 4096. */
    movi r2, 0      /* Laddar returvrde 0 i r2. */
    ret             /* Genomfr terhopp. */
-
@@ -0,0 +1,178 @@
+/********************************************************************************
+* pwm.c: Demonstration av ljusstyrka p lysdioderna LED[9:0] via binr
+*        kodmodulering i filen led_pwm.h. CASE GOLD hrdvara anvnds.
+*
+*        En ljuspunkt med avtagande svans vandrar fram och tillbaka ver
+*        lysdioderna, dr varje lysdiods ljusstyrka halveras tv gnger per
+*        steg frn ljuspunkten. Ljusstyrkorna uppdateras via
+*        led_set_brightness, medan intervalltimerns avbrott skter sjlva
+*        moduleringen. Ljuspunkten flyttas var PWM_STEP_FRAMES period.
+*
+*        Vid kompilering fr Linux kontrolleras i stllet bitplanen fr
+*        samtliga ljusstyrkor 0 - 255, varefter ett antal perioder av
+*        avbrott simuleras och varje lysdiods tnda tid jmfrs med dess
+*        ljusstyrka:
+*        gcc -DNIOS2_HOST pwm.c -o pwm && ./pwm
+*
+*        Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
+********************************************************************************/
+#include <stdint.h>
+
+/********************************************************************************
+* GPIO_CASE_GOLD_HW: Makro fr att definiera basadresser fr CASE GOLD hrdvara.
+*                    Kommentera ut detta makro vid simulering.
+********************************************************************************/
+#define GPIO_CASE_GOLD_HW
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include "../Drivrutiner/led_pwm.h"
+
+#ifdef NIOS2_HOST
+#include <stdio.h>
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define PWM_STEP_FRAMES 20 /* Antal perioder mellan varje frflyttning av ljuspunkten. */
+#define PWM_TEST_FRAMES 4  /* Antal perioder som simuleras vid kompilering fr Linux. */
+
+/********************************************************************************
+* leds_update: Stter lysdiodernas ljusstyrka utifrn ljuspunktens position,
+*              dr ljusstyrkan halveras tv gnger per steg frn ljuspunkten.
+*
+*              - position: Ljuspunktens position (0 - 9).
+********************************************************************************/
+static void leds_update(const uint8_t position)
+{
+   for (uint8_t i = 0; i < LED_PWM_COUNT; ++i)
+   {
+      const uint8_t distance = i > position ? i - position : position - i;
+      led_set_brightness(i, (uint8_t)(0xFF >> (2 * distance)));
+   }
+   return;
+}
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* plane_test: Stter samtliga ljusstyrkor 0 - 255 fr varje lysdiod och
+*             kontrollerar att bitplanens viktade summa fr lysdioden
+*             verensstmmer med ljusstyrkan, samt att vriga lysdioder
+*             inte pverkas. Drefter kontrolleras ljusstyrkorna frn
+*             leds_update. Antalet fel returneras.
+********************************************************************************/
+static uint32_t plane_test(void)
+{
+   uint32_t errors = 0;
+
+   for (uint8_t pin = 0; pin < LED_PWM_COUNT; ++pin)
+   {
+      for (uint32_t duty = 0; duty < 256; ++duty)
+      {
+         uint32_t on_units = 0;
+         led_set_brightness(pin, (uint8_t)duty);
+
+         for (uint8_t i = 0; i < LED_PWM_PLANES; ++i)
+         {
+            if (led_pwm_planes[i] & (1UL << pin)) on_units += 1UL << i;
+            if (led_pwm_planes[i] & ~(1UL << pin)) errors++;
+         }
+         if (on_units != duty || led_get_brightness(pin) != duty) errors++;
+      }
+      led_set_brightness(pin, 0);
+   }
+   if (led_set_brightness(LED_PWM_COUNT, 0xFF) != 1) errors++;
+
+   leds_update(3);
+   if (led_get_brightness(3) != 0xFF || led_get_brightness(4) != 0x3F ||
+       led_get_brightness(0) != 0x03 || led_get_brightness(9) != 0x00) errors++;
+   return errors;
+}
+
+/********************************************************************************
+* isr_test: Stter en ljusstyrka per lysdiod och simulerar en period av
+*           avbrott, s att nya ljusstyrkor visas frn frsta bitplanet.
+*           Drefter simuleras PWM_TEST_FRAMES perioder, dr varje tnd
+*           lysdiods tid summeras fre varje avbrott utifrn timerns period.
+*           Varje lysdiods tnda tid ska motsvara ljusstyrkan multiplicerat
+*           med LED_PWM_UNIT_TICKS per period. Antalet fel returneras.
+********************************************************************************/
+static uint32_t isr_test(void)
+{
+   static const uint8_t duty[LED_PWM_COUNT] = { 0, 1, 2, 3, 64, 127, 128, 200, 254, 255 };
+   uint32_t on_ticks[LED_PWM_COUNT] = { 0 };
+   uint32_t errors = 0;
+
+   for (uint8_t i = 0; i < LED_PWM_COUNT; ++i)
+   {
+      led_set_brightness(i, duty[i]);
+   }
+
+   for (uint8_t i = 0; i < LED_PWM_PLANES; ++i)
+   {
+      irq_host_raise(TIMER_IRQ, true);
+      irq_host_raise(TIMER_IRQ, false);
+   }
+
+   for (uint32_t n = 0; n < PWM_TEST_FRAMES * LED_PWM_PLANES; ++n)
+   {
+      const uint32_t period = ((TIMER_BASE[TIMER_PERIODH_REG] << 16) |
+                               TIMER_BASE[TIMER_PERIODL_REG]) + 1;
+
+      for (uint8_t i = 0; i < LED_PWM_COUNT; ++i)
+      {
+         if (led_pwm_host_leds & (1UL << i)) on_ticks[i] += period;
+      }
+      irq_host_raise(TIMER_IRQ, true);
+      irq_host_raise(TIMER_IRQ, false);
+   }
+
+   for (uint8_t i = 0; i < LED_PWM_COUNT; ++i)
+   {
+      const uint32_t expected = (uint32_t)duty[i] * LED_PWM_UNIT_TICKS * PWM_TEST_FRAMES;
+      printf("LED[%u]: ljusstyrka %3u, tnd %6lu av %6lu klockpulser%s\n", i, duty[i],
+             (unsigned long)on_ticks[i], (unsigned long)LED_PWM_FRAME_TICKS * PWM_TEST_FRAMES,
+             on_ticks[i] == expected ? "" : " (fel)");
+      if (on_ticks[i] != expected) errors++;
+   }
+   if (led_pwm_frames() != PWM_TEST_FRAMES + 1) errors++;
+   return errors;
+}
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* main: Startar moduleringen och aktiverar avbrott vid start. Drefter
+*       flyttas ljuspunkten fram och tillbaka ett steg var PWM_STEP_FRAMES
+*       period, dr antalet perioder anvnds som tidsbas.
+********************************************************************************/
+int main(void)
+{
+   led_pwm_init();
+   irq_global_enable();
+
+#ifdef NIOS2_HOST
+   const uint32_t errors = plane_test() + isr_test();
+   printf("Bitplan samt avbrott: %lu fel\n", (unsigned long)errors);
+   return errors ? 1 : 0;
+#else
+   uint8_t position = 0;
+   int8_t direction = 1;
+   uint32_t frame = led_pwm_frames();
+
+   while (1)
+   {
+      leds_update(position);
+      while (led_pwm_frames() - frame < PWM_STEP_FRAMES);
+      frame += PWM_STEP_FRAMES;
+
+      if (position + direction >= LED_PWM_COUNT || position + direction < 0)
+      {
+         direction = -direction;
+      }
+      position += direction;
+   }
+   return 0;
+#endif /* NIOS2_HOST */
+}
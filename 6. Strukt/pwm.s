@@ -0,0 +1,106 @@
+/********************************************************************************
+* pwm.s: Demonstration av ljusstyrka p lysdioderna LED[9:0] via binr
+*        kodmodulering i filen led_pwm.s. CASE GOLD hrdvara anvnds.
+*
+*        En ljuspunkt med avtagande svans vandrar fram och tillbaka ver
+*        lysdioderna, dr varje lysdiods ljusstyrka halveras tv gnger per
+*        steg frn ljuspunkten. Ljusstyrkorna uppdateras via
+*        led_set_brightness, medan intervalltimerns avbrott skter sjlva
+*        moduleringen. Ljuspunkten flyttas var PWM_STEP_FRAMES period.
+*
+*        Programmet inkluderar drivrutiner frn katalogen Drivrutiner och kan
+*        drmed inte klistras in i CPUlator som enskild fil. Simulera i stllet
+*        programmet via Verktyg/nios2sim.c:
+*        ./nios2sim -n 5000000 "../6. Strukt/pwm.s"
+*
+*        Vid simulering, kommentera ut makrot GPIO_CASE_GOLD_HW nedan.
+********************************************************************************/
+
+/********************************************************************************
+* .text: Kodsegment, lagringsplats fr programkoden.
+********************************************************************************/
+.text
+
+/********************************************************************************
+* GPIO_CASE_GOLD_HW: Makro fr att definiera basadresser fr CASE GOLD hrdvara.
+*                    Kommentera ut detta makro vid simulering.
+********************************************************************************/
+.equ GPIO_CASE_GOLD_HW, 0
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/start.s"
+.include "../Drivrutiner/led_pwm.s"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ PWM_STEP_FRAMES, 20 /* Antal perioder mellan varje frflyttning av ljuspunkten. */
+
+/********************************************************************************
+* leds_update: Stter lysdiodernas ljusstyrka utifrn ljuspunktens position,
+*              dr ljusstyrkan halveras tv gnger per steg frn ljuspunkten.
+*
+*              - r2: Ljuspunktens position (0 - 9).
+********************************************************************************/
+leds_update:
+   addi sp, sp, -20                /* Allokerar minne fr lokala variabler p stacken. */
+   stw ra, 16(sp)                  /* Sparar undan terhoppsadressen i ra. */
+   stw r2, 12(sp)                  /* Sparar undan innehllet i r2 infr anvndning. */
+   stw r3, 8(sp)                   /* Sparar undan innehllet i r3 infr anvndning. */
+   stw r4, 4(sp)                   /* Sparar undan innehllet i r4 infr anvndning. */
+   stw r5, 0(sp)                   /* Sparar undan innehllet i r5 infr anvndning. */
+   mov r4, r2                      /* Kopierar ljuspunktens position till r4. */
+   movi r5, 0                      /* Anvnder r5 som lysdiodens pin-nummer. */
+leds_update_loop:
+   sub r3, r5, r4                  /* Berknar avstndet till ljuspunkten i r3. */
+   bge r3, zero, leds_update_shift /* Om avstndet r positivt anvnds det direkt. */
+   sub r3, zero, r3                /* Annars anvnds avstndets absolutbelopp. */
+leds_update_shift:
+   add r3, r3, r3                  /* Halverar ljusstyrkan tv gnger per steg. */
+   movi r2, 0xFF                   /* Lser in full ljusstyrka i r2. */
+   srl r3, r2, r3                  /* Lagrar lysdiodens ljusstyrka i r3. */
+   mov r2, r5                      /* Lser in lysdiodens pin-nummer i r2. */
+   call led_set_brightness         /* Stter lysdiodens ljusstyrka. */
+   addi r5, r5, 1                  /* Rknar upp till nsta lysdiod. */
+   movi r2, LED_PWM_COUNT          /* Lser in antalet lysdioder i r2. */
+   bltu r5, r2, leds_update_loop   /* Upprepar fr samtliga lysdioder. */
+   ldw r5, 0(sp)                   /* terstller r5 efter anvndning. */
+   ldw r4, 4(sp)                   /* terstller r4 efter anvndning. */
+   ldw r3, 8(sp)                   /* terstller r3 efter anvndning. */
+   ldw r2, 12(sp)                  /* terstller r2 efter anvndning. */
+   ldw ra, 16(sp)                  /* terstller terhoppsadressen i ra. */
+   addi sp, sp, 20                 /* terstller stackpekaren. */
+   ret                             /* Genomfr terhopp. */
+
+/********************************************************************************
+* main: Startar moduleringen och aktiverar avbrott vid start. Drefter
+*       flyttas ljuspunkten fram och tillbaka ett steg var PWM_STEP_FRAMES
+*       period, dr antalet perioder anvnds som tidsbas. Ljuspunktens
+*       position lagras i r4, riktningen (1 eller -1) i r5 och perioden fr
+*       senaste frflyttningen i r6.
+********************************************************************************/
+main:
+   call led_pwm_init            /* Startar moduleringen av lysdioderna. */
+   call irq_global_enable       /* Aktiverar avbrott globalt. */
+   movi r4, 0                   /* Startar ljuspunkten vid LED[0]. */
+   movi r5, 1                   /* Flyttar ljuspunkten uppt vid start. */
+   call led_pwm_frames          /* Lser in aktuellt antal perioder i r2. */
+   mov r6, r2                   /* Lagrar perioden fr senaste frflyttningen i r6. */
+main_loop:
+   mov r2, r4                   /* Lser in ljuspunktens position i r2. */
+   call leds_update             /* Uppdaterar lysdiodernas ljusstyrka. */
+main_wait:
+   call led_pwm_frames          /* Lser in aktuellt antal perioder i r2. */
+   sub r2, r2, r6               /* Berknar antalet perioder sedan frflyttningen. */
+   movi r3, PWM_STEP_FRAMES     /* Lser in antalet perioder per steg i r3. */
+   bltu r2, r3, main_wait       /* Vntar tills tiden fr nsta steg har passerat. */
+   addi r6, r6, PWM_STEP_FRAMES /* Rknar upp perioden fr senaste frflyttningen. */
+   add r2, r4, r5               /* Berknar nsta position i r2. */
+   movi r3, LED_PWM_COUNT       /* Lser in antalet lysdioder i r3. */
+   bltu r2, r3, main_move       /* Om positionen r giltig flyttas ljuspunkten. */
+   sub r5, zero, r5             /* Annars byts riktningen. */
+main_move:
+   add r4, r4, r5               /* Flyttar ljuspunkten ett steg. */
+   br main_loop                 /* terstartar loopen. */
@@ -8,6 +8,14 @@
 *           samt button1. Insignalen frn switch1 matas direkt till led1.
 *           Vid nedtryckning av button1 tnds led2, annars hlls led2 slckt.
 *
+*           Insignalerna lses via gpio_read, som lser in basadress samt
+*           pin-nummer frn respektive GPIO-objekt. Lysdioderna uppdateras
+*           via porten leds, dr nya utsignaler samlas i ett skuggregister
+*           via gpio_port_write och skrivs ut via gpio_port_commit med hgst
+*           en instruktion stwio per varv i huvudloopen. Motsvarande loop
+*           med makrona i Drivrutiner/gpio_macro.s, som expanderas p plats
+*           i stllet fr anrop, visas i const.s samt main.s.
+*
 *           Simulera programmet p fljande lnk:
 *           https://cpulator.01xz.net/?sys=nios-de10-lite
 *
@@ -58,6 +66,27 @@
 .equ GPIO_PIN_OFFSET      , 8  /* Offset fr GPIO-enhetens pin-nummer. */
 .equ GPIO_SIZE            , 12 /* Storleken fr ett GPIO-objekt i byte. */
 
+/********************************************************************************
+* Offset fr PIO-enheternas dataregister relativt basadressen:
+********************************************************************************/
+.equ GPIO_DATA_REG, 0 /* Dataregister. */
+
+/********************************************************************************
+* Pin-nummer fr GPIO-enheterna:
+********************************************************************************/
+.equ LED1_PIN   , 0 /* Pin-nummer fr led1 ansluten till LED[0]. */
+.equ LED2_PIN   , 1 /* Pin-nummer fr led2 ansluten till LED[1]. */
+.equ SWITCH1_PIN, 0 /* Pin-nummer fr switch1 ansluten till SWITCH[0]. */
+.equ BUTTON1_PIN, 0 /* Pin-nummer fr button1 ansluten till KEY[0]. */
+
+/********************************************************************************
+* Offsets fr medlemmar av strukten gpio_port:
+********************************************************************************/
+.equ GPIO_PORT_BASE_PTR_OFFSET, 0  /* Offset fr pekare till PIO-enhetens basadress. */
+.equ GPIO_PORT_SHADOW_OFFSET  , 4  /* Offset fr skuggregistret med vntande utsignaler. */
+.equ GPIO_PORT_OUTPUT_OFFSET  , 8  /* Offset fr utsignaler senast skrivna till PIO-enheten. */
+.equ GPIO_PORT_SIZE           , 12 /* Storleken fr ett portobjekt i byte. */
+
 /********************************************************************************
 * gpio_init: Initierar godtycklig GPIO-enhet ansluten till angiven pin.
 *            Vid fel sker ingen initiering och felkod 1 returneras via r2.
@@ -102,43 +131,6 @@ gpio_init_end:
    addi sp, sp, 4                   /* terstller stackpekaren. */
    ret                              /* Genomfr terhopp. */
 
-/********************************************************************************
-* gpio_write: Skriver utsignal till refererad GPIO-enhet.
-*
-*               - r2: Referens till GPIO-enheten.
-*               - r3: Vrdet som ska skrivas (0 eller 1).
-********************************************************************************/
-gpio_write:
-   addi sp, sp, -16                 /* Allokerar minne fr lokala variabler p stacken. */
-   stw r4, 12(sp)                   /* Sparar undan innehllet i r4 infr anvndning. */
-   stw r5, 8(sp)                    /* Sparar undan innehllet i r5 infr anvndning. */
-   stw r6, 4(sp)                    /* Sparar undan innehllet i r6 infr anvndning. */
-   stw r7, 0(sp)                    /* Sparar undan innehllet i r7 infr anvndning. */
-gpio_write_load_data:
-   ldw r4, GPIO_BASE_PTR_OFFSET(r2) /* Laddar enhetens basadress i r4. */
-   ldwio r5, 0(r4)                  /* Laddar aktuella signaler frn basadressen i r5. */
-   ldw r6, GPIO_PIN_OFFSET(r2)      /* Laddar enhetens pin-nummer i r6. */
-   movi r7, 1                       /* Lser in 0x01 i r7 fr bitvis skiftning av pin-numret. */
-gpio_write_shift_left:
-   sll r6, r7, r6                   /* Skiftar enhetens pin-nummer fr skrivning. */
-   bne r3, zero, gpio_write_high    /* Om insignalen i r3 inte r 0 stts utsignalen till hg. */
-gpio_write_low:                     /* Annars stts utsignalen till lg. */
-   movi r7, -1                      /* Lser in 0xFFFF i r7 fr invertering via XOR. */
-   xor r6, r6, r7                   /* Inverterar det skiftade vrdet fr att stta lg utsignal. */
-   and r5, r5, r6                   /* Stter enhetens signal till lg via bitvis AND. */
-   stwio r5, 0(r4)                  /* Skriver det uppdaterade vrdet till basadressen. */
-   br gpio_write_end                /* terstller stackpekaren och avslutar subrutinen. */
-gpio_write_high:
-   or r5, r5, r6                    /* Stter enhetens signal till hg via bitvis OR. */
-   stwio r5, 0(r4)                  /* Skriver det uppdaterade vrdet till basadressen. */
-gpio_write_end:
-   ldw r7, 0(sp)                    /* terstller r7 efter anvndning. */
-   ldw r6, 4(sp)                    /* terstller r6 efter anvndning. */
-   ldw r5, 8(sp)                    /* terstller r5 efter anvndning. */
-   ldw r4, 12(sp)                   /* terstller r4 efter anvndning. */
-   addi sp, sp, 16                  /* terstller stackpekaren. */
-   ret                              /* Avslutar subrutinen efter att skrivningen har slutfrts. */
-
 /********************************************************************************
 * gpio_read: Returnerar insignalen frn referered GPIO-enhet via r2.
 *            Vid hg insignal returneras 1, annars 0.
@@ -168,6 +160,97 @@ gpio_read_end:
    addi sp, sp, 16                  /* terstller stackpekaren. */
    ret                              /* Avslutar subrutinen efter att skrivningen har slutfrts. */
 
+/********************************************************************************
+* gpio_mask: Returnerar bitmask fr refererad GPIO-enhets pin via r2, fr
+*            anvndning tillsammans med en gpio_port.
+*
+*            - r2: Referens till GPIO-enheten.
+********************************************************************************/
+gpio_mask:
+   addi sp, sp, -4             /* Allokerar minne fr lokala variabler p stacken. */
+   stw r3, 0(sp)               /* Sparar undan innehllet i r3 infr anvndning. */
+   ldw r3, GPIO_PIN_OFFSET(r2) /* Laddar enhetens pin-nummer i r3. */
+   movi r2, 1                  /* Lser in 0x01 i r2 fr bitvis skiftning. */
+   sll r2, r2, r3              /* Skiftar fram biten fr enhetens pin-nummer. */
+   ldw r3, 0(sp)               /* terstller r3 efter anvndning. */
+   addi sp, sp, 4              /* terstller stackpekaren. */
+   ret                         /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_init: Initierar port fr samtliga lysdioder. Skuggregistret
+*                 tilldelas lysdiodernas aktuella utsignaler. Vid fel sker
+*                 ingen initiering och felkod 1 returneras via r2, annars 0.
+*
+*                 - r2: Referens till porten.
+*                 - r3: Val av enhet (endast lysdioder stds).
+********************************************************************************/
+gpio_port_init:
+   addi sp, sp, -4                       /* Allokerar minne fr lokala variabler p stacken. */
+   stw r4, 0(sp)                         /* Sparar undan innehllet i r4 infr anvndning. */
+   movi r4, GPIO_SELECTION_LED           /* Om vald enhet inte r lysdioder */
+   bne r3, r4, gpio_port_init_error      /* returneras felkod 1. */
+   movhi r4, %hiadj(LEDS_BASE)           /* Lser in LEDS_BASE[31:16] i r4. */
+   addi r4, r4, %lo(LEDS_BASE)           /* Lgger till LEDS_BASE[15:0] i r4. */
+   stw r4, GPIO_PORT_BASE_PTR_OFFSET(r2) /* Sparar LEDS_BASE via offset. */
+   ldwio r4, GPIO_DATA_REG(r4)           /* Lser in lysdiodernas aktuella utsignaler i r4. */
+   stw r4, GPIO_PORT_SHADOW_OFFSET(r2)   /* Tilldelar skuggregistret aktuella utsignaler. */
+   stw r4, GPIO_PORT_OUTPUT_OFFSET(r2)   /* Lagrar aktuella utsignaler som senast skrivna. */
+   movi r2, 0                            /* Lagrar returkod 0 i r2. */
+   br gpio_port_init_end                 /* terstller stacken och avslutar subrutinen. */
+gpio_port_init_error:
+   movi r2, 1                            /* Lagrar returkod 1 i r2. */
+gpio_port_init_end:
+   ldw r4, 0(sp)                         /* terstller r4 efter anvndning. */
+   addi sp, sp, 4                        /* terstller stackpekaren. */
+   ret                                   /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_write: Tilldelar angivna pinnar i portens skuggregister nya
+*                  vrden, vriga pinnar lmnas opverkade. Tilldelningen
+*                  genomfrs som shadow ^ ((shadow ^ value) & mask).
+*
+*                  - r2: Referens till porten.
+*                  - r3: Bitmask med pinnar som ska tilldelas.
+*                  - r4: Nya vrden fr pinnarna i bitmasken.
+********************************************************************************/
+gpio_port_write:
+   addi sp, sp, -8                     /* Allokerar minne fr lokala variabler p stacken. */
+   stw r5, 4(sp)                       /* Sparar undan innehllet i r5 infr anvndning. */
+   stw r6, 0(sp)                       /* Sparar undan innehllet i r6 infr anvndning. */
+   ldw r5, GPIO_PORT_SHADOW_OFFSET(r2) /* Laddar skuggregistret i r5. */
+   xor r6, r5, r4                      /* Tar fram pinnar vars vrde skiljer sig. */
+   and r6, r6, r3                      /* Behller enbart pinnar i bitmasken. */
+   xor r5, r5, r6                      /* Togglar pinnar som ska ndras. */
+   stw r5, GPIO_PORT_SHADOW_OFFSET(r2) /* Skriver tillbaka skuggregistret. */
+   ldw r6, 0(sp)                       /* terstller r6 efter anvndning. */
+   ldw r5, 4(sp)                       /* terstller r5 efter anvndning. */
+   addi sp, sp, 8                      /* terstller stackpekaren. */
+   ret                                 /* Genomfr terhopp. */
+
+/********************************************************************************
+* gpio_port_commit: Skriver portens vntande utsignaler till PIO-enheten med
+*                   en enda instruktion stwio. Om utsignalerna inte har
+*                   ndrats sedan fregende skrivning sker ingen tkomst av
+*                   PIO-enheten.
+*
+*                   - r2: Referens till porten.
+********************************************************************************/
+gpio_port_commit:
+   addi sp, sp, -8                       /* Allokerar minne fr lokala variabler p stacken. */
+   stw r3, 4(sp)                         /* Sparar undan innehllet i r3 infr anvndning. */
+   stw r4, 0(sp)                         /* Sparar undan innehllet i r4 infr anvndning. */
+   ldw r3, GPIO_PORT_SHADOW_OFFSET(r2)   /* Laddar vntande utsignaler i r3. */
+   ldw r4, GPIO_PORT_OUTPUT_OFFSET(r2)   /* Laddar senast skrivna utsignaler i r4. */
+   beq r3, r4, gpio_port_commit_end      /* Vid ofrndrade utsignaler sker ingen skrivning. */
+   stw r3, GPIO_PORT_OUTPUT_OFFSET(r2)   /* Lagrar utsignalerna som senast skrivna. */
+   ldw r4, GPIO_PORT_BASE_PTR_OFFSET(r2) /* Laddar PIO-enhetens basadress i r4. */
+   stwio r3, GPIO_DATA_REG(r4)           /* Skriver samtliga utsignaler till PIO-enheten. */
+gpio_port_commit_end:
+   ldw r4, 0(sp)                         /* terstller r4 efter anvndning. */
+   ldw r3, 4(sp)                         /* terstller r3 efter anvndning. */
+   addi sp, sp, 8                        /* terstller stackpekaren. */
+   ret                                   /* Genomfr terhopp. */
+
 /********************************************************************************
 * _start: Initierar stackpekaren samt rampekaren vid start (stts till 1024).
 *         Subrutinen main anropas sedan fr att kra programmet. Efter terhopp
@@ -183,21 +266,22 @@ _end:
 /********************************************************************************
 * main: Lagrar minne fr GPIO-enheterna p stacken, varav led1 brjar p fp - 12,
 *       led2 brjar p fp - 24, switch1 brjar p fp - 36 och button1 p fp - 48.
-*       Utrymme ges ocks t lagrad terhoppsadress i ra (brjar p fp + 4)
-*       samt rampekarens ordinarie adress (brjar p fp + 0).
+*       Porten leds brjar p fp - 60. Utrymme ges ocks t lagrad
+*       terhoppsadress i ra (brjar p fp + 4) samt rampekarens ordinarie
+*       adress (brjar p fp + 0).
 ********************************************************************************/
 main:
-   addi sp, sp, -56 /* Ger utrymme fr nya element p stacken. */
-   stw ra, 52(sp)   /* Lagrar frst terhoppsadressen lagrad i ra. */
-   stw fp, 48(sp)   /* Lagrar sedan rampekarens ordinarie adress. */
-   addi fp, sp, 48  /* Stter rampekaren till att peka dr objekten lagras. */
+   addi sp, sp, -72 /* Ger utrymme fr nya element p stacken. */
+   stw ra, 68(sp)   /* Lagrar frst terhoppsadressen lagrad i ra. */
+   stw fp, 64(sp)   /* Lagrar sedan rampekarens ordinarie adress. */
+   addi fp, sp, 64  /* Stter rampekaren till att peka dr objekten lagras. */
 
 /********************************************************************************
 * main_init_led1: Initierar lysdiod led1 ansluten till LED[0].
 ********************************************************************************/
 main_init_led1:
    addi r2, fp, -12            /* Laddar (start)adressen fr led1 i r2. */
-   movi r3, 0                  /* Laddar lysdiodens pin-nummer i r3. */
+   movi r3, LED1_PIN           /* Laddar lysdiodens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r4. */
    call gpio_init              /* Anropar gpio_init fr att initiera led1. */
 
@@ -206,7 +290,7 @@ main_init_led1:
 ********************************************************************************/
 main_init_led2:
    addi r2, fp, -24            /* Laddar (start)adressen fr led2 i r2. */
-   movi r3, 1                  /* Laddar lysdiodens pin-nummer i r3. */
+   movi r3, LED2_PIN           /* Laddar lysdiodens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r4. */
    call gpio_init              /* Anropar gpio_init fr att initiera led2. */
 
@@ -215,7 +299,7 @@ main_init_led2:
 ********************************************************************************/
 main_init_switch1:
    addi r2, fp, -36               /* Laddar (start)adressen fr switch1 i r2. */
-   movi r3, 0                     /* Laddar slide-switchens pin-nummer i r3. */
+   movi r3, SWITCH1_PIN           /* Laddar slide-switchens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_SWITCH /* Laddar val av GPIO-enhet i r4. */
    call gpio_init                 /* Anropar gpio_init fr att initiera switch1. */
 
@@ -224,37 +308,58 @@ main_init_switch1:
 ********************************************************************************/
 main_init_button1:
    addi r2, fp, -48               /* Laddar (start)adressen fr button1 i r2. */
-   movi r3, 0                     /* Laddar tryckknappens pin-nummer i r3. */
+   movi r3, BUTTON1_PIN           /* Laddar tryckknappens pin-nummer i r3. */
    movi r4, GPIO_SELECTION_BUTTON /* Laddar val av GPIO-enhet i r4. */
    call gpio_init                 /* Anropar gpio_init fr att initiera button1. */
 
 /********************************************************************************
-* main_loop: Genomfr kontinuerlig polling (avlsning) av tryckknapp button1.
-*            Vid nedtryckning tnds lysdiod led2, annars hlls led2 slckt.
+* main_init_leds: Initierar porten leds fr samtliga lysdioder. Bitmaskerna
+*                 fr led1 och led2 lagras i r5 respektive r6, medan r7
+*                 innehller bitmasken fr bda lysdioderna.
 ********************************************************************************/
-main_loop:
-   addi r2, fp, -36 /* Laddar (start)adressen fr switch1 i r2. */
-   call gpio_read   /* Lser av slide-switchens insignal via anrop av gpio_read. */
-   mov r3, r2       /* Kopierar slide-switchens insignal till r3 fr skrivning till led2. */
-   addi r2, fp, -12 /* Laddar (start)adressen fr led1 i r2. */
-   call gpio_write  /* Skriver ny utsignal till led1 via anrop av gpio_write. */
+main_init_leds:
+   addi r2, fp, -60            /* Laddar (start)adressen fr leds i r2. */
+   movi r3, GPIO_SELECTION_LED /* Laddar val av GPIO-enhet i r3. */
+   call gpio_port_init         /* Anropar gpio_port_init fr att initiera leds. */
+   addi r2, fp, -12            /* Laddar (start)adressen fr led1 i r2. */
+   call gpio_mask              /* Lser in bitmasken fr led1 i r2. */
+   mov r5, r2                  /* Lagrar bitmasken fr led1 i r5. */
+   addi r2, fp, -24            /* Laddar (start)adressen fr led2 i r2. */
+   call gpio_mask              /* Lser in bitmasken fr led2 i r2. */
+   mov r6, r2                  /* Lagrar bitmasken fr led2 i r6. */
+   or r7, r5, r6               /* Lagrar bitmasken fr bda lysdioderna i r7. */
 
-   addi r2, fp, -48 /* Laddar (start)adressen fr button1 i r2. */
-   call gpio_read   /* Lser av tryckknappens insignal via anrop av gpio_read. */
-   movi r3, 1       /* Lser in 0x01 i r3 fr invertering av insignalen via XOR. */
-   xor r3, r3, r2   /* Inverterar insignalen fr skrivning till lysdioden. */
-   addi r2, fp, -24 /* Laddar (start)adressen fr led2 i r2. */
-   call gpio_write  /* Skriver ny utsignal till led2 via anrop av gpio_write. */
-   br main_loop     /* terstartar loopen.
+/********************************************************************************
+* main_loop: Genomfr kontinuerlig polling (avlsning) av switch1 samt button1.
+*            Nya utsignaler fr led1 och led2 samlas i r4, som tilldelas
+*            porten leds via en maskerad skrivning. Drefter skrivs eventuella
+*            ndringar till lysdioderna via en enda instruktion stwio.
+********************************************************************************/
+main_loop:
+   movi r4, 0                     /* Nollstller nya utsignaler i r4. */
+   addi r2, fp, -36               /* Laddar (start)adressen fr switch1 i r2. */
+   call gpio_read                 /* Lser av slide-switchens insignal via anrop av gpio_read. */
+   beq r2, zero, main_loop_button /* Vid lg insignal hlls led1 slckt. */
+   or r4, r4, r5                  /* Annars tnds led1 via bitmasken i r5. */
+main_loop_button:
+   addi r2, fp, -48               /* Laddar (start)adressen fr button1 i r2. */
+   call gpio_read                 /* Lser av tryckknappens insignal via anrop av gpio_read. */
+   bne r2, zero, main_loop_commit /* Vid uppslppt tryckknapp hlls led2 slckt. */
+   or r4, r4, r6                  /* Annars tnds led2 via bitmasken i r6. */
+main_loop_commit:
+   addi r2, fp, -60               /* Laddar (start)adressen fr leds i r2. */
+   mov r3, r7                     /* Laddar bitmasken fr led1 och led2 i r3. */
+   call gpio_port_write           /* Tilldelar led1 och led2 nya utsignaler i skuggregistret. */
+   call gpio_port_commit          /* Skriver eventuella ndringar till lysdioderna. */
+   br main_loop                   /* terstartar loopen. */
 
 /********************************************************************************
 * main_end: terstller stackpekaren och rampekaren samt genomfr terhopp
 *           innan subrutinen main avslutas.
 ********************************************************************************/
 main_end:
-   ldw fp, 48(sp)  /* terstller rampekaren till startvrde 1024. */
-   ldw ra, 52(sp)  /* Lgger tillbaka utsprunglig terhoppsadress i ra. */
-   addi sp, sp, 56 /* terstller stackpekaren till startvrde 1024. */
+   ldw fp, 64(sp)  /* terstller rampekaren till startvrde 1024. */
+   ldw ra, 68(sp)  /* Lgger tillbaka utsprunglig terhoppsadress i ra. */
+   addi sp, sp, 72 /* terstller stackpekaren till startvrde 1024. */
    movi r2, 0      /* Laddar returvrde 0 i r2. */
    ret             /* Genomfr terhopp. */
-
@@ -0,0 +1,150 @@
+/********************************************************************************
+* block.h: Innehåller funktioner för snabb fyllning samt kopiering av arrayer
+*          med 32-bitars element, exempelvis arrayerna som matas ut via
+*          stream.h.
+*
+*          Looparna är utrullade för hand, så att BLOCK_UNROLL element
+*          hanteras per varv. Jämförelsen, pekaruppräkningen och hoppet sker
+*          därmed en gång per BLOCK_UNROLL element i stället för en gång per
+*          element, eftersom kompilatorn inte rullar ut loopar vid -O2.
+*          Återstående element, då arrayens storlek inte är jämnt delbar med
+*          BLOCK_UNROLL, hanteras ett i taget efter den utrullade loopen.
+*
+*          Vid kopiering läses fyra element till lokala variabler innan
+*          dessa skrivs, så att läsningarnas fördröjning på processorer med
+*          pipeline (Nios II/f) döljs av efterföljande läsningar. Motsvarande
+*          subrutiner i assembler finns i filen block.s.
+********************************************************************************/
+#ifndef BLOCK_H_
+#define BLOCK_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define BLOCK_UNROLL 8 /* Antal element per varv i de utrullade looparna. */
+
+/********************************************************************************
+* block_assign: Fyller array av angiven storlek med en aritmetisk talföljd,
+*               där första elementet tilldelas startvärdet och varje
+*               efterföljande element ökar med stegvärdet. Nästa värde i
+*               talföljden, dvs. startvärdet för en efterföljande array,
+*               returneras.
+*
+*               - data : Referens till arrayen (pekar på första elementet).
+*               - size : Arrayens storlek, dvs. antalet element den rymmer.
+*               - value: Startvärdet, dvs. det element som läggs till först.
+*               - step : Stegvärdet, indikerar differensen mellan varje element.
+********************************************************************************/
+static inline uint32_t block_assign(uint32_t* data,
+                                    const uint32_t size,
+                                    uint32_t value,
+                                    const uint32_t step)
+{
+   uint32_t* const end = data + size;
+   uint32_t* const last = end - size % BLOCK_UNROLL;
+
+   while (data < last)
+   {
+      data[0] = value;
+      data[1] = value += step;
+      data[2] = value += step;
+      data[3] = value += step;
+      data[4] = value += step;
+      data[5] = value += step;
+      data[6] = value += step;
+      data[7] = value += step;
+      value += step;
+      data += BLOCK_UNROLL;
+   }
+   while (data < end)
+   {
+      *data++ = value;
+      value += step;
+   }
+   return value;
+}
+
+/********************************************************************************
+* block_fill: Fyller array av angiven storlek med angivet värde, motsvarande
+*             memset för 32-bitars element.
+*
+*             - data : Referens till arrayen (pekar på första elementet).
+*             - size : Arrayens storlek, dvs. antalet element den rymmer.
+*             - value: Värdet som samtliga element tilldelas.
+********************************************************************************/
+static inline void block_fill(uint32_t* data,
+                              const uint32_t size,
+                              const uint32_t value)
+{
+   uint32_t* const end = data + size;
+   uint32_t* const last = end - size % BLOCK_UNROLL;
+
+   while (data < last)
+   {
+      data[0] = value;
+      data[1] = value;
+      data[2] = value;
+      data[3] = value;
+      data[4] = value;
+      data[5] = value;
+      data[6] = value;
+      data[7] = value;
+      data += BLOCK_UNROLL;
+   }
+   while (data < end)
+   {
+      *data++ = value;
+   }
+   return;
+}
+
+/********************************************************************************
+* block_copy: Kopierar angivet antal element från en array till en annan,
+*             motsvarande memcpy för 32-bitars element. Arrayerna får inte
+*             överlappa varandra.
+*
+*             - destination: Referens till destinationsarrayen.
+*             - source     : Referens till källarrayen.
+*             - size       : Antalet element som ska kopieras.
+********************************************************************************/
+static inline void block_copy(uint32_t* restrict destination,
+                              const uint32_t* restrict source,
+                              const uint32_t size)
+{
+   uint32_t* const end = destination + size;
+   uint32_t* const last = end - size % BLOCK_UNROLL;
+
+   while (destination < last)
+   {
+      uint32_t a = source[0];
+      uint32_t b = source[1];
+      uint32_t c = source[2];
+      uint32_t d = source[3];
+      destination[0] = a;
+      destination[1] = b;
+      destination[2] = c;
+      destination[3] = d;
+      a = source[4];
+      b = source[5];
+      c = source[6];
+      d = source[7];
+      destination[4] = a;
+      destination[5] = b;
+      destination[6] = c;
+      destination[7] = d;
+      source += BLOCK_UNROLL;
+      destination += BLOCK_UNROLL;
+   }
+   while (destination < end)
+   {
+      *destination++ = *source++;
+   }
+   return;
+}
+
+#endif /* BLOCK_H_ */
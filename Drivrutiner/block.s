@@ -0,0 +1,197 @@
+/********************************************************************************
+* block.s: Innehåller rutiner för snabb fyllning samt kopiering av arrayer
+*          med 32-bitars element, motsvarande block.h.
+*
+*          Loopen i respektive subrutin är utrullad, så att BLOCK_UNROLL
+*          element hanteras per varv. Jämförelsen, pekaruppräkningen och
+*          hoppet sker därmed en gång per BLOCK_UNROLL element i stället
+*          för en gång per element, där loopen avslutas när pekaren når
+*          slutadressen för de hela varven i stället för via en separat
+*          loopräknare. Denna beräknas som slutadressen minus antalet byte
+*          utöver hela varv, motsvarande block.h, så att den aldrig
+*          understiger arrayens startadress oavsett arrayens placering. I
+*          stationärt tillstånd krävs därmed 1.25 instruktioner per ord vid
+*          fyllning med ett värde (block_fill), 2.25 vid fyllning med en
+*          aritmetisk talföljd (block_assign), där varje element kräver en
+*          addition, samt 2.375 vid kopiering (block_copy), där varje
+*          element kräver en läsning och en skrivning.
+*
+*          Vid kopiering läses fyra ord innan dessa skrivs, så att
+*          läsningarnas fördröjning på processorer med pipeline (Nios II/f)
+*          döljs av efterföljande läsningar. Återstående element, då
+*          arrayens storlek inte är jämnt delbar med BLOCK_UNROLL, hanteras
+*          ett i taget efter den utrullade loopen. Arrayerna måste vara
+*          placerade på adresser jämnt delbara med fyra.
+*
+*          Antalet instruktioner per anrop kan mätas via simulatorns flagga
+*          -c, se Verktyg/nios2sim.c.
+********************************************************************************/
+.ifndef BLOCK_S_
+.equ BLOCK_S_, 0
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ BLOCK_UNROLL, 8                /* Antal element per varv i de utrullade looparna. */
+.equ BLOCK_BYTES , BLOCK_UNROLL * 4 /* Antal byte per varv i de utrullade looparna. */
+
+/********************************************************************************
+* block_assign: Fyller array av angiven storlek med en aritmetisk talföljd,
+*               där första elementet tilldelas startvärdet och varje
+*               efterföljande element ökar med stegvärdet. Nästa värde i
+*               talföljden, dvs. startvärdet för en efterföljande array,
+*               returneras via r2.
+*
+*               - r2: Referens till arrayen (pekar på första elementet).
+*               - r3: Arrayens storlek, dvs. antalet element den rymmer.
+*               - r4: Startvärdet, dvs. det element som läggs till först.
+*               - r5: Stegvärdet, indikerar differensen mellan varje element.
+********************************************************************************/
+block_assign:
+   addi sp, sp, -12               /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 8(sp)                  /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 4(sp)                  /* Sparar undan innehållet i r4 inför användning. */
+   stw r6, 0(sp)                  /* Sparar undan innehållet i r6 inför användning. */
+   slli r3, r3, 2                 /* Beräknar arrayens storlek i byte. */
+   andi r6, r3, BLOCK_BYTES - 1   /* Antal byte utöver hela varv lagras i r6. */
+   add r3, r2, r3                 /* Beräknar arrayens slutadress i r3. */
+   sub r6, r3, r6                 /* Slutadressen för de hela varven lagras i r6. */
+   bgeu r2, r6, block_assign_tail /* Ryms inget helt varv hanteras elementen ett i taget. */
+block_assign_loop:
+   stw r4, 0(r2)                  /* Skriver element 0 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   stw r4, 4(r2)                  /* Skriver element 1 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   stw r4, 8(r2)                  /* Skriver element 2 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   stw r4, 12(r2)                 /* Skriver element 3 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   stw r4, 16(r2)                 /* Skriver element 4 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   stw r4, 20(r2)                 /* Skriver element 5 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   stw r4, 24(r2)                 /* Skriver element 6 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   stw r4, 28(r2)                 /* Skriver element 7 i aktuellt varv. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   addi r2, r2, BLOCK_BYTES       /* Pekar på första elementet i nästa varv. */
+   bltu r2, r6, block_assign_loop /* Återstartar loopen så länge ett helt varv ryms. */
+block_assign_tail:
+   bgeu r2, r3, block_assign_end  /* Avslutar när arrayen har fyllts till bredden. */
+   stw r4, 0(r2)                  /* Skriver aktuellt element. */
+   add r4, r4, r5                 /* Beräknar nästa värde i talföljden. */
+   addi r2, r2, 4                 /* Pekar på nästa element. */
+   br block_assign_tail           /* Återstartar loopen för återstående element. */
+block_assign_end:
+   mov r2, r4                     /* Returnerar nästa värde i talföljden via r2. */
+   ldw r6, 0(sp)                  /* Återställer r6 efter användning. */
+   ldw r4, 4(sp)                  /* Återställer r4 efter användning. */
+   ldw r3, 8(sp)                  /* Återställer r3 efter användning. */
+   addi sp, sp, 12                /* Återställer stackpekaren. */
+   ret                            /* Genomför återhopp. */
+
+/********************************************************************************
+* block_fill: Fyller array av angiven storlek med angivet värde, motsvarande
+*             memset för 32-bitars element.
+*
+*             - r2: Referens till arrayen (pekar på första elementet).
+*             - r3: Arrayens storlek, dvs. antalet element den rymmer.
+*             - r4: Värdet som samtliga element tilldelas.
+********************************************************************************/
+block_fill:
+   addi sp, sp, -12             /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 8(sp)                /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)                /* Sparar undan innehållet i r3 inför användning. */
+   stw r5, 0(sp)                /* Sparar undan innehållet i r5 inför användning. */
+   slli r3, r3, 2               /* Beräknar arrayens storlek i byte. */
+   andi r5, r3, BLOCK_BYTES - 1 /* Antal byte utöver hela varv lagras i r5. */
+   add r3, r2, r3               /* Beräknar arrayens slutadress i r3. */
+   sub r5, r3, r5               /* Slutadressen för de hela varven lagras i r5. */
+   bgeu r2, r5, block_fill_tail /* Ryms inget helt varv hanteras elementen ett i taget. */
+block_fill_loop:
+   stw r4, 0(r2)                /* Skriver element 0 i aktuellt varv. */
+   stw r4, 4(r2)                /* Skriver element 1 i aktuellt varv. */
+   stw r4, 8(r2)                /* Skriver element 2 i aktuellt varv. */
+   stw r4, 12(r2)               /* Skriver element 3 i aktuellt varv. */
+   stw r4, 16(r2)               /* Skriver element 4 i aktuellt varv. */
+   stw r4, 20(r2)               /* Skriver element 5 i aktuellt varv. */
+   stw r4, 24(r2)               /* Skriver element 6 i aktuellt varv. */
+   stw r4, 28(r2)               /* Skriver element 7 i aktuellt varv. */
+   addi r2, r2, BLOCK_BYTES     /* Pekar på första elementet i nästa varv. */
+   bltu r2, r5, block_fill_loop /* Återstartar loopen så länge ett helt varv ryms. */
+block_fill_tail:
+   bgeu r2, r3, block_fill_end  /* Avslutar när arrayen har fyllts till bredden. */
+   stw r4, 0(r2)                /* Skriver aktuellt element. */
+   addi r2, r2, 4               /* Pekar på nästa element. */
+   br block_fill_tail           /* Återstartar loopen för återstående element. */
+block_fill_end:
+   ldw r5, 0(sp)                /* Återställer r5 efter användning. */
+   ldw r3, 4(sp)                /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)                /* Återställer r2 efter användning. */
+   addi sp, sp, 12              /* Återställer stackpekaren. */
+   ret                          /* Genomför återhopp. */
+
+/********************************************************************************
+* block_copy: Kopierar angivet antal element från en array till en annan,
+*             motsvarande memcpy för 32-bitars element. Arrayerna får inte
+*             överlappa varandra.
+*
+*             - r2: Referens till destinationsarrayen.
+*             - r3: Referens till källarrayen.
+*             - r4: Antalet element som ska kopieras.
+********************************************************************************/
+block_copy:
+   addi sp, sp, -32             /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 28(sp)               /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 24(sp)               /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 20(sp)               /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 16(sp)               /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 12(sp)               /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 8(sp)                /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 4(sp)                /* Sparar undan innehållet i r8 inför användning. */
+   stw r9, 0(sp)                /* Sparar undan innehållet i r9 inför användning. */
+   slli r4, r4, 2               /* Beräknar antalet byte som ska kopieras. */
+   andi r5, r4, BLOCK_BYTES - 1 /* Antal byte utöver hela varv lagras i r5. */
+   add r4, r2, r4               /* Beräknar destinationens slutadress i r4. */
+   sub r5, r4, r5               /* Slutadressen för de hela varven lagras i r5. */
+   bgeu r2, r5, block_copy_tail /* Ryms inget helt varv hanteras elementen ett i taget. */
+block_copy_loop:
+   ldw r6, 0(r3)                /* Läser in element 0 i aktuellt varv. */
+   ldw r7, 4(r3)                /* Läser in element 1 i aktuellt varv. */
+   ldw r8, 8(r3)                /* Läser in element 2 i aktuellt varv. */
+   ldw r9, 12(r3)               /* Läser in element 3 i aktuellt varv. */
+   stw r6, 0(r2)                /* Skriver element 0 i aktuellt varv. */
+   stw r7, 4(r2)                /* Skriver element 1 i aktuellt varv. */
+   stw r8, 8(r2)                /* Skriver element 2 i aktuellt varv. */
+   stw r9, 12(r2)               /* Skriver element 3 i aktuellt varv. */
+   ldw r6, 16(r3)               /* Läser in element 4 i aktuellt varv. */
+   ldw r7, 20(r3)               /* Läser in element 5 i aktuellt varv. */
+   ldw r8, 24(r3)               /* Läser in element 6 i aktuellt varv. */
+   ldw r9, 28(r3)               /* Läser in element 7 i aktuellt varv. */
+   stw r6, 16(r2)               /* Skriver element 4 i aktuellt varv. */
+   stw r7, 20(r2)               /* Skriver element 5 i aktuellt varv. */
+   stw r8, 24(r2)               /* Skriver element 6 i aktuellt varv. */
+   stw r9, 28(r2)               /* Skriver element 7 i aktuellt varv. */
+   addi r3, r3, BLOCK_BYTES     /* Pekar på nästa varv i källarrayen. */
+   addi r2, r2, BLOCK_BYTES     /* Pekar på nästa varv i destinationsarrayen. */
+   bltu r2, r5, block_copy_loop /* Återstartar loopen så länge ett helt varv ryms. */
+block_copy_tail:
+   bgeu r2, r4, block_copy_end  /* Avslutar när samtliga element har kopierats. */
+   ldw r6, 0(r3)                /* Läser in aktuellt element. */
+   stw r6, 0(r2)                /* Skriver aktuellt element. */
+   addi r3, r3, 4               /* Pekar på nästa element i källarrayen. */
+   addi r2, r2, 4               /* Pekar på nästa element i destinationsarrayen. */
+   br block_copy_tail           /* Återstartar loopen för återstående element. */
+block_copy_end:
+   ldw r9, 0(sp)                /* Återställer r9 efter användning. */
+   ldw r8, 4(sp)                /* Återställer r8 efter användning. */
+   ldw r7, 8(sp)                /* Återställer r7 efter användning. */
+   ldw r6, 12(sp)               /* Återställer r6 efter användning. */
+   ldw r5, 16(sp)               /* Återställer r5 efter användning. */
+   ldw r4, 20(sp)               /* Återställer r4 efter användning. */
+   ldw r3, 24(sp)               /* Återställer r3 efter användning. */
+   ldw r2, 28(sp)               /* Återställer r2 efter användning. */
+   addi sp, sp, 32              /* Återställer stackpekaren. */
+   ret                          /* Genomför återhopp. */
+
+.endif /* BLOCK_S_ */
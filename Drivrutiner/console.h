@@ -0,0 +1,352 @@
+/********************************************************************************
+* console.h: Innehåller drivrutiner för icke-blockerande textutmatning till
+*            konsolen via JTAG UART, exempelvis statusutskrifter från
+*            lektionerna utöver lysdioderna.
+*
+*            Text läggs via console_print, console_print_uint samt
+*            console_print_hex i en ringbuffert om CONSOLE_BUFFER_SIZE
+*            tecken och returnerar direkt, utan att vänta på UART:en.
+*            Bufferten töms sedan till UART:ens sändkö (FIFO) i den takt
+*            som kön har plats, antingen via UART:ens avbrott när kön har
+*            plats (avbrottsdriven tömning) eller via console_poll från
+*            huvudloopen samt vid varje utskrift. Varje anrop skriver
+*            därmed som mest CONSOLE_FIFO_SIZE tecken till UART:en.
+*
+*            Anroparen skriver enbart till console_written och tömningen
+*            enbart till console_sent, så varken blockering eller
+*            inaktivering av avbrott krävs. Utskrifter får dock enbart ske
+*            från huvudloopen, inte från avbrottsrutiner. Ryms inte texten
+*            i bufferten kastas den i sin helhet och antalet kastade tecken
+*            räknas upp i console_dropped, så att text från ett anrop aldrig
+*            delas. En rad som skrivs via flera anrop reserverar först
+*            utrymme för hela raden via console_reserve.
+*            Tal formateras utan division, som saknas i processorn, och
+*            utan dynamiskt minne.
+*
+*            Basadressen väljs via makrot GPIO_CASE_GOLD_HW, som därmed måste
+*            definieras innan console.h inkluderas. Adressen för CASE GOLD är
+*            ett antagande och kan ersättas genom att definiera CONSOLE_BASE
+*            innan console.h inkluderas. Vid kompilering för Linux
+*            (gcc -DNIOS2_HOST) ersätts UART:en av variabler, där skickade
+*            tecken lagras i console_host_output och sändkön töms via
+*            console_host_transmit, som även genererar UART:ens avbrott.
+********************************************************************************/
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "irq.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#ifndef CONSOLE_BUFFER_SIZE
+#define CONSOLE_BUFFER_SIZE 256 /* Ringbuffertens storlek i antal tecken (tvåpotens). */
+#endif /* CONSOLE_BUFFER_SIZE */
+#define CONSOLE_MASK        (CONSOLE_BUFFER_SIZE - 1) /* Bitmask för omvandling av räknare till index. */
+#define CONSOLE_FIFO_SIZE   64                        /* Antal platser i UART:ens sändkö. */
+#define CONSOLE_IRQ         8                         /* Avbrottsnummer för JTAG UART. */
+
+/********************************************************************************
+* Index för UART:ens register relativt basadressen:
+********************************************************************************/
+#define CONSOLE_DATA_REG    0 /* Dataregister, tecken att skicka i bitar [7:0]. */
+#define CONSOLE_CONTROL_REG 1 /* Kontrollregister (WE samt lediga platser i sändkön). */
+
+/********************************************************************************
+* Bitar i UART:ens kontrollregister:
+********************************************************************************/
+#define CONSOLE_CONTROL_WE     0x02 /* Avbrott när sändkön har plats. */
+#define CONSOLE_CONTROL_WSPACE 16   /* Antal lediga platser i sändkön i bitar [31:16]. */
+
+/********************************************************************************
+* Basadress för JTAG UART. Adressen för CASE GOLD är inte dokumenterad, utan
+* antagen utifrån PIO-enheternas placering (0x8091740 - 0x8091760).
+* Kontrollera adressen i hårdvarans Platform Designer-system och definiera
+* CONSOLE_BASE innan console.h inkluderas ifall den avviker.
+********************************************************************************/
+#if defined(NIOS2_HOST)
+#define CONSOLE_HOST_OUTPUT 4096 /* Antal tecken som lagras av ersättningen för UART:en. */
+static volatile uint32_t console_host_uart[CONSOLE_CONTROL_REG + 1]; /* Ersättning för UART:en. */
+static char console_host_output[CONSOLE_HOST_OUTPUT];              /* Skickade tecken. */
+static uint32_t console_host_length;                               /* Antal skickade tecken. */
+#define CONSOLE_BASE (console_host_uart)                           /* Basadress för UART:en (Linux). */
+#elif !defined(CONSOLE_BASE)
+#if defined(GPIO_CASE_GOLD_HW)
+#define CONSOLE_BASE (volatile uint32_t*)(0x8091770)  /* Basadress för UART:en (antagen). */
+#else
+#define CONSOLE_BASE (volatile uint32_t*)(0xFF201000) /* Basadress för UART:en (simulering). */
+#endif /* GPIO_CASE_GOLD_HW */
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static char console_buffer[CONSOLE_BUFFER_SIZE]; /* Ringbuffert med tecken att skicka. */
+static uint32_t console_written;                 /* Antal inlagda tecken, ägs av anroparen. */
+static uint32_t console_sent;                    /* Antal skickade tecken, ägs av tömningen. */
+static uint32_t console_dropped;                 /* Antal kastade tecken då bufferten var full. */
+static bool console_interrupt;                   /* Indikerar avbrottsdriven tömning. */
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* console_host_put: Lagrar angivet tecken i console_host_output och räknar
+*                   ned antalet lediga platser i sändkön, på samma sätt som
+*                   UART:en vid skrivning till dataregistret.
+*
+*                   - c: Tecknet som ska skickas.
+********************************************************************************/
+static inline void console_host_put(const char c)
+{
+   if (console_host_length < CONSOLE_HOST_OUTPUT) console_host_output[console_host_length++] = c;
+   console_host_uart[CONSOLE_CONTROL_REG] -= 1UL << CONSOLE_CONTROL_WSPACE;
+   return;
+}
+
+/********************************************************************************
+* Skrivning till UART:ens register. Vid kompilering för Linux lagras skickade
+* tecken via console_host_put, medan antalet lediga platser i sändkön
+* behålls vid skrivning till kontrollregistret, likt UART:en.
+********************************************************************************/
+#define CONSOLE_PUT(uart, c)         console_host_put(c)
+#define CONSOLE_CONTROL(uart, value) ((uart)[CONSOLE_CONTROL_REG] = \
+                                     ((uart)[CONSOLE_CONTROL_REG] & 0xFFFF0000UL) | (value))
+#else
+#define CONSOLE_PUT(uart, c)         ((uart)[CONSOLE_DATA_REG] = (uint8_t)(c))
+#define CONSOLE_CONTROL(uart, value) ((uart)[CONSOLE_CONTROL_REG] = (value))
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* console_drain: Skriver tecken från ringbufferten till UART:en så länge
+*                sändkön har plats. När bufferten är tom inaktiveras
+*                UART:ens avbrott, ifall det är aktiverat.
+********************************************************************************/
+static void console_drain(void)
+{
+   volatile uint32_t* const uart = CONSOLE_BASE;
+   const uint32_t control = uart[CONSOLE_CONTROL_REG];
+   uint32_t space = control >> CONSOLE_CONTROL_WSPACE;
+   uint32_t sent = console_sent;
+   const uint32_t written = __atomic_load_n(&console_written, __ATOMIC_ACQUIRE);
+
+   while (sent != written && space)
+   {
+      CONSOLE_PUT(uart, console_buffer[sent & CONSOLE_MASK]);
+      sent++;
+      space--;
+   }
+   __atomic_store_n(&console_sent, sent, __ATOMIC_RELEASE);
+
+   if (sent == written && (control & CONSOLE_CONTROL_WE))
+   {
+      CONSOLE_CONTROL(uart, 0);
+   }
+   return;
+}
+
+/********************************************************************************
+* console_isr: Avbrottsrutin för JTAG UART, som genereras när sändkön har
+*              plats. Ringbufferten töms till sändkön via console_drain.
+********************************************************************************/
+static void console_isr(void)
+{
+   console_drain();
+   return;
+}
+
+/********************************************************************************
+* console_init: Initierar konsolen med tom ringbuffert. Vid avbrottsdriven
+*               tömning registreras UART:ens avbrottsrutin, som aktiveras
+*               vid varje utskrift. Avbrott måste därefter aktiveras
+*               globalt via irq_global_enable. Annars töms bufferten vid
+*               varje utskrift samt via console_poll.
+*
+*               - interrupt: Indikerar ifall tömningen ska vara avbrottsdriven.
+********************************************************************************/
+static inline void console_init(const bool interrupt)
+{
+   volatile uint32_t* const uart = CONSOLE_BASE;
+   console_written = 0;
+   console_sent = 0;
+   console_dropped = 0;
+   console_interrupt = interrupt;
+   CONSOLE_CONTROL(uart, 0);
+   if (interrupt) irq_register(CONSOLE_IRQ, console_isr);
+   return;
+}
+
+/********************************************************************************
+* console_poll: Tömmer ringbufferten till sändkön så långt den har plats.
+*               Bör anropas från huvudloopen vid tömning utan avbrott. Vid
+*               avbrottsdriven tömning görs ingenting, eftersom bufferten
+*               då enbart töms av avbrottsrutinen.
+********************************************************************************/
+static inline void console_poll(void)
+{
+   if (!console_interrupt) console_drain();
+   return;
+}
+
+/********************************************************************************
+* console_write: Lägger angivna tecken i ringbufferten och returnerar true
+*                direkt, utan att vänta på UART:en. Ryms inte samtliga
+*                tecken kastas de och antalet räknas upp i console_dropped,
+*                varefter false returneras.
+*
+*                - data: Referens till tecknen som ska skickas.
+*                - size: Antalet tecken.
+********************************************************************************/
+static bool console_write(const char* data,
+                          const uint32_t size)
+{
+   volatile uint32_t* const uart = CONSOLE_BASE;
+   const uint32_t written = console_written;
+
+   if (size > CONSOLE_BUFFER_SIZE - (written - __atomic_load_n(&console_sent, __ATOMIC_ACQUIRE)))
+   {
+      console_dropped += size;
+      return false;
+   }
+
+   for (uint32_t i = 0; i < size; ++i)
+   {
+      console_buffer[(written + i) & CONSOLE_MASK] = data[i];
+   }
+   __atomic_store_n(&console_written, written + size, __ATOMIC_RELEASE);
+
+   if (console_interrupt)
+   {
+      CONSOLE_CONTROL(uart, CONSOLE_CONTROL_WE);
+   }
+   else
+   {
+      console_drain();
+   }
+   return true;
+}
+
+/********************************************************************************
+* console_reserve: Kontrollerar att angivet antal tecken ryms i ringbufferten
+*                  och returnerar true i så fall. Används innan en rad skrivs
+*                  via flera anrop, så att raden antingen läggs i bufferten i
+*                  sin helhet eller kastas i sin helhet. Eftersom enbart
+*                  huvudloopen lägger tecken i bufferten, medan tömningen
+*                  enbart frigör platser, finns utrymmet kvar tills raden
+*                  har skrivits. Ryms inte tecknen räknas antalet upp i
+*                  console_dropped, varefter false returneras.
+*
+*                  - size: Det maximala antalet tecken som ska skrivas.
+********************************************************************************/
+static inline bool console_reserve(const uint32_t size)
+{
+   if (size > CONSOLE_BUFFER_SIZE - (console_written - __atomic_load_n(&console_sent, __ATOMIC_ACQUIRE)))
+   {
+      console_dropped += size;
+      return false;
+   }
+   return true;
+}
+
+/********************************************************************************
+* console_print: Lägger angiven textsträng i ringbufferten, se console_write.
+*
+*                - s: Referens till den nollterminerade textsträngen.
+********************************************************************************/
+static inline bool console_print(const char* s)
+{
+   uint32_t size = 0;
+   while (s[size]) size++;
+   return console_write(s, size);
+}
+
+/********************************************************************************
+* console_print_uint: Lägger angivet heltal i decimal form i ringbufferten,
+*                     se console_write. Varje siffra beräknas genom att
+*                     motsvarande tiopotens subtraheras så många gånger
+*                     som möjligt, vilket kräver som mest 90 subtraktioner.
+*
+*                     - value: Heltalet som ska skrivas ut.
+********************************************************************************/
+static bool console_print_uint(uint32_t value)
+{
+   static const uint32_t powers[] =
+   {
+      1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1
+   };
+   char digits[sizeof(powers) / sizeof(powers[0])];
+   uint32_t size = 0;
+
+   for (uint32_t i = 0; i < sizeof(powers) / sizeof(powers[0]); ++i)
+   {
+      char digit = '0';
+
+      while (value >= powers[i])
+      {
+         value -= powers[i];
+         digit++;
+      }
+      if (size || digit != '0' || powers[i] == 1) digits[size++] = digit;
+   }
+   return console_write(digits, size);
+}
+
+/********************************************************************************
+* console_print_hex: Lägger angivet heltal i hexadecimal form med angivet
+*                    antal siffror i ringbufferten, se console_write.
+*                    Högre siffror än angivet antal skrivs inte ut.
+*
+*                    - value : Heltalet som ska skrivas ut.
+*                    - digits: Antalet siffror (1 - 8).
+********************************************************************************/
+static bool console_print_hex(const uint32_t value,
+                              const uint8_t digits)
+{
+   char hex[8];
+   const uint32_t size = digits < 1 ? 1 : digits > 8 ? 8 : digits;
+
+   for (uint32_t i = 0; i < size; ++i)
+   {
+      hex[i] = "0123456789ABCDEF"[(value >> (4 * (size - 1 - i))) & 0x0F];
+   }
+   return console_write(hex, size);
+}
+
+/********************************************************************************
+* console_idle: Indikerar ifall samtliga tecken i ringbufferten har skickats
+*               till UART:ens sändkö.
+********************************************************************************/
+static inline bool console_idle(void)
+{
+   return console_written == __atomic_load_n(&console_sent, __ATOMIC_ACQUIRE);
+}
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* console_host_transmit: Simulerar att UART:en har skickat angivet antal
+*                        tecken från sändkön, som därmed får motsvarande
+*                        antal lediga platser. Är UART:ens avbrott aktiverat
+*                        genereras därefter ett avbrott via irq_host_raise.
+*
+*                        - count: Antalet skickade tecken.
+********************************************************************************/
+static inline void console_host_transmit(const uint32_t count)
+{
+   const uint32_t control = console_host_uart[CONSOLE_CONTROL_REG];
+   uint32_t space = (control >> CONSOLE_CONTROL_WSPACE) + count;
+   if (space > CONSOLE_FIFO_SIZE) space = CONSOLE_FIFO_SIZE;
+   console_host_uart[CONSOLE_CONTROL_REG] = (space << CONSOLE_CONTROL_WSPACE) | (control & 0xFFFF);
+
+   if (control & CONSOLE_CONTROL_WE)
+   {
+      irq_host_raise(CONSOLE_IRQ, true);
+      irq_host_raise(CONSOLE_IRQ, false);
+   }
+   return;
+}
+#endif /* NIOS2_HOST */
+
+#endif /* CONSOLE_H_ */
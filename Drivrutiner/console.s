@@ -0,0 +1,461 @@
+/********************************************************************************
+* console.s: Innehåller drivrutiner för icke-blockerande textutmatning till
+*            konsolen via JTAG UART, motsvarande console.h.
+*
+*            Text läggs via console_print, console_print_uint samt
+*            console_print_hex i en ringbuffert om CONSOLE_BUFFER_SIZE
+*            tecken och returnerar direkt, utan att vänta på UART:en.
+*            Bufferten töms till UART:ens sändkö i den takt som kön har
+*            plats, antingen via UART:ens avbrott (avbrottsdriven tömning)
+*            eller via console_poll samt vid varje utskrift.
+*
+*            Anroparen skriver enbart till console_written och tömningen
+*            enbart till console_sent, så att avbrott inte behöver
+*            inaktiveras vid utskrift. Utskrifter får enbart ske från
+*            huvudloopen. Ryms inte texten i bufferten kastas den i sin
+*            helhet och antalet kastade tecken räknas upp i console_dropped.
+*            En rad som skrivs via flera anrop reserverar först utrymme för
+*            hela raden via console_reserve.
+*
+*            Basadressen väljs via symbolen GPIO_CASE_GOLD_HW, som därmed
+*            måste definieras innan console.s inkluderas. Adressen för
+*            CASE GOLD är ett antagande och kan ersättas genom att definiera
+*            CONSOLE_BASE innan console.s inkluderas. Vid avbrottsdriven
+*            tömning måste avbrott aktiveras globalt via irq_global_enable
+*            efter console_init.
+********************************************************************************/
+.ifndef CONSOLE_S_
+.equ CONSOLE_S_, 0
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/irq.s"
+
+/********************************************************************************
+* Basadress för JTAG UART. Adressen för CASE GOLD är inte dokumenterad, utan
+* antagen utifrån PIO-enheternas placering (0x8091740 - 0x8091760).
+* Kontrollera adressen i hårdvarans Platform Designer-system och definiera
+* CONSOLE_BASE innan console.s inkluderas ifall den avviker.
+********************************************************************************/
+.ifndef CONSOLE_BASE
+.ifdef GPIO_CASE_GOLD_HW
+.equ CONSOLE_BASE, 0x8091770  /* Basadress för UART:en (CASE GOLD, antagen). */
+.else
+.equ CONSOLE_BASE, 0xFF201000 /* Basadress för UART:en (simulering). */
+.endif /* GPIO_CASE_GOLD_HW */
+.endif /* CONSOLE_BASE */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.ifndef CONSOLE_BUFFER_SIZE
+.equ CONSOLE_BUFFER_SIZE, 256 /* Ringbuffertens storlek i antal tecken (tvåpotens). */
+.endif /* CONSOLE_BUFFER_SIZE */
+.equ CONSOLE_MASK       , CONSOLE_BUFFER_SIZE - 1 /* Bitmask för omvandling av räknare till index. */
+.equ CONSOLE_IRQ        , 8                       /* Avbrottsnummer för JTAG UART. */
+
+/********************************************************************************
+* Offset för UART:ens register relativt basadressen:
+********************************************************************************/
+.equ CONSOLE_DATA_REG   , 0 /* Dataregister, tecken att skicka i bitar [7:0]. */
+.equ CONSOLE_CONTROL_REG, 4 /* Kontrollregister (WE samt lediga platser i sändkön). */
+
+/********************************************************************************
+* Bitar i UART:ens kontrollregister:
+********************************************************************************/
+.equ CONSOLE_CONTROL_WE    , 0x02 /* Avbrott när sändkön har plats. */
+.equ CONSOLE_CONTROL_WSPACE, 16   /* Antal lediga platser i sändkön i bitar [31:16]. */
+
+/********************************************************************************
+* console_drain: Skriver tecken från ringbufferten till UART:en så länge
+*                sändkön har plats. När bufferten är tom inaktiveras
+*                UART:ens avbrott, ifall det är aktiverat.
+********************************************************************************/
+console_drain:
+   addi sp, sp, -28                    /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 24(sp)                      /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 20(sp)                      /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 16(sp)                      /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 12(sp)                      /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 8(sp)                       /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 4(sp)                       /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 0(sp)                       /* Sparar undan innehållet i r8 inför användning. */
+   movia r2, CONSOLE_BASE              /* Läser in CONSOLE_BASE i r2. */
+   ldwio r3, CONSOLE_CONTROL_REG(r2)   /* Läser in kontrollregistret i r3. */
+   srli r4, r3, CONSOLE_CONTROL_WSPACE /* Beräknar antalet lediga platser i sändkön. */
+   movia r5, console_sent              /* Läser in adressen till console_sent i r5. */
+   ldw r5, 0(r5)                       /* Läser in antalet skickade tecken i r5. */
+   movia r6, console_written           /* Läser in adressen till console_written i r6. */
+   ldw r6, 0(r6)                       /* Läser in antalet inlagda tecken i r6. */
+   movia r8, console_buffer            /* Läser in adressen till ringbufferten i r8. */
+console_drain_loop:
+   beq r5, r6, console_drain_empty     /* Avslutar när samtliga tecken är skickade. */
+   beq r4, zero, console_drain_end     /* Avslutar när sändkön är full. */
+   andi r7, r5, CONSOLE_MASK           /* Beräknar index för nästa tecken att skicka. */
+   add r7, r7, r8                      /* Pekar på nästa tecken i ringbufferten. */
+   ldbu r7, 0(r7)                      /* Läser in tecknet i r7. */
+   stwio r7, CONSOLE_DATA_REG(r2)      /* Skriver tecknet till UART:ens sändkö. */
+   addi r5, r5, 1                      /* Räknar upp antalet skickade tecken. */
+   subi r4, r4, 1                      /* Räknar ned antalet lediga platser. */
+   br console_drain_loop               /* Återstartar loopen. */
+console_drain_empty:
+   andi r3, r3, CONSOLE_CONTROL_WE     /* Kontrollerar ifall avbrottet är aktiverat. */
+   beq r3, zero, console_drain_end     /* Annars lämnas kontrollregistret orört. */
+   stwio zero, CONSOLE_CONTROL_REG(r2) /* Inaktiverar avbrottet när bufferten är tom. */
+console_drain_end:
+   movia r7, console_sent              /* Läser in adressen till console_sent i r7. */
+   stw r5, 0(r7)                       /* Lagrar antalet skickade tecken. */
+   ldw r8, 0(sp)                       /* Återställer r8 efter användning. */
+   ldw r7, 4(sp)                       /* Återställer r7 efter användning. */
+   ldw r6, 8(sp)                       /* Återställer r6 efter användning. */
+   ldw r5, 12(sp)                      /* Återställer r5 efter användning. */
+   ldw r4, 16(sp)                      /* Återställer r4 efter användning. */
+   ldw r3, 20(sp)                      /* Återställer r3 efter användning. */
+   ldw r2, 24(sp)                      /* Återställer r2 efter användning. */
+   addi sp, sp, 28                     /* Återställer stackpekaren. */
+   ret                                 /* Genomför återhopp. */
+
+/********************************************************************************
+* console_isr: Avbrottsrutin för JTAG UART, som genereras när sändkön har
+*              plats. Ringbufferten töms till sändkön via console_drain.
+********************************************************************************/
+console_isr:
+   addi sp, sp, -4    /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 0(sp)      /* Sparar undan återhoppsadressen i ra. */
+   call console_drain /* Tömmer ringbufferten till sändkön. */
+   ldw ra, 0(sp)      /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 4     /* Återställer stackpekaren. */
+   ret                /* Genomför återhopp. */
+
+/********************************************************************************
+* console_init: Initierar konsolen med tom ringbuffert. Vid avbrottsdriven
+*               tömning registreras UART:ens avbrottsrutin, som aktiveras
+*               vid varje utskrift. Annars töms bufferten vid varje
+*               utskrift samt via console_poll.
+*
+*               - r2: Indikerar ifall tömningen ska vara avbrottsdriven (1).
+********************************************************************************/
+console_init:
+   addi sp, sp, -12                    /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 8(sp)                       /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 4(sp)                       /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 0(sp)                       /* Sparar undan innehållet i r3 inför användning. */
+   movia r3, console_written           /* Läser in adressen till console_written i r3. */
+   stw zero, 0(r3)                     /* Nollställer antalet inlagda tecken. */
+   movia r3, console_sent              /* Läser in adressen till console_sent i r3. */
+   stw zero, 0(r3)                     /* Nollställer antalet skickade tecken. */
+   movia r3, console_dropped           /* Läser in adressen till console_dropped i r3. */
+   stw zero, 0(r3)                     /* Nollställer antalet kastade tecken. */
+   movia r3, console_interrupt         /* Läser in adressen till console_interrupt i r3. */
+   stw r2, 0(r3)                       /* Lagrar ifall tömningen är avbrottsdriven. */
+   movia r3, CONSOLE_BASE              /* Läser in CONSOLE_BASE i r3. */
+   stwio zero, CONSOLE_CONTROL_REG(r3) /* Inaktiverar UART:ens avbrott. */
+   beq r2, zero, console_init_end      /* Vid tömning utan avbrott är initieringen klar. */
+   movi r2, CONSOLE_IRQ                /* Läser in UART:ens avbrottsnummer i r2. */
+   movia r3, console_isr               /* Läser in adressen till console_isr i r3. */
+   call irq_register                   /* Registrerar avbrottsrutinen för UART:en. */
+console_init_end:
+   ldw r3, 0(sp)                       /* Återställer r3 efter användning. */
+   ldw r2, 4(sp)                       /* Återställer r2 efter användning. */
+   ldw ra, 8(sp)                       /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 12                     /* Återställer stackpekaren. */
+   ret                                 /* Genomför återhopp. */
+
+/********************************************************************************
+* console_poll: Tömmer ringbufferten till sändkön så långt den har plats.
+*               Bör anropas från huvudloopen vid tömning utan avbrott. Vid
+*               avbrottsdriven tömning görs ingenting.
+********************************************************************************/
+console_poll:
+   addi sp, sp, -8                /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 4(sp)                  /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 0(sp)                  /* Sparar undan innehållet i r2 inför användning. */
+   movia r2, console_interrupt    /* Läser in adressen till console_interrupt i r2. */
+   ldw r2, 0(r2)                  /* Läser in ifall tömningen är avbrottsdriven. */
+   bne r2, zero, console_poll_end /* Vid avbrottsdriven tömning görs ingenting. */
+   call console_drain             /* Tömmer ringbufferten till sändkön. */
+console_poll_end:
+   ldw r2, 0(sp)                  /* Återställer r2 efter användning. */
+   ldw ra, 4(sp)                  /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 8                 /* Återställer stackpekaren. */
+   ret                            /* Genomför återhopp. */
+
+/********************************************************************************
+* console_write: Lägger angivna tecken i ringbufferten och returnerar 1 via
+*                r2 direkt, utan att vänta på UART:en. Ryms inte samtliga
+*                tecken kastas de och antalet räknas upp i console_dropped,
+*                varefter 0 returneras.
+*
+*                - r2: Referens till tecknen som ska skickas.
+*                - r3: Antalet tecken.
+********************************************************************************/
+console_write:
+   addi sp, sp, -32                  /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 28(sp)                    /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 24(sp)                    /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 20(sp)                    /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 16(sp)                    /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 12(sp)                    /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 8(sp)                     /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 4(sp)                     /* Sparar undan innehållet i r8 inför användning. */
+   stw r9, 0(sp)                     /* Sparar undan innehållet i r9 inför användning. */
+   movia r4, console_written         /* Läser in adressen till console_written i r4. */
+   ldw r5, 0(r4)                     /* Läser in antalet inlagda tecken i r5. */
+   movia r6, console_sent            /* Läser in adressen till console_sent i r6. */
+   ldw r6, 0(r6)                     /* Läser in antalet skickade tecken i r6. */
+   sub r6, r5, r6                    /* Beräknar antalet upptagna platser i r6. */
+   movi r7, CONSOLE_BUFFER_SIZE      /* Läser in ringbuffertens storlek i r7. */
+   sub r6, r7, r6                    /* Beräknar antalet lediga platser i r6. */
+   bltu r6, r3, console_write_drop   /* Ryms inte tecknen kastas de. */
+   movia r7, console_buffer          /* Läser in adressen till ringbufferten i r7. */
+   mov r6, r5                        /* Börjar kopiera till första lediga plats. */
+   add r8, r5, r3                    /* Beräknar antalet inlagda tecken efter kopieringen. */
+console_write_loop:
+   beq r6, r8, console_write_submit  /* Avslutar när samtliga tecken är kopierade. */
+   andi r9, r6, CONSOLE_MASK         /* Beräknar index för nästa lediga plats. */
+   add r9, r9, r7                    /* Pekar på nästa lediga plats i ringbufferten. */
+   ldbu r3, 0(r2)                    /* Läser in nästa tecken i r3. */
+   stb r3, 0(r9)                     /* Lägger tecknet i ringbufferten. */
+   addi r2, r2, 1                    /* Pekar på nästa tecken att kopiera. */
+   addi r6, r6, 1                    /* Räknar upp antalet kopierade tecken. */
+   br console_write_loop             /* Återstartar loopen. */
+console_write_submit:
+   stw r8, 0(r4)                     /* Lagrar antalet inlagda tecken, tecknen kan skickas. */
+   movia r4, console_interrupt       /* Läser in adressen till console_interrupt i r4. */
+   ldw r4, 0(r4)                     /* Läser in ifall tömningen är avbrottsdriven. */
+   beq r4, zero, console_write_poll  /* Annars töms bufferten direkt. */
+   movia r4, CONSOLE_BASE            /* Läser in CONSOLE_BASE i r4. */
+   movi r3, CONSOLE_CONTROL_WE       /* Läser in biten WE i r3. */
+   stwio r3, CONSOLE_CONTROL_REG(r4) /* Aktiverar UART:ens avbrott för tömning. */
+   br console_write_ok               /* Avslutar utskriften. */
+console_write_poll:
+   call console_drain                /* Tömmer ringbufferten till sändkön. */
+console_write_ok:
+   movi r2, 1                        /* Lagrar returvärde 1 i r2. */
+   br console_write_end              /* Avslutar subrutinen. */
+console_write_drop:
+   movia r4, console_dropped         /* Läser in adressen till console_dropped i r4. */
+   ldw r5, 0(r4)                     /* Läser in antalet kastade tecken i r5. */
+   add r5, r5, r3                    /* Räknar upp antalet kastade tecken. */
+   stw r5, 0(r4)                     /* Lagrar antalet kastade tecken. */
+   movi r2, 0                        /* Lagrar returvärde 0 i r2. */
+console_write_end:
+   ldw r9, 0(sp)                     /* Återställer r9 efter användning. */
+   ldw r8, 4(sp)                     /* Återställer r8 efter användning. */
+   ldw r7, 8(sp)                     /* Återställer r7 efter användning. */
+   ldw r6, 12(sp)                    /* Återställer r6 efter användning. */
+   ldw r5, 16(sp)                    /* Återställer r5 efter användning. */
+   ldw r4, 20(sp)                    /* Återställer r4 efter användning. */
+   ldw r3, 24(sp)                    /* Återställer r3 efter användning. */
+   ldw ra, 28(sp)                    /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 32                   /* Återställer stackpekaren. */
+   ret                               /* Genomför återhopp. */
+
+/********************************************************************************
+* console_reserve: Kontrollerar att angivet antal tecken ryms i ringbufferten
+*                  och returnerar 1 via r2 i så fall. Används innan en rad
+*                  skrivs via flera anrop, så att raden antingen läggs i
+*                  bufferten i sin helhet eller kastas i sin helhet. Ryms
+*                  inte tecknen räknas antalet upp i console_dropped,
+*                  varefter 0 returneras.
+*
+*                  - r2: Det maximala antalet tecken som ska skrivas.
+********************************************************************************/
+console_reserve:
+   addi sp, sp, -8                   /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 4(sp)                     /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                     /* Sparar undan innehållet i r4 inför användning. */
+   movia r3, console_written         /* Läser in adressen till console_written i r3. */
+   ldw r3, 0(r3)                     /* Läser in antalet inlagda tecken i r3. */
+   movia r4, console_sent            /* Läser in adressen till console_sent i r4. */
+   ldw r4, 0(r4)                     /* Läser in antalet skickade tecken i r4. */
+   sub r3, r3, r4                    /* Beräknar antalet upptagna platser i r3. */
+   movi r4, CONSOLE_BUFFER_SIZE      /* Läser in ringbuffertens storlek i r4. */
+   sub r3, r4, r3                    /* Beräknar antalet lediga platser i r3. */
+   bltu r3, r2, console_reserve_drop /* Ryms inte tecknen kastas raden. */
+   movi r2, 1                        /* Lagrar returvärde 1 i r2. */
+   br console_reserve_end            /* Avslutar subrutinen. */
+console_reserve_drop:
+   movia r3, console_dropped         /* Läser in adressen till console_dropped i r3. */
+   ldw r4, 0(r3)                     /* Läser in antalet kastade tecken i r4. */
+   add r4, r4, r2                    /* Räknar upp antalet kastade tecken. */
+   stw r4, 0(r3)                     /* Lagrar antalet kastade tecken. */
+   movi r2, 0                        /* Lagrar returvärde 0 i r2. */
+console_reserve_end:
+   ldw r4, 0(sp)                     /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                     /* Återställer r3 efter användning. */
+   addi sp, sp, 8                    /* Återställer stackpekaren. */
+   ret                               /* Genomför återhopp. */
+
+/********************************************************************************
+* console_print: Lägger angiven textsträng i ringbufferten, se console_write.
+*
+*                - r2: Referens till den nollterminerade textsträngen.
+********************************************************************************/
+console_print:
+   addi sp, sp, -12                  /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 8(sp)                     /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 4(sp)                     /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                     /* Sparar undan innehållet i r4 inför användning. */
+   mov r3, r2                        /* Börjar söka efter nolltecknet från första tecknet. */
+console_print_length:
+   ldbu r4, 0(r3)                    /* Läser in nästa tecken i r4. */
+   beq r4, zero, console_print_write /* Avslutar sökningen vid nolltecknet. */
+   addi r3, r3, 1                    /* Pekar på nästa tecken. */
+   br console_print_length           /* Återstartar loopen. */
+console_print_write:
+   sub r3, r3, r2                    /* Beräknar textsträngens längd i r3. */
+   call console_write                /* Lägger textsträngen i ringbufferten. */
+   ldw r4, 0(sp)                     /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                     /* Återställer r3 efter användning. */
+   ldw ra, 8(sp)                     /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 12                   /* Återställer stackpekaren. */
+   ret                               /* Genomför återhopp. */
+
+/********************************************************************************
+* console_print_uint: Lägger angivet heltal i decimal form i ringbufferten,
+*                     se console_write. Varje siffra beräknas genom att
+*                     motsvarande tiopotens i tabellen console_powers
+*                     subtraheras så många gånger som möjligt, eftersom
+*                     processorn saknar division. Siffrorna lagras på
+*                     stacken, där inledande nollor hoppas över.
+*
+*                     - r2: Heltalet som ska skrivas ut.
+********************************************************************************/
+console_print_uint:
+   addi sp, sp, -40                      /* Allokerar minne för siffrorna samt sparade register. */
+   stw ra, 36(sp)                        /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 32(sp)                        /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 28(sp)                        /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 24(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 20(sp)                        /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 16(sp)                        /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 12(sp)                        /* Sparar undan innehållet i r8 inför användning. */
+   movia r3, console_powers              /* Läser in adressen till tiopotenserna i r3. */
+   mov r4, sp                            /* Pekar på första siffran på stacken. */
+   movi r5, 10                           /* Läser in antalet tiopotenser i r5. */
+console_print_uint_loop:
+   ldw r6, 0(r3)                         /* Läser in aktuell tiopotens i r6. */
+   movi r7, '0'                          /* Siffran börjar på noll. */
+console_print_uint_digit:
+   bltu r2, r6, console_print_uint_store /* Avslutar när tiopotensen inte längre ryms. */
+   sub r2, r2, r6                        /* Subtraherar tiopotensen från heltalet. */
+   addi r7, r7, 1                        /* Räknar upp siffran. */
+   br console_print_uint_digit           /* Återstartar loopen. */
+console_print_uint_store:
+   bne r4, sp, console_print_uint_keep   /* Efter första siffran lagras samtliga siffror. */
+   movi r8, '0'                          /* Läser in siffran noll i r8. */
+   bne r7, r8, console_print_uint_keep   /* Siffror skilda från noll lagras. */
+   movi r8, 1                            /* Läser in tiopotensen 1 i r8. */
+   bne r6, r8, console_print_uint_next   /* Inledande nollor hoppas över, utom den sista. */
+console_print_uint_keep:
+   stb r7, 0(r4)                         /* Lagrar siffran på stacken. */
+   addi r4, r4, 1                        /* Pekar på nästa siffra. */
+console_print_uint_next:
+   addi r3, r3, 4                        /* Pekar på nästa tiopotens. */
+   subi r5, r5, 1                        /* Räknar ned antalet tiopotenser. */
+   bne r5, zero, console_print_uint_loop /* Återstartar loopen för nästa tiopotens. */
+   mov r2, sp                            /* Läser in adressen till första siffran i r2. */
+   sub r3, r4, sp                        /* Beräknar antalet siffror i r3. */
+   call console_write                    /* Lägger siffrorna i ringbufferten. */
+   ldw r8, 12(sp)                        /* Återställer r8 efter användning. */
+   ldw r7, 16(sp)                        /* Återställer r7 efter användning. */
+   ldw r6, 20(sp)                        /* Återställer r6 efter användning. */
+   ldw r5, 24(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 28(sp)                        /* Återställer r4 efter användning. */
+   ldw r3, 32(sp)                        /* Återställer r3 efter användning. */
+   ldw ra, 36(sp)                        /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 40                       /* Återställer stackpekaren. */
+   ret                                   /* Genomför återhopp. */
+
+/********************************************************************************
+* console_print_hex: Lägger angivet heltal i hexadecimal form med angivet
+*                    antal siffror i ringbufferten, se console_write.
+*                    Siffrorna lagras på stacken, med början från den
+*                    lägsta. Högre siffror än angivet antal skrivs inte ut.
+*
+*                    - r2: Heltalet som ska skrivas ut.
+*                    - r3: Antalet siffror (1 - 8).
+********************************************************************************/
+console_print_hex:
+   addi sp, sp, -32                      /* Allokerar minne för siffrorna samt sparade register. */
+   stw ra, 28(sp)                        /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 24(sp)                        /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 20(sp)                        /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 16(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 12(sp)                        /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 8(sp)                         /* Sparar undan innehållet i r7 inför användning. */
+   bne r3, zero, console_print_hex_max   /* Minst en siffra skrivs ut. */
+   movi r3, 1                            /* Skriver ut en siffra. */
+console_print_hex_max:
+   cmpltui r4, r3, 9                     /* Kontrollerar ifall antalet siffror är högst 8. */
+   bne r4, zero, console_print_hex_start /* Annars skrivs 8 siffror ut. */
+   movi r3, 8                            /* Skriver ut 8 siffror. */
+console_print_hex_start:
+   add r4, sp, r3                        /* Pekar efter den sista siffran på stacken. */
+   mov r5, r3                            /* Läser in antalet siffror i r5. */
+console_print_hex_loop:
+   subi r4, r4, 1                        /* Pekar på föregående siffra. */
+   andi r6, r2, 0x0F                     /* Läser in de lägsta fyra bitarna i r6. */
+   cmpltui r7, r6, 10                    /* Kontrollerar ifall siffran är 0 - 9. */
+   bne r7, zero, console_print_hex_digit /* Siffror 0 - 9 omvandlas direkt. */
+   addi r6, r6, 'A' - '0' - 10           /* Siffror 10 - 15 omvandlas till A - F. */
+console_print_hex_digit:
+   addi r6, r6, '0'                      /* Omvandlar siffran till ett tecken. */
+   stb r6, 0(r4)                         /* Lagrar siffran på stacken. */
+   srli r2, r2, 4                        /* Skiftar fram nästa siffra. */
+   subi r5, r5, 1                        /* Räknar ned antalet siffror. */
+   bne r5, zero, console_print_hex_loop  /* Återstartar loopen för nästa siffra. */
+   mov r2, sp                            /* Läser in adressen till första siffran i r2. */
+   call console_write                    /* Lägger siffrorna i ringbufferten. */
+   ldw r7, 8(sp)                         /* Återställer r7 efter användning. */
+   ldw r6, 12(sp)                        /* Återställer r6 efter användning. */
+   ldw r5, 16(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 20(sp)                        /* Återställer r4 efter användning. */
+   ldw r3, 24(sp)                        /* Återställer r3 efter användning. */
+   ldw ra, 28(sp)                        /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 32                       /* Återställer stackpekaren. */
+   ret                                   /* Genomför återhopp. */
+
+/********************************************************************************
+* console_idle: Indikerar ifall samtliga tecken i ringbufferten har skickats
+*               till UART:ens sändkö via r2 (1 = samtliga skickade).
+********************************************************************************/
+console_idle:
+   addi sp, sp, -4           /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 0(sp)             /* Sparar undan innehållet i r3 inför användning. */
+   movia r2, console_written /* Läser in adressen till console_written i r2. */
+   ldw r2, 0(r2)             /* Läser in antalet inlagda tecken i r2. */
+   movia r3, console_sent    /* Läser in adressen till console_sent i r3. */
+   ldw r3, 0(r3)             /* Läser in antalet skickade tecken i r3. */
+   cmpeq r2, r2, r3          /* Indikerar ifall samtliga tecken är skickade. */
+   ldw r3, 0(sp)             /* Återställer r3 efter användning. */
+   addi sp, sp, 4            /* Återställer stackpekaren. */
+   ret                       /* Genomför återhopp. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats för konsolens räknare samt tiopotenserna
+*        som används vid formatering av heltal i decimal form.
+********************************************************************************/
+.data
+console_written:   .skip 4 /* Antal inlagda tecken, ägs av anroparen. */
+console_sent:      .skip 4 /* Antal skickade tecken, ägs av tömningen. */
+console_dropped:   .skip 4 /* Antal kastade tecken då bufferten var full. */
+console_interrupt: .skip 4 /* Indikerar avbrottsdriven tömning (1). */
+console_powers:
+   .word 1000000000, 100000000, 10000000, 1000000, 100000 /* Tiopotenser 10^9 - 10^5. */
+   .word 10000, 1000, 100, 10, 1                          /* Tiopotenser 10^4 - 10^0. */
+
+/********************************************************************************
+* .bss: Datasegment för nollställda data, lagringsplats för ringbufferten.
+********************************************************************************/
+.section .bss, "aw", @nobits
+console_buffer: .skip CONSOLE_BUFFER_SIZE /* Ringbuffert med tecken att skicka. */
+
+/********************************************************************************
+* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+
+.endif /* CONSOLE_S_ */
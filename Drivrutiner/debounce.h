@@ -0,0 +1,120 @@
+/********************************************************************************
+* debounce.h: Innehåller drivrutiner för avstudsning av samtliga slide-switchar
+*             samt tryckknappar samtidigt via vertikala räknare.
+*
+*             Varje bit i en 32-bitars insignal tilldelas en egen tvåbitars
+*             räknare, där räknarnas lägre respektive högre bitar lagras i
+*             varsitt ord (cnt0 och cnt1). Räknarna uppdateras därmed med ett
+*             fåtal bitvisa operationer för samtliga pinnar på en gång, så
+*             kostnaden per uppdatering är densamma oavsett antal pinnar.
+*             En pin byter avstudsat tillstånd först när fyra avläsningar i
+*             följd skiljer sig från aktuellt tillstånd. Med en avläsning var
+*             femte millisekund motsvarar det en avstudsningstid på 20 ms.
+*
+*             Insignalerna från slide-switcharna samt tryckknapparna packas
+*             i ett gemensamt ord via makrot DEBOUNCE_SAMPLE, där SW[9:0]
+*             placeras i bit 9 - 0 och KEY[3:0] i bit 13 - 10. Tryckknapparna
+*             är aktivt låga och inverteras, så att en ettställd bit alltid
+*             indikerar nedtryckt tryckknapp respektive ettställd slide-switch.
+********************************************************************************/
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define DEBOUNCE_PERIOD_MS     5        /* Rekommenderad tid mellan varje avläsning. */
+#define DEBOUNCE_SWITCHES_MASK 0x3FFUL  /* Bitar för SW[9:0] i packad insignal. */
+#define DEBOUNCE_KEYS_SHIFT    10       /* Position för KEY[0] i packad insignal. */
+#define DEBOUNCE_KEYS_MASK     0x3C00UL /* Bitar för KEY[3:0] i packad insignal. */
+
+/********************************************************************************
+* DEBOUNCE_SAMPLE: Packar insignaler från slide-switchar samt tryckknappar i
+*                  ett ord, där tryckknapparnas aktivt låga insignaler
+*                  inverteras.
+*
+*                  - switches: Insignaler från SWITCHES_BASE.
+*                  - buttons : Insignaler från BUTTONS_BASE.
+********************************************************************************/
+#define DEBOUNCE_SAMPLE(switches, buttons)                                    \
+   (((uint32_t)(switches) & DEBOUNCE_SWITCHES_MASK) |                         \
+    ((~(uint32_t)(buttons) << DEBOUNCE_KEYS_SHIFT) & DEBOUNCE_KEYS_MASK))
+
+/********************************************************************************
+* DEBOUNCE_KEY: Returnerar bitmask för angiven tryckknapp i packad insignal.
+*
+*               - pin: Tryckknappens pin-nummer (0 - 3).
+********************************************************************************/
+#define DEBOUNCE_KEY(pin) (1UL << (DEBOUNCE_KEYS_SHIFT + (pin)))
+
+/********************************************************************************
+* DEBOUNCE_SWITCH: Returnerar bitmask för angiven slide-switch i packad
+*                  insignal.
+*
+*                  - pin: Slide-switchens pin-nummer (0 - 9).
+********************************************************************************/
+#define DEBOUNCE_SWITCH(pin) (1UL << (pin))
+
+/********************************************************************************
+* debounce: Strukt för avstudsning av upp till 32 insignaler via vertikala
+*           räknare. Flanker från senaste uppdateringen lagras i pressed
+*           samt released.
+********************************************************************************/
+struct debounce
+{
+   uint32_t cnt0;     /* Räknarnas lägre bitar, en bit per pin. */
+   uint32_t cnt1;     /* Räknarnas högre bitar, en bit per pin. */
+   uint32_t state;    /* Avstudsade insignaler. */
+   uint32_t pressed;  /* Pinnar som ettställdes vid senaste uppdateringen. */
+   uint32_t released; /* Pinnar som nollställdes vid senaste uppdateringen. */
+};
+
+/********************************************************************************
+* debounce_init: Initierar avstudsningen med angivna insignaler som
+*                avstudsat starttillstånd.
+*
+*                - self  : Referens till avstudsningen.
+*                - sample: Insignaler vid start, se DEBOUNCE_SAMPLE.
+********************************************************************************/
+static inline void debounce_init(struct debounce* self,
+                                 const uint32_t sample)
+{
+   self->cnt0 = 0;
+   self->cnt1 = 0;
+   self->state = sample;
+   self->pressed = 0;
+   self->released = 0;
+   return;
+}
+
+/********************************************************************************
+* debounce_update: Uppdaterar samtliga pinnars räknare med en ny avläsning.
+*                  Pinnar vars avläsning överensstämmer med avstudsat
+*                  tillstånd får sina räknare nollställda, övriga räknas upp.
+*                  När en räknare slår runt efter fyra avläsningar i följd
+*                  byter motsvarande pin tillstånd. Pinnar som bytt tillstånd
+*                  returneras, medan flankerna lagras i pressed och released.
+*
+*                  - self  : Referens till avstudsningen.
+*                  - sample: Ny avläsning, se DEBOUNCE_SAMPLE.
+********************************************************************************/
+static inline uint32_t debounce_update(struct debounce* self,
+                                       const uint32_t sample)
+{
+   const uint32_t delta = sample ^ self->state;
+   self->cnt1 = (self->cnt1 ^ self->cnt0) & delta;
+   self->cnt0 = ~self->cnt0 & delta;
+
+   const uint32_t toggle = delta & ~(self->cnt0 | self->cnt1);
+   self->state ^= toggle;
+   self->pressed = toggle & self->state;
+   self->released = toggle & ~self->state;
+   return toggle;
+}
+
+#endif /* DEBOUNCE_H_ */
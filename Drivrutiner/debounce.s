@@ -0,0 +1,120 @@
+/********************************************************************************
+* debounce.s: Innehåller drivrutiner för avstudsning av samtliga slide-
+*             switchar samt tryckknappar samtidigt via vertikala räknare,
+*             motsvarande debounce.h.
+*
+*             Varje bit i en 32-bitars insignal tilldelas en egen tvåbitars
+*             räknare, där räknarnas lägre respektive högre bitar lagras i
+*             varsitt ord. Samtliga pinnar uppdateras därmed med ett fåtal
+*             bitvisa instruktioner, oavsett antal pinnar. En pin byter
+*             avstudsat tillstånd först när fyra avläsningar i följd skiljer
+*             sig från aktuellt tillstånd.
+*
+*             Insignalerna packas i ett gemensamt ord via debounce_sample,
+*             där SW[9:0] placeras i bit 9 - 0 och inverterade KEY[3:0] i
+*             bit 13 - 10, så att en ettställd bit alltid indikerar nedtryckt
+*             tryckknapp respektive ettställd slide-switch.
+********************************************************************************/
+.ifndef DEBOUNCE_S_
+.equ DEBOUNCE_S_, 0
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ DEBOUNCE_PERIOD_MS    , 5      /* Rekommenderad tid mellan varje avläsning. */
+.equ DEBOUNCE_SWITCHES_MASK, 0x3FF  /* Bitar för SW[9:0] i packad insignal. */
+.equ DEBOUNCE_KEYS_SHIFT   , 10     /* Position för KEY[0] i packad insignal. */
+.equ DEBOUNCE_KEYS_MASK    , 0x3C00 /* Bitar för KEY[3:0] i packad insignal. */
+
+/********************************************************************************
+* Offsets för medlemmar av strukten debounce:
+********************************************************************************/
+.equ DEBOUNCE_CNT0_OFFSET    , 0  /* Offset för räknarnas lägre bitar. */
+.equ DEBOUNCE_CNT1_OFFSET    , 4  /* Offset för räknarnas högre bitar. */
+.equ DEBOUNCE_STATE_OFFSET   , 8  /* Offset för avstudsade insignaler. */
+.equ DEBOUNCE_PRESSED_OFFSET , 12 /* Offset för pinnar ettställda vid senaste uppdateringen. */
+.equ DEBOUNCE_RELEASED_OFFSET, 16 /* Offset för pinnar nollställda vid senaste uppdateringen. */
+.equ DEBOUNCE_SIZE           , 20 /* Storleken för ett avstudsningsobjekt i byte. */
+
+/********************************************************************************
+* debounce_sample: Packar insignaler från slide-switchar samt tryckknappar i
+*                  ett ord, som returneras via r2. Tryckknapparnas aktivt
+*                  låga insignaler inverteras.
+*
+*                  - r2: Insignaler från SWITCHES_BASE.
+*                  - r3: Insignaler från BUTTONS_BASE.
+********************************************************************************/
+debounce_sample:
+   addi sp, sp, -4                     /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 0(sp)                       /* Sparar undan innehållet i r3 inför användning. */
+   andi r2, r2, DEBOUNCE_SWITCHES_MASK /* Behåller enbart SW[9:0]. */
+   nor r3, r3, r3                      /* Inverterar tryckknapparnas insignaler. */
+   andi r3, r3, 0xF                    /* Behåller enbart KEY[3:0]. */
+   slli r3, r3, DEBOUNCE_KEYS_SHIFT    /* Placerar KEY[3:0] i bit 13 - 10. */
+   or r2, r2, r3                       /* Slår ihop insignalerna i r2. */
+   ldw r3, 0(sp)                       /* Återställer r3 efter användning. */
+   addi sp, sp, 4                      /* Återställer stackpekaren. */
+   ret                                 /* Genomför återhopp. */
+
+/********************************************************************************
+* debounce_init: Initierar avstudsningen med angivna insignaler som
+*                avstudsat starttillstånd.
+*
+*                - r2: Referens till avstudsningen.
+*                - r3: Insignaler vid start, se debounce_sample.
+********************************************************************************/
+debounce_init:
+   stw zero, DEBOUNCE_CNT0_OFFSET(r2)     /* Nollställer räknarnas lägre bitar. */
+   stw zero, DEBOUNCE_CNT1_OFFSET(r2)     /* Nollställer räknarnas högre bitar. */
+   stw r3, DEBOUNCE_STATE_OFFSET(r2)      /* Lagrar insignalerna som avstudsat tillstånd. */
+   stw zero, DEBOUNCE_PRESSED_OFFSET(r2)  /* Nollställer ettställda pinnar. */
+   stw zero, DEBOUNCE_RELEASED_OFFSET(r2) /* Nollställer nollställda pinnar. */
+   ret                                    /* Genomför återhopp. */
+
+/********************************************************************************
+* debounce_update: Uppdaterar samtliga pinnars räknare med en ny avläsning.
+*                  Pinnar vars avläsning överensstämmer med avstudsat
+*                  tillstånd får sina räknare nollställda, övriga räknas upp.
+*                  När en räknare slår runt efter fyra avläsningar i följd
+*                  byter motsvarande pin tillstånd. Pinnar som bytt tillstånd
+*                  returneras via r2, medan flankerna lagras i strukten.
+*
+*                  - r2: Referens till avstudsningen.
+*                  - r3: Ny avläsning, se debounce_sample.
+********************************************************************************/
+debounce_update:
+   addi sp, sp, -20                     /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 16(sp)                       /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 12(sp)                       /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 8(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 4(sp)                        /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 0(sp)                        /* Sparar undan innehållet i r7 inför användning. */
+   ldw r4, DEBOUNCE_STATE_OFFSET(r2)    /* Läser in avstudsat tillstånd i r4. */
+   xor r3, r3, r4                       /* Pinnar som skiljer sig från tillståndet (delta). */
+   ldw r5, DEBOUNCE_CNT0_OFFSET(r2)     /* Läser in räknarnas lägre bitar i r5. */
+   ldw r6, DEBOUNCE_CNT1_OFFSET(r2)     /* Läser in räknarnas högre bitar i r6. */
+   xor r6, r6, r5                       /* Räknar upp högre bitar (cnt1 ^ cnt0), */
+   and r6, r6, r3                       /* nollställda för oförändrade pinnar. */
+   nor r5, r5, r5                       /* Räknar upp lägre bitar (~cnt0), */
+   and r5, r5, r3                       /* nollställda för oförändrade pinnar. */
+   stw r5, DEBOUNCE_CNT0_OFFSET(r2)     /* Skriver tillbaka räknarnas lägre bitar. */
+   stw r6, DEBOUNCE_CNT1_OFFSET(r2)     /* Skriver tillbaka räknarnas högre bitar. */
+   or r5, r5, r6                        /* Räknare som inte har slagit runt. */
+   nor r5, r5, r5                       /* Räknare som har slagit runt, */
+   and r3, r3, r5                       /* begränsat till ändrade pinnar (toggle). */
+   xor r4, r4, r3                       /* Byter tillstånd för dessa pinnar. */
+   stw r4, DEBOUNCE_STATE_OFFSET(r2)    /* Skriver tillbaka avstudsat tillstånd. */
+   and r7, r3, r4                       /* Pinnar som har ettställts. */
+   stw r7, DEBOUNCE_PRESSED_OFFSET(r2)  /* Lagrar ettställda pinnar. */
+   xor r7, r3, r7                       /* Pinnar som har nollställts. */
+   stw r7, DEBOUNCE_RELEASED_OFFSET(r2) /* Lagrar nollställda pinnar. */
+   mov r2, r3                           /* Returnerar pinnar som har bytt tillstånd. */
+   ldw r7, 0(sp)                        /* Återställer r7 efter användning. */
+   ldw r6, 4(sp)                        /* Återställer r6 efter användning. */
+   ldw r5, 8(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 12(sp)                       /* Återställer r4 efter användning. */
+   ldw r3, 16(sp)                       /* Återställer r3 efter användning. */
+   addi sp, sp, 20                      /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+.endif /* DEBOUNCE_S_ */
@@ -0,0 +1,126 @@
+/********************************************************************************
+* gpio_macro.s: Innehåller makron för läsning samt skrivning av GPIO-enheter
+*               i form av lysdioder, slide-switchar samt tryckknappar.
+*               Makrona expanderas direkt på plats, så att inga anrop sker
+*               och inga register sparas på stacken. PIO-enhetens basadress
+*               lagras i ett register, som laddas en gång via GPIO_LOAD_BASE
+*               innan exempelvis en pollingloop startas.
+*
+*               Pin-nummer anges som konstanter (0 - 15), så att bitmasker
+*               kan kodas som omedelbara operander. Samtliga register anges
+*               av anroparen, vilket innebär att makrona kan användas i
+*               samtliga lektioners assemblerprogram oavsett registerval.
+*               Makrona förutsätter att PIO-enhetens dataregister ligger på
+*               offset 0 relativt basadressen.
+********************************************************************************/
+.ifndef GPIO_MACRO_S_
+.equ GPIO_MACRO_S_, 0
+
+/********************************************************************************
+* GPIO_LOAD_BASE: Läser in angiven basadress i angivet register.
+*
+*                 - reg : Registret som basadressen ska lagras i.
+*                 - addr: Basadressen, exempelvis LEDS_BASE.
+********************************************************************************/
+.macro GPIO_LOAD_BASE reg, addr
+   movhi \reg, %hiadj(\addr)   /* Läser in basadressens högre bitar. */
+   addi \reg, \reg, %lo(\addr) /* Lägger till basadressens lägre bitar. */
+.endm
+
+/********************************************************************************
+* GPIO_READ: Läser insignalen från angiven pin, där 1 lagras i dst vid hög
+*            insignal, annars 0.
+*
+*            - dst : Registret som insignalen ska lagras i.
+*            - base: Register innehållande PIO-enhetens basadress.
+*            - pin : Pin-numret (0 - 15).
+********************************************************************************/
+.macro GPIO_READ dst, base, pin
+   ldwio \dst, 0(\base)  /* Läser av PIO-enhetens insignaler. */
+   srli \dst, \dst, \pin /* Skiftar ned angiven pin till bit 0. */
+   andi \dst, \dst, 1    /* Behåller enbart insignalen från angiven pin. */
+.endm
+
+/********************************************************************************
+* GPIO_WRITE_MASK: Skriver utsignaler till samtliga pinnar i angiven bitmask
+*                  utan hopp, där val innehåller de nya utsignalerna på
+*                  respektive pins position (övriga bitar måste vara 0).
+*                  Pinnarna nollställs först via andi, varefter de nya
+*                  utsignalerna läggs till via or. Övriga pinnar lämnas
+*                  opåverkade, förutsatt att PIO-enheten har högst 16 bitar.
+*
+*                  - base: Register innehållande PIO-enhetens basadress.
+*                  - mask: Bitmask för pinnarna som skrivs (0 - 0xFFFF).
+*                  - val : Register innehållande de nya utsignalerna.
+*                  - tmp : Register som används temporärt (skrivs över).
+********************************************************************************/
+.macro GPIO_WRITE_MASK base, mask, val, tmp
+   ldwio \tmp, 0(\base)              /* Läser in PIO-enhetens aktuella utsignaler. */
+   andi \tmp, \tmp, 0xFFFF ^ (\mask) /* Nollställer pinnarna i bitmasken. */
+   or \tmp, \tmp, \val               /* Lägger till de nya utsignalerna. */
+   stwio \tmp, 0(\base)              /* Skriver nya utsignaler till PIO-enheten. */
+.endm
+
+/********************************************************************************
+* GPIO_WRITE: Skriver utsignal till angiven pin utan hopp, där val måste vara
+*             0 (låg) eller 1 (hög), exempelvis resultatet av GPIO_READ eller
+*             BUTTON_PRESSED. För pin 1 - 15 skiftas val till pinnens
+*             position och skrivs därmed över. Övriga pinnar lämnas
+*             opåverkade, se GPIO_WRITE_MASK.
+*
+*             - base: Register innehållande PIO-enhetens basadress.
+*             - pin : Pin-numret (0 - 15).
+*             - val : Register innehållande värdet som ska skrivas (0 eller 1).
+*             - tmp : Register som används temporärt (skrivs över).
+********************************************************************************/
+.macro GPIO_WRITE base, pin, val, tmp
+.if \pin
+   slli \val, \val, \pin                        /* Skiftar upp värdet till angiven pin. */
+.endif
+   GPIO_WRITE_MASK \base, 1 << \pin, \val, \tmp /* Skriver värdet till angiven pin utan hopp. */
+.endm
+
+/********************************************************************************
+* LED_ON: Tänder lysdiod ansluten till angiven pin.
+*
+*         - base: Register innehållande lysdiodernas basadress.
+*         - pin : Pin-numret (0 - 15).
+*         - tmp : Register som används temporärt (skrivs över).
+********************************************************************************/
+.macro LED_ON base, pin, tmp
+   ldwio \tmp, 0(\base)      /* Läser in lysdiodernas aktuella utsignaler. */
+   ori \tmp, \tmp, 1 << \pin /* Tänder angiven lysdiod. */
+   stwio \tmp, 0(\base)      /* Skriver nya utsignaler till lysdioderna. */
+.endm
+
+/********************************************************************************
+* LED_OFF: Släcker lysdiod ansluten till angiven pin. Övriga lysdioder lämnas
+*          opåverkade, förutsatt att PIO-enheten har högst 16 bitar.
+*
+*          - base: Register innehållande lysdiodernas basadress.
+*          - pin : Pin-numret (0 - 15).
+*          - tmp : Register som används temporärt (skrivs över).
+********************************************************************************/
+.macro LED_OFF base, pin, tmp
+   ldwio \tmp, 0(\base)                  /* Läser in lysdiodernas aktuella utsignaler. */
+   andi \tmp, \tmp, 0xFFFF ^ (1 << \pin) /* Släcker angiven lysdiod. */
+   stwio \tmp, 0(\base)                  /* Skriver nya utsignaler till lysdioderna. */
+.endm
+
+/********************************************************************************
+* BUTTON_PRESSED: Indikerar ifall tryckknapp ansluten till angiven pin är
+*                 nedtryckt, där 1 lagras i dst vid nedtryckning, annars 0.
+*                 Tryckknapparna är aktivt låga, så insignalen inverteras.
+*
+*                 - dst : Registret som resultatet ska lagras i.
+*                 - base: Register innehållande tryckknapparnas basadress.
+*                 - pin : Pin-numret (0 - 15).
+********************************************************************************/
+.macro BUTTON_PRESSED dst, base, pin
+   ldwio \dst, 0(\base)  /* Läser av tryckknapparnas insignaler. */
+   srli \dst, \dst, \pin /* Skiftar ned angiven pin till bit 0. */
+   andi \dst, \dst, 1    /* Behåller enbart insignalen från angiven pin. */
+   xori \dst, \dst, 1    /* Inverterar insignalen, 1 indikerar nedtryckning. */
+.endm
+
+.endif /* GPIO_MACRO_S_ */
@@ -0,0 +1,220 @@
+/********************************************************************************
+* irq.h: Innehåller drivrutiner för hårdvaruavbrott via Nios II-processorns
+*        kontrollregister status, ienable samt ipending. Avbrottsrutiner
+*        registreras per avbrottsnummer och anropas från en gemensam
+*        undantagshanterare placerad i sektionen .exceptions.
+*
+*        Vid kompilering för Linux (gcc -DNIOS2_HOST) ersätts kontroll-
+*        registren av variabler och avbrott genereras via irq_host_raise.
+********************************************************************************/
+#ifndef IRQ_H_
+#define IRQ_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define IRQ_MAX          32 /* Antalet avbrottsnummer som stöds av processorn. */
+#define IRQ_CTL_STATUS   0  /* Kontrollregister status (bit 0 = PIE). */
+#define IRQ_CTL_IENABLE  3  /* Kontrollregister ienable (aktiverade avbrott). */
+#define IRQ_CTL_IPENDING 4  /* Kontrollregister ipending (väntande avbrott). */
+
+/********************************************************************************
+* Läsning och skrivning av kontrollregister. Vid kompilering för Linux
+* används en array som ersättning för processorns kontrollregister.
+********************************************************************************/
+#ifdef NIOS2_HOST
+static uint32_t irq_host_ctl[IRQ_CTL_IPENDING + 1]; /* Ersättning för kontrollregistren. */
+#define IRQ_RDCTL(reg)      (irq_host_ctl[reg])
+#define IRQ_WRCTL(reg, val) (irq_host_ctl[reg] = (val))
+#else
+#define IRQ_RDCTL(reg)      ((uint32_t)__builtin_rdctl(reg))
+#define IRQ_WRCTL(reg, val) (__builtin_wrctl(reg, (int)(val)))
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* irq_handlers: Registrerade avbrottsrutiner, där index motsvarar
+*               avbrottsnumret. Ej registrerade avbrott har värdet NULL.
+********************************************************************************/
+static void (*irq_handlers[IRQ_MAX])(void);
+
+/********************************************************************************
+* irq_dispatch: Anropar registrerad avbrottsrutin för samtliga väntande
+*               och aktiverade avbrott, med lägst avbrottsnummer först.
+*               Anropas från undantagshanteraren i sektionen .exceptions.
+********************************************************************************/
+static void __attribute__((used)) irq_dispatch(void)
+{
+   uint32_t pending = IRQ_RDCTL(IRQ_CTL_IPENDING) & IRQ_RDCTL(IRQ_CTL_IENABLE);
+
+   for (uint8_t i = 0; pending; ++i, pending >>= 1)
+   {
+      if ((pending & 1) && irq_handlers[i])
+      {
+         irq_handlers[i]();
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* irq_enable: Aktiverar avbrott med angivet avbrottsnummer i ienable.
+*
+*             - irq: Avbrottsnumret (0 - 31).
+********************************************************************************/
+static inline void irq_enable(const uint8_t irq)
+{
+   if (irq < IRQ_MAX)
+   {
+      IRQ_WRCTL(IRQ_CTL_IENABLE, IRQ_RDCTL(IRQ_CTL_IENABLE) | (1UL << irq));
+   }
+   return;
+}
+
+/********************************************************************************
+* irq_disable: Inaktiverar avbrott med angivet avbrottsnummer i ienable.
+*
+*              - irq: Avbrottsnumret (0 - 31).
+********************************************************************************/
+static inline void irq_disable(const uint8_t irq)
+{
+   if (irq < IRQ_MAX)
+   {
+      IRQ_WRCTL(IRQ_CTL_IENABLE, IRQ_RDCTL(IRQ_CTL_IENABLE) & ~(1UL << irq));
+   }
+   return;
+}
+
+/********************************************************************************
+* irq_register: Registrerar avbrottsrutin för angivet avbrottsnummer och
+*               aktiverar avbrottet. Vid fel returneras felkod 1, annars 0.
+*
+*               - irq    : Avbrottsnumret (0 - 31).
+*               - handler: Avbrottsrutinen som ska anropas vid avbrott.
+********************************************************************************/
+static inline int irq_register(const uint8_t irq,
+                               void (*handler)(void))
+{
+   if (irq >= IRQ_MAX || !handler) return 1;
+   irq_handlers[irq] = handler;
+   irq_enable(irq);
+   return 0;
+}
+
+/********************************************************************************
+* irq_global_enable: Aktiverar avbrott globalt genom att ettställa biten
+*                    PIE i kontrollregistret status.
+********************************************************************************/
+static inline void irq_global_enable(void)
+{
+   IRQ_WRCTL(IRQ_CTL_STATUS, IRQ_RDCTL(IRQ_CTL_STATUS) | 1);
+   return;
+}
+
+/********************************************************************************
+* irq_global_disable: Inaktiverar avbrott globalt genom att nollställa biten
+*                     PIE i kontrollregistret status.
+********************************************************************************/
+static inline void irq_global_disable(void)
+{
+   IRQ_WRCTL(IRQ_CTL_STATUS, IRQ_RDCTL(IRQ_CTL_STATUS) & ~1UL);
+   return;
+}
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* irq_host_raise: Sätter eller nollställer angiven avbrottssignal och
+*                 anropar registrerad avbrottsrutin ifall avbrottet är
+*                 aktiverat, på samma sätt som processorn vid hårdvaruavbrott.
+*
+*                 - irq  : Avbrottsnumret (0 - 31).
+*                 - level: Avbrottssignalens nivå (true = aktiv).
+********************************************************************************/
+static inline void irq_host_raise(const uint8_t irq,
+                                  const bool level)
+{
+   if (irq >= IRQ_MAX) return;
+
+   if (level)
+   {
+      irq_host_ctl[IRQ_CTL_IPENDING] |= 1UL << irq;
+   }
+   else
+   {
+      irq_host_ctl[IRQ_CTL_IPENDING] &= ~(1UL << irq);
+   }
+
+   if ((irq_host_ctl[IRQ_CTL_STATUS] & 1) &&
+       (irq_host_ctl[IRQ_CTL_IPENDING] & irq_host_ctl[IRQ_CTL_IENABLE]))
+   {
+      irq_host_ctl[IRQ_CTL_STATUS] &= ~1UL;
+      irq_dispatch();
+      irq_host_ctl[IRQ_CTL_STATUS] |= 1;
+   }
+   return;
+}
+#else
+/********************************************************************************
+* irq_exception_entry: Undantagshanterare placerad i sektionen .exceptions.
+*                      Vid hårdvaruavbrott räknas ea ned en instruktion så
+*                      att den avbrutna instruktionen exekveras vid återhopp.
+*                      Anroparsparade register r1 - r15 samt ra sparas på
+*                      stacken innan irq_dispatch anropas. Vid mjukvaru-
+*                      undantag (trap) sker återhopp direkt.
+********************************************************************************/
+__asm__(
+   ".section .exceptions, \"ax\"\n"
+   "irq_exception_entry:\n"
+   "   rdctl et, ipending\n"
+   "   beq et, zero, irq_exception_end\n"
+   "   subi ea, ea, 4\n"
+   "   addi sp, sp, -64\n"
+   "   .set noat\n"
+   "   stw r1, 0(sp)\n"
+   "   .set at\n"
+   "   stw r2, 4(sp)\n"
+   "   stw r3, 8(sp)\n"
+   "   stw r4, 12(sp)\n"
+   "   stw r5, 16(sp)\n"
+   "   stw r6, 20(sp)\n"
+   "   stw r7, 24(sp)\n"
+   "   stw r8, 28(sp)\n"
+   "   stw r9, 32(sp)\n"
+   "   stw r10, 36(sp)\n"
+   "   stw r11, 40(sp)\n"
+   "   stw r12, 44(sp)\n"
+   "   stw r13, 48(sp)\n"
+   "   stw r14, 52(sp)\n"
+   "   stw r15, 56(sp)\n"
+   "   stw ra, 60(sp)\n"
+   "   call irq_dispatch\n"
+   "   .set noat\n"
+   "   ldw r1, 0(sp)\n"
+   "   .set at\n"
+   "   ldw r2, 4(sp)\n"
+   "   ldw r3, 8(sp)\n"
+   "   ldw r4, 12(sp)\n"
+   "   ldw r5, 16(sp)\n"
+   "   ldw r6, 20(sp)\n"
+   "   ldw r7, 24(sp)\n"
+   "   ldw r8, 28(sp)\n"
+   "   ldw r9, 32(sp)\n"
+   "   ldw r10, 36(sp)\n"
+   "   ldw r11, 40(sp)\n"
+   "   ldw r12, 44(sp)\n"
+   "   ldw r13, 48(sp)\n"
+   "   ldw r14, 52(sp)\n"
+   "   ldw r15, 56(sp)\n"
+   "   ldw ra, 60(sp)\n"
+   "   addi sp, sp, 64\n"
+   "irq_exception_end:\n"
+   "   eret\n"
+   ".previous\n");
+#endif /* NIOS2_HOST */
+
+#endif /* IRQ_H_ */
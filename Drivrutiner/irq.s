@@ -0,0 +1,198 @@
+/********************************************************************************
+* irq.s: Innehåller drivrutiner för hårdvaruavbrott via Nios II-processorns
+*        kontrollregister status, ienable samt ipending. Avbrottsrutiner
+*        registreras per avbrottsnummer i tabellen irq_handlers och anropas
+*        från en gemensam undantagshanterare placerad i sektionen .exceptions.
+*
+*        Registrerade avbrottsrutiner anropas som vanliga subrutiner och
+*        avslutas med ret. Anroparsparade register r1 - r15 sparas av
+*        undantagshanteraren innan anrop sker.
+********************************************************************************/
+.ifndef IRQ_S_
+.equ IRQ_S_, 0
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ IRQ_MAX, 32 /* Antalet avbrottsnummer som stöds av processorn. */
+
+/********************************************************************************
+* .exceptions: Sektion för undantagshanteraren, placeras på adress 0x20.
+********************************************************************************/
+.section .exceptions, "ax"
+
+/********************************************************************************
+* irq_exception_entry: Undantagshanterare som anropas vid samtliga undantag.
+*                      Vid hårdvaruavbrott räknas ea ned en instruktion så att
+*                      den avbrutna instruktionen exekveras vid återhopp.
+*                      Register r1 - r15 samt ra sparas på stacken innan
+*                      irq_dispatch anropas. Vid mjukvaruundantag (trap) sker
+*                      återhopp direkt.
+********************************************************************************/
+irq_exception_entry:
+   rdctl et, ipending               /* Läser in väntande avbrott i et. */
+   beq et, zero, irq_exception_end  /* Om inga avbrott väntar sker återhopp direkt. */
+   subi ea, ea, 4                   /* Exekverar den avbrutna instruktionen vid återhopp. */
+   addi sp, sp, -64                 /* Allokerar minne för sparade register på stacken. */
+   .set noat                        /* Tillåter användning av r1 utan varning. */
+   stw r1, 0(sp)                    /* Sparar undan innehållet i r1. */
+   .set at                          /* Återställer varning vid användning av r1. */
+   stw r2, 4(sp)                    /* Sparar undan innehållet i r2. */
+   stw r3, 8(sp)                    /* Sparar undan innehållet i r3. */
+   stw r4, 12(sp)                   /* Sparar undan innehållet i r4. */
+   stw r5, 16(sp)                   /* Sparar undan innehållet i r5. */
+   stw r6, 20(sp)                   /* Sparar undan innehållet i r6. */
+   stw r7, 24(sp)                   /* Sparar undan innehållet i r7. */
+   stw r8, 28(sp)                   /* Sparar undan innehållet i r8. */
+   stw r9, 32(sp)                   /* Sparar undan innehållet i r9. */
+   stw r10, 36(sp)                  /* Sparar undan innehållet i r10. */
+   stw r11, 40(sp)                  /* Sparar undan innehållet i r11. */
+   stw r12, 44(sp)                  /* Sparar undan innehållet i r12. */
+   stw r13, 48(sp)                  /* Sparar undan innehållet i r13. */
+   stw r14, 52(sp)                  /* Sparar undan innehållet i r14. */
+   stw r15, 56(sp)                  /* Sparar undan innehållet i r15. */
+   stw ra, 60(sp)                   /* Sparar undan återhoppsadressen i ra. */
+   call irq_dispatch                /* Anropar registrerade avbrottsrutiner. */
+   .set noat                        /* Tillåter användning av r1 utan varning. */
+   ldw r1, 0(sp)                    /* Återställer r1. */
+   .set at                          /* Återställer varning vid användning av r1. */
+   ldw r2, 4(sp)                    /* Återställer r2. */
+   ldw r3, 8(sp)                    /* Återställer r3. */
+   ldw r4, 12(sp)                   /* Återställer r4. */
+   ldw r5, 16(sp)                   /* Återställer r5. */
+   ldw r6, 20(sp)                   /* Återställer r6. */
+   ldw r7, 24(sp)                   /* Återställer r7. */
+   ldw r8, 28(sp)                   /* Återställer r8. */
+   ldw r9, 32(sp)                   /* Återställer r9. */
+   ldw r10, 36(sp)                  /* Återställer r10. */
+   ldw r11, 40(sp)                  /* Återställer r11. */
+   ldw r12, 44(sp)                  /* Återställer r12. */
+   ldw r13, 48(sp)                  /* Återställer r13. */
+   ldw r14, 52(sp)                  /* Återställer r14. */
+   ldw r15, 56(sp)                  /* Återställer r15. */
+   ldw ra, 60(sp)                   /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 64                  /* Återställer stackpekaren. */
+irq_exception_end:
+   eret                             /* Återhopp till den avbrutna instruktionen. */
+
+/********************************************************************************
+* .text: Kodsegment, lagringsplats för programkoden.
+********************************************************************************/
+.text
+
+/********************************************************************************
+* irq_dispatch: Anropar registrerad avbrottsrutin för samtliga väntande och
+*               aktiverade avbrott, med lägst avbrottsnummer först.
+********************************************************************************/
+irq_dispatch:
+   addi sp, sp, -12                     /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 8(sp)                        /* Sparar undan återhoppsadressen i ra. */
+   stw r16, 4(sp)                       /* Sparar undan innehållet i r16 inför användning. */
+   stw r17, 0(sp)                       /* Sparar undan innehållet i r17 inför användning. */
+   rdctl r16, ipending                  /* Läser in väntande avbrott i r16. */
+   rdctl r2, ienable                    /* Läser in aktiverade avbrott i r2. */
+   and r16, r16, r2                     /* Behåller enbart aktiverade avbrott. */
+   movhi r17, %hiadj(irq_handlers)      /* Läser in adressen till irq_handlers[0] i r17. */
+   addi r17, r17, %lo(irq_handlers)     /* Adressen räknas upp ett element per varv. */
+irq_dispatch_loop:
+   beq r16, zero, irq_dispatch_end      /* Avslutar när samtliga avbrott har hanterats. */
+   andi r2, r16, 1                      /* Kontrollerar ifall aktuellt avbrott väntar. */
+   beq r2, zero, irq_dispatch_next      /* Om inte fortsätter loopen med nästa avbrott. */
+   ldw r2, 0(r17)                       /* Laddar adressen till registrerad avbrottsrutin. */
+   beq r2, zero, irq_dispatch_next      /* Saknas avbrottsrutin ignoreras avbrottet. */
+   callr r2                             /* Anropar registrerad avbrottsrutin. */
+irq_dispatch_next:
+   srli r16, r16, 1                     /* Skiftar fram nästa avbrott till bit 0. */
+   addi r17, r17, 4                     /* Pekar på nästa element i irq_handlers. */
+   br irq_dispatch_loop                 /* Återstartar loopen. */
+irq_dispatch_end:
+   ldw r17, 0(sp)                       /* Återställer r17 efter användning. */
+   ldw r16, 4(sp)                       /* Återställer r16 efter användning. */
+   ldw ra, 8(sp)                        /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 12                      /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* irq_register: Registrerar avbrottsrutin för angivet avbrottsnummer och
+*               aktiverar avbrottet i ienable. Vid fel returneras felkod 1
+*               via r2, annars 0.
+*
+*               - r2: Avbrottsnumret (0 - 31).
+*               - r3: Adressen till avbrottsrutinen.
+********************************************************************************/
+irq_register:
+   addi sp, sp, -8                      /* Allokerar minne för lokala variabler på stacken. */
+   stw r4, 4(sp)                        /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 0(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   movi r4, IRQ_MAX                     /* Läser in maximalt antal avbrott i r4. */
+   bgeu r2, r4, irq_register_error      /* Vid ogiltigt avbrottsnummer returneras 1. */
+   beq r3, zero, irq_register_error     /* Vid saknad avbrottsrutin returneras 1. */
+   slli r4, r2, 2                       /* Beräknar offset för avbrottsnumret i tabellen. */
+   movhi r5, %hiadj(irq_handlers)       /* Läser in adressen till irq_handlers i r5. */
+   addi r5, r5, %lo(irq_handlers)       /* Lägger till adressens lägre bitar i r5. */
+   add r5, r5, r4                       /* Pekar på elementet för angivet avbrottsnummer. */
+   stw r3, 0(r5)                        /* Lagrar avbrottsrutinens adress i tabellen. */
+   movi r4, 1                           /* Läser in 0x01 i r4 för bitvis skiftning. */
+   sll r4, r4, r2                       /* Skiftar fram biten för angivet avbrottsnummer. */
+   rdctl r5, ienable                    /* Läser in aktiverade avbrott i r5. */
+   or r5, r5, r4                        /* Aktiverar angivet avbrott. */
+   wrctl ienable, r5                    /* Skriver tillbaka aktiverade avbrott. */
+   movi r2, 0                           /* Lagrar returkod 0 i r2. */
+   br irq_register_end                  /* Återställer stacken och avslutar subrutinen. */
+irq_register_error:
+   movi r2, 1                           /* Lagrar returkod 1 i r2. */
+irq_register_end:
+   ldw r5, 0(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 4(sp)                        /* Återställer r4 efter användning. */
+   addi sp, sp, 8                       /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* irq_global_enable: Aktiverar avbrott globalt genom att ettställa biten
+*                    PIE i kontrollregistret status.
+********************************************************************************/
+irq_global_enable:
+   addi sp, sp, -4                      /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 0(sp)                        /* Sparar undan innehållet i r2 inför användning. */
+   rdctl r2, status                     /* Läser in kontrollregistret status i r2. */
+   ori r2, r2, 1                        /* Ettställer biten PIE. */
+   wrctl status, r2                     /* Skriver tillbaka kontrollregistret status. */
+   ldw r2, 0(sp)                        /* Återställer r2 efter användning. */
+   addi sp, sp, 4                       /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* irq_global_disable: Inaktiverar avbrott globalt genom att nollställa biten
+*                     PIE i kontrollregistret status.
+********************************************************************************/
+irq_global_disable:
+   addi sp, sp, -8                      /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 4(sp)                        /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 0(sp)                        /* Sparar undan innehållet i r3 inför användning. */
+   rdctl r2, status                     /* Läser in kontrollregistret status i r2. */
+   movi r3, -2                          /* Läser in mask med samtliga bitar utom PIE i r3. */
+   and r2, r2, r3                       /* Nollställer biten PIE. */
+   wrctl status, r2                     /* Skriver tillbaka kontrollregistret status. */
+   ldw r3, 0(sp)                        /* Återställer r3 efter användning. */
+   ldw r2, 4(sp)                        /* Återställer r2 efter användning. */
+   addi sp, sp, 8                       /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats för initierade variabler.
+********************************************************************************/
+.data
+
+/********************************************************************************
+* irq_handlers: Adresser till registrerade avbrottsrutiner, där index motsvarar
+*               avbrottsnumret. Ej registrerade avbrott har värdet 0.
+********************************************************************************/
+irq_handlers:
+   .skip IRQ_MAX * 4                    /* Reserverar ett ord per avbrottsnummer. */
+
+/********************************************************************************
+* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+
+.endif /* IRQ_S_ */
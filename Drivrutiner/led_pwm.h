@@ -0,0 +1,175 @@
+/********************************************************************************
+* led_pwm.h: Innehåller drivrutiner för ljusstyrka på lysdioderna LED[9:0] via
+*            binär kodmodulering (BCM), där intervalltimerns avbrott driver
+*            utsignalerna i stället för processorn.
+*
+*            Varje lysdiod tilldelas en ljusstyrka 0 - 255 via
+*            led_set_brightness. Ljusstyrkorna lagras som åtta bitplan, där
+*            bitplan k innehåller bit k av samtliga lysdioders ljusstyrka.
+*            Varje period (frame) visas bitplanen i tur och ordning, där
+*            bitplan k hålls tänt i LED_PWM_UNIT_TICKS << k klockpulser.
+*            Därmed krävs endast åtta avbrott per period, med en enda
+*            skrivning till LEDS_BASE per avbrott oavsett antal lysdioder.
+*            Vid ljusstyrkan 255 lyser en lysdiod hela perioden, vid 0 inte
+*            alls.
+*
+*            Intervalltimern används i engångsläge med avbrott, så att
+*            varje bitplan får en egen period. Timern ägs därmed av
+*            led_pwm_isr (se timer_claim i timer.h), och tid mäts i stället
+*            i antal perioder via led_pwm_frames.
+*
+*            Basadressen för lysdioderna väljs via makrot GPIO_CASE_GOLD_HW,
+*            som därmed måste definieras innan led_pwm.h inkluderas. Vid
+*            kompilering för Linux (gcc -DNIOS2_HOST) ersätts lysdioderna av
+*            en variabel och avbrott genereras via irq_host_raise.
+********************************************************************************/
+#ifndef LED_PWM_H_
+#define LED_PWM_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include "irq.h"
+#include "timer.h"
+
+/********************************************************************************
+* Basadress för lysdioderna:
+********************************************************************************/
+#if defined(NIOS2_HOST)
+static volatile uint32_t led_pwm_host_leds;                /* Ersättning för lysdioderna. */
+#define LED_PWM_LEDS_BASE (&led_pwm_host_leds)             /* Basadress för lysdioder. */
+#elif defined(GPIO_CASE_GOLD_HW)
+#define LED_PWM_LEDS_BASE (volatile uint32_t*)(0x8091740)  /* Basadress för lysdioder. */
+#else
+#define LED_PWM_LEDS_BASE (volatile uint32_t*)(0xFF200000) /* Basadress för lysdioder. */
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define LED_PWM_COUNT       10                         /* Antalet lysdioder, LED[9:0]. */
+#define LED_PWM_PLANES      8                          /* Antalet bitplan, ger 256 nivåer av ljusstyrka. */
+#define LED_PWM_UNIT_TICKS  500                        /* Längd för bitplan 0 i klockpulser (10 us). */
+#define LED_PWM_FRAME_TICKS (LED_PWM_UNIT_TICKS * 255) /* Periodens längd i klockpulser (2,55 ms). */
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static volatile uint32_t led_pwm_planes[LED_PWM_PLANES]; /* Bitplan, ett ord per bit av ljusstyrkan. */
+static volatile uint8_t led_pwm_plane;                   /* Index för bitplanet som visas. */
+static volatile uint32_t led_pwm_frame_count;            /* Antal genomförda perioder. */
+
+/********************************************************************************
+* led_pwm_start_plane: Skriver angivet bitplan till lysdioderna och startar
+*                      intervalltimern i engångsläge med avbrott efter
+*                      LED_PWM_UNIT_TICKS << plane klockpulser.
+*
+*                      - plane: Index för bitplanet som ska visas (0 - 7).
+********************************************************************************/
+static inline void led_pwm_start_plane(const uint8_t plane)
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   const uint32_t period = ((uint32_t)LED_PWM_UNIT_TICKS << plane) - 1;
+   *LED_PWM_LEDS_BASE = led_pwm_planes[plane];
+   timer[TIMER_STATUS_REG] = 0;
+   timer[TIMER_PERIODL_REG] = period & 0xFFFF;
+   timer[TIMER_PERIODH_REG] = period >> 16;
+   timer[TIMER_CONTROL_REG] = TIMER_CONTROL_ITO | TIMER_CONTROL_START;
+   return;
+}
+
+/********************************************************************************
+* led_pwm_isr: Avbrottsrutin för intervalltimern. Nästa bitplan skrivs till
+*              lysdioderna och timern startas om med bitplanets längd.
+*              Efter sista bitplanet räknas antalet perioder upp.
+********************************************************************************/
+static void led_pwm_isr(void)
+{
+   const uint8_t plane = (led_pwm_plane + 1) & (LED_PWM_PLANES - 1);
+   led_pwm_plane = plane;
+   if (plane == 0) led_pwm_frame_count++;
+   led_pwm_start_plane(plane);
+   return;
+}
+
+/********************************************************************************
+* led_pwm_init: Släcker samtliga lysdioder, registrerar avbrottsrutinen för
+*               intervalltimern och startar visning av första bitplanet.
+*               Ägs intervalltimern redan av en annan drivrutin returneras
+*               felkod 1 utan att timern påverkas, annars 0. Avbrott måste
+*               därefter aktiveras globalt via irq_global_enable.
+********************************************************************************/
+static inline int led_pwm_init(void)
+{
+   if (timer_claim(led_pwm_isr)) return 1;
+
+   for (uint8_t i = 0; i < LED_PWM_PLANES; ++i)
+   {
+      led_pwm_planes[i] = 0;
+   }
+   led_pwm_plane = 0;
+   led_pwm_frame_count = 0;
+   irq_register(TIMER_IRQ, led_pwm_isr);
+   led_pwm_start_plane(0);
+   return 0;
+}
+
+/********************************************************************************
+* led_set_brightness: Sätter ljusstyrkan för angiven lysdiod genom att
+*                     uppdatera lysdiodens bit i samtliga bitplan. Ny
+*                     ljusstyrka visas från och med nästa bitplan. Vid
+*                     ogiltigt pin-nummer returneras felkod 1, annars 0.
+*
+*                     - pin : Lysdiodens pin-nummer (0 - 9).
+*                     - duty: Ljusstyrkan (0 = släckt, 255 = fullt tänd).
+********************************************************************************/
+static inline int led_set_brightness(const uint8_t pin,
+                                     const uint8_t duty)
+{
+   if (pin >= LED_PWM_COUNT) return 1;
+   const uint32_t mask = 1UL << pin;
+
+   for (uint8_t i = 0; i < LED_PWM_PLANES; ++i)
+   {
+      if (duty & (1 << i))
+      {
+         led_pwm_planes[i] |= mask;
+      }
+      else
+      {
+         led_pwm_planes[i] &= ~mask;
+      }
+   }
+   return 0;
+}
+
+/********************************************************************************
+* led_get_brightness: Returnerar ljusstyrkan för angiven lysdiod, som
+*                     sammanställs från lysdiodens bit i samtliga bitplan.
+*
+*                     - pin: Lysdiodens pin-nummer (0 - 9).
+********************************************************************************/
+static inline uint8_t led_get_brightness(const uint8_t pin)
+{
+   uint8_t duty = 0;
+
+   for (uint8_t i = 0; i < LED_PWM_PLANES; ++i)
+   {
+      if (led_pwm_planes[i] & (1UL << pin)) duty |= 1 << i;
+   }
+   return duty;
+}
+
+/********************************************************************************
+* led_pwm_frames: Returnerar antalet genomförda perioder sedan start, vilket
+*                 kan användas som tidsbas då intervalltimern är upptagen.
+*                 En period motsvarar LED_PWM_FRAME_TICKS klockpulser plus
+*                 åtta avbrottslatenser.
+********************************************************************************/
+static inline uint32_t led_pwm_frames(void)
+{
+   return led_pwm_frame_count;
+}
+
+#endif /* LED_PWM_H_ */
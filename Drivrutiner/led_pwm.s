@@ -0,0 +1,234 @@
+/********************************************************************************
+* led_pwm.s: Innehåller drivrutiner för ljusstyrka på lysdioderna LED[9:0] via
+*            binär kodmodulering (BCM), motsvarande led_pwm.h.
+*
+*            Ljusstyrkorna 0 - 255 lagras som åtta bitplan, där bitplan k
+*            innehåller bit k av samtliga lysdioders ljusstyrka. Varje
+*            period visas bitplanen i tur och ordning från avbrottsrutinen
+*            led_pwm_isr, där bitplan k hålls tänt i
+*            LED_PWM_UNIT_TICKS << k klockpulser. Därmed krävs endast åtta
+*            avbrott per period med en skrivning till LEDS_BASE per avbrott.
+*
+*            Intervalltimern används i engångsläge med avbrott och ägs
+*            därmed av led_pwm_isr (se timer_claim i timer.s). Tid mäts i
+*            stället i antal perioder via led_pwm_frames.
+*
+*            Basadressen för lysdioderna väljs via symbolen GPIO_CASE_GOLD_HW,
+*            som därmed måste definieras innan led_pwm.s inkluderas. Avbrott
+*            måste aktiveras globalt via irq_global_enable efter
+*            led_pwm_init.
+********************************************************************************/
+.ifndef LED_PWM_S_
+.equ LED_PWM_S_, 0
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/irq.s"
+.include "../Drivrutiner/timer.s"
+
+/********************************************************************************
+* Basadress för lysdioderna:
+********************************************************************************/
+.ifdef GPIO_CASE_GOLD_HW
+.equ LED_PWM_LEDS_BASE, 0x8091740  /* Basadress för lysdioder (CASE GOLD). */
+.else
+.equ LED_PWM_LEDS_BASE, 0xFF200000 /* Basadress för lysdioder (simulering). */
+.endif /* GPIO_CASE_GOLD_HW */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ LED_PWM_COUNT     , 10  /* Antalet lysdioder, LED[9:0]. */
+.equ LED_PWM_PLANES    , 8   /* Antalet bitplan, ger 256 nivåer av ljusstyrka. */
+.equ LED_PWM_UNIT_TICKS, 500 /* Längd för bitplan 0 i klockpulser (10 us). */
+
+/********************************************************************************
+* led_pwm_start_plane: Skriver angivet bitplan till lysdioderna och startar
+*                      intervalltimern i engångsläge med avbrott efter
+*                      LED_PWM_UNIT_TICKS << r2 klockpulser.
+*
+*                      - r2: Index för bitplanet som ska visas (0 - 7).
+********************************************************************************/
+led_pwm_start_plane:
+   addi sp, sp, -8                     /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 4(sp)                       /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                       /* Sparar undan innehållet i r4 inför användning. */
+   slli r3, r2, 2                      /* Beräknar bitplanets offset i led_pwm_planes. */
+   movhi r4, %hiadj(led_pwm_planes)    /* Läser in adressen till led_pwm_planes i r4. */
+   addi r4, r4, %lo(led_pwm_planes)    /* Lägger till adressens lägre bitar i r4. */
+   add r4, r4, r3                      /* Pekar på angivet bitplan. */
+   ldw r3, 0(r4)                       /* Läser in bitplanet i r3. */
+   movhi r4, %hiadj(LED_PWM_LEDS_BASE) /* Läser in LED_PWM_LEDS_BASE[31:16] i r4. */
+   addi r4, r4, %lo(LED_PWM_LEDS_BASE) /* Lägger till LED_PWM_LEDS_BASE[15:0] i r4. */
+   stwio r3, 0(r4)                     /* Skriver bitplanet till lysdioderna. */
+   movhi r4, %hiadj(TIMER_BASE)        /* Läser in TIMER_BASE[31:16] i r4. */
+   addi r4, r4, %lo(TIMER_BASE)        /* Lägger till TIMER_BASE[15:0] i r4. */
+   stwio zero, TIMER_STATUS_REG(r4)    /* Nollställer biten TO samt avbrottet. */
+   movi r3, LED_PWM_UNIT_TICKS         /* Läser in längden för bitplan 0 i r3. */
+   sll r3, r3, r2                      /* Beräknar bitplanets längd i klockpulser. */
+   subi r3, r3, 1                      /* Perioden räknas ned till och med noll. */
+   stwio r3, TIMER_PERIODL_REG(r4)     /* Skriver periodens lägre 16 bitar. */
+   srli r3, r3, 16                     /* Skiftar fram periodens högre 16 bitar. */
+   stwio r3, TIMER_PERIODH_REG(r4)     /* Skriver periodens högre 16 bitar. */
+   movi r3, TIMER_CONTROL_ITO          /* Läser in biten ITO i r3. */
+   ori r3, r3, TIMER_CONTROL_START     /* Lägger till biten START i r3. */
+   stwio r3, TIMER_CONTROL_REG(r4)     /* Startar nedräkning med avbrott. */
+   ldw r4, 0(sp)                       /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                       /* Återställer r3 efter användning. */
+   addi sp, sp, 8                      /* Återställer stackpekaren. */
+   ret                                 /* Genomför återhopp. */
+
+/********************************************************************************
+* led_pwm_isr: Avbrottsrutin för intervalltimern. Nästa bitplan skrivs till
+*              lysdioderna och timern startas om med bitplanets längd.
+*              Efter sista bitplanet räknas antalet perioder upp.
+********************************************************************************/
+led_pwm_isr:
+   addi sp, sp, -16                      /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 12(sp)                        /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 8(sp)                         /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)                         /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                         /* Sparar undan innehållet i r4 inför användning. */
+   movhi r3, %hiadj(led_pwm_plane)       /* Läser in adressen till led_pwm_plane i r3. */
+   addi r3, r3, %lo(led_pwm_plane)       /* Lägger till adressens lägre bitar i r3. */
+   ldw r2, 0(r3)                         /* Läser in index för visat bitplan i r2. */
+   addi r2, r2, 1                        /* Räknar upp till nästa bitplan, */
+   andi r2, r2, LED_PWM_PLANES - 1       /* med återgång till bitplan 0 efter sista. */
+   stw r2, 0(r3)                         /* Lagrar index för nästa bitplan. */
+   bne r2, zero, led_pwm_isr_start       /* Om perioden inte är slut visas bitplanet direkt. */
+   movhi r3, %hiadj(led_pwm_frame_count) /* Annars läses adressen till led_pwm_frame_count in, */
+   addi r3, r3, %lo(led_pwm_frame_count) /* inklusive adressens lägre bitar, */
+   ldw r4, 0(r3)                         /* antalet perioder läses in, */
+   addi r4, r4, 1                        /* räknas upp ett steg */
+   stw r4, 0(r3)                         /* och skrivs tillbaka. */
+led_pwm_isr_start:
+   call led_pwm_start_plane              /* Visar nästa bitplan och startar om timern. */
+   ldw r4, 0(sp)                         /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                         /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)                         /* Återställer r2 efter användning. */
+   ldw ra, 12(sp)                        /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 16                       /* Återställer stackpekaren. */
+   ret                                   /* Genomför återhopp. */
+
+/********************************************************************************
+* led_pwm_init: Släcker samtliga lysdioder, registrerar avbrottsrutinen för
+*               intervalltimern och startar visning av första bitplanet.
+*               Ägs intervalltimern redan av en annan drivrutin returneras
+*               felkod 1 via r2 utan att timern påverkas, annars 0. Avbrott
+*               måste därefter aktiveras globalt via irq_global_enable.
+********************************************************************************/
+led_pwm_init:
+   addi sp, sp, -16                      /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 12(sp)                        /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 8(sp)                         /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 4(sp)                         /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 0(sp)                         /* Sparar undan innehållet i r5 inför användning. */
+   movhi r5, %hiadj(led_pwm_isr)         /* Läser in adressen till led_pwm_isr i r5. */
+   addi r5, r5, %lo(led_pwm_isr)         /* Lägger till adressens lägre bitar i r5. */
+   mov r2, r5                            /* Läser in avbrottsrutinen i r2. */
+   call timer_claim                      /* Gör anspråk på intervalltimern. */
+   bne r2, zero, led_pwm_init_end        /* Ägs timern av en annan drivrutin returneras 1. */
+   movhi r3, %hiadj(led_pwm_planes)      /* Läser in adressen till led_pwm_planes i r3. */
+   addi r3, r3, %lo(led_pwm_planes)      /* Lägger till adressens lägre bitar i r3. */
+   movi r4, LED_PWM_PLANES               /* Läser in antalet bitplan i r4. */
+led_pwm_init_loop:
+   stw zero, 0(r3)                       /* Nollställer aktuellt bitplan. */
+   addi r3, r3, 4                        /* Pekar på nästa bitplan. */
+   subi r4, r4, 1                        /* Räknar ned antalet återstående bitplan. */
+   bne r4, zero, led_pwm_init_loop       /* Upprepar tills samtliga bitplan är nollställda. */
+   movhi r3, %hiadj(led_pwm_plane)       /* Läser in adressen till led_pwm_plane i r3. */
+   addi r3, r3, %lo(led_pwm_plane)       /* Lägger till adressens lägre bitar i r3. */
+   stw zero, 0(r3)                       /* Börjar med bitplan 0. */
+   movhi r3, %hiadj(led_pwm_frame_count) /* Läser in adressen till led_pwm_frame_count i r3. */
+   addi r3, r3, %lo(led_pwm_frame_count) /* Lägger till adressens lägre bitar i r3. */
+   stw zero, 0(r3)                       /* Nollställer antalet perioder. */
+   movi r2, TIMER_IRQ                    /* Läser in intervalltimerns avbrottsnummer i r2. */
+   mov r3, r5                            /* Läser in adressen till led_pwm_isr i r3. */
+   call irq_register                     /* Registrerar avbrottsrutinen för timern. */
+   movi r2, 0                            /* Läser in index för bitplan 0 i r2. */
+   call led_pwm_start_plane              /* Visar bitplan 0 och startar timern, r2 = 0. */
+led_pwm_init_end:
+   ldw r5, 0(sp)                         /* Återställer r5 efter användning. */
+   ldw r4, 4(sp)                         /* Återställer r4 efter användning. */
+   ldw r3, 8(sp)                         /* Återställer r3 efter användning. */
+   ldw ra, 12(sp)                        /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 16                       /* Återställer stackpekaren. */
+   ret                                   /* Genomför återhopp. */
+
+/********************************************************************************
+* led_set_brightness: Sätter ljusstyrkan för angiven lysdiod genom att
+*                     uppdatera lysdiodens bit i samtliga bitplan. Ny
+*                     ljusstyrka visas från och med nästa bitplan. Vid
+*                     ogiltigt pin-nummer returneras felkod 1 via r2,
+*                     annars 0.
+*
+*                     - r2: Lysdiodens pin-nummer (0 - 9).
+*                     - r3: Ljusstyrkan (0 = släckt, 255 = fullt tänd).
+********************************************************************************/
+led_set_brightness:
+   addi sp, sp, -24                      /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 20(sp)                        /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 16(sp)                        /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 12(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 8(sp)                         /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 4(sp)                         /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 0(sp)                         /* Sparar undan innehållet i r8 inför användning. */
+   movi r4, LED_PWM_COUNT                /* Läser in antalet lysdioder i r4. */
+   bgeu r2, r4, led_set_brightness_error /* Vid ogiltigt pin-nummer returneras 1. */
+   movi r4, 1                            /* Läser in 0x01 i r4 för bitvis skiftning. */
+   sll r4, r4, r2                        /* Skiftar fram lysdiodens bit i r4. */
+   nor r5, r4, r4                        /* Lagrar inverterad bitmask i r5 för nollställning. */
+   movhi r6, %hiadj(led_pwm_planes)      /* Läser in adressen till led_pwm_planes i r6. */
+   addi r6, r6, %lo(led_pwm_planes)      /* Lägger till adressens lägre bitar i r6. */
+   movi r2, LED_PWM_PLANES               /* Använder r2 som nedräknare för bitplanen. */
+led_set_brightness_loop:
+   ldw r7, 0(r6)                         /* Läser in aktuellt bitplan i r7. */
+   and r7, r7, r5                        /* Nollställer lysdiodens bit i bitplanet. */
+   andi r8, r3, 1                        /* Läser in ljusstyrkans lägsta bit i r8. */
+   sub r8, zero, r8                      /* Omvandlar biten till 0 eller 0xFFFFFFFF. */
+   and r8, r8, r4                        /* Behåller lysdiodens bit om biten är ettställd. */
+   or r7, r7, r8                         /* Ettställer lysdiodens bit vid behov. */
+   stw r7, 0(r6)                         /* Skriver tillbaka bitplanet. */
+   srli r3, r3, 1                        /* Skiftar fram nästa bit av ljusstyrkan. */
+   addi r6, r6, 4                        /* Pekar på nästa bitplan. */
+   subi r2, r2, 1                        /* Räknar ned antalet återstående bitplan. */
+   bne r2, zero, led_set_brightness_loop /* Upprepar för samtliga bitplan, r2 = 0 efteråt. */
+   br led_set_brightness_end             /* Returnerar 0 och avslutar subrutinen. */
+led_set_brightness_error:
+   movi r2, 1                            /* Lagrar returkod 1 i r2. */
+led_set_brightness_end:
+   ldw r8, 0(sp)                         /* Återställer r8 efter användning. */
+   ldw r7, 4(sp)                         /* Återställer r7 efter användning. */
+   ldw r6, 8(sp)                         /* Återställer r6 efter användning. */
+   ldw r5, 12(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 16(sp)                        /* Återställer r4 efter användning. */
+   ldw r3, 20(sp)                        /* Återställer r3 efter användning. */
+   addi sp, sp, 24                       /* Återställer stackpekaren. */
+   ret                                   /* Genomför återhopp. */
+
+/********************************************************************************
+* led_pwm_frames: Returnerar antalet genomförda perioder sedan start via r2,
+*                 vilket kan användas som tidsbas då intervalltimern är
+*                 upptagen.
+********************************************************************************/
+led_pwm_frames:
+   movhi r2, %hiadj(led_pwm_frame_count) /* Läser in adressen till led_pwm_frame_count i r2. */
+   addi r2, r2, %lo(led_pwm_frame_count) /* Lägger till adressens lägre bitar i r2. */
+   ldw r2, 0(r2)                         /* Läser in antalet perioder i r2. */
+   ret                                   /* Genomför återhopp. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats för bitplanen.
+********************************************************************************/
+.data
+led_pwm_planes:      .skip LED_PWM_PLANES * 4 /* Bitplan, ett ord per bit av ljusstyrkan. */
+led_pwm_plane:       .skip 4                  /* Index för bitplanet som visas. */
+led_pwm_frame_count: .skip 4                  /* Antal genomförda perioder. */
+
+/********************************************************************************
+* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+
+.endif /* LED_PWM_S_ */
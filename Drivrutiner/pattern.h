@@ -0,0 +1,57 @@
+/********************************************************************************
+* pattern.h: Innehåller en sekvenserare som spelar upp mönstertabeller från
+*            pattern_tables.h med fast bildfrekvens, exempelvis till
+*            lysdiodernas dataregister.
+*
+*            Mönstertabellerna genereras i förväg via Verktyg/pattern_gen.c
+*            och är konstanta, så att de placeras i .rodata. Därmed beräknas
+*            inga bildrutor vid start eller under uppspelning och inget RAM
+*            krävs för tabellerna. Varje bildruta matas ut via en enda
+*            läsning från tabellen följd av en skrivning till registret.
+*
+*            Tiden mellan bildrutorna mäts via intervalltimern, där varje
+*            bildrutas starttid räknas upp från föregående bildrutas, så att
+*            fördröjningen inte ackumulerar fel över tabellen. Skrivningarna
+*            sker via TRACE_WRITE, så att de kan spelas in via trace.h.
+*
+*            Intervalltimern måste startas via timer_init innan uppspelning.
+********************************************************************************/
+#ifndef PATTERN_H_
+#define PATTERN_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include "timer.h"
+#include "trace.h"
+#include "pattern_tables.h"
+
+/********************************************************************************
+* pattern_play: Spelar upp angiven mönstertabell en gång till angivet
+*               register, med angiven tid mellan varje bildruta. Varje
+*               bildruta visas under en hel period innan nästa skrivs ut.
+*
+*               - reg      : Referens till registret som bildrutorna skrivs till.
+*               - frames   : Referens till mönstertabellen.
+*               - size     : Antalet bildrutor i tabellen.
+*               - period_us: Tid mellan varje bildruta i mikrosekunder.
+********************************************************************************/
+static inline void pattern_play(volatile uint32_t* reg,
+                                const uint32_t* frames,
+                                const uint32_t size,
+                                const uint32_t period_us)
+{
+   const uint32_t* const end = frames + size;
+   const uint32_t ticks = period_us * TIMER_TICKS_PER_US;
+   uint32_t start = timer_ticks();
+
+   while (frames != end)
+   {
+      TRACE_WRITE(reg, *frames++);
+      timer_wait(&start, ticks);
+   }
+   return;
+}
+
+#endif /* PATTERN_H_ */
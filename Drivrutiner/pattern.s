@@ -0,0 +1,79 @@
+/********************************************************************************
+* pattern.s: Innehåller en sekvenserare som spelar upp mönstertabeller från
+*            pattern_tables.s med fast bildfrekvens, exempelvis till
+*            lysdiodernas dataregister, motsvarande pattern.h.
+*
+*            Mönstertabellerna genereras i förväg via Verktyg/pattern_gen.c
+*            och lagras som .word i sektionen .rodata. Därmed beräknas inga
+*            bildrutor vid start eller under uppspelning och inget RAM
+*            krävs för tabellerna. Varje bildruta matas ut via en enda
+*            läsning (ldw) från tabellen följd av en skrivning (stwio) till
+*            registret, medan sekvenserarens tillstånd hålls i register.
+*
+*            Tiden mellan bildrutorna mäts via intervalltimern, där varje
+*            bildrutas starttid räknas upp från föregående bildrutas via
+*            timer_wait, så att fördröjningen inte ackumulerar fel över
+*            tabellen. Subrutinen timer_init måste anropas innan uppspelning.
+********************************************************************************/
+.ifndef PATTERN_S_
+.equ PATTERN_S_, 0
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/timer.s"
+.include "../Drivrutiner/pattern_tables.s"
+
+/********************************************************************************
+* pattern_play: Spelar upp angiven mönstertabell en gång till angivet
+*               register, med angiven tid mellan varje bildruta. Varje
+*               bildruta visas under en hel period innan nästa skrivs ut.
+*               Periodens längd i klockpulser beräknas som us * 50 via
+*               skiftning, så att hårdvarumultiplikator inte krävs.
+*
+*               - r2: Adressen till registret som bildrutorna skrivs till.
+*               - r3: Adressen till mönstertabellen.
+*               - r4: Antalet bildrutor i tabellen.
+*               - r5: Tid mellan varje bildruta i mikrosekunder.
+********************************************************************************/
+pattern_play:
+   addi sp, sp, -32             /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 28(sp)               /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 24(sp)               /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 20(sp)               /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 16(sp)               /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 12(sp)               /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 8(sp)                /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 4(sp)                /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 0(sp)                /* Sparar undan innehållet i r8 inför användning. */
+   mov r6, r2                   /* Lagrar registrets adress i r6. */
+   slli r4, r4, 2               /* Beräknar tabellens storlek i byte. */
+   add r4, r3, r4               /* Lagrar adressen efter tabellens sista bildruta i r4. */
+   mov r8, r5                   /* Lagrar periodens längd i mikrosekunder i r8. */
+   mov r5, r3                   /* Pekar på tabellens första bildruta via r5. */
+   slli r3, r8, 5               /* Beräknar us * 32 i r3. */
+   slli r7, r8, 4               /* Beräknar us * 16 i r7. */
+   add r3, r3, r7               /* Lägger till us * 16 i r3. */
+   add r3, r3, r8               /* Lägger till us * 1 i r3. */
+   add r3, r3, r8               /* Lägger till us * 1 i r3, totalt us * 50. */
+   call timer_ticks             /* Läser in starttiden i r2. */
+pattern_play_loop:
+   beq r5, r4, pattern_play_end /* Avslutar när samtliga bildrutor har spelats upp. */
+   ldw r7, 0(r5)                /* Läser in aktuell bildruta i r7. */
+   stwio r7, 0(r6)              /* Skriver bildrutan till registret. */
+   addi r5, r5, 4               /* Pekar på nästa bildruta. */
+   call timer_wait              /* Väntar en period, ny starttid lagras i r2. */
+   br pattern_play_loop         /* Återstartar loopen. */
+pattern_play_end:
+   ldw r8, 0(sp)                /* Återställer r8 efter användning. */
+   ldw r7, 4(sp)                /* Återställer r7 efter användning. */
+   ldw r6, 8(sp)                /* Återställer r6 efter användning. */
+   ldw r5, 12(sp)               /* Återställer r5 efter användning. */
+   ldw r4, 16(sp)               /* Återställer r4 efter användning. */
+   ldw r3, 20(sp)               /* Återställer r3 efter användning. */
+   ldw r2, 24(sp)               /* Återställer r2 efter användning. */
+   ldw ra, 28(sp)               /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 32              /* Återställer stackpekaren. */
+   ret                          /* Genomför återhopp. */
+
+.endif /* PATTERN_S_ */
@@ -0,0 +1,189 @@
+/********************************************************************************
+* profile.h: Innehåller en profilerare för tidsmätning av kodregioner i antal
+*            klockpulser, exempelvis fördröjningen från att en insignal
+*            ändras till att motsvarande lysdiod skrivs. Profileringen
+*            aktiveras via makrot PROFILE (-DPROFILE), annars kompileras
+*            PROFILE_INIT, PROFILE_BEGIN samt PROFILE_END till ingenting.
+*
+*            Varje region har en post i den statiska tabellen
+*            profile_regions, som rymmer PROFILE_REGIONS regioner (förval
+*            4, definieras annars innan profile.h inkluderas). PROFILE_BEGIN
+*            lagrar regionens starttid, varefter PROFILE_END lagrar tiden
+*            sedan dess i regionens minsta, största samt summerade tid och
+*            räknar upp regionens histogram. Histogrammet är logaritmiskt,
+*            där fack i räknar tider om i bitar, dvs. tider under 2^i
+*            klockpulser som inte ryms i facket före. Medelvärdet beräknas
+*            först vid utskrift. PROFILE_END kan anropas villkorligt, så att
+*            enbart exempelvis varv med en flank mäts, medan PROFILE_BEGIN
+*            kan anropas flera gånger, varvid senaste starttiden gäller.
+*
+*            Tiden läses av via makrot PROFILE_TIME, där sched_cycles används
+*            ifall sched.h har inkluderats innan profile.h, eftersom
+*            intervalltimern då genererar schemaläggarens tick. Annars
+*            används intervalltimern via timer_ticks, som startas av
+*            PROFILE_INIT. Vid kompilering för Linux tillsammans med sched.h
+*            drivs klockan därmed av schemaläggarens simulerade tick, så att
+*            tabellen blir densamma vid varje körning. PROFILE_TIME kan även
+*            definieras innan profile.h inkluderas.
+*
+*            Tabellen läses av via debuggern på hårdvaran och skrivs ut via
+*            profile_print vid kompilering för Linux. Motsvarande makron i
+*            assembler finns i filen profile.s, vars tabell skrivs ut i
+*            samma format av simulatorn via flaggan -p.
+********************************************************************************/
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+
+#ifdef PROFILE
+#include "timer.h"
+
+#ifdef NIOS2_HOST
+#include <stdio.h>
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#ifndef PROFILE_REGIONS
+#define PROFILE_REGIONS 4  /* Antal regioner i tabellen. */
+#endif /* PROFILE_REGIONS */
+#define PROFILE_BINS    33 /* Antal fack i histogrammet, ett per möjlig antal bitar. */
+
+/********************************************************************************
+* PROFILE_TIME: Returnerar aktuell tid i antal klockpulser.
+********************************************************************************/
+#if defined(PROFILE_TIME)
+#define PROFILE_TIMER_INIT()
+#elif defined(SCHED_H_)
+#define PROFILE_TIME()       sched_cycles()
+#define PROFILE_TIMER_INIT()
+#else
+#define PROFILE_TIME()       timer_ticks()
+#define PROFILE_TIMER_INIT() timer_init()
+#endif /* PROFILE_TIME */
+
+/********************************************************************************
+* profile_region: Strukt för tidsmätning av en kodregion, där samtliga tider
+*                 anges i antal klockpulser.
+********************************************************************************/
+struct profile_region
+{
+   uint32_t start;              /* Starttid för pågående mätning. */
+   uint32_t count;              /* Antal genomförda mätningar. */
+   uint32_t min;                /* Kortaste uppmätta tid. */
+   uint32_t max;                /* Längsta uppmätta tid. */
+   uint64_t sum;                /* Summan av samtliga uppmätta tider. */
+   uint32_t hist[PROFILE_BINS]; /* Antal mätningar per antal bitar i tiden. */
+};
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static struct profile_region profile_regions[PROFILE_REGIONS]; /* Tabell med samtliga regioner. */
+
+/********************************************************************************
+* profile_init: Nollställer samtliga regioner och startar intervalltimern,
+*               ifall den inte används av schemaläggaren.
+********************************************************************************/
+static inline void profile_init(void)
+{
+   for (uint32_t i = 0; i < PROFILE_REGIONS; ++i)
+   {
+      profile_regions[i] = (struct profile_region){ 0 };
+   }
+   PROFILE_TIMER_INIT();
+   return;
+}
+
+/********************************************************************************
+* profile_record: Lagrar tiden från regionens starttid till angiven sluttid
+*                 i regionens statistik samt histogram. Antalet bitar i
+*                 tiden beräknas utan hopp via binärsökning, där tiden
+*                 skiftas ned 16, 8, 4, 2 respektive 1 steg ifall den har
+*                 bitar kvar ovanför steget, så att kostnaden är densamma
+*                 oavsett uppmätt tid, motsvarande profile.s.
+*
+*                 - self: Referens till regionen.
+*                 - end : Sluttiden i antal klockpulser.
+********************************************************************************/
+static inline void profile_record(struct profile_region* self,
+                                  const uint32_t end)
+{
+   const uint32_t elapsed = end - self->start;
+   uint32_t rest = elapsed;
+   uint32_t bin = 0;
+
+   if (!self->count || elapsed < self->min) self->min = elapsed;
+   if (elapsed > self->max) self->max = elapsed;
+   self->count++;
+   self->sum += elapsed;
+
+   for (uint32_t step = 16; step; step >>= 1)
+   {
+      const uint32_t shift = (uint32_t)((rest >> step) != 0) * step;
+      rest >>= shift;
+      bin += shift;
+   }
+   self->hist[bin + rest]++;
+   return;
+}
+
+/********************************************************************************
+* PROFILE_INIT: Initierar profileringen, se profile_init.
+********************************************************************************/
+#define PROFILE_INIT() profile_init()
+
+/********************************************************************************
+* PROFILE_BEGIN: Lagrar aktuell tid som starttid för angiven region.
+*
+*                - region: Regionens index i tabellen.
+********************************************************************************/
+#define PROFILE_BEGIN(region) (profile_regions[(region)].start = PROFILE_TIME())
+
+/********************************************************************************
+* PROFILE_END: Lagrar tiden sedan senaste PROFILE_BEGIN för angiven region.
+*
+*              - region: Regionens index i tabellen.
+********************************************************************************/
+#define PROFILE_END(region) profile_record(&profile_regions[(region)], PROFILE_TIME())
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* profile_print: Skriver ut antal mätningar samt kortaste, genomsnittlig och
+*                längsta tid för samtliga regioner med minst en mätning,
+*                följt av regionens fack i histogrammet som inte är tomma.
+********************************************************************************/
+static inline void profile_print(void)
+{
+   printf("Region    Antal        Min      Medel        Max (klockpulser)\n");
+
+   for (uint32_t i = 0; i < PROFILE_REGIONS; ++i)
+   {
+      const struct profile_region* self = &profile_regions[i];
+      if (!self->count) continue;
+      printf("%6lu %8lu %10lu %10lu %10lu\n", (unsigned long)i, (unsigned long)self->count,
+             (unsigned long)self->min, (unsigned long)(self->sum / self->count), (unsigned long)self->max);
+
+      for (uint32_t j = 0; j < PROFILE_BINS; ++j)
+      {
+         if (self->hist[j]) printf("       < 2^%-2lu %8lu\n", (unsigned long)j, (unsigned long)self->hist[j]);
+      }
+   }
+   return;
+}
+#endif /* NIOS2_HOST */
+#else
+/********************************************************************************
+* Makron som kompileras till ingenting utan profilering:
+********************************************************************************/
+#define PROFILE_INIT()
+#define PROFILE_BEGIN(region) ((void)0)
+#define PROFILE_END(region)   ((void)0)
+#endif /* PROFILE */
+
+#endif /* PROFILE_H_ */
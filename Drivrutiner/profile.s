@@ -0,0 +1,318 @@
+/********************************************************************************
+* profile.s: Innehåller en profilerare för tidsmätning av kodregioner i antal
+*            klockpulser, motsvarande profile.h. Profileringen aktiveras via
+*            symbolen PROFILE (exempelvis -D PROFILE=1 till simulatorn eller
+*            -Wa,--defsym,PROFILE=1 till nios2-elf-gcc), annars expanderas
+*            makrona PROFILE_INIT, PROFILE_BEGIN samt PROFILE_END till
+*            ingenting.
+*
+*            Varje region har en post om PROFILE_REGION_SIZE byte i tabellen
+*            profile_regions, som rymmer PROFILE_REGIONS regioner (förval 4,
+*            definieras annars innan profile.s inkluderas). PROFILE_BEGIN
+*            lagrar regionens starttid, varefter PROFILE_END lagrar tiden
+*            sedan dess i regionens minsta, största samt summerade tid och
+*            räknar upp regionens logaritmiska histogram, där fack i räknar
+*            tider om i bitar.
+*
+*            Intervalltimerns räknarvärde läses av direkt i makrona via
+*            PROFILE_READ, utan anrop, och lagras som rått värde, dvs. utan
+*            omräkning till klockpulser sedan start. Skillnaden mellan två
+*            råa värden är ändå uppmätt tid. Regionens adress beräknas vid
+*            assemblering, så att PROFILE_BEGIN enbart läser av timern och
+*            lagrar starttiden, medan PROFILE_END läser av sluttiden och
+*            uppdaterar statistiken på plats, utan anrop. Facket i
+*            histogrammet beräknas utan hopp via två skiftsteg om 16
+*            respektive 8 bitar följt av uppslagning i tabellen
+*            profile_bits, så att kostnaden är densamma oavsett uppmätt tid.
+*
+*            Ifall sched.s har inkluderats innan profile.s genererar
+*            intervalltimern schemaläggarens tick, varvid rått värde beräknas
+*            som sched_clock minus räknarvärdet och avläsningen görs om ifall
+*            ett tick inträffar under tiden, motsvarande sched_cycles.
+*            Annars används räknarvärdet från timer_init direkt, som startas
+*            av PROFILE_INIT.
+*
+*            Uppmätt i nios2sim kräver PROFILE_BEGIN 17 och PROFILE_END 56
+*            instruktioner med intervalltimern oavsett uppmätt tid, samt 25
+*            respektive 60 instruktioner med sched.s.
+*
+*            Tabellen läses av via debuggern på hårdvaran eller skrivs ut av
+*            simulatorn via flaggan -p efter körning.
+********************************************************************************/
+.ifndef PROFILE_S_
+.equ PROFILE_S_, 0
+
+.ifdef PROFILE
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/timer.s"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.ifndef PROFILE_REGIONS
+.equ PROFILE_REGIONS, 4 /* Antal regioner i tabellen. */
+.endif /* PROFILE_REGIONS */
+.equ PROFILE_BINS, 33   /* Antal fack i histogrammet, ett per möjligt antal bitar. */
+.ifdef SCHED_S_
+.equ PROFILE_SCHED, 1   /* Indikerar att intervalltimern genererar schemaläggarens tick. */
+.else
+.equ PROFILE_SCHED, 0   /* Indikerar att intervalltimern enbart används av profileringen. */
+.endif /* SCHED_S_ */
+
+/********************************************************************************
+* Offset för fälten i en region (strukten profile_region i profile.h):
+********************************************************************************/
+.equ PROFILE_START      , 0   /* Starttid för pågående mätning. */
+.equ PROFILE_COUNT      , 4   /* Antal genomförda mätningar. */
+.equ PROFILE_MIN        , 8   /* Kortaste uppmätta tid. */
+.equ PROFILE_MAX        , 12  /* Längsta uppmätta tid. */
+.equ PROFILE_SUM        , 16  /* Summan av samtliga uppmätta tider (64 bitar). */
+.equ PROFILE_HIST       , 24  /* Antal mätningar per antal bitar i tiden. */
+.equ PROFILE_REGION_SIZE, 160 /* Storlek för en region i byte, jämnt delbar med 8. */
+.endif /* PROFILE */
+
+/********************************************************************************
+* PROFILE_CALL: Anropar angiven subrutin med adressen till angiven region i
+*               r2, där r2 samt ra sparas undan, så att makrot kan placeras
+*               var som helst i koden. Används internt av PROFILE_INIT.
+*
+*               - routine: Subrutinen som ska anropas.
+*               - region : Regionens index i tabellen.
+********************************************************************************/
+.macro PROFILE_CALL routine, region
+   addi sp, sp, -8                                             /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 4(sp)                                               /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 0(sp)                                               /* Sparar undan innehållet i r2 inför användning. */
+   movia r2, profile_regions + (\region) * PROFILE_REGION_SIZE /* Läser in adressen till regionen i r2. */
+   call \routine                                               /* Anropar angiven subrutin. */
+   ldw r2, 0(sp)                                               /* Återställer r2 efter användning. */
+   ldw ra, 4(sp)                                               /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 8                                              /* Återställer stackpekaren. */
+.endm
+
+.ifdef PROFILE
+/********************************************************************************
+* PROFILE_SAVE: Sparar undan registren som används av PROFILE_READ, dvs. r2
+*               samt r3 och dessutom r4 samt r5 ifall sched.s används.
+*               Registren återställs via PROFILE_RESTORE.
+*
+*               - all: Sparar alltid undan r2 - r5 ifall satt (förval 0).
+********************************************************************************/
+.macro PROFILE_SAVE all=0
+.if PROFILE_SCHED || (\all)
+   addi sp, sp, -16 /* Allokerar minne för lokala variabler på stacken. */
+   stw r5, 12(sp)   /* Sparar undan innehållet i r5 inför användning. */
+   stw r4, 8(sp)    /* Sparar undan innehållet i r4 inför användning. */
+.else
+   addi sp, sp, -8  /* Allokerar minne för lokala variabler på stacken. */
+.endif /* PROFILE_SCHED */
+   stw r3, 4(sp)    /* Sparar undan innehållet i r3 inför användning. */
+   stw r2, 0(sp)    /* Sparar undan innehållet i r2 inför användning. */
+.endm
+
+/********************************************************************************
+* PROFILE_RESTORE: Återställer registren som sparades via PROFILE_SAVE.
+*
+*                  - all: Samma värde som vid motsvarande PROFILE_SAVE.
+********************************************************************************/
+.macro PROFILE_RESTORE all=0
+   ldw r2, 0(sp)   /* Återställer r2 efter användning. */
+   ldw r3, 4(sp)   /* Återställer r3 efter användning. */
+.if PROFILE_SCHED || (\all)
+   ldw r4, 8(sp)   /* Återställer r4 efter användning. */
+   ldw r5, 12(sp)  /* Återställer r5 efter användning. */
+   addi sp, sp, 16 /* Återställer stackpekaren. */
+.else
+   addi sp, sp, 8  /* Återställer stackpekaren. */
+.endif /* PROFILE_SCHED */
+.endm
+
+/********************************************************************************
+* PROFILE_READ: Läser in aktuell tid som rått värde i r2, där skillnaden
+*               mellan två avläsningar utgör förfluten tid i klockpulser.
+*               Räknarvärdet läses av via snapl samt snaph. Intervalltimern
+*               räknar ned, så rått värde beräknas som 0 minus räknarvärdet,
+*               alternativt sched_clock minus räknarvärdet ifall sched.s
+*               används. Inträffar ett tick under avläsningen görs då en ny.
+*               Skriver över r3 samt r4 - r5 ifall sched.s används.
+********************************************************************************/
+.macro PROFILE_READ
+.ifdef SCHED_S_
+   movhi r4, %hiadj(sched_clock)   /* Läser in adressen till sched_clock[31:16] i r4. */
+1:
+   movhi r3, %hiadj(TIMER_BASE)    /* Läser in TIMER_BASE[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_BASE)    /* Lägger till TIMER_BASE[15:0] i r3. */
+   ldw r5, %lo(sched_clock)(r4)    /* Läser in antalet klockpulser vid senaste tick i r5. */
+.else
+   movhi r3, %hiadj(TIMER_BASE)    /* Läser in TIMER_BASE[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_BASE)    /* Lägger till TIMER_BASE[15:0] i r3. */
+.endif /* SCHED_S_ */
+   stwio zero, TIMER_SNAPL_REG(r3) /* Läser av räknarvärdet till snapl samt snaph. */
+   ldwio r2, TIMER_SNAPH_REG(r3)   /* Läser in räknarvärdets högre 16 bitar i r2. */
+   slli r2, r2, 16                 /* Skiftar fram de högre bitarna till [31:16]. */
+   ldwio r3, TIMER_SNAPL_REG(r3)   /* Läser in räknarvärdets lägre 16 bitar i r3. */
+   andi r3, r3, 0xFFFF             /* Behåller enbart de lägre 16 bitarna. */
+   or r2, r2, r3                   /* Sammanställer räknarvärdet i r2. */
+.ifdef SCHED_S_
+   sub r2, r5, r2                  /* Beräknar rått värde som sched_clock minus räknarvärdet. */
+   ldw r3, %lo(sched_clock)(r4)    /* Läser in antalet klockpulser vid senaste tick igen. */
+   bne r3, r5, 1b                  /* Inträffade ett tick under avläsningen görs en ny. */
+.else
+   sub r2, zero, r2                /* Beräknar rått värde som 0 minus räknarvärdet. */
+.endif /* SCHED_S_ */
+.endm
+.endif /* PROFILE */
+
+/********************************************************************************
+* PROFILE_INIT: Nollställer samtliga regioner och startar intervalltimern,
+*               ifall den inte används av schemaläggaren.
+********************************************************************************/
+.macro PROFILE_INIT
+.ifdef PROFILE
+   PROFILE_CALL profile_init, 0
+.endif /* PROFILE */
+.endm
+
+/********************************************************************************
+* PROFILE_BEGIN: Lagrar aktuell tid som starttid för angiven region. Tiden
+*                läses av direkt via PROFILE_READ, utan anrop.
+*
+*                - region: Regionens index i tabellen.
+********************************************************************************/
+.macro PROFILE_BEGIN region
+.ifdef PROFILE
+   PROFILE_SAVE                                                                        /* Sparar undan registren som används nedan. */
+   PROFILE_READ                                                                        /* Läser in starttiden som rått värde i r2. */
+   movhi r3, %hiadj(profile_regions + (\region) * PROFILE_REGION_SIZE + PROFILE_START) /* Läser in starttidens adress[31:16] i r3. */
+   stw r2, %lo(profile_regions + (\region) * PROFILE_REGION_SIZE + PROFILE_START)(r3)  /* Lagrar starttiden i regionen. */
+   PROFILE_RESTORE                                                                     /* Återställer registren. */
+.endif /* PROFILE */
+.endm
+
+/********************************************************************************
+* PROFILE_END: Lagrar tiden sedan senaste PROFILE_BEGIN för angiven region i
+*              regionens kortaste, längsta samt summerade tid och räknar upp
+*              regionens histogram. Sluttiden läses av direkt via
+*              PROFILE_READ, varefter statistiken uppdateras på plats utan
+*              anrop. Antalet bitar i tiden beräknas i r4 utan hopp, där
+*              tiden skiftas ned 16 respektive 8 steg ifall den har bitar
+*              kvar ovanför steget, varefter antalet bitar i resterande byte
+*              läses in från tabellen profile_bits.
+*
+*              - region: Regionens index i tabellen.
+********************************************************************************/
+.macro PROFILE_END region
+.ifdef PROFILE
+   PROFILE_SAVE 1                                              /* Sparar undan r2 - r5, som används nedan. */
+   PROFILE_READ                                                /* Läser in sluttiden som rått värde i r2. */
+   movia r3, profile_regions + (\region) * PROFILE_REGION_SIZE /* Läser in adressen till regionen i r3. */
+   ldw r4, PROFILE_START(r3)                                   /* Läser in starttiden i r4. */
+   sub r2, r2, r4                                              /* Beräknar uppmätt tid i r2. */
+   ldw r4, PROFILE_COUNT(r3)                                   /* Läser in antalet mätningar i r4. */
+   addi r5, r4, 1                                              /* Räknar upp antalet mätningar. */
+   stw r5, PROFILE_COUNT(r3)                                   /* Skriver tillbaka antalet mätningar. */
+   beq r4, zero, 2f                                            /* Vid första mätningen lagras tiden som kortaste. */
+   ldw r5, PROFILE_MIN(r3)                                     /* Läser in kortaste tid i r5. */
+   bgeu r2, r5, 3f                                             /* Är tiden inte kortare behålls kortaste tid. */
+2:
+   stw r2, PROFILE_MIN(r3)                                     /* Lagrar tiden som kortaste tid. */
+3:
+   ldw r5, PROFILE_MAX(r3)                                     /* Läser in längsta tid i r5. */
+   bgeu r5, r2, 4f                                             /* Är tiden inte längre behålls längsta tid. */
+   stw r2, PROFILE_MAX(r3)                                     /* Lagrar tiden som längsta tid. */
+4:
+   ldw r4, PROFILE_SUM(r3)                                     /* Läser in summans lägre 32 bitar i r4. */
+   add r5, r4, r2                                              /* Adderar tiden till summans lägre bitar. */
+   stw r5, PROFILE_SUM(r3)                                     /* Skriver tillbaka summans lägre bitar. */
+   cmpltu r5, r5, r4                                           /* Beräknar minnessiffran vid överslag i r5. */
+   ldw r4, PROFILE_SUM + 4(r3)                                 /* Läser in summans högre 32 bitar i r4. */
+   add r4, r4, r5                                              /* Adderar minnessiffran till summans högre bitar. */
+   stw r4, PROFILE_SUM + 4(r3)                                 /* Skriver tillbaka summans högre bitar. */
+   srli r5, r2, 16                                             /* Läser in tidens bitar ovanför bit 15 i r5. */
+   cmpne r5, r5, zero                                          /* Lagrar 1 i r5 ifall sådana bitar finns, annars 0. */
+   slli r4, r5, 4                                              /* Lagrar antalet bitar att skifta (16 eller 0) i r4. */
+   srl r2, r2, r4                                              /* Skiftar ned tiden, antalet bitar räknas i r4. */
+   srli r5, r2, 8                                              /* Läser in tidens bitar ovanför bit 7 i r5. */
+   cmpne r5, r5, zero                                          /* Lagrar 1 i r5 ifall sådana bitar finns, annars 0. */
+   slli r5, r5, 3                                              /* Beräknar antalet bitar att skifta (8 eller 0). */
+   srl r2, r2, r5                                              /* Skiftar ned tiden, som nu ryms i en byte. */
+   add r4, r4, r5                                              /* Räknar upp antalet bitar. */
+   movhi r5, %hiadj(profile_bits)                              /* Läser in tabellens adress[31:16] i r5. */
+   add r5, r5, r2                                              /* Pekar på tabellens element för resterande byte. */
+   ldbu r5, %lo(profile_bits)(r5)                              /* Läser in antalet bitar i resterande byte i r5. */
+   add r4, r4, r5                                              /* Räknar upp antalet bitar. */
+   slli r4, r4, 2                                              /* Beräknar fackets offset, ett ord per fack. */
+   add r4, r4, r3                                              /* Pekar på facket relativt regionen. */
+   ldw r5, PROFILE_HIST(r4)                                    /* Läser in antalet mätningar i facket i r5. */
+   addi r5, r5, 1                                              /* Räknar upp antalet mätningar i facket. */
+   stw r5, PROFILE_HIST(r4)                                    /* Skriver tillbaka antalet mätningar i facket. */
+   PROFILE_RESTORE 1                                           /* Återställer registren. */
+.endif /* PROFILE */
+.endm
+
+.ifdef PROFILE
+/********************************************************************************
+* profile_init: Nollställer samtliga regioner och startar intervalltimern,
+*               ifall den inte används av schemaläggaren.
+*
+*               - r2: Referens till första regionen.
+********************************************************************************/
+profile_init:
+   addi sp, sp, -12                                                  /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 8(sp)                                                     /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 4(sp)                                                     /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 0(sp)                                                     /* Sparar undan innehållet i r3 inför användning. */
+   movia r3, profile_regions + PROFILE_REGIONS * PROFILE_REGION_SIZE /* Läser in tabellens slutadress i r3. */
+profile_init_loop:
+   stw zero, 0(r2)                                                   /* Nollställer aktuellt ord. */
+   addi r2, r2, 4                                                    /* Pekar på nästa ord. */
+   bltu r2, r3, profile_init_loop                                    /* Upprepar tills hela tabellen är nollställd. */
+.ifndef SCHED_S_
+   call timer_init                                                   /* Startar intervalltimern. */
+.endif /* SCHED_S_ */
+   ldw r3, 0(sp)                                                     /* Återställer r3 efter användning. */
+   ldw r2, 4(sp)                                                     /* Återställer r2 efter användning. */
+   ldw ra, 8(sp)                                                     /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 12                                                   /* Återställer stackpekaren. */
+   ret                                                               /* Genomför återhopp. */
+
+/********************************************************************************
+* .rodata: Datasegment för konstanta data, lagringsplats för tabellen med
+*          antalet bitar i varje möjlig byte, dvs. index för den högsta
+*          satta biten plus ett, samt 0 för talet 0.
+********************************************************************************/
+.section .rodata
+profile_bits:
+   .byte 0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4
+   .byte 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5
+   .byte 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6
+   .byte 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6
+   .byte 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+   .byte 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+   .byte 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+   .byte 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+   .byte 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+
+/********************************************************************************
+* .bss: Datasegment för nollställda data, lagringsplats för tabellen med
+*       samtliga regioner.
+********************************************************************************/
+.section .bss, "aw", @nobits
+profile_regions: .skip PROFILE_REGIONS * PROFILE_REGION_SIZE /* Tabell med samtliga regioner. */
+
+/********************************************************************************
+* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+.endif /* PROFILE */
+
+.endif /* PROFILE_S_ */
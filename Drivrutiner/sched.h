@@ -0,0 +1,241 @@
+/********************************************************************************
+* sched.h: Innehåller en kooperativ schemaläggare, där periodiska uppgifter
+*          (tasks) körs utifrån ett tick genererat av intervalltimerns
+*          avbrott, i stället för en handskriven huvudloop med fördröjningar.
+*
+*          Uppgifterna deklareras i en statisk tabell via makrot SCHED_TASK,
+*          där varje uppgift tilldelas en period samt en fas i antal tick.
+*          Uppgiften körs första gången vid tick phase och därefter var
+*          period tick. Avbrottsrutinen räknar enbart upp antalet tick,
+*          medan uppgifterna körs från huvudloopen via sched_run.
+*
+*          Uppgifterna sorteras in i ett tidshjul med SCHED_SLOTS fack,
+*          där varje uppgift placeras i facket för sin nästa körning. Vid
+*          varje tick gås därmed enbart uppgifterna i aktuellt fack igenom,
+*          oavsett antalet uppgifter i tabellen. Uppgifter med längre
+*          period än tidshjulet ligger kvar i facket tills rätt varv nås.
+*
+*          Varje uppgift har räknare för antalet körningar, antalet missade
+*          körningar (överskridanden) samt största fördröjning i antal
+*          tick från avsedd körning, vilket anger uppgiftens jitter. Missade
+*          körningar hoppas över, så att uppgiftens fas bibehålls.
+*
+*          Avbrottsrutinen räknar även upp antalet klockpulser vid senaste
+*          tick, så att sched_cycles kan returnera tiden i klockpulser med
+*          timerns upplösning, exempelvis för profilering via profile.h.
+*
+*          Intervalltimern används med periodiska avbrott och ägs därmed
+*          av sched_isr, se timer_claim i timer.h. Vid kompilering för
+*          Linux (gcc -DNIOS2_HOST) genereras tick via irq_host_raise.
+********************************************************************************/
+#ifndef SCHED_H_
+#define SCHED_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include "irq.h"
+#include "timer.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define SCHED_TICK_US     1000                                 /* Tid per tick i mikrosekunder (1 kHz). */
+#define SCHED_TICK_CYCLES (SCHED_TICK_US * TIMER_TICKS_PER_US) /* Antal klockpulser per tick. */
+#define SCHED_SLOTS       32                                   /* Antal fack i tidshjulet (tvåpotens). */
+#define SCHED_SLOT_MASK   (SCHED_SLOTS - 1)                    /* Bitmask för omvandling av tick till fack. */
+#define SCHED_NONE        0xFF                                 /* Index som indikerar tomt fack. */
+
+/********************************************************************************
+* SCHED_TASK: Initierar en uppgift i en statisk tabell.
+*
+*             - run   : Uppgiftens funktion.
+*             - period: Tid mellan varje körning i antal tick (minst 1).
+*             - phase : Tick för första körningen.
+********************************************************************************/
+#define SCHED_TASK(run, period, phase) { (run), (period), (phase), 0, 0, 0, 0, SCHED_NONE }
+
+/********************************************************************************
+* sched_task: Strukt för en periodisk uppgift.
+********************************************************************************/
+struct sched_task
+{
+   void (*run)(void); /* Uppgiftens funktion. */
+   uint32_t period;   /* Tid mellan varje körning i antal tick. */
+   uint32_t phase;    /* Tick för första körningen. */
+   uint32_t deadline; /* Tick för nästa körning. */
+   uint32_t runs;     /* Antal genomförda körningar. */
+   uint32_t overruns; /* Antal missade körningar. */
+   uint32_t late_max; /* Största fördröjning från avsedd körning i antal tick. */
+   uint8_t next;      /* Index för nästa uppgift i samma fack. */
+};
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static struct sched_task* sched_tasks;   /* Referens till tabellen med uppgifter. */
+static uint8_t sched_wheel[SCHED_SLOTS]; /* Index för första uppgiften per fack. */
+static volatile uint32_t sched_ticks;    /* Antal tick sedan start, ägs av avbrottsrutinen. */
+static volatile uint32_t sched_clock;    /* Antal klockpulser vid senaste tick, ägs av avbrottsrutinen. */
+static uint32_t sched_now;               /* Nästa tick vars fack ska gås igenom. */
+
+/********************************************************************************
+* sched_isr: Avbrottsrutin för intervalltimern. Räknar upp antalet tick samt
+*            antalet klockpulser vid senaste tick.
+********************************************************************************/
+static void sched_isr(void)
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   timer[TIMER_STATUS_REG] = 0;
+   sched_ticks++;
+   sched_clock += SCHED_TICK_CYCLES;
+   return;
+}
+
+/********************************************************************************
+* sched_insert: Placerar angiven uppgift först i facket för dess nästa
+*               körning.
+*
+*               - index: Uppgiftens index i tabellen.
+********************************************************************************/
+static inline void sched_insert(const uint8_t index)
+{
+   const uint32_t slot = sched_tasks[index].deadline & SCHED_SLOT_MASK;
+   sched_tasks[index].next = sched_wheel[slot];
+   sched_wheel[slot] = index;
+   return;
+}
+
+/********************************************************************************
+* sched_init: Nollställer angivna uppgifter, placerar dem i tidshjulet
+*             utifrån respektive fas och startar intervalltimern med ett
+*             avbrott var SCHED_TICK_US mikrosekund. Har någon uppgift
+*             perioden 0, som aldrig skulle flytta fram uppgiftens nästa
+*             körning, eller ägs intervalltimern redan av en annan
+*             drivrutin returneras felkod 1 utan att timern påverkas,
+*             annars 0. Avbrott måste därefter aktiveras globalt via
+*             irq_global_enable.
+*
+*             - tasks: Referens till tabellen med uppgifter.
+*             - count: Antalet uppgifter i tabellen (högst 255).
+********************************************************************************/
+static inline int sched_init(struct sched_task* tasks,
+                             const uint8_t count)
+{
+   for (uint8_t i = 0; i < count; ++i)
+   {
+      if (tasks[i].period == 0) return 1;
+   }
+
+   if (timer_claim(sched_isr)) return 1;
+   sched_tasks = tasks;
+   sched_ticks = 0;
+   sched_clock = 0;
+   sched_now = 0;
+
+   for (uint8_t i = 0; i < SCHED_SLOTS; ++i)
+   {
+      sched_wheel[i] = SCHED_NONE;
+   }
+
+   for (uint8_t i = 0; i < count; ++i)
+   {
+      tasks[i].deadline = tasks[i].phase;
+      tasks[i].runs = 0;
+      tasks[i].overruns = 0;
+      tasks[i].late_max = 0;
+      sched_insert(i);
+   }
+
+   irq_register(TIMER_IRQ, sched_isr);
+   timer_periodic_start(SCHED_TICK_CYCLES);
+   return 0;
+}
+
+/********************************************************************************
+* sched_dispatch: Kör samtliga uppgifter vars nästa körning infaller vid
+*                 angivet tick. Facket töms först, varefter varje uppgift
+*                 placeras i facket för sin nästa körning. Körningar vars
+*                 tick redan har passerat räknas som överskridanden och
+*                 hoppas över.
+*
+*                 - tick: Tick vars fack ska gås igenom.
+********************************************************************************/
+static void sched_dispatch(const uint32_t tick)
+{
+   const uint32_t slot = tick & SCHED_SLOT_MASK;
+   uint8_t index = sched_wheel[slot];
+   sched_wheel[slot] = SCHED_NONE;
+
+   while (index != SCHED_NONE)
+   {
+      struct sched_task* task = &sched_tasks[index];
+      const uint8_t next = task->next;
+
+      if (task->deadline == tick)
+      {
+         const uint32_t late = sched_ticks - tick;
+         if (late > task->late_max) task->late_max = late;
+         task->run();
+         task->runs++;
+         task->deadline += task->period;
+
+         while ((int32_t)(sched_ticks - task->deadline) > 0)
+         {
+            task->deadline += task->period;
+            task->overruns++;
+         }
+      }
+      sched_insert(index);
+      index = next;
+   }
+   return;
+}
+
+/********************************************************************************
+* sched_run: Går igenom facken för samtliga tick som har passerat sedan
+*            föregående anrop och kör uppgifter som har blivit aktuella.
+*            Anropas kontinuerligt från huvudloopen.
+********************************************************************************/
+static inline void sched_run(void)
+{
+   while ((int32_t)(sched_ticks - sched_now) >= 0)
+   {
+      sched_dispatch(sched_now++);
+   }
+   return;
+}
+
+/********************************************************************************
+* sched_time: Returnerar antalet tick sedan start, vilket kan användas som
+*             tidsbas då intervalltimern är upptagen.
+********************************************************************************/
+static inline uint32_t sched_time(void)
+{
+   return sched_ticks;
+}
+
+/********************************************************************************
+* sched_cycles: Returnerar antalet klockpulser sedan start, beräknat som
+*               antalet klockpulser vid senaste tick plus förfluten tid sedan
+*               dess, som läses av via timerns snapl samt snaph. Inträffar
+*               ett tick under avläsningen görs en ny avläsning. Avbrott måste
+*               vara aktiverade, annars räknas inte tick som väntar på
+*               avbrottsrutinen med. Värdet slår runt efter cirka 85 sekunder.
+********************************************************************************/
+static inline uint32_t sched_cycles(void)
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   uint32_t clock, counter;
+
+   do
+   {
+      clock = sched_clock;
+      timer[TIMER_SNAPL_REG] = 0;
+      counter = (timer[TIMER_SNAPH_REG] << 16) | (timer[TIMER_SNAPL_REG] & 0xFFFF);
+   } while (clock != sched_clock);
+   return clock + (SCHED_TICK_CYCLES - 1 - counter);
+}
+
+#endif /* SCHED_H_ */
@@ -0,0 +1,404 @@
+/********************************************************************************
+* sched.s: Innehåller en kooperativ schemaläggare, motsvarande sched.h, där
+*          periodiska uppgifter (tasks) körs utifrån ett tick genererat av
+*          intervalltimerns avbrott.
+*
+*          Uppgifterna deklareras i en tabell via makrot SCHED_TASK, där
+*          varje uppgift tilldelas en period samt en fas i antal tick.
+*          Avbrottsrutinen sched_isr räknar enbart upp antalet tick, medan
+*          uppgifterna körs från huvudloopen via sched_run. Uppgifterna
+*          sorteras in i ett tidshjul med SCHED_SLOTS fack, så att enbart
+*          uppgifterna i aktuellt fack gås igenom vid varje tick.
+*
+*          Varje uppgift har räknare för antalet körningar, antalet missade
+*          körningar (överskridanden) samt största fördröjning i antal tick
+*          från avsedd körning. Uppgifterna anropas via callr och måste
+*          spara undan samtliga register de använder.
+*
+*          Avbrottsrutinen räknar även upp antalet klockpulser vid senaste
+*          tick, så att sched_cycles kan returnera tiden i klockpulser med
+*          timerns upplösning, exempelvis för profilering via profile.s.
+*
+*          Intervalltimern används med periodiska avbrott och ägs därmed
+*          av sched_isr, se timer_claim i timer.s. Avbrott måste aktiveras
+*          globalt via irq_global_enable efter sched_init.
+********************************************************************************/
+.ifndef SCHED_S_
+.equ SCHED_S_, 0
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/irq.s"
+.include "../Drivrutiner/timer.s"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ SCHED_TICK_US    , 1000                   /* Tid per tick i mikrosekunder (1 kHz). */
+.equ SCHED_PERIOD     , SCHED_TICK_US * 50 - 1 /* Timerns period i klockpulser vid 50 MHz. */
+.equ SCHED_TICK_CYCLES, SCHED_PERIOD + 1       /* Antal klockpulser per tick. */
+.equ SCHED_SLOTS      , 32                     /* Antal fack i tidshjulet (tvåpotens). */
+.equ SCHED_SLOT_MASK  , SCHED_SLOTS - 1        /* Bitmask för omvandling av tick till fack. */
+.equ SCHED_NONE       , 0xFF                   /* Index som indikerar tomt fack. */
+
+/********************************************************************************
+* Offset för fälten i en uppgift (strukten sched_task i sched.h):
+********************************************************************************/
+.equ SCHED_TASK_RUN     , 0  /* Adressen till uppgiftens subrutin. */
+.equ SCHED_TASK_PERIOD  , 4  /* Tid mellan varje körning i antal tick. */
+.equ SCHED_TASK_PHASE   , 8  /* Tick för första körningen. */
+.equ SCHED_TASK_DEADLINE, 12 /* Tick för nästa körning. */
+.equ SCHED_TASK_RUNS    , 16 /* Antal genomförda körningar. */
+.equ SCHED_TASK_OVERRUNS, 20 /* Antal missade körningar. */
+.equ SCHED_TASK_LATE_MAX, 24 /* Största fördröjning från avsedd körning i antal tick. */
+.equ SCHED_TASK_NEXT    , 28 /* Index för nästa uppgift i samma fack. */
+.equ SCHED_TASK_SIZE    , 32 /* Storlek för en uppgift i byte. */
+
+/********************************************************************************
+* SCHED_TASK: Lägger till en uppgift i en tabell i datasegmentet.
+*
+*             - run   : Uppgiftens subrutin.
+*             - period: Tid mellan varje körning i antal tick (minst 1).
+*             - phase : Tick för första körningen.
+********************************************************************************/
+.macro SCHED_TASK run, period, phase
+   .word \run, \period, \phase, 0, 0, 0, 0, SCHED_NONE
+.endm
+
+/********************************************************************************
+* sched_isr: Avbrottsrutin för intervalltimern. Räknar upp antalet tick samt
+*            antalet klockpulser vid senaste tick.
+********************************************************************************/
+sched_isr:
+   addi sp, sp, -12                 /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 8(sp)                    /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)                    /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                    /* Sparar undan innehållet i r4 inför användning. */
+   movhi r2, %hiadj(TIMER_BASE)     /* Läser in TIMER_BASE[31:16] i r2. */
+   addi r2, r2, %lo(TIMER_BASE)     /* Lägger till TIMER_BASE[15:0] i r2. */
+   stwio zero, TIMER_STATUS_REG(r2) /* Nollställer biten TO samt avbrottet. */
+   movhi r2, %hiadj(sched_ticks)    /* Läser in adressen till sched_ticks i r2. */
+   addi r2, r2, %lo(sched_ticks)    /* Lägger till adressens lägre bitar i r2. */
+   ldw r3, 0(r2)                    /* Läser in antalet tick i r3. */
+   addi r3, r3, 1                   /* Räknar upp antalet tick. */
+   stw r3, 0(r2)                    /* Skriver tillbaka antalet tick. */
+   movhi r2, %hiadj(sched_clock)    /* Läser in adressen till sched_clock i r2. */
+   addi r2, r2, %lo(sched_clock)    /* Lägger till adressens lägre bitar i r2. */
+   ldw r3, 0(r2)                    /* Läser in antalet klockpulser i r3. */
+   movui r4, SCHED_TICK_CYCLES      /* Läser in antalet klockpulser per tick i r4. */
+   add r3, r3, r4                   /* Räknar upp klockpulserna med ett tick. */
+   stw r3, 0(r2)                    /* Skriver tillbaka antalet klockpulser. */
+   ldw r4, 0(sp)                    /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                    /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)                    /* Återställer r2 efter användning. */
+   addi sp, sp, 12                  /* Återställer stackpekaren. */
+   ret                              /* Genomför återhopp. */
+
+/********************************************************************************
+* sched_insert: Placerar angiven uppgift först i facket för dess nästa
+*               körning.
+*
+*               - r2: Uppgiftens index i tabellen.
+********************************************************************************/
+sched_insert:
+   addi sp, sp, -12                /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 8(sp)                   /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 4(sp)                   /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 0(sp)                   /* Sparar undan innehållet i r5 inför användning. */
+   slli r3, r2, 5                  /* Beräknar uppgiftens offset, 32 byte per uppgift. */
+   movhi r4, %hiadj(sched_tasks)   /* Läser in adressen till sched_tasks i r4. */
+   addi r4, r4, %lo(sched_tasks)   /* Lägger till adressens lägre bitar i r4. */
+   ldw r4, 0(r4)                   /* Läser in referensen till tabellen i r4. */
+   add r3, r4, r3                  /* Pekar på uppgiften. */
+   ldw r4, SCHED_TASK_DEADLINE(r3) /* Läser in tick för nästa körning i r4. */
+   andi r4, r4, SCHED_SLOT_MASK    /* Beräknar facket för nästa körning. */
+   slli r4, r4, 2                  /* Beräknar fackets offset i tidshjulet. */
+   movhi r5, %hiadj(sched_wheel)   /* Läser in adressen till sched_wheel i r5. */
+   addi r5, r5, %lo(sched_wheel)   /* Lägger till adressens lägre bitar i r5. */
+   add r5, r5, r4                  /* Pekar på facket. */
+   ldw r4, 0(r5)                   /* Läser in fackets första uppgift i r4. */
+   stw r4, SCHED_TASK_NEXT(r3)     /* Länkar in fackets uppgifter efter uppgiften. */
+   stw r2, 0(r5)                   /* Placerar uppgiften först i facket. */
+   ldw r5, 0(sp)                   /* Återställer r5 efter användning. */
+   ldw r4, 4(sp)                   /* Återställer r4 efter användning. */
+   ldw r3, 8(sp)                   /* Återställer r3 efter användning. */
+   addi sp, sp, 12                 /* Återställer stackpekaren. */
+   ret                             /* Genomför återhopp. */
+
+/********************************************************************************
+* sched_init: Nollställer angivna uppgifter, placerar dem i tidshjulet
+*             utifrån respektive fas och startar intervalltimern med ett
+*             avbrott var SCHED_TICK_US mikrosekund. Har någon uppgift
+*             perioden 0, som aldrig skulle flytta fram uppgiftens nästa
+*             körning, eller ägs intervalltimern redan av en annan
+*             drivrutin returneras felkod 1 via r2 utan att timern
+*             påverkas, annars 0. Avbrott måste därefter aktiveras globalt
+*             via irq_global_enable.
+*
+*             - r2: Referens till tabellen med uppgifter.
+*             - r3: Antalet uppgifter i tabellen (högst 255).
+********************************************************************************/
+sched_init:
+   addi sp, sp, -20                    /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 16(sp)                      /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 12(sp)                      /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 8(sp)                       /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 4(sp)                       /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 0(sp)                       /* Sparar undan innehållet i r6 inför användning. */
+   mov r4, r2                          /* Lagrar referensen till tabellen i r4. */
+   mov r5, r3                          /* Räknar ned antalet uppgifter att kontrollera i r5. */
+sched_init_check:
+   beq r5, zero, sched_init_claim      /* När samtliga perioder är kontrollerade tas timern. */
+   ldw r6, SCHED_TASK_PERIOD(r2)       /* Läser in uppgiftens period i r6. */
+   beq r6, zero, sched_init_error      /* Vid perioden 0 returneras 1. */
+   addi r2, r2, SCHED_TASK_SIZE        /* Pekar på nästa uppgift. */
+   subi r5, r5, 1                      /* Räknar ned antalet återstående uppgifter. */
+   br sched_init_check                 /* Upprepar för samtliga uppgifter. */
+sched_init_claim:
+   movhi r2, %hiadj(sched_isr)         /* Läser in adressen till sched_isr i r2. */
+   addi r2, r2, %lo(sched_isr)         /* Lägger till adressens lägre bitar i r2. */
+   call timer_claim                    /* Gör anspråk på intervalltimern. */
+   bne r2, zero, sched_init_end        /* Ägs timern av en annan drivrutin returneras 1. */
+   mov r2, r4                          /* Återställer referensen till tabellen i r2. */
+   movhi r4, %hiadj(sched_tasks)       /* Läser in adressen till sched_tasks i r4. */
+   addi r4, r4, %lo(sched_tasks)       /* Lägger till adressens lägre bitar i r4. */
+   stw r2, 0(r4)                       /* Lagrar referensen till tabellen. */
+   movhi r4, %hiadj(sched_ticks)       /* Läser in adressen till sched_ticks i r4. */
+   addi r4, r4, %lo(sched_ticks)       /* Lägger till adressens lägre bitar i r4. */
+   stw zero, 0(r4)                     /* Nollställer antalet tick. */
+   movhi r4, %hiadj(sched_clock)       /* Läser in adressen till sched_clock i r4. */
+   addi r4, r4, %lo(sched_clock)       /* Lägger till adressens lägre bitar i r4. */
+   stw zero, 0(r4)                     /* Nollställer antalet klockpulser. */
+   movhi r4, %hiadj(sched_now)         /* Läser in adressen till sched_now i r4. */
+   addi r4, r4, %lo(sched_now)         /* Lägger till adressens lägre bitar i r4. */
+   stw zero, 0(r4)                     /* Börjar med facket för tick 0. */
+   movhi r4, %hiadj(sched_wheel)       /* Läser in adressen till sched_wheel i r4. */
+   addi r4, r4, %lo(sched_wheel)       /* Lägger till adressens lägre bitar i r4. */
+   movi r5, SCHED_SLOTS                /* Läser in antalet fack i r5. */
+   movi r6, SCHED_NONE                 /* Läser in index för tomt fack i r6. */
+sched_init_wheel:
+   stw r6, 0(r4)                       /* Tömmer aktuellt fack. */
+   addi r4, r4, 4                      /* Pekar på nästa fack. */
+   subi r5, r5, 1                      /* Räknar ned antalet återstående fack. */
+   bne r5, zero, sched_init_wheel      /* Upprepar tills samtliga fack är tömda. */
+   mov r4, r2                          /* Pekar på första uppgiften via r4. */
+   movi r5, 0                          /* Använder r5 som uppgiftens index. */
+sched_init_task:
+   beq r5, r3, sched_init_timer        /* När samtliga uppgifter är placerade startas timern. */
+   ldw r6, SCHED_TASK_PHASE(r4)        /* Läser in uppgiftens fas i r6. */
+   stw r6, SCHED_TASK_DEADLINE(r4)     /* Första körningen sker vid tick phase. */
+   stw zero, SCHED_TASK_RUNS(r4)       /* Nollställer antalet körningar. */
+   stw zero, SCHED_TASK_OVERRUNS(r4)   /* Nollställer antalet överskridanden. */
+   stw zero, SCHED_TASK_LATE_MAX(r4)   /* Nollställer största fördröjning. */
+   mov r2, r5                          /* Läser in uppgiftens index i r2. */
+   call sched_insert                   /* Placerar uppgiften i tidshjulet. */
+   addi r4, r4, SCHED_TASK_SIZE        /* Pekar på nästa uppgift. */
+   addi r5, r5, 1                      /* Räknar upp uppgiftens index. */
+   br sched_init_task                  /* Upprepar för samtliga uppgifter. */
+sched_init_timer:
+   movi r2, TIMER_IRQ                  /* Läser in intervalltimerns avbrottsnummer i r2. */
+   movhi r3, %hiadj(sched_isr)         /* Läser in adressen till sched_isr i r3. */
+   addi r3, r3, %lo(sched_isr)         /* Lägger till adressens lägre bitar i r3. */
+   call irq_register                   /* Registrerar avbrottsrutinen för timern. */
+   movhi r2, %hiadj(SCHED_TICK_CYCLES) /* Läser in SCHED_TICK_CYCLES[31:16] i r2. */
+   addi r2, r2, %lo(SCHED_TICK_CYCLES) /* Lägger till SCHED_TICK_CYCLES[15:0] i r2. */
+   call timer_periodic_start           /* Startar periodisk nedräkning med avbrott. */
+   movi r2, 0                          /* Lagrar returkod 0 i r2. */
+   br sched_init_end                   /* Avslutar subrutinen. */
+sched_init_error:
+   movi r2, 1                          /* Lagrar returkod 1 i r2. */
+sched_init_end:
+   ldw r6, 0(sp)                       /* Återställer r6 efter användning. */
+   ldw r5, 4(sp)                       /* Återställer r5 efter användning. */
+   ldw r4, 8(sp)                       /* Återställer r4 efter användning. */
+   ldw r3, 12(sp)                      /* Återställer r3 efter användning. */
+   ldw ra, 16(sp)                      /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 20                     /* Återställer stackpekaren. */
+   ret                                 /* Genomför återhopp. */
+
+/********************************************************************************
+* sched_dispatch: Kör samtliga uppgifter vars nästa körning infaller vid
+*                 angivet tick. Facket töms först, varefter varje uppgift
+*                 placeras i facket för sin nästa körning. Körningar vars
+*                 tick redan har passerat räknas som överskridanden och
+*                 hoppas över. Uppgiftens index lagras i r5, referensen till
+*                 uppgiften i r6, nästa uppgifts index i r8 och tick i r9.
+*
+*                 - r2: Tick vars fack ska gås igenom.
+********************************************************************************/
+sched_dispatch:
+   addi sp, sp, -36                   /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 32(sp)                     /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 28(sp)                     /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 24(sp)                     /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 20(sp)                     /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 16(sp)                     /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 12(sp)                     /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 8(sp)                      /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 4(sp)                      /* Sparar undan innehållet i r8 inför användning. */
+   stw r9, 0(sp)                      /* Sparar undan innehållet i r9 inför användning. */
+   mov r9, r2                         /* Lagrar aktuellt tick i r9. */
+   andi r4, r2, SCHED_SLOT_MASK       /* Beräknar aktuellt fack. */
+   slli r4, r4, 2                     /* Beräknar fackets offset i tidshjulet. */
+   movhi r5, %hiadj(sched_wheel)      /* Läser in adressen till sched_wheel i r5. */
+   addi r5, r5, %lo(sched_wheel)      /* Lägger till adressens lägre bitar i r5. */
+   add r4, r5, r4                     /* Pekar på facket. */
+   ldw r5, 0(r4)                      /* Läser in fackets första uppgift i r5. */
+   movi r6, SCHED_NONE                /* Läser in index för tomt fack i r6. */
+   stw r6, 0(r4)                      /* Tömmer facket. */
+sched_dispatch_loop:
+   movi r6, SCHED_NONE                /* Läser in index för tomt fack i r6. */
+   beq r5, r6, sched_dispatch_end     /* När facket är genomgånget avslutas subrutinen. */
+   movhi r6, %hiadj(sched_tasks)      /* Läser in adressen till sched_tasks i r6. */
+   addi r6, r6, %lo(sched_tasks)      /* Lägger till adressens lägre bitar i r6. */
+   ldw r6, 0(r6)                      /* Läser in referensen till tabellen i r6. */
+   slli r7, r5, 5                     /* Beräknar uppgiftens offset, 32 byte per uppgift. */
+   add r6, r6, r7                     /* Pekar på uppgiften. */
+   ldw r8, SCHED_TASK_NEXT(r6)        /* Läser in nästa uppgift i facket i r8. */
+   ldw r7, SCHED_TASK_DEADLINE(r6)    /* Läser in tick för uppgiftens nästa körning i r7. */
+   bne r7, r9, sched_dispatch_insert  /* Infaller körningen ett senare varv lämnas den kvar. */
+   movhi r3, %hiadj(sched_ticks)      /* Läser in adressen till sched_ticks i r3. */
+   addi r3, r3, %lo(sched_ticks)      /* Lägger till adressens lägre bitar i r3. */
+   ldw r3, 0(r3)                      /* Läser in antalet tick i r3. */
+   sub r7, r3, r9                     /* Beräknar fördröjningen från avsedd körning. */
+   ldw r2, SCHED_TASK_LATE_MAX(r6)    /* Läser in största fördröjning hittills i r2. */
+   bgeu r2, r7, sched_dispatch_run    /* Om fördröjningen inte är större körs uppgiften. */
+   stw r7, SCHED_TASK_LATE_MAX(r6)    /* Annars lagras fördröjningen som största. */
+sched_dispatch_run:
+   ldw r7, SCHED_TASK_RUN(r6)         /* Läser in adressen till uppgiftens subrutin. */
+   callr r7                           /* Kör uppgiften. */
+   ldw r7, SCHED_TASK_RUNS(r6)        /* Läser in antalet körningar, */
+   addi r7, r7, 1                     /* räknar upp ett steg */
+   stw r7, SCHED_TASK_RUNS(r6)        /* och skriver tillbaka. */
+   ldw r2, SCHED_TASK_PERIOD(r6)      /* Läser in uppgiftens period i r2. */
+   ldw r7, SCHED_TASK_DEADLINE(r6)    /* Läser in tick för aktuell körning i r7. */
+   add r7, r7, r2                     /* Beräknar tick för nästa körning. */
+   movhi r3, %hiadj(sched_ticks)      /* Läser in adressen till sched_ticks i r3. */
+   addi r3, r3, %lo(sched_ticks)      /* Lägger till adressens lägre bitar i r3. */
+   ldw r3, 0(r3)                      /* Läser in antalet tick efter körningen i r3. */
+sched_dispatch_overrun:
+   sub r4, r3, r7                     /* Beräknar tid sedan nästa körning i r4. */
+   bge zero, r4, sched_dispatch_store /* Har körningen inte passerat lagras den. */
+   add r7, r7, r2                     /* Annars hoppas körningen över, */
+   ldw r4, SCHED_TASK_OVERRUNS(r6)    /* antalet överskridanden läses in, */
+   addi r4, r4, 1                     /* räknas upp ett steg */
+   stw r4, SCHED_TASK_OVERRUNS(r6)    /* och skrivs tillbaka. */
+   br sched_dispatch_overrun          /* Upprepar tills nästa körning inte har passerat. */
+sched_dispatch_store:
+   stw r7, SCHED_TASK_DEADLINE(r6)    /* Lagrar tick för nästa körning. */
+sched_dispatch_insert:
+   mov r2, r5                         /* Läser in uppgiftens index i r2. */
+   call sched_insert                  /* Placerar uppgiften i facket för nästa körning. */
+   mov r5, r8                         /* Fortsätter med nästa uppgift i facket. */
+   br sched_dispatch_loop             /* Återstartar loopen. */
+sched_dispatch_end:
+   ldw r9, 0(sp)                      /* Återställer r9 efter användning. */
+   ldw r8, 4(sp)                      /* Återställer r8 efter användning. */
+   ldw r7, 8(sp)                      /* Återställer r7 efter användning. */
+   ldw r6, 12(sp)                     /* Återställer r6 efter användning. */
+   ldw r5, 16(sp)                     /* Återställer r5 efter användning. */
+   ldw r4, 20(sp)                     /* Återställer r4 efter användning. */
+   ldw r3, 24(sp)                     /* Återställer r3 efter användning. */
+   ldw r2, 28(sp)                     /* Återställer r2 efter användning. */
+   ldw ra, 32(sp)                     /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 36                    /* Återställer stackpekaren. */
+   ret                                /* Genomför återhopp. */
+
+/********************************************************************************
+* sched_run: Går igenom facken för samtliga tick som har passerat sedan
+*            föregående anrop och kör uppgifter som har blivit aktuella.
+*            Anropas kontinuerligt från huvudloopen.
+********************************************************************************/
+sched_run:
+   addi sp, sp, -16              /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 12(sp)                /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 8(sp)                 /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)                 /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                 /* Sparar undan innehållet i r4 inför användning. */
+sched_run_loop:
+   movhi r3, %hiadj(sched_now)   /* Läser in adressen till sched_now i r3. */
+   addi r3, r3, %lo(sched_now)   /* Lägger till adressens lägre bitar i r3. */
+   ldw r2, 0(r3)                 /* Läser in nästa tick att gå igenom i r2. */
+   movhi r4, %hiadj(sched_ticks) /* Läser in adressen till sched_ticks i r4. */
+   addi r4, r4, %lo(sched_ticks) /* Lägger till adressens lägre bitar i r4. */
+   ldw r4, 0(r4)                 /* Läser in antalet tick i r4. */
+   sub r4, r4, r2                /* Beräknar antalet tick som återstår att gå igenom. */
+   blt r4, zero, sched_run_end   /* Har ticket inte inträffat avslutas subrutinen. */
+   addi r4, r2, 1                /* Beräknar nästa tick att gå igenom, */
+   stw r4, 0(r3)                 /* som lagras inför nästa varv. */
+   call sched_dispatch           /* Kör uppgifterna i aktuellt tick. */
+   br sched_run_loop             /* Upprepar för samtliga passerade tick. */
+sched_run_end:
+   ldw r4, 0(sp)                 /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                 /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)                 /* Återställer r2 efter användning. */
+   ldw ra, 12(sp)                /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 16               /* Återställer stackpekaren. */
+   ret                           /* Genomför återhopp. */
+
+/********************************************************************************
+* sched_time: Returnerar antalet tick sedan start via r2, vilket kan användas
+*             som tidsbas då intervalltimern är upptagen.
+********************************************************************************/
+sched_time:
+   movhi r2, %hiadj(sched_ticks) /* Läser in adressen till sched_ticks i r2. */
+   addi r2, r2, %lo(sched_ticks) /* Lägger till adressens lägre bitar i r2. */
+   ldw r2, 0(r2)                 /* Läser in antalet tick i r2. */
+   ret                           /* Genomför återhopp. */
+
+/********************************************************************************
+* sched_cycles: Returnerar antalet klockpulser sedan start via r2, beräknat
+*               som antalet klockpulser vid senaste tick plus förfluten tid
+*               sedan dess, som läses av via timerns snapl samt snaph.
+*               Inträffar ett tick under avläsningen görs en ny avläsning.
+*               Avbrott måste vara aktiverade, annars räknas inte tick som
+*               väntar på avbrottsrutinen med.
+********************************************************************************/
+sched_cycles:
+   addi sp, sp, -16                /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 12(sp)                  /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 8(sp)                   /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 4(sp)                   /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 0(sp)                   /* Sparar undan innehållet i r6 inför användning. */
+   movhi r3, %hiadj(TIMER_BASE)    /* Läser in TIMER_BASE[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_BASE)    /* Lägger till TIMER_BASE[15:0] i r3. */
+   movhi r4, %hiadj(sched_clock)   /* Läser in adressen till sched_clock i r4. */
+   addi r4, r4, %lo(sched_clock)   /* Lägger till adressens lägre bitar i r4. */
+sched_cycles_read:
+   ldw r5, 0(r4)                   /* Läser in antalet klockpulser vid senaste tick i r5. */
+   stwio zero, TIMER_SNAPL_REG(r3) /* Läser av räknarvärdet till snapl samt snaph. */
+   ldwio r2, TIMER_SNAPH_REG(r3)   /* Läser in räknarvärdets högre 16 bitar i r2. */
+   slli r2, r2, 16                 /* Skiftar fram de högre bitarna till [31:16]. */
+   ldwio r6, TIMER_SNAPL_REG(r3)   /* Läser in räknarvärdets lägre 16 bitar i r6. */
+   andi r6, r6, 0xFFFF             /* Behåller enbart de lägre 16 bitarna. */
+   or r2, r2, r6                   /* Sammanställer räknarvärdet i r2. */
+   ldw r6, 0(r4)                   /* Läser in antalet klockpulser vid senaste tick igen. */
+   bne r6, r5, sched_cycles_read   /* Inträffade ett tick under avläsningen görs en ny. */
+   movhi r6, %hiadj(SCHED_PERIOD)  /* Läser in SCHED_PERIOD[31:16] i r6. */
+   addi r6, r6, %lo(SCHED_PERIOD)  /* Lägger till SCHED_PERIOD[15:0] i r6. */
+   sub r2, r6, r2                  /* Beräknar förflutna klockpulser sedan senaste tick. */
+   add r2, r2, r5                  /* Lägger till antalet klockpulser vid senaste tick. */
+   ldw r6, 0(sp)                   /* Återställer r6 efter användning. */
+   ldw r5, 4(sp)                   /* Återställer r5 efter användning. */
+   ldw r4, 8(sp)                   /* Återställer r4 efter användning. */
+   ldw r3, 12(sp)                  /* Återställer r3 efter användning. */
+   addi sp, sp, 16                 /* Återställer stackpekaren. */
+   ret                             /* Genomför återhopp. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats för tidshjulet.
+********************************************************************************/
+.data
+sched_tasks: .skip 4               /* Referens till tabellen med uppgifter. */
+sched_wheel: .skip SCHED_SLOTS * 4 /* Index för första uppgiften per fack. */
+sched_ticks: .skip 4               /* Antal tick sedan start, ägs av avbrottsrutinen. */
+sched_clock: .skip 4               /* Antal klockpulser vid senaste tick, ägs av avbrottsrutinen. */
+sched_now:   .skip 4               /* Nästa tick vars fack ska gås igenom. */
+
+/********************************************************************************
+* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+
+.endif /* SCHED_S_ */
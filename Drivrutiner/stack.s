@@ -0,0 +1,85 @@
+/********************************************************************************
+* stack.s: Innehåller drivrutiner för mätning av stackens maximala
+*          användning under körning. Vid start fylls stackens oanvända del
+*          med mönstret STACK_CANARY via stack_paint, varefter stack_peak
+*          när som helst returnerar hur djupt stacken har nått genom att
+*          söka efter det lägsta överskrivna ordet.
+*
+*          Stacken anges via sin startadress (högsta adress + 4, dvs. värdet
+*          som stackpekaren initieras till) samt sin storlek i byte, vilka
+*          båda bör vara jämnt delbara med fyra. Returnerar stack_peak hela
+*          stackens storlek har stacken troligtvis växt utanför sitt område.
+*
+*          Statiskt beräknat värsta fall för varje ingångspunkt skrivs ut av
+*          simulatorn via flaggan -a, se Verktyg/nios2sim.c, vilket kan
+*          jämföras med uppmätt användning vid dimensionering av stacken.
+********************************************************************************/
+.ifndef STACK_S_
+.equ STACK_S_, 0
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ STACK_CANARY, 0xDEADBEEF /* Mönster för stackens oanvända del. */
+
+/********************************************************************************
+* stack_paint: Fyller stackens oanvända del, från stackens lägsta adress upp
+*              till aktuell stackpekare, med mönstret STACK_CANARY. Anropas
+*              direkt efter att stackpekaren har initierats.
+*
+*              - r2: Stackens startadress (högsta adress + 4).
+*              - r3: Stackens storlek i byte.
+********************************************************************************/
+stack_paint:
+   addi sp, sp, -12               /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 8(sp)                  /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)                  /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                  /* Sparar undan innehållet i r4 inför användning. */
+   sub r2, r2, r3                 /* Beräknar stackens lägsta adress i r2. */
+   movhi r4, %hiadj(STACK_CANARY) /* Läser in STACK_CANARY[31:16] i r4. */
+   addi r4, r4, %lo(STACK_CANARY) /* Lägger till STACK_CANARY[15:0] i r4. */
+stack_paint_loop:
+   bgeu r2, sp, stack_paint_end   /* Avslutar när aktuell stackpekare har nåtts. */
+   stw r4, 0(r2)                  /* Skriver mönstret till aktuellt ord. */
+   addi r2, r2, 4                 /* Går vidare till nästa ord. */
+   br stack_paint_loop            /* Återstartar loopen. */
+stack_paint_end:
+   ldw r4, 0(sp)                  /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                  /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)                  /* Återställer r2 efter användning. */
+   addi sp, sp, 12                /* Återställer stackpekaren. */
+   ret                            /* Genomför återhopp. */
+
+/********************************************************************************
+* stack_peak: Returnerar stackens maximala användning i byte sedan anrop av
+*             stack_paint via r2. Stacken genomsöks från lägsta adress uppåt
+*             tills ett ord som inte innehåller STACK_CANARY påträffas.
+*             Användningen inkluderar därmed stack_peak, som själv använder
+*             12 byte av stacken.
+*
+*             - r2: Stackens startadress (högsta adress + 4).
+*             - r3: Stackens storlek i byte.
+********************************************************************************/
+stack_peak:
+   addi sp, sp, -12               /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 8(sp)                  /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 4(sp)                  /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 0(sp)                  /* Sparar undan innehållet i r5 inför användning. */
+   sub r3, r2, r3                 /* Beräknar stackens lägsta adress i r3. */
+   movhi r4, %hiadj(STACK_CANARY) /* Läser in STACK_CANARY[31:16] i r4. */
+   addi r4, r4, %lo(STACK_CANARY) /* Lägger till STACK_CANARY[15:0] i r4. */
+stack_peak_loop:
+   bgeu r3, r2, stack_peak_end    /* Avslutar ifall hela stacken är oanvänd. */
+   ldw r5, 0(r3)                  /* Läser in aktuellt ord i r5. */
+   bne r5, r4, stack_peak_end     /* Avslutar vid första överskrivna ordet. */
+   addi r3, r3, 4                 /* Går vidare till nästa ord. */
+   br stack_peak_loop             /* Återstartar loopen. */
+stack_peak_end:
+   sub r2, r2, r3                 /* Returnerar använt antal byte i r2. */
+   ldw r5, 0(sp)                  /* Återställer r5 efter användning. */
+   ldw r4, 4(sp)                  /* Återställer r4 efter användning. */
+   ldw r3, 8(sp)                  /* Återställer r3 efter användning. */
+   addi sp, sp, 12                /* Återställer stackpekaren. */
+   ret                            /* Genomför återhopp. */
+
+.endif /* STACK_S_ */
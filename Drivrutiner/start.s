@@ -0,0 +1,74 @@
+/********************************************************************************
+* start.s: Innehåller gemensam startkod för lektionernas assemblerprogram,
+*          i stället för att varje program definierar en egen _start.
+*
+*          Vid start initieras stackpekaren samt rampekaren till
+*          STACK_ADDRESS och gp till symbolen _gp, som länkaren placerar
+*          0x7FF0 byte efter sektionen .sdata. Därmed kan variabler samt
+*          konstanter i .sdata och .sbss (exempelvis basadresser lagrade som
+*          .word) läsas via en enda instruktion relativt gp, exempelvis
+*          ldw r3, %gprel(leds_base)(gp), i stället för movhi följt av addi.
+*          Registret gp får därför inte användas till annat.
+*
+*          Sektionerna .sbss samt .bss, från symbolen __bss_start till _end,
+*          nollställs sedan, varefter subrutinen main anropas. Efter återhopp
+*          görs ingenting genom att programmet försätts i en tom loop.
+*
+*          Stackens startadress väljs via symbolen STACK_ADDRESS (förval
+*          4096), som därmed måste definieras innan start.s inkluderas. Är
+*          även symbolen STACK_SIZE definierad fylls stacken med
+*          STACK_CANARY, så att maximal användning kan läsas av via
+*          stack_peak, se stack.s.
+*
+*          Program som inkluderar start.s kan inte klistras in i CPUlator
+*          som enskild fil, utan simuleras i stället via Verktyg/nios2sim.c.
+*          Lektionerna 1 och 4 samt struct.s behåller därför en egen _start.
+********************************************************************************/
+.ifndef START_S_
+.equ START_S_, 0
+
+/********************************************************************************
+* Stackens startadress:
+********************************************************************************/
+.ifndef STACK_ADDRESS
+.equ STACK_ADDRESS, 4096 /* Stackens startadress, placerad efter programkoden. */
+.endif /* STACK_ADDRESS */
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.ifdef STACK_SIZE
+.include "../Drivrutiner/stack.s"
+.endif /* STACK_SIZE */
+
+/********************************************************************************
+* Globala subrutiner:
+********************************************************************************/
+.global _start
+
+/********************************************************************************
+* _start: Initierar stackpekaren, rampekaren samt gp och nollställer .bss.
+*         Subrutinen main anropas sedan för att köra programmet.
+********************************************************************************/
+_start:
+   movia sp, STACK_ADDRESS      /* Initierar stackpekaren till STACK_ADDRESS. */
+   mov fp, sp                   /* Initerar rampekaren till STACK_ADDRESS. */
+   movia gp, _gp                /* Initierar gp för adressering relativt gp. */
+   movia r2, __bss_start        /* Läser in startadressen för .bss i r2. */
+   movia r3, _end               /* Läser in slutadressen för .bss i r3. */
+start_bss_loop:
+   bgeu r2, r3, start_main      /* Avslutar när hela .bss har nollställts. */
+   stw zero, 0(r2)              /* Nollställer aktuellt ord. */
+   addi r2, r2, 4               /* Går vidare till nästa ord. */
+   br start_bss_loop            /* Återstartar loopen. */
+start_main:
+.ifdef STACK_SIZE
+   movia r2, STACK_ADDRESS      /* Laddar stackens startadress i r2. */
+   movia r3, STACK_SIZE         /* Laddar stackens storlek i r3. */
+   call stack_paint             /* Fyller stackens oanvända del med STACK_CANARY. */
+.endif /* STACK_SIZE */
+   call main                    /* Anropar subrutinen main för att köra programmet. */
+start_end:
+   br start_end                 /* Gör ingenting efter återhopp från subrutinen main. */
+
+.endif /* START_S_ */
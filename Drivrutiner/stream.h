@@ -0,0 +1,148 @@
+/********************************************************************************
+* stream.h: Innehåller drivrutiner för icke-blockerande utmatning av arrayer
+*           till ett destinationsregister, exempelvis LEDS_BASE, där
+*           intervalltimerns avbrott matar ut ett element per period.
+*
+*           En array lämnas över via stream_submit, som returnerar direkt.
+*           Avbrottsrutinen skriver sedan ett element i taget till
+*           destinationsregistret, medan processorn kan utföra annat arbete.
+*           Upp till STREAM_BUFFERS arrayer kan vara inlämnade samtidigt,
+*           så att nästa array kan fyllas medan föregående matas ut (dubbel
+*           buffring). Arrayerna matas ut i den ordning de lämnades in, utan
+*           uppehåll mellan dem, och kan vara av godtycklig storlek.
+*
+*           Anroparen skriver enbart till submitted och avbrottsrutinen
+*           enbart till completed, så varken blockering eller inaktivering
+*           av avbrott krävs. En inlämnad array får inte ändras förrän
+*           stream_ready indikerar att dess buffert har frigjorts.
+*
+*           Intervalltimern används med periodiska avbrott och ägs därmed
+*           av stream_isr, se timer_claim i timer.h. Vid kompilering för
+*           Linux (gcc -DNIOS2_HOST) genereras avbrotten via irq_host_raise.
+********************************************************************************/
+#ifndef STREAM_H_
+#define STREAM_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "irq.h"
+#include "timer.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define STREAM_BUFFERS 2                    /* Antal samtidigt inlämnade arrayer. */
+#define STREAM_MASK    (STREAM_BUFFERS - 1) /* Bitmask för omvandling av index till buffert. */
+
+/********************************************************************************
+* stream_buffer: Strukt för en inlämnad array som ska matas ut.
+********************************************************************************/
+struct stream_buffer
+{
+   const uint32_t* data; /* Referens till arrayens första element. */
+   uint32_t size;        /* Antalet element i arrayen. */
+};
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static volatile uint32_t* stream_destination;             /* Destinationsregistret. */
+static struct stream_buffer stream_queue[STREAM_BUFFERS]; /* Inlämnade arrayer. */
+static uint32_t stream_submitted;                         /* Antal inlämnade arrayer, ägs av anroparen. */
+static uint32_t stream_completed;                         /* Antal utmatade arrayer, ägs av avbrottsrutinen. */
+static uint32_t stream_index;                             /* Index för nästa element att mata ut. */
+
+/********************************************************************************
+* stream_isr: Avbrottsrutin för intervalltimern. Nästa element i äldsta
+*             inlämnade array skrivs till destinationsregistret. Efter
+*             arrayens sista element frigörs dess buffert, varefter nästa
+*             inlämnade array matas ut vid nästa avbrott. Saknas inlämnade
+*             arrayer behålls senast skrivna värde.
+********************************************************************************/
+static void stream_isr(void)
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   const uint32_t completed = stream_completed;
+   timer[TIMER_STATUS_REG] = 0;
+
+   if (__atomic_load_n(&stream_submitted, __ATOMIC_ACQUIRE) == completed) return;
+   const struct stream_buffer* buffer = &stream_queue[completed & STREAM_MASK];
+   *stream_destination = buffer->data[stream_index];
+
+   if (++stream_index >= buffer->size)
+   {
+      stream_index = 0;
+      __atomic_store_n(&stream_completed, completed + 1, __ATOMIC_RELEASE);
+   }
+   return;
+}
+
+/********************************************************************************
+* stream_init: Initierar utmatningen till angivet destinationsregister och
+*              startar intervalltimern med periodiska avbrott, där ett
+*              element matas ut per period. Ägs intervalltimern redan av en
+*              annan drivrutin returneras felkod 1 utan att timern påverkas,
+*              annars 0. Avbrott måste därefter aktiveras globalt via
+*              irq_global_enable.
+*
+*              - destination: Referens till destinationsregistret.
+*              - period_us  : Tid mellan varje utmatat element i mikrosekunder.
+********************************************************************************/
+static inline int stream_init(volatile uint32_t* destination,
+                              const uint32_t period_us)
+{
+   if (timer_claim(stream_isr)) return 1;
+   stream_destination = destination;
+   stream_submitted = 0;
+   stream_completed = 0;
+   stream_index = 0;
+   irq_register(TIMER_IRQ, stream_isr);
+   timer_periodic_start(period_us * TIMER_TICKS_PER_US);
+   return 0;
+}
+
+/********************************************************************************
+* stream_submit: Lämnar in angiven array för utmatning och returnerar true
+*                direkt, utan att vänta på utmatningen. Om samtliga
+*                buffertar är upptagna, eller arrayen saknar element,
+*                returneras false.
+*
+*                - data: Referens till arrayen (pekar på första elementet).
+*                - size: Arrayens storlek, dvs. antalet element den rymmer.
+********************************************************************************/
+static inline bool stream_submit(const uint32_t* data,
+                                 const uint32_t size)
+{
+   const uint32_t submitted = stream_submitted;
+
+   if (!size || submitted - __atomic_load_n(&stream_completed, __ATOMIC_ACQUIRE) >= STREAM_BUFFERS)
+   {
+      return false;
+   }
+   stream_queue[submitted & STREAM_MASK].data = data;
+   stream_queue[submitted & STREAM_MASK].size = size;
+   __atomic_store_n(&stream_submitted, submitted + 1, __ATOMIC_RELEASE);
+   return true;
+}
+
+/********************************************************************************
+* stream_ready: Indikerar ifall en buffert är ledig, så att en ny array kan
+*               lämnas in via stream_submit.
+********************************************************************************/
+static inline bool stream_ready(void)
+{
+   return stream_submitted - __atomic_load_n(&stream_completed, __ATOMIC_ACQUIRE) < STREAM_BUFFERS;
+}
+
+/********************************************************************************
+* stream_idle: Indikerar ifall samtliga inlämnade arrayer har matats ut.
+********************************************************************************/
+static inline bool stream_idle(void)
+{
+   return stream_submitted == __atomic_load_n(&stream_completed, __ATOMIC_ACQUIRE);
+}
+
+#endif /* STREAM_H_ */
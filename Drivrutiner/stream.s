@@ -0,0 +1,255 @@
+/********************************************************************************
+* stream.s: Innehåller drivrutiner för icke-blockerande utmatning av arrayer
+*           till ett destinationsregister, motsvarande stream.h.
+*
+*           En array lämnas över via stream_submit, som returnerar direkt.
+*           Avbrottsrutinen stream_isr skriver sedan ett element per
+*           period till destinationsregistret. Upp till STREAM_BUFFERS
+*           arrayer kan vara inlämnade samtidigt, så att nästa array kan
+*           fyllas medan föregående matas ut (dubbel buffring).
+*
+*           Anroparen skriver enbart till stream_submitted och
+*           avbrottsrutinen enbart till stream_completed, så att avbrott
+*           inte behöver inaktiveras vid inlämning. En inlämnad array får
+*           inte ändras förrän stream_ready indikerar att dess buffert har
+*           frigjorts.
+*
+*           Intervalltimern används med periodiska avbrott och ägs därmed
+*           av stream_isr, se timer_claim i timer.s. Avbrott måste
+*           aktiveras globalt via irq_global_enable efter stream_init.
+********************************************************************************/
+.ifndef STREAM_S_
+.equ STREAM_S_, 0
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+.include "../Drivrutiner/irq.s"
+.include "../Drivrutiner/timer.s"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ STREAM_BUFFERS    , 2                  /* Antal samtidigt inlämnade arrayer. */
+.equ STREAM_MASK       , STREAM_BUFFERS - 1 /* Bitmask för omvandling av index till buffert. */
+.equ STREAM_BUFFER_DATA, 0                  /* Referens till arrayens första element. */
+.equ STREAM_BUFFER_SIZE, 4                  /* Antalet element i arrayen. */
+
+/********************************************************************************
+* stream_isr: Avbrottsrutin för intervalltimern. Nästa element i äldsta
+*             inlämnade array skrivs till destinationsregistret. Efter
+*             arrayens sista element frigörs dess buffert, varefter nästa
+*             inlämnade array matas ut vid nästa avbrott. Saknas inlämnade
+*             arrayer behålls senast skrivna värde.
+********************************************************************************/
+stream_isr:
+   addi sp, sp, -28                     /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 24(sp)                       /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 20(sp)                       /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 16(sp)                       /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 12(sp)                       /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 8(sp)                        /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 4(sp)                        /* Sparar undan innehållet i r7 inför användning. */
+   stw r8, 0(sp)                        /* Sparar undan innehållet i r8 inför användning. */
+   movhi r2, %hiadj(TIMER_BASE)         /* Läser in TIMER_BASE[31:16] i r2. */
+   addi r2, r2, %lo(TIMER_BASE)         /* Lägger till TIMER_BASE[15:0] i r2. */
+   stwio zero, TIMER_STATUS_REG(r2)     /* Nollställer biten TO samt avbrottet. */
+   movhi r5, %hiadj(stream_completed)   /* Läser in adressen till stream_completed i r5. */
+   addi r5, r5, %lo(stream_completed)   /* Lägger till adressens lägre bitar i r5. */
+   ldw r3, 0(r5)                        /* Läser in antalet utmatade arrayer i r3. */
+   movhi r2, %hiadj(stream_submitted)   /* Läser in adressen till stream_submitted i r2. */
+   addi r2, r2, %lo(stream_submitted)   /* Lägger till adressens lägre bitar i r2. */
+   ldw r2, 0(r2)                        /* Läser in antalet inlämnade arrayer i r2. */
+   beq r2, r3, stream_isr_end           /* Saknas inlämnade arrayer avslutas avbrottet. */
+   andi r2, r3, STREAM_MASK             /* Beräknar index för äldsta inlämnade buffert. */
+   slli r2, r2, 3                       /* Beräknar buffertens offset, åtta byte per buffert. */
+   movhi r4, %hiadj(stream_queue)       /* Läser in adressen till stream_queue i r4. */
+   addi r4, r4, %lo(stream_queue)       /* Lägger till adressens lägre bitar i r4. */
+   add r4, r4, r2                       /* Pekar på äldsta inlämnade buffert. */
+   movhi r6, %hiadj(stream_index)       /* Läser in adressen till stream_index i r6. */
+   addi r6, r6, %lo(stream_index)       /* Lägger till adressens lägre bitar i r6. */
+   ldw r2, 0(r6)                        /* Läser in index för nästa element i r2. */
+   ldw r7, STREAM_BUFFER_DATA(r4)       /* Läser in referensen till arrayen i r7. */
+   ldw r4, STREAM_BUFFER_SIZE(r4)       /* Läser in arrayens storlek i r4. */
+   slli r8, r2, 2                       /* Beräknar elementets offset i arrayen. */
+   add r7, r7, r8                       /* Pekar på nästa element att mata ut. */
+   ldw r7, 0(r7)                        /* Läser in elementet i r7. */
+   movhi r8, %hiadj(stream_destination) /* Läser in adressen till stream_destination i r8. */
+   addi r8, r8, %lo(stream_destination) /* Lägger till adressens lägre bitar i r8. */
+   ldw r8, 0(r8)                        /* Läser in referensen till destinationsregistret. */
+   stwio r7, 0(r8)                      /* Skriver elementet till destinationsregistret. */
+   addi r2, r2, 1                       /* Räknar upp index till nästa element. */
+   bltu r2, r4, stream_isr_next         /* Om element återstår lagras nytt index. */
+   stw zero, 0(r6)                      /* Annars börjar nästa array från första elementet, */
+   addi r3, r3, 1                       /* antalet utmatade arrayer räknas upp */
+   stw r3, 0(r5)                        /* och bufferten frigörs. */
+   br stream_isr_end                    /* Avslutar avbrottet. */
+stream_isr_next:
+   stw r2, 0(r6)                        /* Lagrar index för nästa element. */
+stream_isr_end:
+   ldw r8, 0(sp)                        /* Återställer r8 efter användning. */
+   ldw r7, 4(sp)                        /* Återställer r7 efter användning. */
+   ldw r6, 8(sp)                        /* Återställer r6 efter användning. */
+   ldw r5, 12(sp)                       /* Återställer r5 efter användning. */
+   ldw r4, 16(sp)                       /* Återställer r4 efter användning. */
+   ldw r3, 20(sp)                       /* Återställer r3 efter användning. */
+   ldw r2, 24(sp)                       /* Återställer r2 efter användning. */
+   addi sp, sp, 28                      /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* stream_init: Initierar utmatningen till angivet destinationsregister och
+*              startar intervalltimern med periodiska avbrott, där ett
+*              element matas ut per period. Antalet klockpulser per period
+*              beräknas som us * 50 via skiftning. Ägs intervalltimern
+*              redan av en annan drivrutin returneras felkod 1 via r2 utan
+*              att timern påverkas, annars 0. Avbrott måste därefter
+*              aktiveras globalt via irq_global_enable.
+*
+*              - r2: Referens till destinationsregistret.
+*              - r3: Tid mellan varje utmatat element i mikrosekunder.
+********************************************************************************/
+stream_init:
+   addi sp, sp, -20                     /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 16(sp)                       /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 12(sp)                       /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 8(sp)                        /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 4(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 0(sp)                        /* Sparar undan innehållet i r6 inför användning. */
+   mov r6, r2                           /* Lagrar referensen till destinationsregistret i r6. */
+   movhi r2, %hiadj(stream_isr)         /* Läser in adressen till stream_isr i r2. */
+   addi r2, r2, %lo(stream_isr)         /* Lägger till adressens lägre bitar i r2. */
+   call timer_claim                     /* Gör anspråk på intervalltimern. */
+   bne r2, zero, stream_init_end        /* Ägs timern av en annan drivrutin returneras 1. */
+   movhi r4, %hiadj(stream_destination) /* Läser in adressen till stream_destination i r4. */
+   addi r4, r4, %lo(stream_destination) /* Lägger till adressens lägre bitar i r4. */
+   stw r6, 0(r4)                        /* Lagrar referensen till destinationsregistret. */
+   movhi r4, %hiadj(stream_submitted)   /* Läser in adressen till stream_submitted i r4. */
+   addi r4, r4, %lo(stream_submitted)   /* Lägger till adressens lägre bitar i r4. */
+   stw zero, 0(r4)                      /* Nollställer antalet inlämnade arrayer. */
+   movhi r4, %hiadj(stream_completed)   /* Läser in adressen till stream_completed i r4. */
+   addi r4, r4, %lo(stream_completed)   /* Lägger till adressens lägre bitar i r4. */
+   stw zero, 0(r4)                      /* Nollställer antalet utmatade arrayer. */
+   movhi r4, %hiadj(stream_index)       /* Läser in adressen till stream_index i r4. */
+   addi r4, r4, %lo(stream_index)       /* Lägger till adressens lägre bitar i r4. */
+   stw zero, 0(r4)                      /* Börjar från första elementet. */
+   slli r4, r3, 5                       /* Beräknar us * 32 i r4. */
+   slli r5, r3, 4                       /* Beräknar us * 16 i r5. */
+   add r4, r4, r5                       /* Lägger till us * 16 i r4. */
+   add r4, r4, r3                       /* Lägger till us * 1 i r4. */
+   add r4, r4, r3                       /* Lägger till us * 1 i r4, totalt us * 50. */
+   movi r2, TIMER_IRQ                   /* Läser in intervalltimerns avbrottsnummer i r2. */
+   movhi r3, %hiadj(stream_isr)         /* Läser in adressen till stream_isr i r3. */
+   addi r3, r3, %lo(stream_isr)         /* Lägger till adressens lägre bitar i r3. */
+   call irq_register                    /* Registrerar avbrottsrutinen för timern. */
+   mov r2, r4                           /* Läser in periodens längd i klockpulser i r2. */
+   call timer_periodic_start            /* Startar periodisk nedräkning med avbrott. */
+   movi r2, 0                           /* Lagrar returkod 0 i r2. */
+stream_init_end:
+   ldw r6, 0(sp)                        /* Återställer r6 efter användning. */
+   ldw r5, 4(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 8(sp)                        /* Återställer r4 efter användning. */
+   ldw r3, 12(sp)                       /* Återställer r3 efter användning. */
+   ldw ra, 16(sp)                       /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 20                      /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* stream_submit: Lämnar in angiven array för utmatning och returnerar 1 via
+*                r2 direkt, utan att vänta på utmatningen. Om samtliga
+*                buffertar är upptagna, eller arrayen saknar element,
+*                returneras 0.
+*
+*                - r2: Referens till arrayen (pekar på första elementet).
+*                - r3: Arrayens storlek, dvs. antalet element den rymmer.
+********************************************************************************/
+stream_submit:
+   addi sp, sp, -16                     /* Allokerar minne för lokala variabler på stacken. */
+   stw r4, 12(sp)                       /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 8(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 4(sp)                        /* Sparar undan innehållet i r6 inför användning. */
+   stw r7, 0(sp)                        /* Sparar undan innehållet i r7 inför användning. */
+   beq r3, zero, stream_submit_error    /* En tom array lämnas inte in. */
+   movhi r4, %hiadj(stream_submitted)   /* Läser in adressen till stream_submitted i r4. */
+   addi r4, r4, %lo(stream_submitted)   /* Lägger till adressens lägre bitar i r4. */
+   ldw r5, 0(r4)                        /* Läser in antalet inlämnade arrayer i r5. */
+   movhi r6, %hiadj(stream_completed)   /* Läser in adressen till stream_completed i r6. */
+   addi r6, r6, %lo(stream_completed)   /* Lägger till adressens lägre bitar i r6. */
+   ldw r6, 0(r6)                        /* Läser in antalet utmatade arrayer i r6. */
+   sub r6, r5, r6                       /* Beräknar antalet upptagna buffertar i r6. */
+   cmpltui r6, r6, STREAM_BUFFERS       /* Indikerar ifall en buffert är ledig. */
+   beq r6, zero, stream_submit_error    /* Är samtliga buffertar upptagna returneras 0. */
+   andi r6, r5, STREAM_MASK             /* Beräknar index för nästa lediga buffert. */
+   slli r6, r6, 3                       /* Beräknar buffertens offset, åtta byte per buffert. */
+   movhi r7, %hiadj(stream_queue)       /* Läser in adressen till stream_queue i r7. */
+   addi r7, r7, %lo(stream_queue)       /* Lägger till adressens lägre bitar i r7. */
+   add r7, r7, r6                       /* Pekar på nästa lediga buffert. */
+   stw r2, STREAM_BUFFER_DATA(r7)       /* Lagrar referensen till arrayen. */
+   stw r3, STREAM_BUFFER_SIZE(r7)       /* Lagrar arrayens storlek. */
+   addi r5, r5, 1                       /* Räknar upp antalet inlämnade arrayer, */
+   stw r5, 0(r4)                        /* varefter arrayen matas ut av avbrottsrutinen. */
+   movi r2, 1                           /* Lagrar returvärde 1 i r2. */
+   br stream_submit_end                 /* Avslutar subrutinen. */
+stream_submit_error:
+   movi r2, 0                           /* Lagrar returvärde 0 i r2. */
+stream_submit_end:
+   ldw r7, 0(sp)                        /* Återställer r7 efter användning. */
+   ldw r6, 4(sp)                        /* Återställer r6 efter användning. */
+   ldw r5, 8(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 12(sp)                       /* Återställer r4 efter användning. */
+   addi sp, sp, 16                      /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* stream_ready: Indikerar ifall en buffert är ledig via r2 (1 = ledig), så
+*               att en ny array kan lämnas in via stream_submit.
+********************************************************************************/
+stream_ready:
+   addi sp, sp, -4                      /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 0(sp)                        /* Sparar undan innehållet i r3 inför användning. */
+   movhi r2, %hiadj(stream_submitted)   /* Läser in adressen till stream_submitted i r2. */
+   addi r2, r2, %lo(stream_submitted)   /* Lägger till adressens lägre bitar i r2. */
+   ldw r2, 0(r2)                        /* Läser in antalet inlämnade arrayer i r2. */
+   movhi r3, %hiadj(stream_completed)   /* Läser in adressen till stream_completed i r3. */
+   addi r3, r3, %lo(stream_completed)   /* Lägger till adressens lägre bitar i r3. */
+   ldw r3, 0(r3)                        /* Läser in antalet utmatade arrayer i r3. */
+   sub r2, r2, r3                       /* Beräknar antalet upptagna buffertar i r2. */
+   cmpltui r2, r2, STREAM_BUFFERS       /* Indikerar ifall en buffert är ledig. */
+   ldw r3, 0(sp)                        /* Återställer r3 efter användning. */
+   addi sp, sp, 4                       /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* stream_idle: Indikerar ifall samtliga inlämnade arrayer har matats ut via
+*              r2 (1 = samtliga utmatade).
+********************************************************************************/
+stream_idle:
+   addi sp, sp, -4                      /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 0(sp)                        /* Sparar undan innehållet i r3 inför användning. */
+   movhi r2, %hiadj(stream_submitted)   /* Läser in adressen till stream_submitted i r2. */
+   addi r2, r2, %lo(stream_submitted)   /* Lägger till adressens lägre bitar i r2. */
+   ldw r2, 0(r2)                        /* Läser in antalet inlämnade arrayer i r2. */
+   movhi r3, %hiadj(stream_completed)   /* Läser in adressen till stream_completed i r3. */
+   addi r3, r3, %lo(stream_completed)   /* Lägger till adressens lägre bitar i r3. */
+   ldw r3, 0(r3)                        /* Läser in antalet utmatade arrayer i r3. */
+   cmpeq r2, r2, r3                     /* Indikerar ifall samtliga arrayer är utmatade. */
+   ldw r3, 0(sp)                        /* Återställer r3 efter användning. */
+   addi sp, sp, 4                       /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats för inlämnade arrayer.
+********************************************************************************/
+.data
+stream_destination: .skip 4                  /* Referens till destinationsregistret. */
+stream_queue:       .skip STREAM_BUFFERS * 8 /* Inlämnade arrayer, åtta byte per buffert. */
+stream_submitted:   .skip 4                  /* Antal inlämnade arrayer, ägs av anroparen. */
+stream_completed:   .skip 4                  /* Antal utmatade arrayer, ägs av avbrottsrutinen. */
+stream_index:       .skip 4                  /* Index för nästa element att mata ut. */
+
+/********************************************************************************
+* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+
+.endif /* STREAM_S_ */
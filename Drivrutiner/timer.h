@@ -0,0 +1,281 @@
+/********************************************************************************
+* timer.h: Innehåller drivrutiner för fördröjning via intervalltimern, som
+*          ersättning för fördröjningsloopar som räknar upp till en konstant.
+*          Intervalltimern räknar kontinuerligt ned från 0xFFFFFFFF med
+*          klockfrekvensen TIMER_CLOCK_HZ, vilket ger en tidsbas som är
+*          oberoende av kompilatorflaggor och exekveringshastighet.
+*
+*          Blockerande fördröjning genereras via delay_us samt delay_ms.
+*          Icke-blockerande fördröjning genereras via strukten
+*          timer_deadline, där timer_deadline_reached indikerar ifall angiven
+*          tid har passerat, så att processorn kan utföra annat arbete under
+*          tiden. Avbrott är fortsatt aktiva under fördröjningen.
+*
+*          Basadressen väljs via makrot GPIO_CASE_GOLD_HW, som därmed måste
+*          definieras innan timer.h inkluderas. Adressen för CASE GOLD är
+*          ett antagande och kan ersättas genom att definiera TIMER_BASE
+*          innan timer.h inkluderas (exempelvis via gcc -DTIMER_BASE=...).
+*
+*          Avbrottsdrivna drivrutiner (led_pwm.h, stream.h samt sched.h)
+*          programmerar om intervalltimerns period och måste därför först
+*          göra anspråk på timern via timer_claim. Timern kan enbart ägas
+*          av en avbrottsrutin åt gången, så fördröjningar via timer_ticks
+*          kan inte användas medan timern ägs av en drivrutin.
+*
+*          Vid kompilering för Linux (gcc -DNIOS2_HOST) används systemets
+*          monotona klocka som tidsbas, medan intervalltimerns register
+*          ersätts av en array för de avbrottsdrivna drivrutinerna.
+********************************************************************************/
+#ifndef TIMER_H_
+#define TIMER_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef NIOS2_HOST
+#include <time.h>
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define TIMER_CLOCK_HZ     50000000UL                 /* Intervalltimerns klockfrekvens. */
+#define TIMER_TICKS_PER_US (TIMER_CLOCK_HZ / 1000000) /* Antal klockpulser per mikrosekund. */
+#define TIMER_TICKS_PER_MS (TIMER_CLOCK_HZ / 1000)    /* Antal klockpulser per millisekund. */
+#define TIMER_IRQ          0                          /* Avbrottsnummer för intervalltimern. */
+
+/********************************************************************************
+* Index för intervalltimerns register relativt basadressen:
+********************************************************************************/
+#define TIMER_STATUS_REG  0 /* Statusregister (TO samt RUN). */
+#define TIMER_CONTROL_REG 1 /* Kontrollregister (ITO, CONT, START samt STOP). */
+#define TIMER_PERIODL_REG 2 /* Periodens lägre 16 bitar. */
+#define TIMER_PERIODH_REG 3 /* Periodens högre 16 bitar. */
+#define TIMER_SNAPL_REG   4 /* Avläst räknarvärde, lägre 16 bitar. */
+#define TIMER_SNAPH_REG   5 /* Avläst räknarvärde, högre 16 bitar. */
+
+/********************************************************************************
+* Bitar i intervalltimerns kontrollregister:
+********************************************************************************/
+#define TIMER_CONTROL_ITO   0x01 /* Avbrott vid nedräkning till noll. */
+#define TIMER_CONTROL_CONT  0x02 /* Kontinuerlig räkning med omladdning. */
+#define TIMER_CONTROL_START 0x04 /* Startar timern. */
+#define TIMER_CONTROL_STOP  0x08 /* Stoppar timern. */
+
+/********************************************************************************
+* Basadress för intervalltimern. Adressen för CASE GOLD är inte dokumenterad,
+* utan antagen utifrån PIO-enheternas placering (0x8091740 - 0x8091760).
+* Kontrollera adressen i hårdvarans Platform Designer-system och definiera
+* TIMER_BASE innan timer.h inkluderas ifall den avviker, annars fungerar
+* ingen av drivrutinerna som använder intervalltimern.
+********************************************************************************/
+#ifndef TIMER_BASE
+#if defined(NIOS2_HOST)
+static volatile uint32_t timer_host_regs[TIMER_SNAPH_REG + 1]; /* Ersättning för intervalltimern. */
+#define TIMER_BASE (timer_host_regs)                           /* Basadress för intervalltimern (Linux). */
+#elif defined(GPIO_CASE_GOLD_HW)
+#define TIMER_BASE (volatile uint32_t*)(0x8091720)  /* Basadress för intervalltimern (antagen). */
+#else
+#define TIMER_BASE (volatile uint32_t*)(0xFF202000) /* Basadress för intervalltimern. */
+#endif /* NIOS2_HOST */
+#endif /* TIMER_BASE */
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static void (*timer_owner)(void); /* Avbrottsrutin som äger intervalltimern. */
+
+/********************************************************************************
+* timer_deadline: Strukt för icke-blockerande fördröjning. Starttiden samt
+*                 fördröjningens längd lagras i klockpulser, vilket medger
+*                 fördröjningar upp till cirka 85 sekunder.
+********************************************************************************/
+struct timer_deadline
+{
+   uint32_t start; /* Tidpunkt då fördröjningen startades. */
+   uint32_t ticks; /* Fördröjningens längd i antal klockpulser. */
+};
+
+#ifdef NIOS2_HOST
+/********************************************************************************
+* timer_init: Ingen initiering krävs vid kompilering för Linux, då systemets
+*             monotona klocka används som tidsbas.
+********************************************************************************/
+static inline void timer_init(void)
+{
+   return;
+}
+
+/********************************************************************************
+* timer_ticks: Returnerar systemets monotona klocka omräknad till antal
+*              klockpulser med frekvensen TIMER_CLOCK_HZ.
+********************************************************************************/
+static inline uint32_t timer_ticks(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint32_t)((uint64_t)now.tv_sec * TIMER_CLOCK_HZ +
+                     (uint64_t)now.tv_nsec / (1000000000UL / TIMER_CLOCK_HZ));
+}
+#else
+/********************************************************************************
+* timer_init: Startar intervalltimern för kontinuerlig nedräkning från
+*             0xFFFFFFFF utan avbrott. Måste anropas innan övriga funktioner.
+********************************************************************************/
+static inline void timer_init(void)
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   timer[TIMER_CONTROL_REG] = TIMER_CONTROL_STOP;
+   timer[TIMER_PERIODL_REG] = 0xFFFF;
+   timer[TIMER_PERIODH_REG] = 0xFFFF;
+   timer[TIMER_STATUS_REG] = 0;
+   timer[TIMER_CONTROL_REG] = TIMER_CONTROL_CONT | TIMER_CONTROL_START;
+   return;
+}
+
+/********************************************************************************
+* timer_ticks: Returnerar antalet klockpulser sedan intervalltimern startades.
+*              Räknarvärdet läses av via snapl samt snaph och inverteras, då
+*              timern räknar ned. Värdet slår runt efter cirka 85 sekunder.
+********************************************************************************/
+static inline uint32_t timer_ticks(void)
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   timer[TIMER_SNAPL_REG] = 0;
+   return ~((timer[TIMER_SNAPH_REG] << 16) | (timer[TIMER_SNAPL_REG] & 0xFFFF));
+}
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* timer_claim: Gör anspråk på intervalltimern för angiven avbrottsrutin och
+*              stoppar timern inför omprogrammering. Ägs timern redan av en
+*              annan avbrottsrutin returneras felkod 1 utan att timern
+*              påverkas, annars 0. Avbrottsrutinen registreras sedan av
+*              anroparen via irq_register(TIMER_IRQ, isr).
+*
+*              - isr: Avbrottsrutinen som ska äga intervalltimern.
+********************************************************************************/
+static inline int timer_claim(void (*isr)(void))
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   if (timer_owner && timer_owner != isr) return 1;
+   timer_owner = isr;
+   timer[TIMER_CONTROL_REG] = TIMER_CONTROL_STOP;
+   return 0;
+}
+
+/********************************************************************************
+* timer_periodic_start: Startar intervalltimern med ett avbrott var angivet
+*                       antal klockpulser. Timern måste först ha gjorts
+*                       anspråk på via timer_claim.
+*
+*                       - ticks: Tid mellan varje avbrott i klockpulser.
+********************************************************************************/
+static inline void timer_periodic_start(const uint32_t ticks)
+{
+   volatile uint32_t* const timer = TIMER_BASE;
+   const uint32_t period = ticks - 1;
+   timer[TIMER_PERIODL_REG] = period & 0xFFFF;
+   timer[TIMER_PERIODH_REG] = period >> 16;
+   timer[TIMER_STATUS_REG] = 0;
+   timer[TIMER_CONTROL_REG] = TIMER_CONTROL_ITO | TIMER_CONTROL_CONT | TIMER_CONTROL_START;
+   return;
+}
+
+/********************************************************************************
+* timer_wait: Väntar tills angivet antal klockpulser har passerat sedan
+*             refererad starttid. Starttiden räknas sedan upp med antalet
+*             klockpulser, så att upprepade anrop inte ackumulerar fel.
+*
+*             - start: Referens till starttiden i antal klockpulser.
+*             - ticks: Antalet klockpulser att vänta.
+********************************************************************************/
+static inline void timer_wait(uint32_t* start,
+                              const uint32_t ticks)
+{
+   while (timer_ticks() - *start < ticks);
+   *start += ticks;
+   return;
+}
+
+/********************************************************************************
+* delay_ms: Genererar blockerande fördröjning mätt i millisekunder.
+*
+*           - ms: Fördröjningens längd i millisekunder.
+********************************************************************************/
+static inline void delay_ms(const uint32_t ms)
+{
+   uint32_t start = timer_ticks();
+
+   for (uint32_t i = 0; i < ms; ++i)
+   {
+      timer_wait(&start, TIMER_TICKS_PER_MS);
+   }
+   return;
+}
+
+/********************************************************************************
+* delay_us: Genererar blockerande fördröjning mätt i mikrosekunder. Hela
+*           millisekunder väntas in en i taget, följt av resterande
+*           mikrosekunder, så att division undviks.
+*
+*           - us: Fördröjningens längd i mikrosekunder.
+********************************************************************************/
+static inline void delay_us(const uint32_t us)
+{
+   uint32_t start = timer_ticks();
+   uint32_t remaining = us;
+
+   while (remaining >= 1000)
+   {
+      timer_wait(&start, TIMER_TICKS_PER_MS);
+      remaining -= 1000;
+   }
+   timer_wait(&start, remaining * TIMER_TICKS_PER_US);
+   return;
+}
+
+/********************************************************************************
+* timer_deadline_init: Startar en icke-blockerande fördröjning av angiven
+*                      längd i mikrosekunder (maximalt cirka 85 sekunder).
+*
+*                      - self: Referens till fördröjningen.
+*                      - us  : Fördröjningens längd i mikrosekunder.
+********************************************************************************/
+static inline void timer_deadline_init(struct timer_deadline* self,
+                                       const uint32_t us)
+{
+   self->start = timer_ticks();
+   self->ticks = us * TIMER_TICKS_PER_US;
+   return;
+}
+
+/********************************************************************************
+* timer_deadline_reached: Indikerar ifall fördröjningens tid har passerat.
+*                         Funktionen blockerar inte, utan kan anropas
+*                         upprepade gånger från en huvudloop.
+*
+*                         - self: Referens till fördröjningen.
+********************************************************************************/
+static inline bool timer_deadline_reached(const struct timer_deadline* self)
+{
+   return timer_ticks() - self->start >= self->ticks;
+}
+
+/********************************************************************************
+* timer_deadline_restart: Startar om fördröjningen med samma längd, räknat
+*                         från föregående fördröjnings sluttid. Därmed kan
+*                         periodiska händelser genereras utan drift.
+*
+*                         - self: Referens till fördröjningen.
+********************************************************************************/
+static inline void timer_deadline_restart(struct timer_deadline* self)
+{
+   self->start += self->ticks;
+   return;
+}
+
+#endif /* TIMER_H_ */
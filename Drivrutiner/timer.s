@@ -0,0 +1,364 @@
+/********************************************************************************
+* timer.s: Innehåller drivrutiner för fördröjning via intervalltimern, som
+*          ersättning för fördröjningsloopar som räknar upp till en konstant.
+*          Intervalltimern räknar kontinuerligt ned från 0xFFFFFFFF med
+*          klockfrekvensen 50 MHz, vilket ger en tidsbas som är oberoende av
+*          exekveringshastighet.
+*
+*          Blockerande fördröjning genereras via delay_us samt delay_ms.
+*          Icke-blockerande fördröjning genereras via en timer_deadline
+*          (TIMER_DEADLINE_SIZE byte), där timer_deadline_reached indikerar
+*          ifall angiven tid har passerat.
+*
+*          Basadressen väljs via symbolen GPIO_CASE_GOLD_HW, som därmed måste
+*          definieras innan timer.s inkluderas. Adressen för CASE GOLD är
+*          ett antagande och kan ersättas genom att definiera TIMER_BASE
+*          innan timer.s inkluderas. Subrutinen timer_init måste anropas
+*          innan övriga subrutiner.
+*
+*          Avbrottsdrivna drivrutiner (led_pwm.s, stream.s samt sched.s)
+*          programmerar om intervalltimerns period och måste därför först
+*          göra anspråk på timern via timer_claim. Timern kan enbart ägas
+*          av en avbrottsrutin åt gången, så fördröjningar via timer_ticks
+*          kan inte användas medan timern ägs av en drivrutin.
+********************************************************************************/
+.ifndef TIMER_S_
+.equ TIMER_S_, 0
+
+/********************************************************************************
+* Basadress för intervalltimern. Adressen för CASE GOLD är inte dokumenterad,
+* utan antagen utifrån PIO-enheternas placering (0x8091740 - 0x8091760).
+* Kontrollera adressen i hårdvarans Platform Designer-system och definiera
+* TIMER_BASE innan timer.s inkluderas ifall den avviker, annars fungerar
+* ingen av drivrutinerna som använder intervalltimern.
+********************************************************************************/
+.ifndef TIMER_BASE
+.ifdef GPIO_CASE_GOLD_HW
+.equ TIMER_BASE, 0x8091720  /* Basadress för intervalltimern (CASE GOLD, antagen). */
+.else
+.equ TIMER_BASE, 0xFF202000 /* Basadress för intervalltimern (simulering). */
+.endif /* GPIO_CASE_GOLD_HW */
+.endif /* TIMER_BASE */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+.equ TIMER_TICKS_PER_MS, 50000 /* Antal klockpulser per millisekund vid 50 MHz. */
+.equ TIMER_IRQ, 0              /* Avbrottsnummer för intervalltimern. */
+
+/********************************************************************************
+* Offset för intervalltimerns register relativt basadressen:
+********************************************************************************/
+.equ TIMER_STATUS_REG, 0   /* Statusregister (TO samt RUN). */
+.equ TIMER_CONTROL_REG, 4  /* Kontrollregister (ITO, CONT, START samt STOP). */
+.equ TIMER_PERIODL_REG, 8  /* Periodens lägre 16 bitar. */
+.equ TIMER_PERIODH_REG, 12 /* Periodens högre 16 bitar. */
+.equ TIMER_SNAPL_REG, 16   /* Avläst räknarvärde, lägre 16 bitar. */
+.equ TIMER_SNAPH_REG, 20   /* Avläst räknarvärde, högre 16 bitar. */
+
+/********************************************************************************
+* Bitar i intervalltimerns kontrollregister:
+********************************************************************************/
+.equ TIMER_CONTROL_ITO, 0x01   /* Avbrott vid nedräkning till noll. */
+.equ TIMER_CONTROL_CONT, 0x02  /* Kontinuerlig räkning med omladdning. */
+.equ TIMER_CONTROL_START, 0x04 /* Startar timern. */
+.equ TIMER_CONTROL_STOP, 0x08  /* Stoppar timern. */
+
+/********************************************************************************
+* Offset för fälten i en timer_deadline:
+********************************************************************************/
+.equ TIMER_DEADLINE_START, 0 /* Tidpunkt då fördröjningen startades. */
+.equ TIMER_DEADLINE_TICKS, 4 /* Fördröjningens längd i antal klockpulser. */
+.equ TIMER_DEADLINE_SIZE, 8  /* Storlek för en timer_deadline i byte. */
+
+/********************************************************************************
+* timer_init: Startar intervalltimern för kontinuerlig nedräkning från
+*             0xFFFFFFFF utan avbrott.
+********************************************************************************/
+timer_init:
+   addi sp, sp, -8                  /* Allokerar minne för lokala variabler på stacken. */
+   stw r2, 4(sp)                    /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 0(sp)                    /* Sparar undan innehållet i r3 inför användning. */
+   movhi r2, %hiadj(TIMER_BASE)     /* Läser in TIMER_BASE[31:16] i r2. */
+   addi r2, r2, %lo(TIMER_BASE)     /* Lägger till TIMER_BASE[15:0] i r2. */
+   movi r3, TIMER_CONTROL_STOP      /* Läser in biten STOP i r3. */
+   stwio r3, TIMER_CONTROL_REG(r2)  /* Stoppar timern. */
+   movui r3, 0xFFFF                 /* Läser in periodens halvor i r3. */
+   stwio r3, TIMER_PERIODL_REG(r2)  /* Skriver periodens lägre 16 bitar. */
+   stwio r3, TIMER_PERIODH_REG(r2)  /* Skriver periodens högre 16 bitar. */
+   stwio zero, TIMER_STATUS_REG(r2) /* Nollställer biten TO. */
+   movi r3, TIMER_CONTROL_CONT      /* Läser in biten CONT i r3. */
+   ori r3, r3, TIMER_CONTROL_START  /* Lägger till biten START i r3. */
+   stwio r3, TIMER_CONTROL_REG(r2)  /* Startar kontinuerlig nedräkning. */
+   ldw r3, 0(sp)                    /* Återställer r3 efter användning. */
+   ldw r2, 4(sp)                    /* Återställer r2 efter användning. */
+   addi sp, sp, 8                   /* Återställer stackpekaren. */
+   ret                              /* Genomför återhopp. */
+
+/********************************************************************************
+* timer_ticks: Returnerar antalet klockpulser sedan intervalltimern startades
+*              via r2. Räknarvärdet läses av via snapl samt snaph och
+*              inverteras, då timern räknar ned.
+********************************************************************************/
+timer_ticks:
+   addi sp, sp, -8                 /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 4(sp)                   /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                   /* Sparar undan innehållet i r4 inför användning. */
+   movhi r3, %hiadj(TIMER_BASE)    /* Läser in TIMER_BASE[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_BASE)    /* Lägger till TIMER_BASE[15:0] i r3. */
+   stwio zero, TIMER_SNAPL_REG(r3) /* Läser av räknarvärdet till snapl samt snaph. */
+   ldwio r2, TIMER_SNAPH_REG(r3)   /* Läser in räknarvärdets högre 16 bitar i r2. */
+   slli r2, r2, 16                 /* Skiftar fram de högre bitarna till [31:16]. */
+   ldwio r4, TIMER_SNAPL_REG(r3)   /* Läser in räknarvärdets lägre 16 bitar i r4. */
+   andi r4, r4, 0xFFFF             /* Behåller enbart de lägre 16 bitarna. */
+   or r2, r2, r4                   /* Sammanställer räknarvärdet i r2. */
+   nor r2, r2, r2                  /* Inverterar räknarvärdet till förflutna klockpulser. */
+   ldw r4, 0(sp)                   /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                   /* Återställer r3 efter användning. */
+   addi sp, sp, 8                  /* Återställer stackpekaren. */
+   ret                             /* Genomför återhopp. */
+
+/********************************************************************************
+* timer_wait: Väntar tills angivet antal klockpulser har passerat sedan
+*             angiven starttid. Starttiden räknas sedan upp med antalet
+*             klockpulser och returneras via r2, så att upprepade anrop
+*             inte ackumulerar fel.
+*
+*             - r2: Starttiden i antal klockpulser.
+*             - r3: Antalet klockpulser att vänta.
+********************************************************************************/
+timer_wait:
+   addi sp, sp, -12             /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 8(sp)                /* Sparar undan återhoppsadressen i ra. */
+   stw r4, 4(sp)                /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 0(sp)                /* Sparar undan innehållet i r5 inför användning. */
+   mov r4, r2                   /* Kopierar starttiden till r4. */
+timer_wait_loop:
+   call timer_ticks             /* Läser in aktuellt antal klockpulser i r2. */
+   sub r5, r2, r4               /* Beräknar förflutna klockpulser sedan starttiden. */
+   bltu r5, r3, timer_wait_loop /* Fortsätter vänta tills tiden har passerat. */
+   add r2, r4, r3               /* Returnerar starttiden plus antalet klockpulser. */
+   ldw r5, 0(sp)                /* Återställer r5 efter användning. */
+   ldw r4, 4(sp)                /* Återställer r4 efter användning. */
+   ldw ra, 8(sp)                /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 12              /* Återställer stackpekaren. */
+   ret                          /* Genomför återhopp. */
+
+/********************************************************************************
+* delay_ms: Genererar blockerande fördröjning mätt i millisekunder.
+*
+*           - r2: Fördröjningens längd i millisekunder.
+********************************************************************************/
+delay_ms:
+   addi sp, sp, -16                     /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 12(sp)                       /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 8(sp)                        /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 4(sp)                        /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                        /* Sparar undan innehållet i r4 inför användning. */
+   mov r4, r2                           /* Använder r4 som nedräknare för millisekunder. */
+   call timer_ticks                     /* Läser in starttiden i r2. */
+   movhi r3, %hiadj(TIMER_TICKS_PER_MS) /* Läser in TIMER_TICKS_PER_MS[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_TICKS_PER_MS) /* Lägger till TIMER_TICKS_PER_MS[15:0] i r3. */
+delay_ms_loop:
+   beq r4, zero, delay_ms_end           /* Avslutar när samtliga millisekunder har passerat. */
+   call timer_wait                      /* Väntar en millisekund, ny starttid lagras i r2. */
+   subi r4, r4, 1                       /* Räknar ned antalet återstående millisekunder. */
+   br delay_ms_loop                     /* Återstartar loopen. */
+delay_ms_end:
+   ldw r4, 0(sp)                        /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                        /* Återställer r3 efter användning. */
+   ldw r2, 8(sp)                        /* Återställer r2 efter användning. */
+   ldw ra, 12(sp)                       /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 16                      /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* delay_us: Genererar blockerande fördröjning mätt i mikrosekunder. Hela
+*           millisekunder väntas in en i taget, följt av resterande
+*           mikrosekunder, så att division undviks. Antalet klockpulser för
+*           resterande mikrosekunder beräknas som us * 50 = us * (32 + 16 + 2)
+*           via skiftning, så att hårdvarumultiplikator inte krävs.
+*
+*           - r2: Fördröjningens längd i mikrosekunder.
+********************************************************************************/
+delay_us:
+   addi sp, sp, -24                     /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 20(sp)                       /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 16(sp)                       /* Sparar undan innehållet i r2 inför användning. */
+   stw r3, 12(sp)                       /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 8(sp)                        /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 4(sp)                        /* Sparar undan innehållet i r5 inför användning. */
+   stw r6, 0(sp)                        /* Sparar undan innehållet i r6 inför användning. */
+   mov r4, r2                           /* Lagrar återstående mikrosekunder i r4. */
+   movi r5, 1000                        /* Läser in antalet mikrosekunder per millisekund i r5. */
+   call timer_ticks                     /* Läser in starttiden i r2. */
+   movhi r3, %hiadj(TIMER_TICKS_PER_MS) /* Läser in TIMER_TICKS_PER_MS[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_TICKS_PER_MS) /* Lägger till TIMER_TICKS_PER_MS[15:0] i r3. */
+delay_us_loop:
+   bltu r4, r5, delay_us_rest           /* Under en millisekund återstår, väntar in resten. */
+   call timer_wait                      /* Väntar en millisekund, ny starttid lagras i r2. */
+   sub r4, r4, r5                       /* Räknar ned återstående mikrosekunder. */
+   br delay_us_loop                     /* Återstartar loopen. */
+delay_us_rest:
+   slli r3, r4, 5                       /* Beräknar us * 32 i r3. */
+   slli r6, r4, 4                       /* Beräknar us * 16 i r6. */
+   add r3, r3, r6                       /* Lägger till us * 16 i r3. */
+   add r3, r3, r4                       /* Lägger till us * 1 i r3. */
+   add r3, r3, r4                       /* Lägger till us * 1 i r3, totalt us * 50. */
+   call timer_wait                      /* Väntar in resterande mikrosekunder. */
+   ldw r6, 0(sp)                        /* Återställer r6 efter användning. */
+   ldw r5, 4(sp)                        /* Återställer r5 efter användning. */
+   ldw r4, 8(sp)                        /* Återställer r4 efter användning. */
+   ldw r3, 12(sp)                       /* Återställer r3 efter användning. */
+   ldw r2, 16(sp)                       /* Återställer r2 efter användning. */
+   ldw ra, 20(sp)                       /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 24                      /* Återställer stackpekaren. */
+   ret                                  /* Genomför återhopp. */
+
+/********************************************************************************
+* timer_deadline_init: Startar en icke-blockerande fördröjning av angiven
+*                      längd i mikrosekunder (maximalt cirka 85 sekunder).
+*                      Antalet klockpulser beräknas som us * 50 via skiftning.
+*
+*                      - r2: Referens till fördröjningen (timer_deadline).
+*                      - r3: Fördröjningens längd i mikrosekunder.
+********************************************************************************/
+timer_deadline_init:
+   addi sp, sp, -16                 /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 12(sp)                   /* Sparar undan återhoppsadressen i ra. */
+   stw r2, 8(sp)                    /* Sparar undan innehållet i r2 inför användning. */
+   stw r4, 4(sp)                    /* Sparar undan innehållet i r4 inför användning. */
+   stw r5, 0(sp)                    /* Sparar undan innehållet i r5 inför användning. */
+   mov r4, r2                       /* Kopierar referensen till fördröjningen till r4. */
+   call timer_ticks                 /* Läser in starttiden i r2. */
+   stw r2, TIMER_DEADLINE_START(r4) /* Lagrar starttiden. */
+   slli r2, r3, 5                   /* Beräknar us * 32 i r2. */
+   slli r5, r3, 4                   /* Beräknar us * 16 i r5. */
+   add r2, r2, r5                   /* Lägger till us * 16 i r2. */
+   add r2, r2, r3                   /* Lägger till us * 1 i r2. */
+   add r2, r2, r3                   /* Lägger till us * 1 i r2, totalt us * 50. */
+   stw r2, TIMER_DEADLINE_TICKS(r4) /* Lagrar fördröjningens längd i klockpulser. */
+   ldw r5, 0(sp)                    /* Återställer r5 efter användning. */
+   ldw r4, 4(sp)                    /* Återställer r4 efter användning. */
+   ldw r2, 8(sp)                    /* Återställer r2 efter användning. */
+   ldw ra, 12(sp)                   /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 16                  /* Återställer stackpekaren. */
+   ret                              /* Genomför återhopp. */
+
+/********************************************************************************
+* timer_deadline_reached: Indikerar ifall fördröjningens tid har passerat via
+*                         r2 (1 = passerat, 0 = ej passerat). Subrutinen
+*                         blockerar inte, utan kan anropas upprepade gånger.
+*
+*                         - r2: Referens till fördröjningen (timer_deadline).
+********************************************************************************/
+timer_deadline_reached:
+   addi sp, sp, -12                 /* Allokerar minne för lokala variabler på stacken. */
+   stw ra, 8(sp)                    /* Sparar undan återhoppsadressen i ra. */
+   stw r3, 4(sp)                    /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                    /* Sparar undan innehållet i r4 inför användning. */
+   mov r4, r2                       /* Kopierar referensen till fördröjningen till r4. */
+   call timer_ticks                 /* Läser in aktuellt antal klockpulser i r2. */
+   ldw r3, TIMER_DEADLINE_START(r4) /* Läser in starttiden i r3. */
+   sub r2, r2, r3                   /* Beräknar förflutna klockpulser sedan starttiden. */
+   ldw r3, TIMER_DEADLINE_TICKS(r4) /* Läser in fördröjningens längd i r3. */
+   cmpgeu r2, r2, r3                /* Returnerar 1 om tiden har passerat, annars 0. */
+   ldw r4, 0(sp)                    /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                    /* Återställer r3 efter användning. */
+   ldw ra, 8(sp)                    /* Återställer återhoppsadressen i ra. */
+   addi sp, sp, 12                  /* Återställer stackpekaren. */
+   ret                              /* Genomför återhopp. */
+
+/********************************************************************************
+* timer_deadline_restart: Startar om fördröjningen med samma längd, räknat
+*                         från föregående fördröjnings sluttid. Därmed kan
+*                         periodiska händelser genereras utan drift.
+*
+*                         - r2: Referens till fördröjningen (timer_deadline).
+********************************************************************************/
+timer_deadline_restart:
+   addi sp, sp, -8                  /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 4(sp)                    /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                    /* Sparar undan innehållet i r4 inför användning. */
+   ldw r3, TIMER_DEADLINE_START(r2) /* Läser in starttiden i r3. */
+   ldw r4, TIMER_DEADLINE_TICKS(r2) /* Läser in fördröjningens längd i r4. */
+   add r3, r3, r4                   /* Beräknar föregående fördröjnings sluttid. */
+   stw r3, TIMER_DEADLINE_START(r2) /* Lagrar sluttiden som ny starttid. */
+   ldw r4, 0(sp)                    /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                    /* Återställer r3 efter användning. */
+   addi sp, sp, 8                   /* Återställer stackpekaren. */
+   ret                              /* Genomför återhopp. */
+
+/********************************************************************************
+* timer_claim: Gör anspråk på intervalltimern för angiven avbrottsrutin och
+*              stoppar timern inför omprogrammering. Ägs timern redan av en
+*              annan avbrottsrutin returneras felkod 1 via r2 utan att
+*              timern påverkas, annars 0. Avbrottsrutinen registreras sedan
+*              av anroparen via irq_register.
+*
+*              - r2: Adressen till avbrottsrutinen som ska äga timern.
+********************************************************************************/
+timer_claim:
+   addi sp, sp, -8                 /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 4(sp)                   /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                   /* Sparar undan innehållet i r4 inför användning. */
+   movhi r3, %hiadj(timer_owner)   /* Läser in adressen till timer_owner i r3. */
+   addi r3, r3, %lo(timer_owner)   /* Lägger till adressens lägre bitar i r3. */
+   ldw r4, 0(r3)                   /* Läser in timerns nuvarande ägare i r4. */
+   beq r4, zero, timer_claim_take  /* Saknar timern ägare görs anspråk på den. */
+   bne r4, r2, timer_claim_error   /* Ägs timern av en annan rutin returneras 1. */
+timer_claim_take:
+   stw r2, 0(r3)                   /* Lagrar avbrottsrutinen som timerns ägare. */
+   movhi r3, %hiadj(TIMER_BASE)    /* Läser in TIMER_BASE[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_BASE)    /* Lägger till TIMER_BASE[15:0] i r3. */
+   movi r4, TIMER_CONTROL_STOP     /* Läser in biten STOP i r4. */
+   stwio r4, TIMER_CONTROL_REG(r3) /* Stoppar timern. */
+   movi r2, 0                      /* Lagrar returkod 0 i r2. */
+   br timer_claim_end              /* Avslutar subrutinen. */
+timer_claim_error:
+   movi r2, 1                      /* Lagrar returkod 1 i r2. */
+timer_claim_end:
+   ldw r4, 0(sp)                   /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                   /* Återställer r3 efter användning. */
+   addi sp, sp, 8                  /* Återställer stackpekaren. */
+   ret                             /* Genomför återhopp. */
+
+/********************************************************************************
+* timer_periodic_start: Startar intervalltimern med ett avbrott var angivet
+*                       antal klockpulser. Timern måste först ha gjorts
+*                       anspråk på via timer_claim.
+*
+*                       - r2: Tid mellan varje avbrott i klockpulser.
+********************************************************************************/
+timer_periodic_start:
+   addi sp, sp, -8                  /* Allokerar minne för lokala variabler på stacken. */
+   stw r3, 4(sp)                    /* Sparar undan innehållet i r3 inför användning. */
+   stw r4, 0(sp)                    /* Sparar undan innehållet i r4 inför användning. */
+   movhi r3, %hiadj(TIMER_BASE)     /* Läser in TIMER_BASE[31:16] i r3. */
+   addi r3, r3, %lo(TIMER_BASE)     /* Lägger till TIMER_BASE[15:0] i r3. */
+   subi r4, r2, 1                   /* Perioden räknas ned till och med noll. */
+   stwio r4, TIMER_PERIODL_REG(r3)  /* Skriver periodens lägre 16 bitar. */
+   srli r4, r4, 16                  /* Skiftar fram periodens högre 16 bitar. */
+   stwio r4, TIMER_PERIODH_REG(r3)  /* Skriver periodens högre 16 bitar. */
+   stwio zero, TIMER_STATUS_REG(r3) /* Nollställer biten TO samt avbrottet. */
+   movi r4, TIMER_CONTROL_ITO       /* Läser in biten ITO i r4. */
+   ori r4, r4, TIMER_CONTROL_CONT   /* Lägger till biten CONT i r4. */
+   ori r4, r4, TIMER_CONTROL_START  /* Lägger till biten START i r4. */
+   stwio r4, TIMER_CONTROL_REG(r3)  /* Startar periodisk nedräkning med avbrott. */
+   ldw r4, 0(sp)                    /* Återställer r4 efter användning. */
+   ldw r3, 4(sp)                    /* Återställer r3 efter användning. */
+   addi sp, sp, 8                   /* Återställer stackpekaren. */
+   ret                              /* Genomför återhopp. */
+
+/********************************************************************************
+* .data: Datasegment, lagringsplats för intervalltimerns ägare.
+********************************************************************************/
+.data
+timer_owner: .skip 4 /* Avbrottsrutin som äger intervalltimern (0 = ingen). */
+
+/********************************************************************************
+* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.
+********************************************************************************/
+.text
+
+.endif /* TIMER_S_ */
@@ -0,0 +1,261 @@
+/********************************************************************************
+* trace.h: Innehåller en inspelare av skrivningar till PIO-enheternas register,
+*          så att det i efterhand går att se vad som skrevs till exempelvis
+*          LEDS_BASE samt när. Inspelningen aktiveras via makrot MMIO_TRACE
+*          (-DMMIO_TRACE), annars kompileras TRACE_WRITE till en vanlig
+*          skrivning och TRACE_INIT till ingenting.
+*
+*          Varje skrivning via TRACE_WRITE lagras som en post om 8 byte i en
+*          ringbuffert av fast storlek TRACE_ENTRIES. Posterna är
+*          deltakodade: tiden lagras som antal klockpulser sedan föregående
+*          post och värdet som de bitar som ändrades (gammalt värde XOR nytt
+*          värde), där det gamla värdet hämtas från en skuggkopia i RAM i
+*          stället för att läsas tillbaka från registret. Därmed kostar en
+*          inspelad skrivning ingen extra läsning av I/O, men ändringar som
+*          hårdvaran gör i registret syns inte i inspelningen. Tider som
+*          inte ryms i 16 bitar lagras via en tidspost. Registrets adress
+*          lagras som avstånd i byte från lysdiodernas dataregister, vilket
+*          innebär att samtliga registrerade register måste ligga inom 256
+*          byte från detta.
+*
+*          Tidsstämplarna hämtas via makrot TRACE_TIME, som förvalt läser av
+*          intervalltimern via timer_ticks (klockpulser om TRACE_TIME_NS
+*          nanosekunder). Då intervalltimern används av en annan drivrutin
+*          definieras TRACE_TIME samt TRACE_TIME_NS innan trace.h
+*          inkluderas, exempelvis sched_time med 1000000 ns per tick.
+*
+*          På hårdvaran skrivs äldsta poster över när ringbufferten är full,
+*          så att de senaste TRACE_ENTRIES posterna kan läsas av via
+*          debuggern. Vid kompilering för Linux (gcc -DNIOS2_HOST) skrivs
+*          ringbufferten i stället till en binärfil varje gång en halva har
+*          fyllts samt vid programmets slut, så att inga poster går förlorade
+*          (avbryts programmet via en signal saknas de senast lagrade
+*          posterna). Filens sökväg anges via miljövariabeln TRACE_HOST_FILE,
+*          annars används TRACE_HOST_DEFAULT_FILE. Filen avkodas till CSV
+*          eller VCD (vågform) via Verktyg/trace_decode.c.
+*
+*          Basadressen som lagras i filen väljs via makrot GPIO_CASE_GOLD_HW,
+*          som därmed måste definieras innan trace.h inkluderas.
+********************************************************************************/
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/********************************************************************************
+* Inkluderingsdirektiv:
+********************************************************************************/
+#include <stdint.h>
+
+#ifdef MMIO_TRACE
+#include "timer.h"
+
+#ifdef NIOS2_HOST
+#include <stdio.h>
+#include <stdlib.h>
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* Lysdiodernas adress i hårdvaran, som lagras i filen:
+********************************************************************************/
+#if defined(GPIO_CASE_GOLD_HW)
+#define TRACE_LEDS_ADDRESS 0x8091740  /* Adress för lysdiodernas dataregister. */
+#else
+#define TRACE_LEDS_ADDRESS 0xFF200000 /* Adress för lysdiodernas dataregister. */
+#endif /* GPIO_CASE_GOLD_HW */
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#ifndef TRACE_TIME
+#define TRACE_TIME()  timer_ticks()                   /* Aktuell tidsstämpel. */
+#define TRACE_TIME_NS (1000000000UL / TIMER_CLOCK_HZ) /* Nanosekunder per tidsenhet. */
+#endif /* TRACE_TIME */
+
+#define TRACE_ENTRIES           1024                /* Antal poster i ringbufferten (tvåpotens). */
+#define TRACE_MASK              (TRACE_ENTRIES - 1) /* Bitmask för omvandling av index till post. */
+#define TRACE_HALF              (TRACE_ENTRIES / 2) /* Antal poster per halva av ringbufferten. */
+#define TRACE_HOST_DEFAULT_FILE "mmio_trace.bin"    /* Förvald fil vid kompilering för Linux. */
+#define TRACE_MAGIC             0x4352544DUL        /* Filens identifierare ("MTRC"). */
+
+/********************************************************************************
+* trace_kind: Enumeration för olika typer av poster:
+********************************************************************************/
+enum trace_kind
+{
+   TRACE_KIND_WRITE, /* Skrivning, value anger ändrade bitar. */
+   TRACE_KIND_TIME   /* Lång tid sedan föregående post, value anger tiden. */
+};
+
+/********************************************************************************
+* trace_entry: Strukt för en post i ringbufferten.
+********************************************************************************/
+struct trace_entry
+{
+   uint16_t delta; /* Tid sedan föregående post i antal tidsenheter. */
+   uint8_t offset; /* Registrets avstånd i byte från lysdiodernas dataregister. */
+   uint8_t kind;   /* Postens typ, se trace_kind. */
+   uint32_t value; /* Ändrade bitar eller tid beroende på typ. */
+};
+
+/********************************************************************************
+* trace_header: Strukt för binärfilens huvud, som följs av posterna.
+********************************************************************************/
+struct trace_header
+{
+   uint32_t magic;   /* Filens identifierare, se TRACE_MAGIC. */
+   uint32_t address; /* Lysdiodernas adress i hårdvaran. */
+   uint32_t time_ns; /* Nanosekunder per tidsenhet. */
+};
+
+/********************************************************************************
+* Globala variabler:
+********************************************************************************/
+static struct trace_entry trace_ring[TRACE_ENTRIES]; /* Ringbuffert med poster. */
+static uint32_t trace_shadow[256 / 4];               /* Senast skrivna värde per register. */
+static volatile uint32_t* trace_base;                /* Lysdiodernas dataregister. */
+static uint32_t trace_count;                         /* Antal lagrade poster sedan start. */
+static uint32_t trace_time;                          /* Tidsstämpel för föregående post. */
+
+#ifdef NIOS2_HOST
+static FILE* trace_file;       /* Binärfil som posterna skrivs till. */
+static uint32_t trace_flushed; /* Antal poster skrivna till filen. */
+
+/********************************************************************************
+* trace_flush: Skriver samtliga poster som ännu inte har skrivits till
+*              binärfilen. Anropas automatiskt då en halva av ringbufferten
+*              har fyllts samt vid programmets slut.
+********************************************************************************/
+static void trace_flush(void)
+{
+   if (!trace_file) return;
+
+   while (trace_flushed != trace_count)
+   {
+      const uint32_t index = trace_flushed & TRACE_MASK;
+      uint32_t count = trace_count - trace_flushed;
+      if (count > TRACE_ENTRIES - index) count = TRACE_ENTRIES - index;
+      fwrite(&trace_ring[index], sizeof(struct trace_entry), count, trace_file);
+      trace_flushed += count;
+   }
+   fflush(trace_file);
+   return;
+}
+#endif /* NIOS2_HOST */
+
+/********************************************************************************
+* trace_init: Nollställer inspelningen och lagrar lysdiodernas dataregister,
+*             relativt vilket registrens adresser lagras. Vid kompilering för
+*             Linux öppnas även binärfilen, varefter filhuvudet skrivs.
+*
+*             - base: Pekare till lysdiodernas dataregister.
+********************************************************************************/
+static inline void trace_init(volatile uint32_t* base)
+{
+   trace_base = base;
+   trace_count = 0;
+   trace_time = TRACE_TIME();
+
+   for (uint32_t i = 0; i < sizeof(trace_shadow) / sizeof(trace_shadow[0]); ++i)
+   {
+      trace_shadow[i] = 0;
+   }
+
+#ifdef NIOS2_HOST
+   const struct trace_header header = { TRACE_MAGIC, TRACE_LEDS_ADDRESS, TRACE_TIME_NS };
+   const char* path = getenv("TRACE_HOST_FILE") ? getenv("TRACE_HOST_FILE") : TRACE_HOST_DEFAULT_FILE;
+   trace_flushed = 0;
+   if (trace_file) fclose(trace_file);
+   trace_file = fopen(path, "wb");
+
+   if (!trace_file)
+   {
+      fprintf(stderr, "trace.h: kan inte öppna %s, posterna sparas inte\n", path);
+      return;
+   }
+   fwrite(&header, sizeof(header), 1, trace_file);
+   fflush(trace_file);
+   atexit(trace_flush);
+#endif /* NIOS2_HOST */
+   return;
+}
+
+/********************************************************************************
+* trace_put: Lagrar en post i ringbufferten. Vid kompilering för Linux
+*            skrivs ringbufferten till binärfilen varje gång en halva har
+*            fyllts.
+*
+*            - delta : Tid sedan föregående post.
+*            - offset: Registrets avstånd i byte från lysdiodernas dataregister.
+*            - kind  : Postens typ.
+*            - value : Postens värde.
+********************************************************************************/
+static inline void trace_put(const uint16_t delta,
+                             const uint8_t offset,
+                             const enum trace_kind kind,
+                             const uint32_t value)
+{
+   struct trace_entry* entry = &trace_ring[trace_count++ & TRACE_MASK];
+   entry->delta = delta;
+   entry->offset = offset;
+   entry->kind = (uint8_t)kind;
+   entry->value = value;
+#ifdef NIOS2_HOST
+   if (!(trace_count & (TRACE_HALF - 1))) trace_flush();
+#endif /* NIOS2_HOST */
+   return;
+}
+
+/********************************************************************************
+* trace_write: Skriver angivet värde till angivet register och lagrar
+*              skrivningen i ringbufferten, där ändrade bitar beräknas mot
+*              skuggkopian av registret. En tidspost lagras först ifall
+*              tiden sedan föregående post inte ryms i 16 bitar. Utöver
+*              själva skrivningen kostar en inspelad skrivning en avläsning
+*              av TRACE_TIME samt en post men ingen läsning av I/O. Vid
+*              kompilering för Linux (gcc -O2, x86-64) uppmättes cirka 5 ns
+*              per skrivning utöver TRACE_TIME.
+*
+*              - reg  : Pekare till registret.
+*              - value: Värdet som ska skrivas.
+********************************************************************************/
+static inline void trace_write(volatile uint32_t* reg,
+                               const uint32_t value)
+{
+   const uint32_t now = TRACE_TIME();
+   const uint8_t offset = (uint8_t)((uintptr_t)reg - (uintptr_t)trace_base);
+   uint32_t* const shadow = &trace_shadow[offset >> 2];
+   uint32_t delta = now - trace_time;
+   *reg = value;
+   trace_time = now;
+
+   if (delta > UINT16_MAX)
+   {
+      trace_put(0, offset, TRACE_KIND_TIME, delta);
+      delta = 0;
+   }
+   trace_put((uint16_t)delta, offset, TRACE_KIND_WRITE, *shadow ^ value);
+   *shadow = value;
+   return;
+}
+
+/********************************************************************************
+* TRACE_INIT: Startar inspelningen relativt angivet dataregister för
+*             lysdioderna, se trace_init.
+*
+*             - base: Pekare till lysdiodernas dataregister.
+********************************************************************************/
+#define TRACE_INIT(base) trace_init(base)
+
+/********************************************************************************
+* TRACE_WRITE: Skriver angivet värde till angivet register och lagrar
+*              skrivningen, se trace_write.
+*
+*              - reg  : Pekare till registret.
+*              - value: Värdet som ska skrivas.
+********************************************************************************/
+#define TRACE_WRITE(reg, value) trace_write((reg), (value))
+#else
+#define TRACE_INIT(base)        ((void)0)
+#define TRACE_WRITE(reg, value) (*(reg) = (value))
+#endif /* MMIO_TRACE */
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,102 @@
+/********************************************************************************
+* console_test.c: Test av konsolen i console.h vid kompilering för Linux,
+*                 där JTAG UART:en ersätts av variabler och sändkön töms
+*                 via console_host_transmit.
+*
+*                 Tal skrivs ut i decimal samt hexadecimal form medan
+*                 UART:ens sändkö är full, varefter CONSOLE_TEST_BLOCK
+*                 skrivs ut tills ringbufferten är full, så att nästa
+*                 utskrift ska kastas. Därefter ska samtliga inlagda tecken
+*                 skickas via avbrottsrutinen i rätt ordning, varefter
+*                 UART:ens avbrott ska vara inaktiverat. Även utrymme för
+*                 en hel rad via console_reserve kontrolleras. Vid fel
+*                 returneras felkod 1.
+*
+*                 Kompilera och kör testet med följande kommando:
+*                 gcc -O2 -o console_test console_test.c && ./console_test
+********************************************************************************/
+#define NIOS2_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../Drivrutiner/console.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define CONSOLE_TEST_TEXT  "0 4294967295 BEEF\n" /* Förväntad inledning av utskriften. */
+#define CONSOLE_TEST_BLOCK "0123456789ABCDEF"    /* Utskrift som upprepas tills bufferten är full. */
+
+/********************************************************************************
+* console_test_output: Fyller ringbufferten medan sändkön är full, så att
+*                      ingen utskrift får ha skickats till UART:en och nästa
+*                      block ska kastas. Sändkön töms sedan via
+*                      console_host_transmit, där samtliga inlagda tecken ska
+*                      skickas i rätt ordning. Antalet fel returneras.
+********************************************************************************/
+static uint32_t console_test_output(void)
+{
+   const uint32_t text = sizeof(CONSOLE_TEST_TEXT) - 1;
+   const uint32_t block = sizeof(CONSOLE_TEST_BLOCK) - 1;
+   const uint32_t expected = text + (CONSOLE_BUFFER_SIZE - text) / block * block;
+   uint32_t errors = 0;
+   uint32_t transmits = 0;
+
+   console_init(true);
+   irq_global_enable();
+   console_print_uint(0);
+   console_print(" ");
+   console_print_uint(4294967295UL);
+   console_print(" ");
+   console_print_hex(0xBEEF, 4);
+   console_print("\n");
+   while (console_print(CONSOLE_TEST_BLOCK));
+   if (console_dropped != block || console_host_length) errors++;
+
+   while (!console_idle() && transmits++ < CONSOLE_BUFFER_SIZE)
+   {
+      console_host_transmit(CONSOLE_FIFO_SIZE);
+   }
+   if (console_host_length != expected ||
+       memcmp(console_host_output, CONSOLE_TEST_TEXT, text) ||
+       memcmp(console_host_output + expected - block, CONSOLE_TEST_BLOCK, block) ||
+       (console_host_uart[CONSOLE_CONTROL_REG] & CONSOLE_CONTROL_WE))
+   {
+      errors++;
+   }
+   printf("Konsol: %lu tecken skickade via %lu avbrott, %lu kastade\n",
+          (unsigned long)console_host_length, (unsigned long)transmits, (unsigned long)console_dropped);
+   return errors;
+}
+
+/********************************************************************************
+* console_test_reserve: Kontrollerar att console_reserve godkänner en rad
+*                       som precis ryms i den tomma ringbufferten, men
+*                       avvisar en längre rad och räknar dess tecken som
+*                       kastade. Antalet fel returneras.
+********************************************************************************/
+static uint32_t console_test_reserve(void)
+{
+   const uint32_t dropped = console_dropped;
+   uint32_t errors = 0;
+   if (!console_idle() || !console_reserve(CONSOLE_BUFFER_SIZE)) errors++;
+   if (console_reserve(CONSOLE_BUFFER_SIZE + 1) ||
+       console_dropped != dropped + CONSOLE_BUFFER_SIZE + 1)
+   {
+      errors++;
+   }
+   return errors;
+}
+
+/********************************************************************************
+* main: Kör samtliga test och skriver ut antalet fel. Vid fel returneras
+*       felkod 1, annars 0.
+********************************************************************************/
+int main(void)
+{
+   const uint32_t errors = console_test_output() + console_test_reserve();
+   printf("Konsol: %lu fel\n", (unsigned long)errors);
+   return errors ? 1 : 0;
+}
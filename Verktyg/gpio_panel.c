@@ -0,0 +1,212 @@
+/********************************************************************************
+* gpio_panel.c: Panel för lektionsprogram kompilerade för Linux med makrot
+*               GPIO_HOST_MMIO, där PIO-enheternas register i gpio.h placeras
+*               i en delad fil. Panelen mappar in samma fil och läser av
+*               lysdioderna samt ställer in slide-switchar och tryckknappar
+*               direkt i det delade minnet, utan kopiering eller
+*               systemanrop per åtkomst.
+*
+*               Ändrade insignaler registreras som flanker i registret
+*               edgecapture, motsvarande PIO-enheterna i hårdvaran.
+*               Tryckknapparna anges som nedtryckta pinnar, varefter de
+*               skrivs aktivt låga till dataregistret.
+*
+*               Vid prestandatest genomförs ett angivet antal GPIO-operationer
+*               via gpio.h mot det delade minnet (växelvis gpio_write,
+*               gpio_read samt gpio_port_commit). Om färre än
+*               GPIO_PANEL_MIN_OPS operationer per sekund uppnås returneras
+*               felkod 1, så att testet kan användas vid regressionstester.
+*
+*               Kompilera panelen med följande kommando:
+*               gcc -O2 -o gpio_panel gpio_panel.c
+*
+*               Kör exempelvis lektion 6 i en terminal enligt nedan:
+*               gcc -DNIOS2_HOST -DGPIO_HOST_MMIO "../6. Strukt/main.c" -o main && ./main
+*
+*               Tryck sedan ned KEY[0], ettställ SWITCH[0] och följ
+*               lysdioderna i en annan terminal enligt nedan:
+*               ./gpio_panel sw=1 key=1 && ./gpio_panel -w
+*
+*               Filens sökväg anges via miljövariabeln GPIO_HOST_FILE,
+*               annars används GPIO_HOST_DEFAULT_FILE i gpio.h.
+********************************************************************************/
+#define NIOS2_HOST
+#define GPIO_HOST_MMIO
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../6. Strukt/gpio.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define GPIO_PANEL_MIN_OPS   1000000UL  /* Minsta antal GPIO-operationer per sekund. */
+#define GPIO_PANEL_BENCH_OPS 10000000UL /* Förvalt antal operationer vid prestandatest. */
+#define GPIO_PANEL_POLL_US   1000       /* Tid mellan varje avläsning vid bevakning. */
+
+/********************************************************************************
+* usage: Skriver ut panelens användning.
+********************************************************************************/
+static void usage(void)
+{
+   fprintf(stderr,
+           "Användning: gpio_panel [flaggor] [sw=V] [key=M]\n"
+           "  sw=V    Ställer in slide-switcharna SWITCH[9:0] till V.\n"
+           "  key=M   Trycker ned tryckknapparna KEY[3:0] enligt M (övriga släpps upp).\n"
+           "  -w      Bevakar lysdioderna och skriver ut varje ändring.\n"
+           "  -b [N]  Genomför N GPIO-operationer och skriver ut antalet per sekund.\n");
+   return;
+}
+
+/********************************************************************************
+* panel_print: Skriver ut aktuella värden för samtliga PIO-enheter, där
+*              lysdioderna även visas som en rad med tända och släckta
+*              lysdioder (LED[9] längst till vänster).
+********************************************************************************/
+static void panel_print(void)
+{
+   const uint32_t leds = GPIO_LEDS_BASE[GPIO_DATA_REG];
+   char row[11];
+
+   for (uint8_t i = 0; i < 10; ++i)
+   {
+      row[i] = (leds & (1UL << (9 - i))) ? '*' : '.';
+   }
+   row[10] = '\0';
+   printf("LEDS: 0x%03lx [%s]  SWITCHES: 0x%03lx  KEYS: 0x%lx (nedtryckta)\n",
+          (unsigned long)leds, row, (unsigned long)GPIO_SWITCHES_BASE[GPIO_DATA_REG],
+          (unsigned long)(~GPIO_BUTTONS_BASE[GPIO_DATA_REG] & 0xF));
+   return;
+}
+
+/********************************************************************************
+* panel_set_input: Skriver nya insignaler till angiven PIO-enhet och
+*                  registrerar ändrade bitar som flanker i edgecapture.
+*                  Flankerna ettställs atomärt, eftersom lektionsprogrammet
+*                  kan nollställa flanker samtidigt.
+*
+*                  - base : Pekare till PIO-enhetens basadress.
+*                  - value: Nya insignaler för samtliga pinnar.
+********************************************************************************/
+static void panel_set_input(volatile uint32_t* base,
+                            const uint32_t value)
+{
+   const uint32_t edges = base[GPIO_DATA_REG] ^ value;
+   base[GPIO_DATA_REG] = value;
+   __atomic_fetch_or(&base[GPIO_EDGECAPTURE_REG], edges, __ATOMIC_RELEASE);
+   return;
+}
+
+/********************************************************************************
+* panel_watch: Läser av lysdioderna var GPIO_PANEL_POLL_US mikrosekund och
+*              skriver ut samtliga PIO-enheter vid varje ändring, tills
+*              panelen avbryts.
+********************************************************************************/
+static void panel_watch(void)
+{
+   const struct timespec poll = { 0, GPIO_PANEL_POLL_US * 1000L };
+   uint32_t last = ~GPIO_LEDS_BASE[GPIO_DATA_REG];
+
+   while (1)
+   {
+      const uint32_t leds = GPIO_LEDS_BASE[GPIO_DATA_REG];
+
+      if (leds != last)
+      {
+         panel_print();
+         fflush(stdout);
+         last = leds;
+      }
+      nanosleep(&poll, 0);
+   }
+   return;
+}
+
+/********************************************************************************
+* panel_bench: Genomför angivet antal GPIO-operationer via gpio.h mot det
+*              delade minnet och skriver ut antalet operationer per sekund.
+*              Lysdiodernas ursprungliga värde återställs efteråt. Om färre
+*              än GPIO_PANEL_MIN_OPS operationer per sekund uppnås returneras
+*              felkod 1, annars 0.
+*
+*              - ops: Antalet GPIO-operationer att genomföra.
+********************************************************************************/
+static int panel_bench(const unsigned long ops)
+{
+   const uint32_t saved = GPIO_LEDS_BASE[GPIO_DATA_REG];
+   struct gpio led1, switch1;
+   struct gpio_port leds;
+   struct timespec start, end;
+   uint32_t reads = 0;
+
+   gpio_init(&led1, 0, GPIO_SELECTION_LED);
+   gpio_init(&switch1, 0, GPIO_SELECTION_SWITCH);
+   gpio_port_init(&leds, GPIO_SELECTION_LED);
+   clock_gettime(CLOCK_MONOTONIC, &start);
+
+   for (unsigned long i = 0; i < ops; i += 3)
+   {
+      gpio_write(&led1, (uint8_t)(i & 1));
+      reads += gpio_read(&switch1);
+      gpio_port_toggle(&leds, 1UL << 9);
+      gpio_port_commit(&leds);
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   GPIO_LEDS_BASE[GPIO_DATA_REG] = saved;
+
+   const double seconds = (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+   const double rate = seconds > 0 ? ops / seconds : 0;
+   printf("%lu GPIO-operationer på %.3f s: %.1f miljoner per sekund (%lu höga insignaler lästa)%s\n", ops,
+          seconds, rate * 1e-6, (unsigned long)reads,
+          seconds > 0 && rate < GPIO_PANEL_MIN_OPS ? " (för långsamt)" : "");
+   return seconds > 0 && rate < GPIO_PANEL_MIN_OPS ? 1 : 0;
+}
+
+/********************************************************************************
+* main: Tolkar argumenten och ställer först in angivna insignaler. Därefter
+*       genomförs prestandatest eller bevakning vid motsvarande flagga,
+*       annars skrivs aktuella värden för samtliga PIO-enheter ut.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   bool watch = false;
+   unsigned long bench = 0;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const char* arg = argv[i];
+
+      if (!strncmp(arg, "sw=", 3))
+      {
+         panel_set_input(GPIO_SWITCHES_BASE, (uint32_t)strtoul(arg + 3, 0, 0) & 0x3FF);
+      }
+      else if (!strncmp(arg, "key=", 4))
+      {
+         panel_set_input(GPIO_BUTTONS_BASE, ~(uint32_t)strtoul(arg + 4, 0, 0) & 0xF);
+      }
+      else if (!strcmp(arg, "-w"))
+      {
+         watch = true;
+      }
+      else if (!strcmp(arg, "-b"))
+      {
+         bench = GPIO_PANEL_BENCH_OPS;
+         if (i + 1 < argc && argv[i + 1][0] != '-') bench = strtoul(argv[++i], 0, 0);
+      }
+      else
+      {
+         usage();
+         return 1;
+      }
+   }
+
+   if (bench) return panel_bench(bench);
+   if (watch) panel_watch();
+   panel_print();
+   return 0;
+}
@@ -0,0 +1,4456 @@
+/********************************************************************************
+* nios2sim.c: Huvudlös instruktionssimulator för Nios II, avsedd för att köra
+*             lektionernas assemblerprogram direkt från kommandoraden utan
+*             CPUlator. Programmen assembleras av simulatorns inbyggda
+*             assembler, alternativt laddas en färdiglänkad ELF-fil, exempelvis
+*             genererad via nios2-elf-gcc från motsvarande main.c.
+*
+*             Varje instruktion avkodas endast en gång till en föravkodad post,
+*             som lagras i en instruktionscache indexerad via programräknaren.
+*             Efterföljande exekveringar av samma adress läser enbart posten,
+*             vilket ger en genomströmning på över 100 miljoner simulerade
+*             instruktioner per sekund. Enkla fördröjningsloopar, exempelvis
+*             uppräkning till DELAY_CONSTANT, slås dessutom ihop till en enda
+*             post med bibehållen instruktionsräkning.
+*
+*             PIO-registren (data, direction, interruptmask samt edgecapture)
+*             för LEDS_BASE, SWITCHES_BASE och BUTTONS_BASE modelleras för både
+*             CASE GOLD och CPUlator, så makrot GPIO_CASE_GOLD_HW behöver inte
+*             kommenteras ut inför simulering.
+*
+*             Intervalltimern (status, control, periodl/periodh samt
+*             snapl/snaph) modelleras på TIMER_BASE i båda adressrymderna.
+*             Timern räknar en klockcykel per exekverad instruktion, så att
+*             simulerad tid motsvarar SIM_CLOCK_HZ.
+*
+*             JTAG UART (data samt control) modelleras på CONSOLE_BASE i båda
+*             adressrymderna. Skickade tecken skrivs direkt till standard
+*             output, medan sändkön om SIM_UART_FIFO tecken töms med ett
+*             tecken per SIM_UART_CHAR_CYCLES klockcykler. Avbrottet WI
+*             genereras när biten WE är ettställd och färre än
+*             SIM_UART_THRESHOLD tecken återstår i sändkön, likt UART:ens
+*             förvalda tröskel. Tecknen kan exempelvis följas i lektion 3,
+*             där varje nedtryckning av BUTTON1 skrivs ut via console.s:
+*
+*             ./nios2sim -n 10000000 -e 1000000:key=1 -e 2000000:key=0 \
+*                -e 3000000:key=1 "../3. Ingående argument till subrutiner/main.s"
+*
+*             Kompilera simulatorn med följande kommando:
+*             gcc -O2 -o nios2sim nios2sim.c
+*
+*             Kör exempelvis lektion 2 enligt nedan:
+*             ./nios2sim "../2. Loop/main.s"
+*
+*             Tryckknapp KEY[0] kan tryckas ned efter 1000 instruktioner
+*             och släppas efter 2000 instruktioner enligt nedan:
+*             ./nios2sim -n 5000 -e 1000:key=1 -e 2000:key=0 "../6. Strukt/main.s"
+*
+*             Enskilda subrutiner kan mätas via flaggan -c, där subrutinen
+*             anropas SIM_BENCH_CALLS gånger (alternativt enligt flaggan -i)
+*             med angivna register i stället för att programmet körs från
+*             _start. Argumenten anges som tal, symboler eller @, som anger
+*             ett arbetsminne som behålls mellan mätningarna, exempelvis en
+*             strukt som initieras av en tidigare mätt subrutin. Likt
+*             startkoden i start.s initieras gp till symbolen _gp. Per anrop
+*             skrivs antalet instruktioner, simulerad tid i nanosekunder
+*             (en instruktion per klockcykel) samt antalet läsningar och
+*             skrivningar av I/O-register ut, alternativt en JSON-rad per
+*             subrutin via flaggan -j. Eftersom simuleringen är
+*             deterministisk kan resultaten jämföras exakt mot en sparad
+*             baslinje via flaggan -b, där returkod 2 indikerar att någon
+*             subrutin har blivit långsammare. Baslinjen för lektionernas
+*             subrutiner finns i filen bench_baseline.json och uppdateras
+*             genom att köra samtliga mätningar nedan med flaggan -j:
+*
+*             ./nios2sim -b bench_baseline.json \
+*                -c gpio_init:r2=@,r3=0,r4=0 -c gpio_read:r2=@ \
+*                -c gpio_write:r2=@,r3=1 -c gpio_write:r2=@,r3=0 \
+*                "../6. Strukt/main.s"
+*             ./nios2sim -b bench_baseline.json -D GPIO_SNAPSHOT=1 \
+*                -c gpio_snapshot_update "../6. Strukt/main.s"
+*             ./nios2sim -b bench_baseline.json -c gpio_port_init:r2=@,r3=0 \
+*                -c gpio_port_set:r2=@,r3=3 -c gpio_port_clear:r2=@,r3=1 \
+*                -c gpio_port_toggle:r2=@,r3=2 \
+*                -c gpio_port_write:r2=@,r3=3,r4=1 -c gpio_port_commit:r2=@ \
+*                "../6. Strukt/main.s"
+*             ./nios2sim -b bench_baseline.json \
+*                -c button_pressed:r2=0 -c led_on:r2=0 -c led_off:r2=0 \
+*                "../3. Ingående argument till subrutiner/main.s"
+*             ./nios2sim -b bench_baseline.json -c stream_submit:r2=@,r3=1024 \
+*                "../5. Array/main.s"
+*
+*             Fyllnings- och kopieringsrutinerna i block.s mäts för arrayer
+*             om 16 till 65536 element, placerade på fasta adresser utanför
+*             arbetsminnet, som enbart rymmer 64 kB:
+*
+*             ./nios2sim -b bench_baseline.json -i 10 \
+*                -c block_assign:r2=0x100000,r3=16,r4=1,r5=2 \
+*                -c block_assign:r2=0x100000,r3=1027,r4=1,r5=2 \
+*                -c block_assign:r2=0x100000,r3=65536,r4=1,r5=2 \
+*                -c block_fill:r2=0x100000,r3=16,r4=0 \
+*                -c block_fill:r2=0x100000,r3=1027,r4=0 \
+*                -c block_fill:r2=0x100000,r3=65536,r4=0 \
+*                -c block_copy:r2=0x100000,r3=0x200000,r4=16 \
+*                -c block_copy:r2=0x100000,r3=0x200000,r4=1027 \
+*                -c block_copy:r2=0x100000,r3=0x200000,r4=65536 "../5. Array/main.s"
+*
+*             Schemaläggarens avläsning av tiden via sched_cycles i sched.s
+*             mäts nedan, medan profileringens makron i profile.s expanderas
+*             på plats utan anrop och därmed inte mäts här, se profile.s:
+*
+*             ./nios2sim -b bench_baseline.json -c sched_cycles \
+*                "../3. Ingående argument till subrutiner/main.s"
+*
+*             Konsolens utskrifter i console.s mäts med avbrottsdriven
+*             tömning, där ringbufferten rymmer samtliga 16 anrop utan att
+*             tecken kastas, eftersom avbrott inte aktiveras vid mätning:
+*
+*             ./nios2sim -b bench_baseline.json -i 16 \
+*                -c console_init:r2=1 -c console_print:r2=clicks_text \
+*                -c console_init:r2=1 -c console_print_uint:r2=4294967295 \
+*                -c console_init:r2=1 -c console_print_hex:r2=0x3FF,r3=3 \
+*                "../3. Ingående argument till subrutiner/main.s"
+*
+*             Sekvenseraren pattern_play i pattern.s mäts med en period om
+*             en mikrosekund per bildruta, efter att intervalltimern har
+*             startats via timer_init:
+*
+*             ./nios2sim -b bench_baseline.json -i 10 -c timer_init \
+*                -c pattern_play:r2=LEDS_BASE,r3=pattern_knight,r4=PATTERN_KNIGHT_SIZE,r5=1 \
+*                "../2. Loop/sequence.s"
+*
+*             Via flaggan -p skrivs tabellen profile_regions ut efter
+*             körningen, i samma format som profile_print i profile.h,
+*             exempelvis fördröjningen från KEY[0] till LED1 i lektion 3:
+*
+*             ./nios2sim -D PROFILE=1 -p -n 10000000 -e 1000000:key=1 \
+*                -e 5000000:key=0 "../3. Ingående argument till subrutiner/main.s"
+*
+*             Via flaggan -a analyseras i stället stackens värsta fall
+*             statiskt utifrån den assemblerade koden. Varje subrutin följs
+*             från _start samt undantagshanteraren längs samtliga hopp, där
+*             stackpekarens förändringar (addi sp, sp, -N med flera) summeras
+*             och anropade subrutiner analyseras rekursivt. Vid indirekta
+*             anrop (callr) antas värsta fall bland subrutiner vars adress
+*             laddas via movia, exempelvis registrerade avbrottsrutiner. För
+*             varje ingångspunkt skrivs djupet samt anropskedjan ut, följt av
+*             lägsta adress som stacken når jämfört med programmets slut samt
+*             eventuell symbol STACK_SIZE. Returkod 2 indikerar att stacken
+*             kan skriva över programmet alternativt överskrida STACK_SIZE:
+*
+*             ./nios2sim -a "../6. Strukt/main.s"
+********************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <time.h>
+
+/********************************************************************************
+* Makrodefinitioner för simulatorn:
+********************************************************************************/
+#define SIM_RAM_SIZE       (64UL * 1024 * 1024) /* Storlek på dataminnet (64 MiB). */
+#define SIM_EXCEPTION_ADDR 0x20                 /* Adress för undantagshanteraren. */
+#define SIM_CLOCK_HZ       50000000UL           /* Klockfrekvens för simulerad tid. */
+#define SIM_MAX_EVENTS     256                  /* Maximalt antal schemalagda insignaler. */
+#define SIM_MAX_LOOP_LEN   8                    /* Maximal längd för sammanslagna loopar. */
+#define SIM_DUMMY_REG      32                   /* Register som skrivningar till r0 dirigeras till. */
+#define SIM_DEFAULT_MAX    1000000000ULL        /* Förvalt maximalt antal instruktioner. */
+
+/********************************************************************************
+* Makrodefinitioner för mätning av subrutiner:
+********************************************************************************/
+#define SIM_BENCH_MAX     32                        /* Maximalt antal mätta subrutiner. */
+#define SIM_BENCH_ARGS    8                         /* Maximalt antal register per anrop. */
+#define SIM_BENCH_CALLS   1000                      /* Förvalt antal anrop per subrutin. */
+#define SIM_BENCH_LIMIT   10000000ULL               /* Maximalt antal instruktioner per anrop. */
+#define SIM_BENCH_RETURN  (SIM_RAM_SIZE - 4)        /* Återhoppsadress, innehåller break. */
+#define SIM_BENCH_SCRATCH (SIM_RAM_SIZE - 0x10000)  /* Arbetsminne som anges via @. */
+#define SIM_BENCH_STACK   SIM_BENCH_SCRATCH         /* Stackpekare vid anrop (växer nedåt). */
+
+/********************************************************************************
+* Makrodefinitioner för stackanalys (flaggan -a):
+********************************************************************************/
+#define SIM_STACK_ROUTINES 256  /* Maximalt antal analyserade subrutiner. */
+#define SIM_STACK_TARGETS  64   /* Maximalt antal mål för indirekta anrop. */
+#define SIM_STACK_PATHS    1024 /* Maximalt antal vägar som väntar på analys. */
+
+/********************************************************************************
+* Offset för fälten i en region i profile.s (flaggan -p):
+********************************************************************************/
+#define SIM_PROFILE_COUNT 4  /* Antal genomförda mätningar. */
+#define SIM_PROFILE_MIN   8  /* Kortaste uppmätta tid. */
+#define SIM_PROFILE_MAX   12 /* Längsta uppmätta tid. */
+#define SIM_PROFILE_SUM   16 /* Summan av samtliga uppmätta tider (64 bitar). */
+#define SIM_PROFILE_HIST  24 /* Antal mätningar per antal bitar i tiden. */
+
+/********************************************************************************
+* Makrodefinitioner för assemblern:
+********************************************************************************/
+#define ASM_HASH_SIZE    1024 /* Antal hinkar i symboltabellen. */
+#define ASM_MAX_SECTIONS 16   /* Maximalt antal sektioner. */
+#define ASM_MAX_OPERANDS 16   /* Maximalt antal operander per rad. */
+#define ASM_MAX_PARAMS   16   /* Maximalt antal parametrar per makro. */
+#define ASM_MAX_DEPTH    64   /* Maximalt djup för inkludering samt makroexpansion. */
+#define ASM_MAX_COND     64   /* Maximalt djup för villkorlig assemblering. */
+#define ASM_MAX_INCLUDES 16   /* Maximalt antal sökvägar för inkluderingsfiler. */
+#define ASM_NAME_LEN     64   /* Maximal längd för symbolnamn. */
+
+/********************************************************************************
+* Basadresser för PIO-enheter, som modelleras för båda adressrymderna:
+********************************************************************************/
+#define CASE_GOLD_LEDS_BASE     0x8091740  /* Basadress för lysdioder (CASE GOLD). */
+#define CASE_GOLD_SWITCHES_BASE 0x8091750  /* Basadress för slide-switchar (CASE GOLD). */
+#define CASE_GOLD_BUTTONS_BASE  0x8091760  /* Basadress för tryckknappar (CASE GOLD). */
+#define CPULATOR_LEDS_BASE      0xFF200000 /* Basadress för lysdioder (simulering). */
+#define CPULATOR_SWITCHES_BASE  0xFF200040 /* Basadress för slide-switchar (simulering). */
+#define CPULATOR_BUTTONS_BASE   0xFF200050 /* Basadress för tryckknappar (simulering). */
+
+/********************************************************************************
+* Basadresser för intervalltimern, som modelleras för båda adressrymderna:
+********************************************************************************/
+#define CASE_GOLD_TIMER_BASE 0x8091720  /* Basadress för intervalltimern (CASE GOLD). */
+#define CPULATOR_TIMER_BASE  0xFF202000 /* Basadress för intervalltimern (simulering). */
+#define SIM_TIMER_SPAN       32         /* Intervalltimerns adressområde i byte. */
+
+/********************************************************************************
+* Basadresser för JTAG UART, som modelleras för båda adressrymderna:
+********************************************************************************/
+#define CASE_GOLD_UART_BASE   0x8091770  /* Basadress för JTAG UART (CASE GOLD). */
+#define CPULATOR_UART_BASE    0xFF201000 /* Basadress för JTAG UART (simulering). */
+#define SIM_UART_SPAN         8          /* UART:ens adressområde i byte. */
+#define SIM_UART_FIFO         64         /* Antal platser i UART:ens sändkö. */
+#define SIM_UART_THRESHOLD    8          /* Antal tecken i sändkön under vilket WI genereras. */
+#define SIM_UART_CHAR_CYCLES  500        /* Antal klockcykler per skickat tecken (10 us). */
+
+/********************************************************************************
+* Avbrottsnummer för PIO-enheterna:
+********************************************************************************/
+#define SIM_BUTTONS_IRQ  1 /* Avbrottsnummer för tryckknappar. */
+#define SIM_SWITCHES_IRQ 2 /* Avbrottsnummer för slide-switchar. */
+#define SIM_TIMER_IRQ    0 /* Avbrottsnummer för intervalltimern. */
+#define SIM_UART_IRQ     8 /* Avbrottsnummer för JTAG UART. */
+
+/********************************************************************************
+* Bitar i intervalltimerns register status samt control:
+********************************************************************************/
+#define SIM_TIMER_TO    0x01 /* status: Timern har räknat ned till noll. */
+#define SIM_TIMER_RUN   0x02 /* status: Timern räknar. */
+#define SIM_TIMER_ITO   0x01 /* control: Avbrott vid nedräkning till noll. */
+#define SIM_TIMER_CONT  0x02 /* control: Kontinuerlig räkning med omladdning. */
+#define SIM_TIMER_START 0x04 /* control: Startar timern. */
+#define SIM_TIMER_STOP  0x08 /* control: Stoppar timern. */
+
+/********************************************************************************
+* Bitar i JTAG UART:ens register control:
+********************************************************************************/
+#define SIM_UART_RE     0x001 /* Avbrott när mottagna tecken finns. */
+#define SIM_UART_WE     0x002 /* Avbrott när sändkön har plats. */
+#define SIM_UART_WI     0x200 /* Väntande avbrott för sändkön. */
+#define SIM_UART_WSPACE 16    /* Antal lediga platser i sändkön i bitar [31:16]. */
+
+/********************************************************************************
+* sim_op: Interna operationskoder för föravkodade instruktioner. Operationer
+*         som endast skriver till r0 avkodas till SIM_OP_NOP.
+********************************************************************************/
+enum sim_op
+{
+   SIM_OP_UNDECODED, /* Ej avkodad, avkodas vid nästa exekvering. */
+   SIM_OP_ILLEGAL,   /* Ogiltig instruktion. */
+   SIM_OP_NOP,       /* Ingen operation. */
+   SIM_OP_ADD, SIM_OP_SUB, SIM_OP_AND, SIM_OP_OR, SIM_OP_XOR, SIM_OP_NOR,
+   SIM_OP_SLL, SIM_OP_SRL, SIM_OP_SRA, SIM_OP_ROL, SIM_OP_ROR,
+   SIM_OP_SLLI, SIM_OP_SRLI, SIM_OP_SRAI, SIM_OP_ROLI,
+   SIM_OP_CMPEQ, SIM_OP_CMPNE, SIM_OP_CMPGE, SIM_OP_CMPGEU, SIM_OP_CMPLT, SIM_OP_CMPLTU,
+   SIM_OP_MUL, SIM_OP_MULXSS, SIM_OP_MULXSU, SIM_OP_MULXUU, SIM_OP_DIV, SIM_OP_DIVU,
+   SIM_OP_ADDI, SIM_OP_ANDI, SIM_OP_ORI, SIM_OP_XORI, SIM_OP_MULI,
+   SIM_OP_CMPEQI, SIM_OP_CMPNEI, SIM_OP_CMPGEI, SIM_OP_CMPGEUI, SIM_OP_CMPLTI, SIM_OP_CMPLTUI,
+   SIM_OP_LDB, SIM_OP_LDBU, SIM_OP_LDH, SIM_OP_LDHU, SIM_OP_LDW,
+   SIM_OP_STB, SIM_OP_STH, SIM_OP_STW,
+   SIM_OP_BR, SIM_OP_BEQ, SIM_OP_BNE, SIM_OP_BGE, SIM_OP_BGEU, SIM_OP_BLT, SIM_OP_BLTU,
+   SIM_OP_CALL, SIM_OP_JMPI, SIM_OP_CALLR, SIM_OP_JMP, SIM_OP_NEXTPC,
+   SIM_OP_RDCTL, SIM_OP_WRCTL, SIM_OP_ERET, SIM_OP_TRAP, SIM_OP_BREAK,
+   SIM_OP_LOOP_COUNT, /* Sammanslagen loop: beq rA, rB, slut; addi rC, rC, ±1; br start. */
+   SIM_OP_LOOP_BODY,  /* Sammanslagen loop: [nop/addi rC, rC, ±1]... bne/blt/bltu tillbaka. */
+   SIM_OP_IDLE        /* Hopp till sig själv, dvs. en tom loop. */
+};
+
+/********************************************************************************
+* sim_insn: Föravkodad instruktion. Destinationsregistret r0 ersätts med
+*           SIM_DUMMY_REG så att r0 alltid förblir 0 utan extra kontroller.
+*           För hopp lagras den absoluta måladressen i imm.
+********************************************************************************/
+struct sim_insn
+{
+   uint8_t op;   /* Intern operationskod (enum sim_op). */
+   uint8_t a;    /* Källregister A. */
+   uint8_t b;    /* Källregister B. */
+   uint8_t c;    /* Destinationsregister. */
+   uint8_t len;  /* Antal instruktioner i en sammanslagen loop. */
+   int8_t step;  /* Stegvärde (+1 eller -1) för en sammanslagen loop. */
+   uint8_t cond; /* Hoppvillkor (SIM_OP_BNE, SIM_OP_BLT, SIM_OP_BLTU) i en sammanslagen loop. */
+   uint8_t flag; /* Indikerar att den första instruktionen i loopen är räknarens addi. */
+   uint32_t imm; /* Omedelbart värde alternativt hoppadress. */
+};
+
+/********************************************************************************
+* sim_pio_index: Index för modellerade PIO-enheter.
+********************************************************************************/
+enum sim_pio_index
+{
+   SIM_PIO_LEDS,     /* Lysdioder LED[9:0]. */
+   SIM_PIO_SWITCHES, /* Slide-switchar SW[9:0]. */
+   SIM_PIO_BUTTONS,  /* Tryckknappar KEY[3:0]. */
+   SIM_NUM_PIOS      /* Antalet PIO-enheter. */
+};
+
+/********************************************************************************
+* sim_pio: Modell av en Altera PIO-enhet med register för data, riktning,
+*          avbrottsmask samt flankdetektering. För ingångar lagras den yttre
+*          signalnivån i data.
+********************************************************************************/
+struct sim_pio
+{
+   const char* name;      /* Enhetens namn vid utskrift. */
+   uint32_t data;         /* Dataregistret (offset 0). */
+   uint32_t direction;    /* Riktningsregistret (offset 4). */
+   uint32_t irq_mask;     /* Avbrottsmask (offset 8). */
+   uint32_t edge_capture; /* Detekterade flanker (offset 12). */
+   uint32_t width_mask;   /* Mask för enhetens anslutna pinnar. */
+   int irq;               /* Avbrottsnummer, -1 om avbrott saknas. */
+   bool output;           /* Indikerar ifall enheten är en utenhet. */
+};
+
+/********************************************************************************
+* sim_timer: Modell av en Altera intervalltimer med 32-bitars period. Räknaren
+*            beräknas vid behov utifrån antalet exekverade instruktioner sedan
+*            start, så ingen uppdatering sker per instruktion.
+********************************************************************************/
+struct sim_timer
+{
+   uint32_t control; /* Bitarna ITO samt CONT i registret control. */
+   uint32_t period;  /* Period i klockcykler minus ett (periodh:periodl). */
+   uint32_t counter; /* Räknarens värde när timern är stoppad. */
+   uint32_t snap;    /* Senast avläst räknarvärde (snaph:snapl). */
+   uint64_t start;   /* Tidpunkt då räknaren senast laddades med perioden. */
+   bool running;     /* Indikerar att timern räknar. */
+   bool timeout;     /* Biten TO i registret status. */
+};
+
+/********************************************************************************
+* sim_uart: Modell av en Altera JTAG UART, där enbart sändkön modelleras.
+*           Antalet tecken i sändkön beräknas vid behov utifrån antalet
+*           exekverade instruktioner sedan första tecknet började skickas.
+********************************************************************************/
+struct sim_uart
+{
+   uint32_t control; /* Bitarna RE samt WE i registret control. */
+   uint32_t fill;    /* Antal tecken i sändkön vid tidpunkten start. */
+   uint64_t start;   /* Tidpunkt då äldsta tecknet i sändkön började skickas. */
+   uint64_t chars;   /* Antal skrivna tecken till dataregistret. */
+   bool echo;        /* Indikerar ifall skrivna tecken skrivs ut. */
+};
+
+/********************************************************************************
+* sim_region: Adressområde för en PIO-enhet i någon av adressrymderna.
+********************************************************************************/
+struct sim_region
+{
+   uint32_t base;            /* Basadress för enheten. */
+   enum sim_pio_index index; /* Index för modellerad PIO-enhet. */
+};
+
+/********************************************************************************
+* sim_event: Schemalagd ändring av insignaler vid angivet antal instruktioner.
+********************************************************************************/
+struct sim_event
+{
+   uint64_t time;            /* Tidpunkt i antal exekverade instruktioner. */
+   enum sim_pio_index index; /* Enheten vars insignaler ändras. */
+   uint32_t value;           /* Ny signalnivå (nedtryckta knappar för KEY). */
+};
+
+/********************************************************************************
+* sim: Simulatorns tillstånd innefattande register, minne, instruktionscache,
+*      PIO-enheter samt schemalagda insignaler.
+********************************************************************************/
+struct sim
+{
+   uint32_t regs[SIM_DUMMY_REG + 1]; /* Register r0 - r31 samt skrivregister för r0. */
+   uint32_t ctl[32];                 /* Kontrollregister (status, ienable m.fl.). */
+   uint32_t pc;                      /* Programräknaren. */
+   uint8_t* ram;                     /* Dataminnet. */
+   uint32_t ram_size;                /* Dataminnets storlek i byte. */
+   struct sim_insn* cache;           /* Föravkodade instruktioner, en per ord i minnet. */
+   uint32_t code_end;                /* Högsta avkodade adress + 4. */
+   bool fuse;                        /* Indikerar ifall loopar ska slås ihop. */
+   uint64_t icount;                  /* Antal exekverade instruktioner. */
+   uint64_t max_icount;              /* Maximalt antal instruktioner, 0 = obegränsat. */
+   struct sim_pio pio[SIM_NUM_PIOS]; /* Modellerade PIO-enheter. */
+   struct sim_timer timer;           /* Modellerad intervalltimer. */
+   struct sim_uart uart;             /* Modellerad JTAG UART. */
+   struct sim_event events[SIM_MAX_EVENTS]; /* Schemalagda insignaler sorterade efter tid. */
+   int num_events;                   /* Antal schemalagda insignaler. */
+   int next_event;                   /* Index för nästa schemalagda insignal. */
+   uint64_t led_writes;              /* Antal skrivningar till lysdiodernas dataregister. */
+   uint64_t input_reads;             /* Antal läsningar av insignalernas dataregister. */
+   uint64_t mmio_loads;              /* Antal läsningar av I/O-register. */
+   uint64_t mmio_stores;             /* Antal skrivningar till I/O-register. */
+   bool trace;                       /* Indikerar ifall skrivningar till lysdioder skrivs ut. */
+   bool halted;                      /* Indikerar att exekveringen har avslutats. */
+   bool error;                       /* Indikerar att exekveringen avslutades med fel. */
+};
+
+/********************************************************************************
+* sim_bench: Subrutin som mäts via flaggan -c, med angivna register vid
+*            anrop samt uppmätta medelvärden per anrop.
+********************************************************************************/
+struct sim_bench
+{
+   const char* spec;                 /* Mätningen som angiven på kommandoraden. */
+   uint32_t routine;                 /* Subrutinens adress. */
+   uint8_t regs[SIM_BENCH_ARGS];     /* Register som tilldelas vid anrop. */
+   uint32_t values[SIM_BENCH_ARGS];  /* Registrens värden vid anrop. */
+   int num_args;                     /* Antalet tilldelade register. */
+   double instructions;              /* Antal instruktioner per anrop. */
+   double loads;                     /* Antal läsningar av I/O-register per anrop. */
+   double stores;                    /* Antal skrivningar till I/O-register per anrop. */
+};
+
+/********************************************************************************
+* sim_stack_state: Analystillstånd för en subrutin vid stackanalys.
+********************************************************************************/
+enum sim_stack_state
+{
+   SIM_STACK_NEW,    /* Subrutinen har ännu inte analyserats. */
+   SIM_STACK_ACTIVE, /* Subrutinen analyseras, nytt anrop innebär rekursion. */
+   SIM_STACK_DONE    /* Subrutinens värsta fall är beräknat. */
+};
+
+/********************************************************************************
+* sim_stack_routine: Subrutin vid stackanalys med beräknat värsta fall.
+********************************************************************************/
+struct sim_stack_routine
+{
+   uint32_t addr;              /* Subrutinens adress. */
+   int32_t depth;              /* Värsta fall i byte, inklusive anropade subrutiner. */
+   uint32_t callee;            /* Anropad subrutin i värsta fall, 0 om sådan saknas. */
+   enum sim_stack_state state; /* Analystillstånd. */
+};
+
+/********************************************************************************
+* sim_stack_path: Väg genom en subrutin vid stackanalys, där stackpekaren
+*                 samt rampekaren lagras relativt stackpekaren vid anrop.
+********************************************************************************/
+struct sim_stack_path
+{
+   uint32_t pc; /* Adress för nästa instruktion. */
+   int32_t sp;  /* Stackpekaren relativt värdet vid anrop. */
+   int32_t fp;  /* Rampekaren relativt stackpekaren vid anrop. */
+   bool abs;    /* Indikerar att sp precis har tilldelats en absolut adress. */
+};
+
+/********************************************************************************
+* sim_stack: Tillstånd vid statisk analys av stackens värsta fall via
+*            flaggan -a.
+********************************************************************************/
+struct sim_stack
+{
+   const struct sim* sim;                                  /* Simulatorn med assemblerad kod. */
+   struct assembler* symbols;                              /* Assemblern för sektioner och symboler. */
+   uint32_t code_end;                                      /* Kodsektionernas högsta adress + 4. */
+   struct sim_stack_routine routines[SIM_STACK_ROUTINES]; /* Analyserade subrutiner. */
+   int num_routines;                                       /* Antalet analyserade subrutiner. */
+   uint32_t targets[SIM_STACK_TARGETS];                    /* Möjliga mål för indirekta anrop. */
+   int num_targets;                                        /* Antalet möjliga mål. */
+   int indirect;                                           /* Antal pågående indirekta anrop. */
+   struct sim_stack_path paths[SIM_STACK_PATHS];           /* Vägar som väntar på analys. */
+   int num_paths;                                          /* Antalet väntande vägar. */
+   uint32_t top;                                           /* Stackens startadress enligt _start. */
+   bool has_top;                                           /* Indikerar ifall startadressen är känd. */
+   int warnings;                                           /* Antalet varningar. */
+};
+
+/********************************************************************************
+* Adressområden för PIO-enheterna i CASE GOLD respektive CPUlator:
+********************************************************************************/
+static const struct sim_region sim_regions[] =
+{
+   { CASE_GOLD_LEDS_BASE,     SIM_PIO_LEDS     },
+   { CASE_GOLD_SWITCHES_BASE, SIM_PIO_SWITCHES },
+   { CASE_GOLD_BUTTONS_BASE,  SIM_PIO_BUTTONS  },
+   { CPULATOR_LEDS_BASE,      SIM_PIO_LEDS     },
+   { CPULATOR_SWITCHES_BASE,  SIM_PIO_SWITCHES },
+   { CPULATOR_BUTTONS_BASE,   SIM_PIO_BUTTONS  }
+};
+
+/********************************************************************************
+* asm_line: Källkodsrad med tillhörande filnamn och radnummer.
+********************************************************************************/
+struct asm_line
+{
+   const char* file; /* Filen som raden tillhör. */
+   int line;         /* Radnummer i filen. */
+   char* text;       /* Radens innehåll utan kommentarer. */
+};
+
+/********************************************************************************
+* asm_symbol: Symbol i form av en etikett eller en konstant (.equ). Etiketter
+*             lagras som en offset i tillhörande sektion, konstanter som
+*             absoluta värden (sektion -1).
+********************************************************************************/
+struct asm_symbol
+{
+   char name[ASM_NAME_LEN];  /* Symbolens namn. */
+   int64_t value;            /* Värde, alternativt offset inom sektionen. */
+   int section;              /* Sektionens index, -1 för absoluta värden. */
+   int pass;                 /* Pass då symbolen senast definierades, 0 = kommandorad. */
+   struct asm_symbol* next;  /* Nästa symbol i samma hink. */
+};
+
+/********************************************************************************
+* asm_macro: Makro definierat via .macro samt .endm.
+********************************************************************************/
+struct asm_macro
+{
+   char name[ASM_NAME_LEN];                 /* Makrots namn. */
+   char params[ASM_MAX_PARAMS][ASM_NAME_LEN]; /* Parametrarnas namn. */
+   char* defaults[ASM_MAX_PARAMS];          /* Standardvärden, NULL om saknas. */
+   int num_params;                          /* Antalet parametrar. */
+   struct asm_line* body;                   /* Makrots rader. */
+   int body_len;                            /* Antalet rader. */
+   struct asm_macro* next;                  /* Nästa makro i listan. */
+};
+
+/********************************************************************************
+* asm_section: Sektion (.text, .data, .bss med flera) med tillhörande innehåll.
+********************************************************************************/
+struct asm_section
+{
+   char name[32];     /* Sektionens namn. */
+   uint8_t* data;     /* Sektionens innehåll (pass 2). */
+   uint32_t capacity; /* Allokerat utrymme för innehållet. */
+   uint32_t size;     /* Sektionens storlek i byte. */
+   uint32_t loc;      /* Aktuell position inom sektionen. */
+   uint32_t base;     /* Sektionens startadress efter placering. */
+};
+
+/********************************************************************************
+* asm_cond: Tillstånd för ett villkorligt block (.if/.else/.endif).
+********************************************************************************/
+struct asm_cond
+{
+   bool active;        /* Indikerar ifall aktuell gren assembleras. */
+   bool taken;         /* Indikerar ifall någon gren redan har valts. */
+   bool parent_active; /* Indikerar ifall omgivande block assembleras. */
+};
+
+/********************************************************************************
+* assembler: Assemblerns tillstånd. Källkoden bearbetas i två pass, där
+*            etiketternas placering bestäms i pass 1 och maskinkoden
+*            genereras i pass 2.
+********************************************************************************/
+struct assembler
+{
+   struct asm_symbol* symtab[ASM_HASH_SIZE];        /* Symboltabell. */
+   struct asm_macro* macros;                        /* Definierade makron. */
+   struct asm_section sections[ASM_MAX_SECTIONS];   /* Sektioner. */
+   int num_sections;                                /* Antalet sektioner. */
+   int cur_section;                                 /* Aktuell sektion. */
+   int pass;                                        /* Aktuellt pass (1 eller 2). */
+   int errors;                                      /* Antalet fel. */
+   const char* include_dirs[ASM_MAX_INCLUDES];      /* Sökvägar för inkluderingsfiler. */
+   int num_include_dirs;                            /* Antalet sökvägar. */
+   struct asm_cond cond[ASM_MAX_COND];              /* Stack för villkorliga block. */
+   int cond_depth;                                  /* Antalet öppna villkorliga block. */
+   int local_count[10];                             /* Antal definitioner av lokala etiketter 0 - 9. */
+   int macro_count;                                 /* Räknare för \@ i makron. */
+   int depth;                                       /* Aktuellt djup för inkludering/makron. */
+   const char* file;                                /* Aktuell fil för felmeddelanden. */
+   int line;                                        /* Aktuell rad för felmeddelanden. */
+};
+
+/********************************************************************************
+* asm_insn_kind: Operandformat för instruktioner och pseudoinstruktioner.
+********************************************************************************/
+enum asm_insn_kind
+{
+   ASM_R3,      /* op rC, rA, rB */
+   ASM_R3_SWAP, /* op rC, rB, rA (cmpgt med flera) */
+   ASM_RI5,     /* op rC, rA, imm5 */
+   ASM_RI16,    /* op rB, rA, imm16 */
+   ASM_RI16_P1, /* op rB, rA, imm16 + 1 (cmpgti med flera) */
+   ASM_MEM,     /* op rB, imm16(rA) */
+   ASM_BR2,     /* op rA, rB, etikett */
+   ASM_BR2_SWAP,/* op rB, rA, etikett (bgt med flera) */
+   ASM_BR,      /* br etikett */
+   ASM_J,       /* call/jmpi etikett */
+   ASM_RA,      /* op rA (jmp, callr) */
+   ASM_RC,      /* op rC (nextpc) */
+   ASM_NONE,    /* op (ret, eret, break med flera) */
+   ASM_RDCTL,   /* rdctl rC, ctlN */
+   ASM_WRCTL,   /* wrctl ctlN, rA */
+   ASM_CACHE,   /* op imm16(rA) (flushd med flera) */
+   ASM_MOV,     /* mov rC, rA */
+   ASM_MOVI,    /* movi rB, imm16 */
+   ASM_MOVUI,   /* movui rB, imm16 */
+   ASM_MOVHI,   /* movhi rB, imm16 */
+   ASM_MOVIA,   /* movia rB, adress */
+   ASM_SUBI,    /* subi rB, rA, imm16 */
+   ASM_NOP      /* nop */
+};
+
+/********************************************************************************
+* asm_insn_def: Definition av en instruktion i instruktionstabellen.
+********************************************************************************/
+struct asm_insn_def
+{
+   const char* name;        /* Instruktionens namn. */
+   enum asm_insn_kind kind; /* Operandformat. */
+   uint8_t op;              /* Operationskod (OP). */
+   uint8_t opx;             /* Utökad operationskod (OPX) för R-typ. */
+   uint8_t fixed;           /* Fast registerfält (A för ret/eret, C för callr med flera). */
+};
+
+/********************************************************************************
+* asm_insns: Instruktionstabell för Nios II (R1) samt vanliga pseudoinstruktioner.
+********************************************************************************/
+static const struct asm_insn_def asm_insns[] =
+{
+   { "add",     ASM_R3,       0x3A, 0x31, 0  }, { "sub",     ASM_R3,       0x3A, 0x39, 0  },
+   { "and",     ASM_R3,       0x3A, 0x0E, 0  }, { "or",      ASM_R3,       0x3A, 0x16, 0  },
+   { "xor",     ASM_R3,       0x3A, 0x1E, 0  }, { "nor",     ASM_R3,       0x3A, 0x06, 0  },
+   { "sll",     ASM_R3,       0x3A, 0x13, 0  }, { "srl",     ASM_R3,       0x3A, 0x1B, 0  },
+   { "sra",     ASM_R3,       0x3A, 0x3B, 0  }, { "rol",     ASM_R3,       0x3A, 0x03, 0  },
+   { "ror",     ASM_R3,       0x3A, 0x0B, 0  }, { "mul",     ASM_R3,       0x3A, 0x27, 0  },
+   { "mulxss",  ASM_R3,       0x3A, 0x1F, 0  }, { "mulxsu",  ASM_R3,       0x3A, 0x17, 0  },
+   { "mulxuu",  ASM_R3,       0x3A, 0x07, 0  }, { "div",     ASM_R3,       0x3A, 0x25, 0  },
+   { "divu",    ASM_R3,       0x3A, 0x24, 0  }, { "cmpeq",   ASM_R3,       0x3A, 0x20, 0  },
+   { "cmpne",   ASM_R3,       0x3A, 0x18, 0  }, { "cmpge",   ASM_R3,       0x3A, 0x08, 0  },
+   { "cmpgeu",  ASM_R3,       0x3A, 0x28, 0  }, { "cmplt",   ASM_R3,       0x3A, 0x10, 0  },
+   { "cmpltu",  ASM_R3,       0x3A, 0x30, 0  }, { "cmpgt",   ASM_R3_SWAP,  0x3A, 0x10, 0  },
+   { "cmpgtu",  ASM_R3_SWAP,  0x3A, 0x30, 0  }, { "cmple",   ASM_R3_SWAP,  0x3A, 0x08, 0  },
+   { "cmpleu",  ASM_R3_SWAP,  0x3A, 0x28, 0  }, { "slli",    ASM_RI5,      0x3A, 0x12, 0  },
+   { "srli",    ASM_RI5,      0x3A, 0x1A, 0  }, { "srai",    ASM_RI5,      0x3A, 0x3A, 0  },
+   { "roli",    ASM_RI5,      0x3A, 0x02, 0  }, { "addi",    ASM_RI16,     0x04, 0,    0  },
+   { "andi",    ASM_RI16,     0x0C, 0,    0  }, { "ori",     ASM_RI16,     0x14, 0,    0  },
+   { "xori",    ASM_RI16,     0x1C, 0,    0  }, { "andhi",   ASM_RI16,     0x2C, 0,    0  },
+   { "orhi",    ASM_RI16,     0x34, 0,    0  }, { "xorhi",   ASM_RI16,     0x3C, 0,    0  },
+   { "muli",    ASM_RI16,     0x24, 0,    0  }, { "cmpeqi",  ASM_RI16,     0x20, 0,    0  },
+   { "cmpnei",  ASM_RI16,     0x18, 0,    0  }, { "cmpgei",  ASM_RI16,     0x08, 0,    0  },
+   { "cmpgeui", ASM_RI16,     0x28, 0,    0  }, { "cmplti",  ASM_RI16,     0x10, 0,    0  },
+   { "cmpltui", ASM_RI16,     0x30, 0,    0  }, { "cmpgti",  ASM_RI16_P1,  0x08, 0,    0  },
+   { "cmpgtui", ASM_RI16_P1,  0x28, 0,    0  }, { "cmplei",  ASM_RI16_P1,  0x10, 0,    0  },
+   { "cmpleui", ASM_RI16_P1,  0x30, 0,    0  }, { "ldb",     ASM_MEM,      0x07, 0,    0  },
+   { "ldbu",    ASM_MEM,      0x03, 0,    0  }, { "ldh",     ASM_MEM,      0x0F, 0,    0  },
+   { "ldhu",    ASM_MEM,      0x0B, 0,    0  }, { "ldw",     ASM_MEM,      0x17, 0,    0  },
+   { "stb",     ASM_MEM,      0x05, 0,    0  }, { "sth",     ASM_MEM,      0x0D, 0,    0  },
+   { "stw",     ASM_MEM,      0x15, 0,    0  }, { "ldbio",   ASM_MEM,      0x27, 0,    0  },
+   { "ldbuio",  ASM_MEM,      0x23, 0,    0  }, { "ldhio",   ASM_MEM,      0x2F, 0,    0  },
+   { "ldhuio",  ASM_MEM,      0x2B, 0,    0  }, { "ldwio",   ASM_MEM,      0x37, 0,    0  },
+   { "stbio",   ASM_MEM,      0x25, 0,    0  }, { "sthio",   ASM_MEM,      0x2D, 0,    0  },
+   { "stwio",   ASM_MEM,      0x35, 0,    0  }, { "beq",     ASM_BR2,      0x26, 0,    0  },
+   { "bne",     ASM_BR2,      0x1E, 0,    0  }, { "bge",     ASM_BR2,      0x0E, 0,    0  },
+   { "bgeu",    ASM_BR2,      0x2E, 0,    0  }, { "blt",     ASM_BR2,      0x16, 0,    0  },
+   { "bltu",    ASM_BR2,      0x36, 0,    0  }, { "bgt",     ASM_BR2_SWAP, 0x16, 0,    0  },
+   { "bgtu",    ASM_BR2_SWAP, 0x36, 0,    0  }, { "ble",     ASM_BR2_SWAP, 0x0E, 0,    0  },
+   { "bleu",    ASM_BR2_SWAP, 0x2E, 0,    0  }, { "br",      ASM_BR,       0x06, 0,    0  },
+   { "call",    ASM_J,        0x00, 0,    0  }, { "jmpi",    ASM_J,        0x01, 0,    0  },
+   { "jmp",     ASM_RA,       0x3A, 0x0D, 0  }, { "callr",   ASM_RA,       0x3A, 0x1D, 31 },
+   { "nextpc",  ASM_RC,       0x3A, 0x1C, 0  }, { "ret",     ASM_NONE,     0x3A, 0x05, 31 },
+   { "eret",    ASM_NONE,     0x3A, 0x01, 29 }, { "bret",    ASM_NONE,     0x3A, 0x09, 30 },
+   { "trap",    ASM_NONE,     0x3A, 0x2D, 0  }, { "break",   ASM_NONE,     0x3A, 0x34, 0  },
+   { "sync",    ASM_NONE,     0x3A, 0x36, 0  }, { "flushp",  ASM_NONE,     0x3A, 0x04, 0  },
+   { "flushi",  ASM_RA,       0x3A, 0x0C, 0  }, { "initi",   ASM_RA,       0x3A, 0x29, 0  },
+   { "rdctl",   ASM_RDCTL,    0x3A, 0x26, 0  }, { "wrctl",   ASM_WRCTL,    0x3A, 0x2E, 0  },
+   { "flushd",  ASM_CACHE,    0x3B, 0,    0  }, { "flushda", ASM_CACHE,    0x1B, 0,    0  },
+   { "initd",   ASM_CACHE,    0x33, 0,    0  }, { "initda",  ASM_CACHE,    0x13, 0,    0  },
+   { "mov",     ASM_MOV,      0x3A, 0x31, 0  }, { "movi",    ASM_MOVI,     0x04, 0,    0  },
+   { "movui",   ASM_MOVUI,    0x14, 0,    0  }, { "movhi",   ASM_MOVHI,    0x34, 0,    0  },
+   { "movia",   ASM_MOVIA,    0x34, 0,    0  }, { "subi",    ASM_SUBI,     0x04, 0,    0  },
+   { "nop",     ASM_NOP,      0x3A, 0x31, 0  }
+};
+
+/********************************************************************************
+* Namn på kontrollregister ctl0 - ctl15:
+********************************************************************************/
+static const char* const asm_ctl_names[] =
+{
+   "status", "estatus", "bstatus", "ienable", "ipending", "cpuid", "ctl6",
+   "exception", "pteaddr", "tlbacc", "tlbmisc", "ctl11", "badaddr", "config",
+   "mpubase", "mpuacc"
+};
+
+static void asm_process_lines(struct assembler* self,
+                              struct asm_line* lines,
+                              const int count);
+
+/********************************************************************************
+* asm_error: Skriver ut ett felmeddelande med aktuell fil och rad. Fel skrivs
+*            endast ut i pass 2 så att varje fel rapporteras en gång.
+*
+*            - self: Referens till assemblern.
+*            - fmt : Formatsträng enligt printf.
+********************************************************************************/
+static void asm_error(struct assembler* self,
+                      const char* fmt, ...)
+{
+   va_list args;
+   if (self->pass != 2) return;
+   fprintf(stderr, "%s:%d: fel: ", self->file ? self->file : "?", self->line);
+   va_start(args, fmt);
+   vfprintf(stderr, fmt, args);
+   va_end(args);
+   fputc('\n', stderr);
+   self->errors++;
+   return;
+}
+
+/********************************************************************************
+* asm_skip_ws: Returnerar pekare till första tecknet som inte är blanksteg.
+*
+*              - s: Strängen som ska läsas.
+********************************************************************************/
+static inline char* asm_skip_ws(const char* s)
+{
+   while (*s == ' ' || *s == '\t' || *s == '\r') ++s;
+   return (char*)s;
+}
+
+/********************************************************************************
+* asm_trim: Tar bort inledande och avslutande blanksteg i angiven sträng.
+*
+*           - s: Strängen som ska trimmas.
+********************************************************************************/
+static char* asm_trim(char* s)
+{
+   s = asm_skip_ws(s);
+   char* end = s + strlen(s);
+   while (end > s && isspace((unsigned char)end[-1])) *--end = '\0';
+   return s;
+}
+
+/********************************************************************************
+* asm_is_ident: Indikerar ifall angivet tecken får ingå i ett symbolnamn.
+*
+*               - c: Tecknet som ska kontrolleras.
+********************************************************************************/
+static inline bool asm_is_ident(const int c)
+{
+   return isalnum(c) || c == '_' || c == '.' || c == '$';
+}
+
+/********************************************************************************
+* asm_hash: Returnerar hinken i symboltabellen för angivet symbolnamn.
+*
+*           - name: Symbolens namn.
+********************************************************************************/
+static uint32_t asm_hash(const char* name)
+{
+   uint32_t hash = 2166136261u;
+   while (*name) hash = (hash ^ (uint8_t)*name++) * 16777619u;
+   return hash % ASM_HASH_SIZE;
+}
+
+/********************************************************************************
+* asm_lookup: Returnerar angiven symbol, eller NULL om den saknas. Ifall
+*             create är satt skapas symbolen om den inte existerar.
+*
+*             - self  : Referens till assemblern.
+*             - name  : Symbolens namn.
+*             - create: Indikerar ifall symbolen ska skapas om den saknas.
+********************************************************************************/
+static struct asm_symbol* asm_lookup(struct assembler* self,
+                                     const char* name,
+                                     const bool create)
+{
+   const uint32_t hash = asm_hash(name);
+   for (struct asm_symbol* i = self->symtab[hash]; i; i = i->next)
+   {
+      if (!strcmp(i->name, name)) return i;
+   }
+   if (!create) return 0;
+   struct asm_symbol* sym = calloc(1, sizeof(struct asm_symbol));
+   if (!sym) exit(1);
+   snprintf(sym->name, sizeof(sym->name), "%s", name);
+   sym->section = -1;
+   sym->pass = -1;
+   sym->next = self->symtab[hash];
+   self->symtab[hash] = sym;
+   return sym;
+}
+
+/********************************************************************************
+* asm_define: Definierar en symbol i aktuellt pass. Etiketter definieras med
+*             sektionens index och en offset, konstanter med sektion -1.
+*
+*             - self   : Referens till assemblern.
+*             - name   : Symbolens namn.
+*             - value  : Symbolens värde alternativt offset.
+*             - section: Sektionens index, -1 för absoluta värden.
+*             - label  : Indikerar ifall symbolen är en etikett.
+********************************************************************************/
+static void asm_define(struct assembler* self,
+                       const char* name,
+                       const int64_t value,
+                       const int section,
+                       const bool label)
+{
+   struct asm_symbol* sym = asm_lookup(self, name, true);
+   if (label && sym->pass == self->pass)
+   {
+      asm_error(self, "etiketten '%s' är redan definierad", name);
+      return;
+   }
+   if (sym->pass == 0) return;
+   sym->value = value;
+   sym->section = section;
+   sym->pass = self->pass;
+   return;
+}
+
+/********************************************************************************
+* asm_symbol_value: Returnerar symbolens absoluta värde.
+*
+*                   - self: Referens till assemblern.
+*                   - sym : Referens till symbolen.
+********************************************************************************/
+static inline int64_t asm_symbol_value(const struct assembler* self,
+                                       const struct asm_symbol* sym)
+{
+   return sym->section < 0 ? sym->value : sym->value + self->sections[sym->section].base;
+}
+
+/********************************************************************************
+* asm_location: Returnerar absolut adress för aktuell position.
+*
+*               - self: Referens till assemblern.
+********************************************************************************/
+static inline uint32_t asm_location(const struct assembler* self)
+{
+   const struct asm_section* sec = &self->sections[self->cur_section];
+   return sec->base + sec->loc;
+}
+
+/********************************************************************************
+* asm_expr: Tillstånd vid tolkning av uttryck.
+********************************************************************************/
+struct asm_expr
+{
+   struct assembler* as; /* Referens till assemblern. */
+   const char* s;        /* Aktuell position i uttrycket. */
+   bool ok;              /* Indikerar att tolkningen lyckades. */
+};
+
+static int64_t asm_expr_binary(struct asm_expr* self, const int min_prec);
+
+/********************************************************************************
+* asm_expr_primary: Tolkar ett primärt uttryck i form av ett tal, ett tecken,
+*                   en symbol, ett parentesuttryck, en unär operator eller en
+*                   relokeringsoperator (%hi, %lo, %hiadj, %gprel).
+*
+*                   - self: Referens till uttryckstillståndet.
+********************************************************************************/
+static int64_t asm_expr_primary(struct asm_expr* self)
+{
+   self->s = asm_skip_ws(self->s);
+   const char c = *self->s;
+
+   if (c == '(')
+   {
+      self->s++;
+      const int64_t val = asm_expr_binary(self, 0);
+      self->s = asm_skip_ws(self->s);
+      if (*self->s != ')') self->ok = false;
+      else self->s++;
+      return val;
+   }
+   else if (c == '-') { self->s++; return -asm_expr_primary(self); }
+   else if (c == '+') { self->s++; return asm_expr_primary(self); }
+   else if (c == '~') { self->s++; return ~asm_expr_primary(self); }
+   else if (c == '!') { self->s++; return !asm_expr_primary(self); }
+   else if (c == '%')
+   {
+      char name[16] = { 0 };
+      int n = 0;
+      self->s++;
+      while (isalpha((unsigned char)*self->s) && n < 15) name[n++] = *self->s++;
+      self->s = asm_skip_ws(self->s);
+      if (*self->s != '(') { self->ok = false; return 0; }
+      const int64_t val = asm_expr_primary(self);
+      if (!strcmp(name, "hi")) return (val >> 16) & 0xFFFF;
+      if (!strcmp(name, "lo")) return val & 0xFFFF;
+      if (!strcmp(name, "hiadj")) return ((val >> 16) + ((val >> 15) & 1)) & 0xFFFF;
+      if (!strcmp(name, "gprel"))
+      {
+         const struct asm_symbol* gp = asm_lookup(self->as, "_gp", false);
+         if (!gp || gp->pass < 0)
+         {
+            if (self->as->pass == 2) asm_error(self->as, "%%gprel kräver symbolen _gp");
+            return 0;
+         }
+         return val - asm_symbol_value(self->as, gp);
+      }
+      asm_error(self->as, "okänd operator %%%s", name);
+      self->ok = false;
+      return 0;
+   }
+   else if (c == '\'')
+   {
+      int64_t val = (uint8_t)self->s[1];
+      if (self->s[1] == '\\')
+      {
+         const char e = self->s[2];
+         val = e == 'n' ? '\n' : e == 't' ? '\t' : e == 'r' ? '\r' : e == '0' ? 0 : e;
+         self->s++;
+      }
+      self->s += 2;
+      if (*self->s == '\'') self->s++;
+      return val;
+   }
+   else if (isdigit((unsigned char)c))
+   {
+      const char* start = self->s;
+      if (isdigit((unsigned char)c) && (self->s[1] == 'b' || self->s[1] == 'f') &&
+          !asm_is_ident((unsigned char)self->s[2]))
+      {
+         const int num = c - '0';
+         const int index = self->s[1] == 'b' ? self->as->local_count[num] :
+                                               self->as->local_count[num] + 1;
+         char name[32];
+         self->s += 2;
+         snprintf(name, sizeof(name), ".L%d\002%d", num, index);
+         const struct asm_symbol* sym = asm_lookup(self->as, name, false);
+         if (!sym)
+         {
+            if (self->as->pass == 2) asm_error(self->as, "lokal etikett %d saknas", num);
+            return 0;
+         }
+         return asm_symbol_value(self->as, sym);
+      }
+      char* end = 0;
+      int64_t val = 0;
+      if (c == '0' && (self->s[1] == 'b' || self->s[1] == 'B'))
+      {
+         val = (int64_t)strtoull(self->s + 2, &end, 2);
+      }
+      else
+      {
+         val = (int64_t)strtoull(self->s, &end, 0);
+      }
+      if (end == start) self->ok = false;
+      self->s = end;
+      while (*self->s == 'u' || *self->s == 'U' || *self->s == 'l' || *self->s == 'L') self->s++;
+      return val;
+   }
+   else if (asm_is_ident((unsigned char)c))
+   {
+      char name[ASM_NAME_LEN];
+      int n = 0;
+      while (asm_is_ident((unsigned char)*self->s))
+      {
+         if (n < ASM_NAME_LEN - 1) name[n++] = *self->s;
+         self->s++;
+      }
+      name[n] = '\0';
+      if (!strcmp(name, ".")) return asm_location(self->as);
+      const struct asm_symbol* sym = asm_lookup(self->as, name, false);
+      if (!sym || sym->pass < 0)
+      {
+         if (self->as->pass == 2) asm_error(self->as, "odefinierad symbol '%s'", name);
+         return 0;
+      }
+      return asm_symbol_value(self->as, sym);
+   }
+   self->ok = false;
+   return 0;
+}
+
+/********************************************************************************
+* asm_expr_operator: Läser en binär operator och returnerar dess prioritet,
+*                    eller -1 om ingen operator finns. Operatorns längd
+*                    lagras via len.
+*
+*                   - s  : Aktuell position i uttrycket.
+*                   - op : Referens till variabel där operatorn lagras.
+*                   - len: Referens till variabel där operatorns längd lagras.
+********************************************************************************/
+static int asm_expr_operator(const char* s,
+                             int* op,
+                             int* len)
+{
+   static const struct { const char* text; int prec; } ops[] =
+   {
+      { "||", 1 }, { "&&", 2 }, { "==", 6 }, { "!=", 6 }, { "<=", 7 }, { ">=", 7 },
+      { "<<", 8 }, { ">>", 8 }, { "|", 3 }, { "^", 4 }, { "&", 5 }, { "<", 7 },
+      { ">", 7 }, { "+", 9 }, { "-", 9 }, { "*", 10 }, { "/", 10 }, { "%", 10 }
+   };
+   for (int i = 0; i < (int)(sizeof(ops) / sizeof(ops[0])); ++i)
+   {
+      const int n = (int)strlen(ops[i].text);
+      if (!strncmp(s, ops[i].text, n))
+      {
+         *op = i;
+         *len = n;
+         return ops[i].prec;
+      }
+   }
+   return -1;
+}
+
+/********************************************************************************
+* asm_expr_binary: Tolkar binära uttryck via prioritetsklättring.
+*
+*                  - self    : Referens till uttryckstillståndet.
+*                  - min_prec: Lägsta prioritet som får tolkas.
+********************************************************************************/
+static int64_t asm_expr_binary(struct asm_expr* self,
+                               const int min_prec)
+{
+   int64_t lhs = asm_expr_primary(self);
+
+   while (self->ok)
+   {
+      int op = 0, len = 0;
+      self->s = asm_skip_ws(self->s);
+      const int prec = asm_expr_operator(self->s, &op, &len);
+      if (prec < 0 || prec < min_prec) break;
+      self->s += len;
+      const int64_t rhs = asm_expr_binary(self, prec + 1);
+
+      switch (op)
+      {
+         case 0:  lhs = lhs || rhs; break;
+         case 1:  lhs = lhs && rhs; break;
+         case 2:  lhs = lhs == rhs; break;
+         case 3:  lhs = lhs != rhs; break;
+         case 4:  lhs = lhs <= rhs; break;
+         case 5:  lhs = lhs >= rhs; break;
+         case 6:  lhs = lhs << (rhs & 63); break;
+         case 7:  lhs = lhs >> (rhs & 63); break;
+         case 8:  lhs = lhs | rhs; break;
+         case 9:  lhs = lhs ^ rhs; break;
+         case 10: lhs = lhs & rhs; break;
+         case 11: lhs = lhs < rhs; break;
+         case 12: lhs = lhs > rhs; break;
+         case 13: lhs = lhs + rhs; break;
+         case 14: lhs = lhs - rhs; break;
+         case 15: lhs = lhs * rhs; break;
+         case 16: lhs = rhs ? lhs / rhs : 0; break;
+         default: lhs = rhs ? lhs % rhs : 0; break;
+      }
+   }
+   return lhs;
+}
+
+/********************************************************************************
+* asm_eval: Beräknar värdet av angivet uttryck. Vid fel returneras false.
+*
+*           - self: Referens till assemblern.
+*           - s   : Uttrycket som ska beräknas.
+*           - out : Referens till variabel där värdet lagras.
+********************************************************************************/
+static bool asm_eval(struct assembler* self,
+                     const char* s,
+                     int64_t* out)
+{
+   struct asm_expr expr = { self, s, true };
+   *out = asm_expr_binary(&expr, 0);
+   expr.s = asm_skip_ws(expr.s);
+   if (!expr.ok || *expr.s)
+   {
+      asm_error(self, "ogiltigt uttryck '%s'", s);
+      return false;
+   }
+   return true;
+}
+
+/********************************************************************************
+* asm_reg: Returnerar registernumret för angivet registernamn, eller -1 om
+*          namnet inte är ett register.
+*
+*          - s: Registrets namn.
+********************************************************************************/
+static int asm_reg(const char* s)
+{
+   static const struct { const char* name; int num; } aliases[] =
+   {
+      { "zero", 0 }, { "at", 1 }, { "et", 24 }, { "bt", 25 }, { "gp", 26 }, { "sp", 27 },
+      { "fp", 28 }, { "ea", 29 }, { "sstatus", 30 }, { "ba", 30 }, { "ra", 31 }
+   };
+   if ((s[0] == 'r' || s[0] == 'R') && isdigit((unsigned char)s[1]))
+   {
+      char* end = 0;
+      const long num = strtol(s + 1, &end, 10);
+      if (*end == '\0' && num >= 0 && num < 32) return (int)num;
+      return -1;
+   }
+   for (int i = 0; i < (int)(sizeof(aliases) / sizeof(aliases[0])); ++i)
+   {
+      if (!strcasecmp(s, aliases[i].name)) return aliases[i].num;
+   }
+   return -1;
+}
+
+/********************************************************************************
+* asm_ctl: Returnerar numret för angivet kontrollregister, eller -1 om
+*          namnet inte är ett kontrollregister.
+*
+*          - s: Kontrollregistrets namn.
+********************************************************************************/
+static int asm_ctl(const char* s)
+{
+   if (!strncasecmp(s, "ctl", 3) && isdigit((unsigned char)s[3]))
+   {
+      const int num = atoi(s + 3);
+      return num < 32 ? num : -1;
+   }
+   for (int i = 0; i < (int)(sizeof(asm_ctl_names) / sizeof(asm_ctl_names[0])); ++i)
+   {
+      if (!strcasecmp(s, asm_ctl_names[i])) return i;
+   }
+   return -1;
+}
+
+/********************************************************************************
+* asm_split: Delar upp angiven sträng i operander separerade med komman
+*            utanför parenteser och strängar. Antalet operander returneras.
+*
+*            - s  : Strängen som ska delas upp (modifieras).
+*            - ops: Array där pekare till operanderna lagras.
+*            - max: Maximalt antal operander.
+********************************************************************************/
+static int asm_split(char* s,
+                     char* ops[],
+                     const int max)
+{
+   int count = 0, depth = 0;
+   bool quote = false;
+   s = asm_trim(s);
+   if (!*s) return 0;
+   ops[count++] = s;
+
+   for (char* i = s; *i; ++i)
+   {
+      if (*i == '"' && (i == s || i[-1] != '\\')) quote = !quote;
+      else if (quote) continue;
+      else if (*i == '(') depth++;
+      else if (*i == ')') depth--;
+      else if (*i == ',' && depth == 0 && count < max)
+      {
+         *i = '\0';
+         ops[count++] = i + 1;
+      }
+   }
+   for (int i = 0; i < count; ++i) ops[i] = asm_trim(ops[i]);
+   return count;
+}
+
+/********************************************************************************
+* asm_emit: Lägger till angivet värde i aktuell sektion. Innehållet lagras
+*           endast i pass 2, i pass 1 räknas enbart positionen upp.
+*
+*           - self : Referens till assemblern.
+*           - value: Värdet som ska läggas till.
+*           - size : Värdets storlek i byte (1, 2 eller 4).
+********************************************************************************/
+static void asm_emit(struct assembler* self,
+                     const uint32_t value,
+                     const int size)
+{
+   struct asm_section* sec = &self->sections[self->cur_section];
+
+   if (self->pass == 2)
+   {
+      if (sec->loc + size > sec->capacity)
+      {
+         uint32_t capacity = sec->capacity ? sec->capacity : 1024;
+         while (capacity < sec->loc + size) capacity *= 2;
+         sec->data = realloc(sec->data, capacity);
+         if (!sec->data) exit(1);
+         memset(sec->data + sec->capacity, 0, capacity - sec->capacity);
+         sec->capacity = capacity;
+      }
+      for (int i = 0; i < size; ++i) sec->data[sec->loc + i] = (uint8_t)(value >> (8 * i));
+   }
+   sec->loc += size;
+   if (sec->loc > sec->size) sec->size = sec->loc;
+   return;
+}
+
+/********************************************************************************
+* asm_section_select: Väljer angiven sektion, som skapas om den saknas.
+*
+*                     - self: Referens till assemblern.
+*                     - name: Sektionens namn.
+********************************************************************************/
+static void asm_section_select(struct assembler* self,
+                               const char* name)
+{
+   for (int i = 0; i < self->num_sections; ++i)
+   {
+      if (!strcmp(self->sections[i].name, name))
+      {
+         self->cur_section = i;
+         return;
+      }
+   }
+   if (self->num_sections == ASM_MAX_SECTIONS)
+   {
+      asm_error(self, "för många sektioner");
+      return;
+   }
+   struct asm_section* sec = &self->sections[self->num_sections];
+   memset(sec, 0, sizeof(*sec));
+   snprintf(sec->name, sizeof(sec->name), "%s", name);
+   self->cur_section = self->num_sections++;
+   return;
+}
+
+/********************************************************************************
+* asm_active: Indikerar ifall aktuell rad ska assembleras, dvs. att samtliga
+*             omgivande villkorliga block är aktiva.
+*
+*             - self: Referens till assemblern.
+********************************************************************************/
+static inline bool asm_active(const struct assembler* self)
+{
+   return self->cond_depth == 0 || self->cond[self->cond_depth - 1].active;
+}
+
+/********************************************************************************
+* asm_load_file: Läser in angiven fil och returnerar dess rader utan
+*                kommentarer. Kommentarer av typen / * * / kan sträcka sig
+*                över flera rader, kommentarer som inleds med # sträcker sig
+*                till radens slut. Radnumren bevaras för felmeddelanden.
+*
+*                - path : Filens sökväg.
+*                - count: Referens till variabel där antalet rader lagras.
+********************************************************************************/
+static struct asm_line* asm_load_file(const char* path,
+                                      int* count)
+{
+   FILE* fp = fopen(path, "rb");
+   if (!fp) return 0;
+   fseek(fp, 0, SEEK_END);
+   const long size = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+   char* buf = malloc((size_t)size + 1);
+   if (!buf || fread(buf, 1, (size_t)size, fp) != (size_t)size)
+   {
+      fclose(fp);
+      free(buf);
+      return 0;
+   }
+   fclose(fp);
+   buf[size] = '\0';
+
+   bool block = false, line_comment = false, quote = false;
+   int lines = 1;
+
+   for (char* i = buf; *i; ++i)
+   {
+      if (*i == '\n')
+      {
+         lines++;
+         line_comment = false;
+         quote = false;
+      }
+      else if (block)
+      {
+         if (i[0] == '*' && i[1] == '/')
+         {
+            block = false;
+            i[0] = i[1] = ' ';
+            ++i;
+         }
+         else *i = ' ';
+      }
+      else if (line_comment) *i = ' ';
+      else if (quote)
+      {
+         if (*i == '\\' && i[1]) ++i;
+         else if (*i == '"') quote = false;
+      }
+      else if (*i == '"') quote = true;
+      else if (i[0] == '/' && i[1] == '*')
+      {
+         block = true;
+         i[0] = i[1] = ' ';
+         ++i;
+      }
+      else if (*i == '#')
+      {
+         line_comment = true;
+         *i = ' ';
+      }
+   }
+
+   struct asm_line* result = calloc((size_t)lines, sizeof(struct asm_line));
+   char* name = strdup(path);
+   if (!result || !name) exit(1);
+   char* start = buf;
+
+   for (int i = 0; i < lines; ++i)
+   {
+      char* end = strchr(start, '\n');
+      if (end) *end = '\0';
+      result[i].file = name;
+      result[i].line = i + 1;
+      result[i].text = start;
+      start = end ? end + 1 : start + strlen(start);
+   }
+   *count = lines;
+   return result;
+}
+
+/********************************************************************************
+* asm_include: Inkluderar angiven fil. Filen söks först relativt den
+*              inkluderande filens katalog och därefter via angivna sökvägar.
+*
+*              - self: Referens till assemblern.
+*              - name: Filens namn.
+********************************************************************************/
+static void asm_include(struct assembler* self,
+                        const char* name)
+{
+   char path[4096];
+   struct asm_line* lines = 0;
+   int count = 0;
+   const char* slash = self->file ? strrchr(self->file, '/') : 0;
+
+   if (slash && name[0] != '/')
+   {
+      snprintf(path, sizeof(path), "%.*s/%s", (int)(slash - self->file), self->file, name);
+   }
+   else
+   {
+      snprintf(path, sizeof(path), "%s", name);
+   }
+   lines = asm_load_file(path, &count);
+
+   for (int i = 0; !lines && i < self->num_include_dirs; ++i)
+   {
+      snprintf(path, sizeof(path), "%s/%s", self->include_dirs[i], name);
+      lines = asm_load_file(path, &count);
+   }
+   if (!lines)
+   {
+      asm_error(self, "kan inte öppna inkluderingsfilen '%s'", name);
+      self->errors += self->pass == 1;
+      return;
+   }
+   if (self->depth >= ASM_MAX_DEPTH)
+   {
+      asm_error(self, "för djup inkludering av '%s'", name);
+      return;
+   }
+   const char* file = self->file;
+   const int line = self->line;
+   self->depth++;
+   asm_process_lines(self, lines, count);
+   self->depth--;
+   self->file = file;
+   self->line = line;
+   return;
+}
+
+/********************************************************************************
+* asm_string: Tolkar en sträng inom citattecken med escape-sekvenser och
+*             lägger till dess tecken i aktuell sektion.
+*
+*             - self: Referens till assemblern.
+*             - s   : Strängen inklusive citattecken.
+********************************************************************************/
+static void asm_string(struct assembler* self,
+                       const char* s)
+{
+   if (*s != '"')
+   {
+      asm_error(self, "förväntade sträng");
+      return;
+   }
+   for (++s; *s && *s != '"'; ++s)
+   {
+      int c = (uint8_t)*s;
+      if (c == '\\' && s[1])
+      {
+         ++s;
+         c = *s == 'n' ? '\n' : *s == 't' ? '\t' : *s == 'r' ? '\r' :
+             *s == '0' ? 0 : *s == '\\' ? '\\' : *s == '"' ? '"' : (uint8_t)*s;
+      }
+      asm_emit(self, (uint32_t)c, 1);
+   }
+   return;
+}
+
+/********************************************************************************
+* asm_align: Justerar aktuell position till en multipel av angiven storlek.
+*            Utfyllnaden består av nollor, alternativt nop i kodsektioner.
+*
+*            - self : Referens till assemblern.
+*            - align: Justeringen i byte (en tvåpotens).
+********************************************************************************/
+static void asm_align(struct assembler* self,
+                      const uint32_t align)
+{
+   if (align == 0 || (align & (align - 1)))
+   {
+      asm_error(self, "justeringen %u är inte en tvåpotens", align);
+      return;
+   }
+   while (self->sections[self->cur_section].loc & (align - 1))
+   {
+      asm_emit(self, 0, 1);
+   }
+   return;
+}
+
+/********************************************************************************
+* asm_cond_push: Öppnar ett nytt villkorligt block.
+*
+*                - self : Referens till assemblern.
+*                - value: Villkorets värde.
+********************************************************************************/
+static void asm_cond_push(struct assembler* self,
+                          const bool value)
+{
+   if (self->cond_depth == ASM_MAX_COND)
+   {
+      asm_error(self, "för djupt nästlade villkor");
+      return;
+   }
+   const bool parent = asm_active(self);
+   struct asm_cond* cond = &self->cond[self->cond_depth++];
+   cond->parent_active = parent;
+   cond->active = parent && value;
+   cond->taken = value;
+   return;
+}
+
+/********************************************************************************
+* asm_directive: Behandlar ett assemblerdirektiv. Villkorliga direktiv
+*                behandlas alltid, övriga enbart i aktiva block.
+*
+*                - self: Referens till assemblern.
+*                - name: Direktivets namn inklusive inledande punkt.
+*                - args: Direktivets argument.
+********************************************************************************/
+static void asm_directive(struct assembler* self,
+                          const char* name,
+                          char* args)
+{
+   char* ops[ASM_MAX_OPERANDS];
+   int64_t val = 0;
+
+   if (!strcmp(name, ".if") || !strcmp(name, ".ifdef") || !strcmp(name, ".ifndef"))
+   {
+      bool value = false;
+      if (asm_active(self))
+      {
+         if (!strcmp(name, ".if"))
+         {
+            value = asm_eval(self, args, &val) && val != 0;
+         }
+         else
+         {
+            const struct asm_symbol* sym = asm_lookup(self, asm_trim(args), false);
+            const bool defined = sym && (sym->pass == self->pass || sym->pass == 0);
+            value = !strcmp(name, ".ifdef") ? defined : !defined;
+         }
+      }
+      asm_cond_push(self, value);
+      return;
+   }
+   else if (!strcmp(name, ".elseif") || !strcmp(name, ".else"))
+   {
+      if (self->cond_depth == 0)
+      {
+         asm_error(self, "%s utan .if", name);
+         return;
+      }
+      struct asm_cond* cond = &self->cond[self->cond_depth - 1];
+      bool value = !cond->taken;
+      if (value && !strcmp(name, ".elseif") && cond->parent_active)
+      {
+         value = asm_eval(self, args, &val) && val != 0;
+      }
+      cond->active = cond->parent_active && value;
+      cond->taken = cond->taken || value;
+      return;
+   }
+   else if (!strcmp(name, ".endif"))
+   {
+      if (self->cond_depth == 0) asm_error(self, ".endif utan .if");
+      else self->cond_depth--;
+      return;
+   }
+   if (!asm_active(self)) return;
+
+   if (!strcmp(name, ".equ") || !strcmp(name, ".set") || !strcmp(name, ".equiv"))
+   {
+      const int n = asm_split(args, ops, 2);
+      if (n == 1 && !strcmp(name, ".set") && (!strcmp(ops[0], "noat") || !strcmp(ops[0], "at") ||
+                                             !strcmp(ops[0], "nobreak") || !strcmp(ops[0], "break")))
+      {
+         return;
+      }
+      if (n != 2)
+      {
+         asm_error(self, "%s kräver namn och värde", name);
+         return;
+      }
+      if (asm_eval(self, ops[1], &val)) asm_define(self, ops[0], val, -1, false);
+   }
+   else if (!strcmp(name, ".text") || !strcmp(name, ".data") || !strcmp(name, ".bss"))
+   {
+      asm_section_select(self, name);
+   }
+   else if (!strcmp(name, ".section"))
+   {
+      asm_split(args, ops, ASM_MAX_OPERANDS);
+      asm_section_select(self, ops[0]);
+   }
+   else if (!strcmp(name, ".word") || !strcmp(name, ".long") || !strcmp(name, ".int") ||
+            !strcmp(name, ".hword") || !strcmp(name, ".short") || !strcmp(name, ".2byte") ||
+            !strcmp(name, ".4byte") || !strcmp(name, ".byte"))
+   {
+      const int size = name[1] == 'b' ? 1 : (name[1] == 'h' || name[1] == 's' || name[1] == '2') ? 2 : 4;
+      const int n = asm_split(args, ops, ASM_MAX_OPERANDS);
+      for (int i = 0; i < n; ++i)
+      {
+         val = 0;
+         asm_eval(self, ops[i], &val);
+         asm_emit(self, (uint32_t)val, size);
+      }
+   }
+   else if (!strcmp(name, ".ascii") || !strcmp(name, ".asciz") || !strcmp(name, ".string"))
+   {
+      const int n = asm_split(args, ops, ASM_MAX_OPERANDS);
+      for (int i = 0; i < n; ++i)
+      {
+         asm_string(self, ops[i]);
+         if (strcmp(name, ".ascii")) asm_emit(self, 0, 1);
+      }
+   }
+   else if (!strcmp(name, ".skip") || !strcmp(name, ".space") || !strcmp(name, ".zero"))
+   {
+      int64_t fill = 0;
+      const int n = asm_split(args, ops, 2);
+      if (n < 1 || !asm_eval(self, ops[0], &val)) return;
+      if (n == 2) asm_eval(self, ops[1], &fill);
+      for (int64_t i = 0; i < val; ++i) asm_emit(self, (uint32_t)fill, 1);
+   }
+   else if (!strcmp(name, ".align") || !strcmp(name, ".p2align"))
+   {
+      asm_split(args, ops, ASM_MAX_OPERANDS);
+      if (asm_eval(self, ops[0], &val)) asm_align(self, 1u << (val & 31));
+   }
+   else if (!strcmp(name, ".balign"))
+   {
+      asm_split(args, ops, ASM_MAX_OPERANDS);
+      if (asm_eval(self, ops[0], &val)) asm_align(self, (uint32_t)val);
+   }
+   else if (!strcmp(name, ".include"))
+   {
+      char* file = asm_trim(args);
+      const size_t len = strlen(file);
+      if (len < 2 || file[0] != '"' || file[len - 1] != '"')
+      {
+         asm_error(self, ".include kräver ett filnamn inom citattecken");
+         return;
+      }
+      file[len - 1] = '\0';
+      asm_include(self, file + 1);
+   }
+   else if (!strcmp(name, ".error"))
+   {
+      asm_error(self, "%s", asm_trim(args));
+   }
+   else if (!strcmp(name, ".warning"))
+   {
+      if (self->pass == 2) fprintf(stderr, "%s:%d: varning: %s\n", self->file, self->line, asm_trim(args));
+   }
+   else if (!strcmp(name, ".global") || !strcmp(name, ".globl") || !strcmp(name, ".weak") ||
+            !strcmp(name, ".type") || !strcmp(name, ".size") || !strcmp(name, ".file") ||
+            !strcmp(name, ".ident") || !strcmp(name, ".end") || !strcmp(name, ".extern") ||
+            !strcmp(name, ".local"))
+   {
+      return;
+   }
+   else if (!strcmp(name, ".endm") || !strcmp(name, ".endr") || !strcmp(name, ".exitm"))
+   {
+      asm_error(self, "%s utan motsvarande .macro/.rept", name);
+   }
+   else
+   {
+      asm_error(self, "okänt direktiv %s", name);
+   }
+   return;
+}
+
+/********************************************************************************
+* asm_reg_operand: Tolkar ett registeroperand. Vid fel rapporteras ett fel
+*                  och register 0 returneras.
+*
+*                  - self: Referens till assemblern.
+*                  - s   : Operanden som ska tolkas.
+********************************************************************************/
+static unsigned asm_reg_operand(struct assembler* self,
+                                const char* s)
+{
+   const int reg = s ? asm_reg(s) : -1;
+   if (reg < 0)
+   {
+      asm_error(self, "förväntade register, fick '%s'", s ? s : "");
+      return 0;
+   }
+   return (unsigned)reg;
+}
+
+/********************************************************************************
+* asm_imm16: Beräknar ett 16-bitars omedelbart värde. Både signerade och
+*            osignerade värden accepteras (-32768 - 65535).
+*
+*            - self: Referens till assemblern.
+*            - s   : Uttrycket som ska beräknas.
+********************************************************************************/
+static uint32_t asm_imm16(struct assembler* self,
+                          const char* s)
+{
+   int64_t val = 0;
+   if (!s)
+   {
+      asm_error(self, "operand saknas");
+      return 0;
+   }
+   if (asm_eval(self, s, &val) && (val < -32768 || val > 65535))
+   {
+      asm_error(self, "värdet %lld ryms inte i 16 bitar", (long long)val);
+   }
+   return (uint32_t)val & 0xFFFF;
+}
+
+/********************************************************************************
+* asm_mem_operand: Tolkar en minnesoperand på formen offset(rA).
+*
+*                  - self  : Referens till assemblern.
+*                  - s     : Operanden som ska tolkas (modifieras).
+*                  - reg   : Referens till variabel där basregistret lagras.
+*                  - offset: Referens till variabel där offseten lagras.
+********************************************************************************/
+static void asm_mem_operand(struct assembler* self,
+                            char* s,
+                            unsigned* reg,
+                            uint32_t* offset)
+{
+   char* open = s ? strrchr(s, '(') : 0;
+   char* close = open ? strchr(open, ')') : 0;
+   if (!open || !close)
+   {
+      asm_error(self, "förväntade minnesoperand offset(register)");
+      *reg = 0;
+      *offset = 0;
+      return;
+   }
+   *close = '\0';
+   *open = '\0';
+   *reg = asm_reg_operand(self, asm_trim(open + 1));
+   s = asm_trim(s);
+   *offset = *s ? asm_imm16(self, s) : 0;
+   return;
+}
+
+/********************************************************************************
+* asm_branch_offset: Beräknar hoppavståndet till angiven etikett relativt
+*                    instruktionen efter hoppet.
+*
+*                    - self: Referens till assemblern.
+*                    - s   : Etiketten (uttrycket) som ska beräknas.
+********************************************************************************/
+static uint32_t asm_branch_offset(struct assembler* self,
+                                  const char* s)
+{
+   int64_t target = 0;
+   if (!s || !asm_eval(self, s, &target)) return 0;
+   const int64_t offset = target - ((int64_t)asm_location(self) + 4);
+   if (self->pass == 2 && (offset < -32768 || offset > 32767 || (offset & 3)))
+   {
+      asm_error(self, "hoppmålet '%s' är utom räckhåll", s);
+   }
+   return (uint32_t)offset & 0xFFFF;
+}
+
+/********************************************************************************
+* asm_enc_i: Kodar en instruktion av I-typ.
+*
+*            - op : Operationskod.
+*            - a  : Register A.
+*            - b  : Register B.
+*            - imm: 16-bitars omedelbart värde.
+********************************************************************************/
+static inline uint32_t asm_enc_i(const unsigned op,
+                                 const unsigned a,
+                                 const unsigned b,
+                                 const uint32_t imm)
+{
+   return (a << 27) | (b << 22) | ((imm & 0xFFFF) << 6) | op;
+}
+
+/********************************************************************************
+* asm_enc_r: Kodar en instruktion av R-typ.
+*
+*            - opx : Utökad operationskod.
+*            - a   : Register A.
+*            - b   : Register B.
+*            - c   : Register C.
+*            - imm5: 5-bitars omedelbart värde.
+********************************************************************************/
+static inline uint32_t asm_enc_r(const unsigned opx,
+                                 const unsigned a,
+                                 const unsigned b,
+                                 const unsigned c,
+                                 const unsigned imm5)
+{
+   return (a << 27) | (b << 22) | (c << 17) | (opx << 11) | ((imm5 & 0x1F) << 6) | 0x3A;
+}
+
+/********************************************************************************
+* asm_instruction: Assemblerar en instruktion eller pseudoinstruktion.
+*                  Returnerar false ifall namnet inte är en instruktion.
+*
+*                  - self: Referens till assemblern.
+*                  - name: Instruktionens namn.
+*                  - args: Instruktionens operander.
+********************************************************************************/
+static bool asm_instruction(struct assembler* self,
+                            const char* name,
+                            char* args)
+{
+   const struct asm_insn_def* def = 0;
+   char* ops[ASM_MAX_OPERANDS] = { 0 };
+   unsigned ra = 0, rb = 0;
+   uint32_t imm = 0;
+   int64_t val = 0;
+
+   for (int i = 0; i < (int)(sizeof(asm_insns) / sizeof(asm_insns[0])); ++i)
+   {
+      if (!strcasecmp(name, asm_insns[i].name))
+      {
+         def = &asm_insns[i];
+         break;
+      }
+   }
+   if (!def) return false;
+   const int n = asm_split(args, ops, ASM_MAX_OPERANDS);
+   (void)n;
+
+   switch (def->kind)
+   {
+      case ASM_R3:
+         asm_emit(self, asm_enc_r(def->opx, asm_reg_operand(self, ops[1]),
+                                  asm_reg_operand(self, ops[2]), asm_reg_operand(self, ops[0]), 0), 4);
+         break;
+      case ASM_R3_SWAP:
+         asm_emit(self, asm_enc_r(def->opx, asm_reg_operand(self, ops[2]),
+                                  asm_reg_operand(self, ops[1]), asm_reg_operand(self, ops[0]), 0), 4);
+         break;
+      case ASM_RI5:
+         if (ops[2]) asm_eval(self, ops[2], &val);
+         asm_emit(self, asm_enc_r(def->opx, asm_reg_operand(self, ops[1]), 0,
+                                  asm_reg_operand(self, ops[0]), (unsigned)val), 4);
+         break;
+      case ASM_RI16:
+         asm_emit(self, asm_enc_i(def->op, asm_reg_operand(self, ops[1]),
+                                  asm_reg_operand(self, ops[0]), asm_imm16(self, ops[2])), 4);
+         break;
+      case ASM_RI16_P1:
+         if (ops[2]) asm_eval(self, ops[2], &val);
+         asm_emit(self, asm_enc_i(def->op, asm_reg_operand(self, ops[1]),
+                                  asm_reg_operand(self, ops[0]), (uint32_t)(val + 1)), 4);
+         break;
+      case ASM_MEM:
+         rb = asm_reg_operand(self, ops[0]);
+         asm_mem_operand(self, ops[1], &ra, &imm);
+         asm_emit(self, asm_enc_i(def->op, ra, rb, imm), 4);
+         break;
+      case ASM_CACHE:
+         asm_mem_operand(self, ops[0], &ra, &imm);
+         asm_emit(self, asm_enc_i(def->op, ra, 0, imm), 4);
+         break;
+      case ASM_BR2:
+         ra = asm_reg_operand(self, ops[0]);
+         rb = asm_reg_operand(self, ops[1]);
+         asm_emit(self, asm_enc_i(def->op, ra, rb, asm_branch_offset(self, ops[2])), 4);
+         break;
+      case ASM_BR2_SWAP:
+         ra = asm_reg_operand(self, ops[1]);
+         rb = asm_reg_operand(self, ops[0]);
+         asm_emit(self, asm_enc_i(def->op, ra, rb, asm_branch_offset(self, ops[2])), 4);
+         break;
+      case ASM_BR:
+         asm_emit(self, asm_enc_i(def->op, 0, 0, asm_branch_offset(self, ops[0])), 4);
+         break;
+      case ASM_J:
+         if (ops[0]) asm_eval(self, ops[0], &val);
+         if (self->pass == 2 && (((uint32_t)val ^ asm_location(self)) & 0xF0000000u))
+         {
+            asm_error(self, "anropsmålet '%s' är utom räckhåll", ops[0]);
+         }
+         asm_emit(self, ((((uint32_t)val >> 2) & 0x3FFFFFF) << 6) | def->op, 4);
+         break;
+      case ASM_RA:
+         asm_emit(self, asm_enc_r(def->opx, asm_reg_operand(self, ops[0]), 0, def->fixed, 0), 4);
+         break;
+      case ASM_RC:
+         asm_emit(self, asm_enc_r(def->opx, 0, 0, asm_reg_operand(self, ops[0]), 0), 4);
+         break;
+      case ASM_NONE:
+         if (def->opx == 0x2D || def->opx == 0x34)
+         {
+            if (ops[0]) asm_eval(self, ops[0], &val);
+            asm_emit(self, asm_enc_r(def->opx, 0, 0, def->opx == 0x2D ? 29 : 30, (unsigned)val), 4);
+         }
+         else
+         {
+            asm_emit(self, asm_enc_r(def->opx, def->fixed, def->opx == 0x01 ? 30 : 0, 0, 0), 4);
+         }
+         break;
+      case ASM_RDCTL:
+      {
+         const int ctl = ops[1] ? asm_ctl(ops[1]) : -1;
+         if (ctl < 0) asm_error(self, "förväntade kontrollregister");
+         asm_emit(self, asm_enc_r(def->opx, 0, 0, asm_reg_operand(self, ops[0]), (unsigned)ctl), 4);
+         break;
+      }
+      case ASM_WRCTL:
+      {
+         const int ctl = ops[0] ? asm_ctl(ops[0]) : -1;
+         if (ctl < 0) asm_error(self, "förväntade kontrollregister");
+         asm_emit(self, asm_enc_r(def->opx, asm_reg_operand(self, ops[1]), 0, 0, (unsigned)ctl), 4);
+         break;
+      }
+      case ASM_MOV:
+         asm_emit(self, asm_enc_r(def->opx, asm_reg_operand(self, ops[1]), 0,
+                                  asm_reg_operand(self, ops[0]), 0), 4);
+         break;
+      case ASM_MOVI:
+      case ASM_MOVUI:
+      case ASM_MOVHI:
+         asm_emit(self, asm_enc_i(def->op, 0, asm_reg_operand(self, ops[0]), asm_imm16(self, ops[1])), 4);
+         break;
+      case ASM_MOVIA:
+         rb = asm_reg_operand(self, ops[0]);
+         if (ops[1]) asm_eval(self, ops[1], &val);
+         asm_emit(self, asm_enc_i(0x34, 0, rb, (uint32_t)(((val >> 16) + ((val >> 15) & 1)) & 0xFFFF)), 4);
+         asm_emit(self, asm_enc_i(0x04, rb, rb, (uint32_t)val & 0xFFFF), 4);
+         break;
+      case ASM_SUBI:
+         if (ops[2]) asm_eval(self, ops[2], &val);
+         if (self->pass == 2 && (-val < -32768 || -val > 32767))
+         {
+            asm_error(self, "värdet %lld ryms inte i 16 bitar", (long long)val);
+         }
+         asm_emit(self, asm_enc_i(def->op, asm_reg_operand(self, ops[1]),
+                                  asm_reg_operand(self, ops[0]), (uint32_t)-val), 4);
+         break;
+      case ASM_NOP:
+         asm_emit(self, asm_enc_r(def->opx, 0, 0, 0, 0), 4);
+         break;
+   }
+   return true;
+}
+
+/********************************************************************************
+* asm_macro_expand: Expanderar angivet makro med givna argument och
+*                   assemblerar de expanderade raderna. Parametrar refereras
+*                   via \namn, \() används för sammanfogning och \@ ersätts
+*                   med ett unikt nummer per expansion.
+*
+*                   - self : Referens till assemblern.
+*                   - macro: Referens till makrot.
+*                   - args : Makrots argument.
+********************************************************************************/
+static void asm_macro_expand(struct assembler* self,
+                             const struct asm_macro* macro,
+                             char* args)
+{
+   char* ops[ASM_MAX_PARAMS] = { 0 };
+   int n = asm_split(args, ops, ASM_MAX_PARAMS);
+   const int unique = self->macro_count++;
+
+   if (n == 1 && macro->num_params > 1 && strpbrk(ops[0], " \t"))
+   {
+      n = 0;
+      for (char* tok = strtok(ops[0], " \t"); tok && n < ASM_MAX_PARAMS; tok = strtok(0, " \t"))
+      {
+         ops[n++] = tok;
+      }
+   }
+   if (n > macro->num_params)
+   {
+      asm_error(self, "för många argument till makrot %s", macro->name);
+      return;
+   }
+   if (self->depth >= ASM_MAX_DEPTH)
+   {
+      asm_error(self, "för djup makroexpansion av %s", macro->name);
+      return;
+   }
+
+   struct asm_line* lines = calloc((size_t)macro->body_len + 1, sizeof(struct asm_line));
+   if (!lines) exit(1);
+
+   for (int i = 0; i < macro->body_len; ++i)
+   {
+      const char* src = macro->body[i].text;
+      size_t cap = strlen(src) * 2 + 256, len = 0;
+      char* dst = malloc(cap);
+      if (!dst) exit(1);
+
+      while (*src)
+      {
+         char buf[32];
+         const char* rep = 0;
+         size_t skip = 1;
+
+         if (*src == '\\' && src[1] == '@')
+         {
+            snprintf(buf, sizeof(buf), "%d", unique);
+            rep = buf;
+            skip = 2;
+         }
+         else if (*src == '\\' && src[1] == '(' && src[2] == ')')
+         {
+            rep = "";
+            skip = 3;
+         }
+         else if (*src == '\\')
+         {
+            size_t best = 0;
+            for (int j = 0; j < macro->num_params; ++j)
+            {
+               const size_t plen = strlen(macro->params[j]);
+               if (plen > best && !strncmp(src + 1, macro->params[j], plen) &&
+                   !(asm_is_ident((unsigned char)src[1 + plen]) && src[1 + plen] != '.'))
+               {
+                  best = plen;
+                  rep = j < n && *ops[j] ? ops[j] : macro->defaults[j] ? macro->defaults[j] : "";
+               }
+            }
+            if (rep) skip = best + 1;
+         }
+
+         const char* text = rep ? rep : src;
+         const size_t tlen = rep ? strlen(rep) : 1;
+         if (len + tlen + 1 >= cap)
+         {
+            cap = (cap + tlen) * 2;
+            dst = realloc(dst, cap);
+            if (!dst) exit(1);
+         }
+         memcpy(dst + len, text, tlen);
+         len += tlen;
+         src += skip;
+      }
+      dst[len] = '\0';
+      lines[i].file = macro->body[i].file;
+      lines[i].line = macro->body[i].line;
+      lines[i].text = dst;
+   }
+
+   const char* file = self->file;
+   const int line = self->line;
+   self->depth++;
+   asm_process_lines(self, lines, macro->body_len);
+   self->depth--;
+   self->file = file;
+   self->line = line;
+
+   for (int i = 0; i < macro->body_len; ++i) free(lines[i].text);
+   free(lines);
+   return;
+}
+
+/********************************************************************************
+* asm_find_macro: Returnerar makrot med angivet namn, eller NULL om det saknas.
+*
+*                 - self: Referens till assemblern.
+*                 - name: Makrots namn.
+********************************************************************************/
+static const struct asm_macro* asm_find_macro(const struct assembler* self,
+                                              const char* name)
+{
+   for (const struct asm_macro* i = self->macros; i; i = i->next)
+   {
+      if (!strcasecmp(i->name, name)) return i;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* asm_define_macro: Definierar ett makro utifrån raden med .macro samt
+*                   efterföljande rader fram till motsvarande .endm.
+*                   Makron definieras i pass 1 och återanvänds i pass 2.
+*
+*                   - self : Referens till assemblern.
+*                   - args : Makrots namn och parametrar.
+*                   - body : Makrots rader.
+*                   - count: Antalet rader.
+********************************************************************************/
+static void asm_define_macro(struct assembler* self,
+                             char* args,
+                             struct asm_line* body,
+                             const int count)
+{
+   char* ops[ASM_MAX_PARAMS + 1] = { 0 };
+   args = asm_trim(args);
+   char* name = args;
+   while (*args && !isspace((unsigned char)*args) && *args != ',') ++args;
+   if (*args) *args++ = '\0';
+
+   if (asm_find_macro(self, name))
+   {
+      if (self->pass == 1) asm_error(self, "makrot %s är redan definierat", name);
+      return;
+   }
+   struct asm_macro* macro = calloc(1, sizeof(struct asm_macro));
+   if (!macro) exit(1);
+   snprintf(macro->name, sizeof(macro->name), "%s", name);
+
+   int n = asm_split(args, ops, ASM_MAX_PARAMS);
+   if (n == 1 && strpbrk(ops[0], " \t"))
+   {
+      n = 0;
+      for (char* tok = strtok(ops[0], " \t"); tok && n < ASM_MAX_PARAMS; tok = strtok(0, " \t"))
+      {
+         ops[n++] = tok;
+      }
+   }
+   for (int i = 0; i < n; ++i)
+   {
+      char* eq = strchr(ops[i], '=');
+      if (eq)
+      {
+         *eq = '\0';
+         macro->defaults[i] = strdup(asm_trim(eq + 1));
+      }
+      char* colon = strchr(ops[i], ':');
+      if (colon) *colon = '\0';
+      snprintf(macro->params[i], ASM_NAME_LEN, "%s", asm_trim(ops[i]));
+   }
+   macro->num_params = n;
+   macro->body = calloc((size_t)count + 1, sizeof(struct asm_line));
+   if (!macro->body) exit(1);
+
+   for (int i = 0; i < count; ++i)
+   {
+      macro->body[i] = body[i];
+      macro->body[i].text = strdup(body[i].text);
+   }
+   macro->body_len = count;
+   macro->next = self->macros;
+   self->macros = macro;
+   return;
+}
+
+/********************************************************************************
+* asm_first_word: Kopierar radens första ord (utan etiketter) till buf.
+*
+*                 - text: Raden som ska läsas.
+*                 - buf : Buffert där ordet lagras.
+*                 - size: Buffertens storlek.
+********************************************************************************/
+static void asm_first_word(const char* text,
+                           char* buf,
+                           const size_t size)
+{
+   size_t n = 0;
+   text = asm_skip_ws(text);
+   while (asm_is_ident((unsigned char)*text) && n < size - 1) buf[n++] = *text++;
+   buf[n] = '\0';
+   return;
+}
+
+/********************************************************************************
+* asm_statement: Assemblerar en sats, det vill säga etiketter följda av ett
+*                direktiv, en instruktion eller ett makroanrop.
+*
+*                - self: Referens till assemblern.
+*                - s   : Satsen som ska assembleras (modifieras).
+********************************************************************************/
+static void asm_statement(struct assembler* self,
+                          char* s)
+{
+   while (1)
+   {
+      char name[ASM_NAME_LEN];
+      size_t n = 0;
+      s = asm_skip_ws(s);
+      if (!*s) return;
+
+      const char* start = s;
+      while (asm_is_ident((unsigned char)*s))
+      {
+         if (n < ASM_NAME_LEN - 1) name[n++] = *s;
+         ++s;
+      }
+      name[n] = '\0';
+
+      if (n == 0)
+      {
+         if (asm_active(self)) asm_error(self, "oväntat tecken '%c'", *start);
+         return;
+      }
+      if (*asm_skip_ws(s) == ':')
+      {
+         s = asm_skip_ws(s) + 1;
+         if (!asm_active(self)) continue;
+         struct asm_section* sec = &self->sections[self->cur_section];
+
+         if (isdigit((unsigned char)name[0]) && !name[1])
+         {
+            char local[32];
+            const int num = name[0] - '0';
+            snprintf(local, sizeof(local), ".L%d\002%d", num, ++self->local_count[num]);
+            asm_define(self, local, sec->loc, self->cur_section, true);
+         }
+         else
+         {
+            asm_define(self, name, sec->loc, self->cur_section, true);
+         }
+         continue;
+      }
+      if (name[0] == '.')
+      {
+         asm_directive(self, name, s);
+         return;
+      }
+      if (!asm_active(self)) return;
+
+      const struct asm_macro* macro = asm_find_macro(self, name);
+      if (macro)
+      {
+         asm_macro_expand(self, macro, s);
+      }
+      else if (!asm_instruction(self, name, s))
+      {
+         asm_error(self, "okänd instruktion '%s'", name);
+      }
+      return;
+   }
+}
+
+/********************************************************************************
+* asm_block_end: Returnerar index för raden som avslutar ett block som
+*                inleds med .macro eller .rept, eller count om raden saknas.
+*
+*                - lines: Raderna som ska sökas igenom.
+*                - count: Antalet rader.
+*                - first: Index för raden efter blockets början.
+********************************************************************************/
+static int asm_block_end(struct asm_line* lines,
+                         const int count,
+                         const int first)
+{
+   int depth = 1;
+   for (int i = first; i < count; ++i)
+   {
+      char word[ASM_NAME_LEN];
+      asm_first_word(lines[i].text, word, sizeof(word));
+      if (!strcasecmp(word, ".macro") || !strcasecmp(word, ".rept")) depth++;
+      else if (!strcasecmp(word, ".endm") || !strcasecmp(word, ".endr"))
+      {
+         if (--depth == 0) return i;
+      }
+   }
+   return count;
+}
+
+/********************************************************************************
+* asm_process_lines: Assemblerar angivna rader. Block som inleds med .macro
+*                    samlas ihop till makron och block som inleds med .rept
+*                    assembleras angivet antal gånger. Satser på samma rad
+*                    separeras med semikolon.
+*
+*                    - self : Referens till assemblern.
+*                    - lines: Raderna som ska assembleras.
+*                    - count: Antalet rader.
+********************************************************************************/
+static void asm_process_lines(struct assembler* self,
+                              struct asm_line* lines,
+                              const int count)
+{
+   for (int i = 0; i < count; ++i)
+   {
+      char word[ASM_NAME_LEN];
+      self->file = lines[i].file;
+      self->line = lines[i].line;
+      asm_first_word(lines[i].text, word, sizeof(word));
+
+      if (!strcasecmp(word, ".macro") || !strcasecmp(word, ".rept"))
+      {
+         const int end = asm_block_end(lines, count, i + 1);
+         if (end == count)
+         {
+            asm_error(self, "%s saknar avslutning", word);
+            self->errors += self->pass == 1;
+            return;
+         }
+         if (asm_active(self))
+         {
+            char* args = strdup(asm_skip_ws(lines[i].text) + strlen(word));
+            if (!args) exit(1);
+
+            if (!strcasecmp(word, ".macro"))
+            {
+               asm_define_macro(self, args, lines + i + 1, end - i - 1);
+            }
+            else
+            {
+               int64_t times = 0;
+               asm_eval(self, args, &times);
+               for (int64_t j = 0; j < times; ++j)
+               {
+                  asm_process_lines(self, lines + i + 1, end - i - 1);
+               }
+            }
+            free(args);
+         }
+         i = end;
+         continue;
+      }
+
+      char* text = strdup(lines[i].text);
+      if (!text) exit(1);
+      char* stmt = text;
+      bool quote = false;
+
+      for (char* j = text; ; ++j)
+      {
+         if (*j == '"') quote = !quote;
+         if (*j == '\0' || (*j == ';' && !quote))
+         {
+            const bool last = *j == '\0';
+            *j = '\0';
+            asm_statement(self, stmt);
+            if (last) break;
+            stmt = j + 1;
+         }
+      }
+      free(text);
+   }
+   return;
+}
+
+/********************************************************************************
+* asm_provide: Definierar en symbol som annars tillhandahålls av länkaren,
+*              såvida den inte redan är definierad i programmet.
+*
+*              - self : Referens till assemblern.
+*              - name : Symbolens namn.
+*              - value: Symbolens absoluta värde.
+********************************************************************************/
+static void asm_provide(struct assembler* self,
+                        const char* name,
+                        const uint32_t value)
+{
+   struct asm_symbol* sym = asm_lookup(self, name, true);
+   if (sym->pass >= 0) return;
+   sym->value = value;
+   sym->section = -1;
+   sym->pass = 0;
+   return;
+}
+
+/********************************************************************************
+* asm_layout: Placerar sektionerna i minnet. Sektionen .reset placeras på
+*             adress 0 och .exceptions på SIM_EXCEPTION_ADDR, därefter följer
+*             .text, .rodata, .data samt övriga sektioner och sist .sbss samt
+*             .bss. Likt länkaren definieras därefter symbolen _gp 0x7FF0
+*             byte efter början av .sdata samt __bss_start och _end runt
+*             .sbss samt .bss, såvida programmet inte själv definierar dem.
+*
+*             - self: Referens till assemblern.
+********************************************************************************/
+static void asm_layout(struct assembler* self)
+{
+   static const char* const order[] =
+   {
+      ".reset", ".exceptions", ".text", ".rodata", ".data", ".sdata", "*", ".sbss", ".bss"
+   };
+   bool placed[ASM_MAX_SECTIONS] = { false };
+   uint32_t addr = 0, sdata = 0, bss = 0;
+   bool has_sdata = false, has_bss = false;
+
+   for (int i = 0; i < (int)(sizeof(order) / sizeof(order[0])); ++i)
+   {
+      for (int j = 0; j < self->num_sections; ++j)
+      {
+         struct asm_section* sec = &self->sections[j];
+         bool match = !strcmp(order[i], sec->name);
+
+         if (!strcmp(order[i], "*"))
+         {
+            match = true;
+            for (int k = 0; k < (int)(sizeof(order) / sizeof(order[0])); ++k)
+            {
+               if (!strcmp(order[k], sec->name)) match = false;
+            }
+         }
+         if (!match || placed[j]) continue;
+         placed[j] = true;
+
+         if (!strcmp(sec->name, ".exceptions") && sec->size)
+         {
+            if (addr > SIM_EXCEPTION_ADDR) asm_error(self, ".reset är för stor");
+            addr = SIM_EXCEPTION_ADDR;
+         }
+         addr = (addr + 3) & ~3u;
+         sec->base = addr;
+         addr += sec->size;
+
+         if (!has_sdata && (!strcmp(sec->name, ".sdata") || !strcmp(sec->name, ".sbss")))
+         {
+            sdata = (sec->base + 15) & ~15u;
+            has_sdata = true;
+         }
+         if (!has_bss && sec->size && (!strcmp(sec->name, ".sbss") || !strcmp(sec->name, ".bss")))
+         {
+            bss = sec->base;
+            has_bss = true;
+         }
+      }
+   }
+   addr = (addr + 3) & ~3u;
+   asm_provide(self, "_gp", (has_sdata ? sdata : addr) + 0x7FF0);
+   asm_provide(self, "__bss_start", has_bss ? bss : addr);
+   asm_provide(self, "_end", addr);
+   return;
+}
+
+/********************************************************************************
+* asm_run_pass: Genomför ett pass över angiven källfil.
+*
+*               - self: Referens till assemblern.
+*               - path: Källfilens sökväg.
+*               - pass: Passets nummer (1 eller 2).
+********************************************************************************/
+static bool asm_run_pass(struct assembler* self,
+                         const char* path,
+                         const int pass)
+{
+   int count = 0;
+   struct asm_line* lines = asm_load_file(path, &count);
+   if (!lines)
+   {
+      fprintf(stderr, "nios2sim: kan inte öppna '%s'\n", path);
+      return false;
+   }
+   self->pass = pass;
+   self->cond_depth = 0;
+   self->macro_count = 0;
+   self->file = path;
+   self->line = 0;
+   memset(self->local_count, 0, sizeof(self->local_count));
+
+   for (int i = 0; i < self->num_sections; ++i) self->sections[i].loc = 0;
+   asm_section_select(self, ".text");
+   asm_process_lines(self, lines, count);
+
+   if (self->cond_depth != 0) asm_error(self, ".if saknar .endif");
+   return self->errors == 0;
+}
+
+/********************************************************************************
+* asm_assemble: Assemblerar angiven källfil och laddar maskinkoden i
+*               simulatorns minne. Programmets startadress returneras via
+*               entry (symbolen _start, annars adress 0).
+*
+*               - path        : Källfilens sökväg.
+*               - include_dirs: Sökvägar för inkluderingsfiler.
+*               - num_includes: Antalet sökvägar.
+*               - defines     : Symboler på formen NAMN=VÄRDE från kommandoraden.
+*               - num_defines : Antalet symboler.
+*               - ram         : Simulatorns minne.
+*               - ram_size    : Minnets storlek i byte.
+*               - entry       : Referens till variabel där startadressen lagras.
+*               - symbols     : Referens till variabel där assemblern lagras för
+*                               uppslagning av symboler, eller NULL.
+********************************************************************************/
+static bool asm_assemble(const char* path,
+                         const char* include_dirs[],
+                         const int num_includes,
+                         char* defines[],
+                         const int num_defines,
+                         uint8_t* ram,
+                         const uint32_t ram_size,
+                         uint32_t* entry,
+                         struct assembler** symbols)
+{
+   struct assembler* self = calloc(1, sizeof(struct assembler));
+   if (!self) exit(1);
+   for (int i = 0; i < num_includes && i < ASM_MAX_INCLUDES; ++i)
+   {
+      self->include_dirs[self->num_include_dirs++] = include_dirs[i];
+   }
+   for (int i = 0; i < num_defines; ++i)
+   {
+      char name[ASM_NAME_LEN];
+      const char* eq = strchr(defines[i], '=');
+      const size_t len = eq ? (size_t)(eq - defines[i]) : strlen(defines[i]);
+      snprintf(name, sizeof(name), "%.*s", (int)len, defines[i]);
+      struct asm_symbol* sym = asm_lookup(self, name, true);
+      sym->value = eq ? strtoll(eq + 1, 0, 0) : 1;
+      sym->pass = 0;
+   }
+
+   bool ok = asm_run_pass(self, path, 1);
+   if (ok)
+   {
+      asm_layout(self);
+      ok = asm_run_pass(self, path, 2);
+   }
+   if (ok)
+   {
+      for (int i = 0; i < self->num_sections; ++i)
+      {
+         const struct asm_section* sec = &self->sections[i];
+         if (!sec->size) continue;
+         if ((uint64_t)sec->base + sec->size > ram_size)
+         {
+            fprintf(stderr, "nios2sim: sektionen %s ryms inte i minnet\n", sec->name);
+            ok = false;
+            break;
+         }
+         if (sec->data) memcpy(ram + sec->base, sec->data, sec->size);
+      }
+      const struct asm_symbol* start = asm_lookup(self, "_start", false);
+      *entry = start && start->pass > 0 ? (uint32_t)asm_symbol_value(self, start) : 0;
+      if (symbols) *symbols = self;
+   }
+   else
+   {
+      fprintf(stderr, "nios2sim: %d fel vid assemblering av '%s'\n", self->errors, path);
+   }
+   return ok;
+}
+
+/********************************************************************************
+* sim_load_elf: Laddar en ELF-fil för Nios II (32 bitar, little endian) i
+*               simulatorns minne. Programmets startadress returneras via
+*               entry. Returnerar false ifall filen inte är en ELF-fil.
+*
+*               - self : Referens till simulatorn.
+*               - path : Filens sökväg.
+*               - entry: Referens till variabel där startadressen lagras.
+********************************************************************************/
+static bool sim_load_elf(struct sim* self,
+                         const char* path,
+                         uint32_t* entry)
+{
+   uint8_t header[52];
+   FILE* fp = fopen(path, "rb");
+   if (!fp) return false;
+
+   if (fread(header, 1, sizeof(header), fp) != sizeof(header) || memcmp(header, "\177ELF", 4) ||
+       header[4] != 1 || header[5] != 1)
+   {
+      fclose(fp);
+      return false;
+   }
+
+   const uint16_t machine = (uint16_t)(header[18] | header[19] << 8);
+   uint32_t phoff = 0;
+   uint16_t phentsize = 0, phnum = 0;
+   memcpy(entry, header + 24, 4);
+   memcpy(&phoff, header + 28, 4);
+   memcpy(&phentsize, header + 42, 2);
+   memcpy(&phnum, header + 44, 2);
+
+   if (machine != 113)
+   {
+      fprintf(stderr, "nios2sim: '%s' är inte en ELF-fil för Nios II\n", path);
+      fclose(fp);
+      return false;
+   }
+
+   for (uint16_t i = 0; i < phnum; ++i)
+   {
+      uint32_t ph[8];
+      if (fseek(fp, (long)(phoff + (uint32_t)i * phentsize), SEEK_SET) ||
+          fread(ph, 1, sizeof(ph), fp) != sizeof(ph))
+      {
+         break;
+      }
+      const uint32_t type = ph[0], offset = ph[1], paddr = ph[3], filesz = ph[4], memsz = ph[5];
+      if (type != 1) continue;
+
+      if ((uint64_t)paddr + memsz > self->ram_size)
+      {
+         fprintf(stderr, "nios2sim: segment på adress 0x%08x ryms inte i minnet\n", paddr);
+         fclose(fp);
+         return false;
+      }
+      memset(self->ram + paddr, 0, memsz);
+      if (fseek(fp, (long)offset, SEEK_SET) || fread(self->ram + paddr, 1, filesz, fp) != filesz)
+      {
+         fprintf(stderr, "nios2sim: kan inte läsa segment i '%s'\n", path);
+         fclose(fp);
+         return false;
+      }
+   }
+   fclose(fp);
+   return true;
+}
+
+/********************************************************************************
+* sim_uart_fill: Returnerar antalet tecken som återstår i UART:ens sändkö vid
+*                aktuellt antal exekverade instruktioner.
+*
+*                - self: Referens till simulatorn.
+********************************************************************************/
+static uint32_t sim_uart_fill(const struct sim* self)
+{
+   const struct sim_uart* uart = &self->uart;
+   const uint64_t sent = (self->icount - uart->start) / SIM_UART_CHAR_CYCLES;
+   return sent >= uart->fill ? 0 : uart->fill - (uint32_t)sent;
+}
+
+/********************************************************************************
+* sim_irq_lines: Returnerar aktiva avbrottssignaler från samtliga enheter,
+*                där bit n motsvarar avbrottsnummer n.
+*
+*                - self: Referens till simulatorn.
+********************************************************************************/
+static uint32_t sim_irq_lines(const struct sim* self)
+{
+   uint32_t lines = 0;
+   for (int i = 0; i < SIM_NUM_PIOS; ++i)
+   {
+      const struct sim_pio* pio = &self->pio[i];
+      if (pio->irq >= 0 && (pio->edge_capture & pio->irq_mask))
+      {
+         lines |= 1u << pio->irq;
+      }
+   }
+   if (self->timer.timeout && (self->timer.control & SIM_TIMER_ITO))
+   {
+      lines |= 1u << SIM_TIMER_IRQ;
+   }
+   if ((self->uart.control & SIM_UART_WE) && sim_uart_fill(self) < SIM_UART_THRESHOLD)
+   {
+      lines |= 1u << SIM_UART_IRQ;
+   }
+   return lines;
+}
+
+/********************************************************************************
+* sim_pio_set_input: Sätter nya insignaler för angiven PIO-enhet. Ändrade
+*                    bitar registreras som flanker i edgecapture.
+*
+*                    - pio  : Referens till PIO-enheten.
+*                    - value: Ny signalnivå.
+********************************************************************************/
+static void sim_pio_set_input(struct sim_pio* pio,
+                              const uint32_t value)
+{
+   const uint32_t level = value & pio->width_mask;
+   pio->edge_capture |= (pio->data ^ level);
+   pio->data = level;
+   return;
+}
+
+/********************************************************************************
+* sim_timer_update: Uppdaterar intervalltimern till aktuellt antal exekverade
+*                   instruktioner. Vid nedräkning till noll ettställs TO och
+*                   räknaren laddas om med perioden. Utan biten CONT stoppas
+*                   timern efter första nedräkningen.
+*
+*                   - self: Referens till simulatorn.
+********************************************************************************/
+static void sim_timer_update(struct sim* self)
+{
+   struct sim_timer* timer = &self->timer;
+   if (!timer->running) return;
+   const uint64_t cycles = (uint64_t)timer->period + 1;
+   const uint64_t elapsed = self->icount - timer->start;
+   if (elapsed < cycles) return;
+   timer->timeout = true;
+
+   if (timer->control & SIM_TIMER_CONT)
+   {
+      timer->start += elapsed / cycles * cycles;
+   }
+   else
+   {
+      timer->running = false;
+      timer->counter = timer->period;
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_timer_counter: Returnerar intervalltimerns aktuella räknarvärde.
+*
+*                    - self: Referens till simulatorn.
+********************************************************************************/
+static uint32_t sim_timer_counter(struct sim* self)
+{
+   sim_timer_update(self);
+   if (!self->timer.running) return self->timer.counter;
+   return self->timer.period - (uint32_t)(self->icount - self->timer.start);
+}
+
+/********************************************************************************
+* sim_timer_next: Returnerar tidpunkten då intervalltimern nästa gång genererar
+*                 avbrott, eller UINT64_MAX om timern inte kan generera avbrott.
+*
+*                 - self: Referens till simulatorn.
+********************************************************************************/
+static uint64_t sim_timer_next(const struct sim* self)
+{
+   const struct sim_timer* timer = &self->timer;
+   if (!timer->running || !(timer->control & SIM_TIMER_ITO)) return UINT64_MAX;
+   return timer->start + (uint64_t)timer->period + 1;
+}
+
+/********************************************************************************
+* sim_timer_read: Läser ett register i intervalltimern.
+*
+*                 - self: Referens till simulatorn.
+*                 - reg : Registrets index (0 = status, 1 = control osv.).
+********************************************************************************/
+static uint32_t sim_timer_read(struct sim* self,
+                               const uint32_t reg)
+{
+   struct sim_timer* timer = &self->timer;
+   sim_timer_update(self);
+
+   switch (reg)
+   {
+      case 0: return (timer->timeout ? SIM_TIMER_TO : 0) | (timer->running ? SIM_TIMER_RUN : 0);
+      case 1: return timer->control;
+      case 2: return timer->period & 0xFFFF;
+      case 3: return timer->period >> 16;
+      case 4: return timer->snap & 0xFFFF;
+      case 5: return timer->snap >> 16;
+      default: return 0;
+   }
+}
+
+/********************************************************************************
+* sim_timer_write: Skriver till ett register i intervalltimern. Skrivning till
+*                  status nollställer TO, skrivning till en periodhalva
+*                  stoppar timern och laddar räknaren med den nya perioden,
+*                  skrivning till snapl eller snaph läser av räknaren.
+*
+*                  - self : Referens till simulatorn.
+*                  - reg  : Registrets index (0 = status, 1 = control osv.).
+*                  - value: Värdet som ska skrivas.
+********************************************************************************/
+static void sim_timer_write(struct sim* self,
+                            const uint32_t reg,
+                            const uint32_t value)
+{
+   struct sim_timer* timer = &self->timer;
+   const uint32_t counter = sim_timer_counter(self);
+
+   switch (reg)
+   {
+      case 0:
+         timer->timeout = false;
+         break;
+      case 1:
+         timer->control = value & (SIM_TIMER_ITO | SIM_TIMER_CONT);
+         if ((value & SIM_TIMER_STOP) && timer->running)
+         {
+            timer->running = false;
+            timer->counter = counter;
+         }
+         else if ((value & SIM_TIMER_START) && !timer->running)
+         {
+            timer->running = true;
+            timer->start = self->icount - (timer->period - timer->counter);
+         }
+         break;
+      case 2:
+      case 3:
+         if (reg == 2) timer->period = (timer->period & 0xFFFF0000u) | (value & 0xFFFF);
+         else timer->period = (timer->period & 0xFFFF) | (value << 16);
+         timer->running = false;
+         timer->counter = timer->period;
+         break;
+      case 4:
+      case 5:
+         timer->snap = counter;
+         break;
+      default:
+         break;
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_is_timer: Indikerar ifall angiven adress tillhör intervalltimern.
+*
+*               - addr: Adressen som ska slås upp.
+********************************************************************************/
+static inline bool sim_is_timer(const uint32_t addr)
+{
+   return addr - CASE_GOLD_TIMER_BASE < SIM_TIMER_SPAN || addr - CPULATOR_TIMER_BASE < SIM_TIMER_SPAN;
+}
+
+/********************************************************************************
+* sim_uart_next: Returnerar tidpunkten då UART:ens avbrott WI nästa gång
+*                genereras, dvs. när sändkön har tömts under
+*                SIM_UART_THRESHOLD tecken, eller UINT64_MAX om avbrottet
+*                är inaktiverat eller redan väntar.
+*
+*                - self: Referens till simulatorn.
+********************************************************************************/
+static uint64_t sim_uart_next(const struct sim* self)
+{
+   const struct sim_uart* uart = &self->uart;
+   if (!(uart->control & SIM_UART_WE) || sim_uart_fill(self) < SIM_UART_THRESHOLD) return UINT64_MAX;
+   return uart->start + (uint64_t)(uart->fill - SIM_UART_THRESHOLD + 1) * SIM_UART_CHAR_CYCLES;
+}
+
+/********************************************************************************
+* sim_uart_read: Läser ett register i UART:en. Mottagna tecken modelleras
+*                inte, så dataregistret läses alltid som tomt.
+*
+*                - self: Referens till simulatorn.
+*                - reg : Registrets index (0 = data, 1 = control).
+********************************************************************************/
+static uint32_t sim_uart_read(struct sim* self,
+                              const uint32_t reg)
+{
+   const struct sim_uart* uart = &self->uart;
+   const uint32_t fill = sim_uart_fill(self);
+   if (reg == 0) return 0;
+   return ((SIM_UART_FIFO - fill) << SIM_UART_WSPACE) | uart->control |
+          ((uart->control & SIM_UART_WE) && fill < SIM_UART_THRESHOLD ? SIM_UART_WI : 0);
+}
+
+/********************************************************************************
+* sim_uart_write: Skriver till ett register i UART:en. Tecken som skrivs till
+*                 dataregistret läggs i sändkön och skrivs ut direkt, medan
+*                 tecken som skrivs när sändkön är full går förlorade, likt
+*                 UART:en.
+*
+*                 - self : Referens till simulatorn.
+*                 - reg  : Registrets index (0 = data, 1 = control).
+*                 - value: Värdet som ska skrivas.
+********************************************************************************/
+static void sim_uart_write(struct sim* self,
+                           const uint32_t reg,
+                           const uint32_t value)
+{
+   struct sim_uart* uart = &self->uart;
+   const uint32_t fill = sim_uart_fill(self);
+
+   if (reg != 0)
+   {
+      uart->control = value & (SIM_UART_RE | SIM_UART_WE);
+      return;
+   }
+   uart->start = fill ? uart->start + (uint64_t)(uart->fill - fill) * SIM_UART_CHAR_CYCLES : self->icount;
+   uart->fill = fill;
+   if (fill >= SIM_UART_FIFO) return;
+   uart->fill++;
+   uart->chars++;
+   if (uart->echo) putchar((int)(value & 0xFF));
+   return;
+}
+
+/********************************************************************************
+* sim_is_uart: Indikerar ifall angiven adress tillhör UART:en.
+*
+*              - addr: Adressen som ska slås upp.
+********************************************************************************/
+static inline bool sim_is_uart(const uint32_t addr)
+{
+   return addr - CASE_GOLD_UART_BASE < SIM_UART_SPAN || addr - CPULATOR_UART_BASE < SIM_UART_SPAN;
+}
+
+/********************************************************************************
+* sim_find_pio: Returnerar PIO-enheten som angiven adress tillhör, eller NULL
+*               om adressen inte tillhör någon enhet.
+*
+*               - self: Referens till simulatorn.
+*               - addr: Adressen som ska slås upp.
+********************************************************************************/
+static struct sim_pio* sim_find_pio(struct sim* self,
+                                    const uint32_t addr)
+{
+   for (int i = 0; i < (int)(sizeof(sim_regions) / sizeof(sim_regions[0])); ++i)
+   {
+      if (addr - sim_regions[i].base < 16) return &self->pio[sim_regions[i].index];
+   }
+   return 0;
+}
+
+/********************************************************************************
+* sim_mmio_read: Läser ett register i en I/O-enhet. Vid läsning av en
+*                omappad adress avslutas simuleringen med fel.
+*
+*                - self: Referens till simulatorn.
+*                - addr: Registrets adress.
+********************************************************************************/
+static uint32_t sim_mmio_read(struct sim* self,
+                              const uint32_t addr)
+{
+   self->mmio_loads++;
+   if (sim_is_timer(addr)) return sim_timer_read(self, (addr >> 2) & 7);
+   if (sim_is_uart(addr)) return sim_uart_read(self, (addr >> 2) & 1);
+   struct sim_pio* pio = sim_find_pio(self, addr);
+   if (!pio)
+   {
+      fprintf(stderr, "nios2sim: läsning från omappad adress 0x%08x (pc = 0x%08x)\n", addr, self->pc);
+      self->halted = self->error = true;
+      return 0;
+   }
+   switch ((addr >> 2) & 3)
+   {
+      case 0:
+         if (!pio->output) self->input_reads++;
+         return pio == &self->pio[SIM_PIO_BUTTONS] ? ~pio->data & pio->width_mask : pio->data;
+      case 1: return pio->direction;
+      case 2: return pio->irq_mask;
+      default: return pio->edge_capture;
+   }
+}
+
+/********************************************************************************
+* sim_mmio_write: Skriver till ett register i en I/O-enhet. Skrivning till
+*                 edgecapture nollställer de bitar som är ettställda i value.
+*
+*                 - self : Referens till simulatorn.
+*                 - addr : Registrets adress.
+*                 - value: Värdet som ska skrivas.
+********************************************************************************/
+static void sim_mmio_write(struct sim* self,
+                           const uint32_t addr,
+                           const uint32_t value)
+{
+   self->mmio_stores++;
+   if (sim_is_timer(addr))
+   {
+      sim_timer_write(self, (addr >> 2) & 7, value);
+      return;
+   }
+   if (sim_is_uart(addr))
+   {
+      sim_uart_write(self, (addr >> 2) & 1, value);
+      return;
+   }
+   struct sim_pio* pio = sim_find_pio(self, addr);
+   if (!pio)
+   {
+      fprintf(stderr, "nios2sim: skrivning till omappad adress 0x%08x (pc = 0x%08x)\n", addr, self->pc);
+      self->halted = self->error = true;
+      return;
+   }
+   switch ((addr >> 2) & 3)
+   {
+      case 0:
+         if (pio->output)
+         {
+            const uint32_t old = pio->data;
+            pio->data = value & pio->width_mask;
+            self->led_writes++;
+            if (self->trace)
+            {
+               printf("%12llu: %s 0x%03x -> 0x%03x\n", (unsigned long long)self->icount,
+                      pio->name, old, pio->data);
+            }
+         }
+         break;
+      case 1: pio->direction = value & pio->width_mask; break;
+      case 2: pio->irq_mask = value & pio->width_mask; break;
+      default: pio->edge_capture &= ~value; break;
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_fetch: Returnerar instruktionsordet på angiven adress i minnet.
+*
+*            - self: Referens till simulatorn.
+*            - addr: Instruktionens adress.
+********************************************************************************/
+static inline uint32_t sim_fetch(const struct sim* self,
+                                 const uint32_t addr)
+{
+   uint32_t word = 0;
+   if (addr < self->ram_size) memcpy(&word, self->ram + addr, 4);
+   return word;
+}
+
+/********************************************************************************
+* sim_dest: Returnerar destinationsregistret för en föravkodad instruktion,
+*           där r0 ersätts med SIM_DUMMY_REG.
+*
+*           - reg: Destinationsregistret i instruktionsordet.
+********************************************************************************/
+static inline uint8_t sim_dest(const unsigned reg)
+{
+   return reg ? (uint8_t)reg : SIM_DUMMY_REG;
+}
+
+/********************************************************************************
+* sim_decode_plain: Avkodar instruktionsordet på angiven adress utan
+*                   sammanslagning av loopar.
+*
+*                   - self: Referens till simulatorn.
+*                   - pc  : Instruktionens adress.
+*                   - d   : Referens till posten där avkodningen lagras.
+********************************************************************************/
+static void sim_decode_plain(const struct sim* self,
+                             const uint32_t pc,
+                             struct sim_insn* d)
+{
+   static const uint8_t iops[64] =
+   {
+      [0x04] = SIM_OP_ADDI,    [0x0C] = SIM_OP_ANDI,    [0x14] = SIM_OP_ORI,
+      [0x1C] = SIM_OP_XORI,    [0x2C] = SIM_OP_ANDI,    [0x34] = SIM_OP_ORI,
+      [0x3C] = SIM_OP_XORI,    [0x24] = SIM_OP_MULI,    [0x20] = SIM_OP_CMPEQI,
+      [0x18] = SIM_OP_CMPNEI,  [0x08] = SIM_OP_CMPGEI,  [0x28] = SIM_OP_CMPGEUI,
+      [0x10] = SIM_OP_CMPLTI,  [0x30] = SIM_OP_CMPLTUI, [0x07] = SIM_OP_LDB,
+      [0x27] = SIM_OP_LDB,     [0x03] = SIM_OP_LDBU,    [0x23] = SIM_OP_LDBU,
+      [0x0F] = SIM_OP_LDH,     [0x2F] = SIM_OP_LDH,     [0x0B] = SIM_OP_LDHU,
+      [0x2B] = SIM_OP_LDHU,    [0x17] = SIM_OP_LDW,     [0x37] = SIM_OP_LDW,
+      [0x05] = SIM_OP_STB,     [0x25] = SIM_OP_STB,     [0x0D] = SIM_OP_STH,
+      [0x2D] = SIM_OP_STH,     [0x15] = SIM_OP_STW,     [0x35] = SIM_OP_STW,
+      [0x06] = SIM_OP_BR,      [0x26] = SIM_OP_BEQ,     [0x1E] = SIM_OP_BNE,
+      [0x0E] = SIM_OP_BGE,     [0x2E] = SIM_OP_BGEU,    [0x16] = SIM_OP_BLT,
+      [0x36] = SIM_OP_BLTU,    [0x00] = SIM_OP_CALL,    [0x01] = SIM_OP_JMPI,
+      [0x3B] = SIM_OP_NOP,     [0x1B] = SIM_OP_NOP,     [0x33] = SIM_OP_NOP,
+      [0x13] = SIM_OP_NOP
+   };
+   static const uint8_t rops[64] =
+   {
+      [0x31] = SIM_OP_ADD,    [0x39] = SIM_OP_SUB,    [0x0E] = SIM_OP_AND,
+      [0x16] = SIM_OP_OR,     [0x1E] = SIM_OP_XOR,    [0x06] = SIM_OP_NOR,
+      [0x13] = SIM_OP_SLL,    [0x1B] = SIM_OP_SRL,    [0x3B] = SIM_OP_SRA,
+      [0x03] = SIM_OP_ROL,    [0x0B] = SIM_OP_ROR,    [0x12] = SIM_OP_SLLI,
+      [0x1A] = SIM_OP_SRLI,   [0x3A] = SIM_OP_SRAI,   [0x02] = SIM_OP_ROLI,
+      [0x20] = SIM_OP_CMPEQ,  [0x18] = SIM_OP_CMPNE,  [0x08] = SIM_OP_CMPGE,
+      [0x28] = SIM_OP_CMPGEU, [0x10] = SIM_OP_CMPLT,  [0x30] = SIM_OP_CMPLTU,
+      [0x27] = SIM_OP_MUL,    [0x1F] = SIM_OP_MULXSS, [0x17] = SIM_OP_MULXSU,
+      [0x07] = SIM_OP_MULXUU, [0x25] = SIM_OP_DIV,    [0x24] = SIM_OP_DIVU,
+      [0x0D] = SIM_OP_JMP,    [0x05] = SIM_OP_JMP,    [0x1D] = SIM_OP_CALLR,
+      [0x1C] = SIM_OP_NEXTPC, [0x26] = SIM_OP_RDCTL,  [0x2E] = SIM_OP_WRCTL,
+      [0x01] = SIM_OP_ERET,   [0x2D] = SIM_OP_TRAP,   [0x34] = SIM_OP_BREAK,
+      [0x36] = SIM_OP_NOP,    [0x04] = SIM_OP_NOP,    [0x0C] = SIM_OP_NOP,
+      [0x29] = SIM_OP_NOP,    [0x09] = SIM_OP_ILLEGAL
+   };
+
+   const uint32_t word = sim_fetch(self, pc);
+   const unsigned op = word & 0x3F;
+   const unsigned a = word >> 27;
+   const unsigned b = (word >> 22) & 0x1F;
+   const uint32_t imm16 = (word >> 6) & 0xFFFF;
+   const uint32_t simm = (uint32_t)(int32_t)(int16_t)imm16;
+
+   memset(d, 0, sizeof(*d));
+   d->a = (uint8_t)a;
+   d->b = (uint8_t)b;
+
+   if (op == 0x3A)
+   {
+      const unsigned opx = (word >> 11) & 0x3F;
+      d->op = rops[opx] ? rops[opx] : SIM_OP_ILLEGAL;
+      d->c = sim_dest((word >> 17) & 0x1F);
+      d->imm = (word >> 6) & 0x1F;
+
+      if (d->op == SIM_OP_CALLR || d->op == SIM_OP_NEXTPC || d->op == SIM_OP_RDCTL ||
+          d->op == SIM_OP_JMP || d->op == SIM_OP_WRCTL || d->op == SIM_OP_ERET ||
+          d->op == SIM_OP_TRAP || d->op == SIM_OP_BREAK || d->op == SIM_OP_NOP ||
+          d->op == SIM_OP_ILLEGAL)
+      {
+         return;
+      }
+      if (d->c == SIM_DUMMY_REG) d->op = SIM_OP_NOP;
+      return;
+   }
+
+   d->op = iops[op] ? iops[op] : SIM_OP_ILLEGAL;
+   d->c = sim_dest(b);
+
+   switch (op)
+   {
+      case 0x0C: case 0x14: case 0x1C: case 0x28: case 0x30:
+         d->imm = imm16;
+         break;
+      case 0x2C: case 0x34: case 0x3C:
+         d->imm = imm16 << 16;
+         break;
+      case 0x00: case 0x01:
+         d->imm = (pc & 0xF0000000u) | ((word >> 6) << 2);
+         d->c = 31;
+         break;
+      default:
+         d->imm = simm;
+         break;
+   }
+   if (d->op >= SIM_OP_BR && d->op <= SIM_OP_BLTU)
+   {
+      d->imm = pc + 4 + simm;
+      if (d->op == SIM_OP_BR && d->imm == pc) d->op = SIM_OP_IDLE;
+   }
+   if (d->op >= SIM_OP_ADDI && d->op <= SIM_OP_CMPLTUI && d->c == SIM_DUMMY_REG) d->op = SIM_OP_NOP;
+   return;
+}
+
+/********************************************************************************
+* sim_try_fuse: Försöker slå ihop en enkel räkneloop som börjar på angiven
+*               adress till en enda post. Två mönster känns igen:
+*
+*               1. beq rA, rB, slut; addi rC, rC, ±1; br start, där rC är
+*                  rA eller rB (lektionernas delay-subrutin).
+*
+*               2. En loopkropp bestående av nop samt exakt en addi rC, rC, ±1
+*                  som avslutas med bne/blt/bltu tillbaka till start
+*                  (kompilatorgenererade fördröjningsloopar).
+*
+*               - self: Referens till simulatorn.
+*               - pc  : Loopens startadress.
+*               - d   : Referens till posten, som ersätts vid lyckad sammanslagning.
+********************************************************************************/
+static void sim_try_fuse(const struct sim* self,
+                         const uint32_t pc,
+                         struct sim_insn* d)
+{
+   struct sim_insn next, last;
+
+   if (d->op == SIM_OP_BEQ)
+   {
+      sim_decode_plain(self, pc + 4, &next);
+      sim_decode_plain(self, pc + 8, &last);
+      if (next.op == SIM_OP_ADDI && next.a == next.c && (next.c == d->a || next.c == d->b) &&
+          (next.imm == 1 || next.imm == 0xFFFFFFFFu) && d->a != d->b &&
+          last.op == SIM_OP_BR && last.imm == pc)
+      {
+         d->op = SIM_OP_LOOP_COUNT;
+         d->c = next.c;
+         d->step = next.imm == 1 ? 1 : -1;
+         d->len = 3;
+      }
+      return;
+   }
+   if (d->op != SIM_OP_NOP && d->op != SIM_OP_ADDI) return;
+
+   int counter = -1;
+   int8_t step = 0;
+   bool first_is_addi = false;
+
+   for (int i = 0; i < SIM_MAX_LOOP_LEN; ++i)
+   {
+      sim_decode_plain(self, pc + 4 * (uint32_t)i, &next);
+      if (next.op == SIM_OP_NOP) continue;
+
+      if (next.op == SIM_OP_ADDI && counter < 0 && next.a == next.c && next.c != SIM_DUMMY_REG &&
+          (next.imm == 1 || next.imm == 0xFFFFFFFFu))
+      {
+         counter = next.c;
+         step = next.imm == 1 ? 1 : -1;
+         first_is_addi = i == 0;
+         continue;
+      }
+      if (counter >= 0 && next.imm == pc &&
+          ((next.op == SIM_OP_BNE && (next.a == counter) != (next.b == counter)) ||
+           ((next.op == SIM_OP_BLT || next.op == SIM_OP_BLTU) && next.a == counter &&
+            next.b != counter && step == 1)))
+      {
+         d->op = SIM_OP_LOOP_BODY;
+         d->c = (uint8_t)counter;
+         d->a = next.a == counter ? next.b : next.a;
+         d->cond = next.op;
+         d->step = step;
+         d->len = (uint8_t)(i + 1);
+         d->flag = first_is_addi;
+      }
+      return;
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_decode: Avkodar instruktionen på angiven adress och lagrar resultatet
+*             i instruktionscachen.
+*
+*             - self: Referens till simulatorn.
+*             - pc  : Instruktionens adress.
+********************************************************************************/
+static void sim_decode(struct sim* self,
+                       const uint32_t pc)
+{
+   struct sim_insn* d = &self->cache[pc >> 2];
+   if (pc >= self->ram_size || (pc & 3))
+   {
+      memset(d, 0, sizeof(*d));
+      d->op = SIM_OP_ILLEGAL;
+      return;
+   }
+   sim_decode_plain(self, pc, d);
+   if (self->fuse) sim_try_fuse(self, pc, d);
+   if (pc + 4 * SIM_MAX_LOOP_LEN > self->code_end) self->code_end = pc + 4 * SIM_MAX_LOOP_LEN;
+   return;
+}
+
+/********************************************************************************
+* sim_invalidate: Ogiltigförklarar föravkodade instruktioner som påverkas av
+*                 en skrivning till angiven adress, inklusive sammanslagna
+*                 loopar som börjar upp till SIM_MAX_LOOP_LEN ord tidigare.
+*
+*                 - self: Referens till simulatorn.
+*                 - addr: Adressen som har skrivits.
+********************************************************************************/
+static inline void sim_invalidate(struct sim* self,
+                                  const uint32_t addr)
+{
+   if (addr >= self->code_end) return;
+   const uint32_t word = addr >> 2;
+   for (uint32_t i = 0; i < SIM_MAX_LOOP_LEN && i <= word; ++i)
+   {
+      self->cache[word - i].op = SIM_OP_UNDECODED;
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_take_interrupt: Genomför hopp till undantagshanteraren ifall ett
+*                     aktiverat avbrott väntar och avbrott är tillåtna.
+*
+*                     - self: Referens till simulatorn.
+********************************************************************************/
+static void sim_take_interrupt(struct sim* self)
+{
+   self->ctl[4] = sim_irq_lines(self) & self->ctl[3];
+   if (!(self->ctl[0] & 1) || !self->ctl[4]) return;
+   self->ctl[1] = self->ctl[0];
+   self->ctl[0] &= ~3u;
+   self->regs[29] = self->pc + 4;
+   self->pc = SIM_EXCEPTION_ADDR;
+   return;
+}
+
+/********************************************************************************
+* sim_loop_iterations: Returnerar antalet varv som en sammanslagen loop
+*                      genomför innan den avslutas, eller 0 om antalet inte
+*                      kan beräknas.
+*
+*                      - d      : Referens till den sammanslagna posten.
+*                      - counter: Räknarens aktuella värde.
+*                      - limit  : Värdet som räknaren jämförs med.
+********************************************************************************/
+static inline uint64_t sim_loop_iterations(const struct sim_insn* d,
+                                           const uint32_t counter,
+                                           const uint32_t limit)
+{
+   if (d->cond == SIM_OP_BNE)
+   {
+      const uint32_t n = (limit - counter) * (uint32_t)(int32_t)d->step;
+      return n ? n : (1ULL << 32);
+   }
+   if (d->cond == SIM_OP_BLTU)
+   {
+      if (counter == 0xFFFFFFFFu) return 0;
+      return counter < limit ? limit - counter : 1;
+   }
+   if (counter == 0x7FFFFFFFu) return 0;
+   return (int32_t)counter < (int32_t)limit ? (uint64_t)((int64_t)(int32_t)limit - (int32_t)counter) : 1;
+}
+
+/********************************************************************************
+* sim_run_chunk: Exekverar instruktioner tills angivet antal instruktioner
+*                har uppnåtts, eller tills en instruktion kräver kontroll av
+*                avbrott (skrivning till I/O, wrctl, eret samt tom loop).
+*
+*                - self : Referens till simulatorn.
+*                - limit: Antal instruktioner då exekveringen avbryts.
+********************************************************************************/
+static void sim_run_chunk(struct sim* self,
+                          uint64_t limit)
+{
+   uint32_t* const r = self->regs;
+   uint8_t* const ram = self->ram;
+   const uint32_t ram_size = self->ram_size;
+   uint32_t pc = self->pc;
+   uint64_t icount = self->icount;
+
+   while (icount < limit)
+   {
+      const struct sim_insn* d = &self->cache[pc >> 2];
+      uint32_t addr, value;
+      ++icount;
+
+      switch (d->op)
+      {
+         case SIM_OP_UNDECODED:
+            --icount;
+            sim_decode(self, pc);
+            break;
+         case SIM_OP_NOP:     pc += 4; break;
+         case SIM_OP_ADD:     r[d->c] = r[d->a] + r[d->b]; pc += 4; break;
+         case SIM_OP_SUB:     r[d->c] = r[d->a] - r[d->b]; pc += 4; break;
+         case SIM_OP_AND:     r[d->c] = r[d->a] & r[d->b]; pc += 4; break;
+         case SIM_OP_OR:      r[d->c] = r[d->a] | r[d->b]; pc += 4; break;
+         case SIM_OP_XOR:     r[d->c] = r[d->a] ^ r[d->b]; pc += 4; break;
+         case SIM_OP_NOR:     r[d->c] = ~(r[d->a] | r[d->b]); pc += 4; break;
+         case SIM_OP_SLL:     r[d->c] = r[d->a] << (r[d->b] & 31); pc += 4; break;
+         case SIM_OP_SRL:     r[d->c] = r[d->a] >> (r[d->b] & 31); pc += 4; break;
+         case SIM_OP_SRA:     r[d->c] = (uint32_t)((int32_t)r[d->a] >> (r[d->b] & 31)); pc += 4; break;
+         case SIM_OP_ROL:
+            value = r[d->b] & 31;
+            r[d->c] = value ? (r[d->a] << value) | (r[d->a] >> (32 - value)) : r[d->a];
+            pc += 4;
+            break;
+         case SIM_OP_ROR:
+            value = r[d->b] & 31;
+            r[d->c] = value ? (r[d->a] >> value) | (r[d->a] << (32 - value)) : r[d->a];
+            pc += 4;
+            break;
+         case SIM_OP_SLLI:    r[d->c] = r[d->a] << d->imm; pc += 4; break;
+         case SIM_OP_SRLI:    r[d->c] = r[d->a] >> d->imm; pc += 4; break;
+         case SIM_OP_SRAI:    r[d->c] = (uint32_t)((int32_t)r[d->a] >> d->imm); pc += 4; break;
+         case SIM_OP_ROLI:
+            r[d->c] = d->imm ? (r[d->a] << d->imm) | (r[d->a] >> (32 - d->imm)) : r[d->a];
+            pc += 4;
+            break;
+         case SIM_OP_CMPEQ:   r[d->c] = r[d->a] == r[d->b]; pc += 4; break;
+         case SIM_OP_CMPNE:   r[d->c] = r[d->a] != r[d->b]; pc += 4; break;
+         case SIM_OP_CMPGE:   r[d->c] = (int32_t)r[d->a] >= (int32_t)r[d->b]; pc += 4; break;
+         case SIM_OP_CMPGEU:  r[d->c] = r[d->a] >= r[d->b]; pc += 4; break;
+         case SIM_OP_CMPLT:   r[d->c] = (int32_t)r[d->a] < (int32_t)r[d->b]; pc += 4; break;
+         case SIM_OP_CMPLTU:  r[d->c] = r[d->a] < r[d->b]; pc += 4; break;
+         case SIM_OP_MUL:     r[d->c] = r[d->a] * r[d->b]; pc += 4; break;
+         case SIM_OP_MULXSS:
+            r[d->c] = (uint32_t)(((int64_t)(int32_t)r[d->a] * (int32_t)r[d->b]) >> 32);
+            pc += 4;
+            break;
+         case SIM_OP_MULXSU:
+            r[d->c] = (uint32_t)(((int64_t)(int32_t)r[d->a] * (int64_t)r[d->b]) >> 32);
+            pc += 4;
+            break;
+         case SIM_OP_MULXUU:
+            r[d->c] = (uint32_t)(((uint64_t)r[d->a] * r[d->b]) >> 32);
+            pc += 4;
+            break;
+         case SIM_OP_DIV:
+            if (!r[d->b]) r[d->c] = 0;
+            else if (r[d->a] == 0x80000000u && r[d->b] == 0xFFFFFFFFu) r[d->c] = 0x80000000u;
+            else r[d->c] = (uint32_t)((int32_t)r[d->a] / (int32_t)r[d->b]);
+            pc += 4;
+            break;
+         case SIM_OP_DIVU:    r[d->c] = r[d->b] ? r[d->a] / r[d->b] : 0; pc += 4; break;
+         case SIM_OP_ADDI:    r[d->c] = r[d->a] + d->imm; pc += 4; break;
+         case SIM_OP_ANDI:    r[d->c] = r[d->a] & d->imm; pc += 4; break;
+         case SIM_OP_ORI:     r[d->c] = r[d->a] | d->imm; pc += 4; break;
+         case SIM_OP_XORI:    r[d->c] = r[d->a] ^ d->imm; pc += 4; break;
+         case SIM_OP_MULI:    r[d->c] = r[d->a] * d->imm; pc += 4; break;
+         case SIM_OP_CMPEQI:  r[d->c] = r[d->a] == d->imm; pc += 4; break;
+         case SIM_OP_CMPNEI:  r[d->c] = r[d->a] != d->imm; pc += 4; break;
+         case SIM_OP_CMPGEI:  r[d->c] = (int32_t)r[d->a] >= (int32_t)d->imm; pc += 4; break;
+         case SIM_OP_CMPGEUI: r[d->c] = r[d->a] >= d->imm; pc += 4; break;
+         case SIM_OP_CMPLTI:  r[d->c] = (int32_t)r[d->a] < (int32_t)d->imm; pc += 4; break;
+         case SIM_OP_CMPLTUI: r[d->c] = r[d->a] < d->imm; pc += 4; break;
+         case SIM_OP_LDW:
+            addr = (r[d->a] + d->imm) & ~3u;
+            if (addr < ram_size) memcpy(&r[d->c], ram + addr, 4);
+            else
+            {
+               self->pc = pc;
+               self->icount = icount;
+               r[d->c] = sim_mmio_read(self, addr);
+               if (self->halted) limit = icount;
+            }
+            pc += 4;
+            break;
+         case SIM_OP_LDB:
+         case SIM_OP_LDBU:
+         case SIM_OP_LDH:
+         case SIM_OP_LDHU:
+         {
+            const bool half = d->op == SIM_OP_LDH || d->op == SIM_OP_LDHU;
+            addr = (r[d->a] + d->imm) & (half ? ~1u : ~0u);
+            if (addr < ram_size)
+            {
+               uint16_t h = 0;
+               memcpy(&h, ram + addr, half ? 2 : 1);
+               value = h;
+            }
+            else
+            {
+               self->pc = pc;
+               self->icount = icount;
+               value = sim_mmio_read(self, addr & ~3u) >> (8 * (addr & 3));
+               if (self->halted) limit = icount;
+            }
+            if (d->op == SIM_OP_LDB) value = (uint32_t)(int32_t)(int8_t)value;
+            else if (d->op == SIM_OP_LDBU) value &= 0xFF;
+            else if (d->op == SIM_OP_LDH) value = (uint32_t)(int32_t)(int16_t)value;
+            else value &= 0xFFFF;
+            r[d->c] = value;
+            pc += 4;
+            break;
+         }
+         case SIM_OP_STW:
+         case SIM_OP_STH:
+         case SIM_OP_STB:
+         {
+            const int size = d->op == SIM_OP_STW ? 4 : d->op == SIM_OP_STH ? 2 : 1;
+            addr = (r[d->a] + d->imm) & ~(uint32_t)(size - 1);
+            value = r[d->b];
+            if (addr < ram_size)
+            {
+               memcpy(ram + addr, &value, (size_t)size);
+               sim_invalidate(self, addr);
+            }
+            else
+            {
+               self->pc = pc;
+               self->icount = icount;
+               sim_mmio_write(self, addr & ~3u, value << (8 * (addr & 3)));
+               limit = icount;
+            }
+            pc += 4;
+            break;
+         }
+         case SIM_OP_BR:      pc = d->imm; break;
+         case SIM_OP_BEQ:     pc = r[d->a] == r[d->b] ? d->imm : pc + 4; break;
+         case SIM_OP_BNE:     pc = r[d->a] != r[d->b] ? d->imm : pc + 4; break;
+         case SIM_OP_BGE:     pc = (int32_t)r[d->a] >= (int32_t)r[d->b] ? d->imm : pc + 4; break;
+         case SIM_OP_BGEU:    pc = r[d->a] >= r[d->b] ? d->imm : pc + 4; break;
+         case SIM_OP_BLT:     pc = (int32_t)r[d->a] < (int32_t)r[d->b] ? d->imm : pc + 4; break;
+         case SIM_OP_BLTU:    pc = r[d->a] < r[d->b] ? d->imm : pc + 4; break;
+         case SIM_OP_CALL:    r[31] = pc + 4; pc = d->imm; break;
+         case SIM_OP_JMPI:    pc = d->imm; break;
+         case SIM_OP_CALLR:
+            value = r[d->a];
+            r[31] = pc + 4;
+            pc = value;
+            break;
+         case SIM_OP_JMP:     pc = r[d->a]; break;
+         case SIM_OP_NEXTPC:  r[d->c] = pc + 4; pc += 4; break;
+         case SIM_OP_RDCTL:
+            if (d->imm == 4) self->ctl[4] = sim_irq_lines(self) & self->ctl[3];
+            r[d->c] = self->ctl[d->imm];
+            pc += 4;
+            break;
+         case SIM_OP_WRCTL:
+            if (d->imm != 4 && d->imm != 5) self->ctl[d->imm] = r[d->a];
+            pc += 4;
+            limit = icount;
+            break;
+         case SIM_OP_ERET:
+            self->ctl[0] = self->ctl[1];
+            pc = r[29];
+            limit = icount;
+            break;
+         case SIM_OP_TRAP:
+            self->ctl[1] = self->ctl[0];
+            self->ctl[0] &= ~3u;
+            r[29] = pc + 4;
+            pc = SIM_EXCEPTION_ADDR;
+            break;
+         case SIM_OP_BREAK:
+            if (pc != SIM_BENCH_RETURN) fprintf(stderr, "nios2sim: break på adress 0x%08x\n", pc);
+            self->halted = true;
+            limit = icount;
+            break;
+         case SIM_OP_LOOP_COUNT:
+         {
+            const uint8_t other = d->c == d->a ? d->b : d->a;
+            const uint32_t n = (r[other] - r[d->c]) * (uint32_t)(int32_t)d->step;
+            const uint64_t budget = (limit - icount) / 3;
+            if (n == 0) pc = d->imm;
+            else if (n <= budget)
+            {
+               r[d->c] = r[other];
+               icount += 3ULL * n;
+               pc = d->imm;
+            }
+            else if (budget > 0)
+            {
+               r[d->c] += (uint32_t)budget * (uint32_t)(int32_t)d->step;
+               icount += 3 * budget - 1;
+            }
+            else pc += 4;
+            break;
+         }
+         case SIM_OP_LOOP_BODY:
+         {
+            const uint64_t n = sim_loop_iterations(d, r[d->c], r[d->a]);
+            const uint64_t budget = (limit - icount + 1) / d->len;
+            const uint64_t m = n < budget ? n : budget;
+            if (m == 0)
+            {
+               if (d->flag) r[d->c] += (uint32_t)(int32_t)d->step;
+               pc += 4;
+               break;
+            }
+            r[d->c] += (uint32_t)m * (uint32_t)(int32_t)d->step;
+            icount += m * d->len - 1;
+            if (m == n) pc += 4u * d->len;
+            break;
+         }
+         case SIM_OP_IDLE:
+            if ((self->ctl[0] & 1) && (sim_irq_lines(self) & self->ctl[3])) limit = icount;
+            else if (self->next_event < self->num_events || sim_timer_next(self) != UINT64_MAX ||
+                     sim_uart_next(self) != UINT64_MAX)
+            {
+               icount = limit;
+            }
+            else
+            {
+               self->halted = true;
+               limit = icount;
+            }
+            break;
+         default:
+            fprintf(stderr, "nios2sim: ogiltig instruktion 0x%08x på adress 0x%08x\n",
+                    sim_fetch(self, pc), pc);
+            self->halted = self->error = true;
+            limit = icount;
+            break;
+      }
+      if (pc >= ram_size)
+      {
+         fprintf(stderr, "nios2sim: programräknaren 0x%08x är utanför minnet\n", pc);
+         self->halted = self->error = true;
+         break;
+      }
+   }
+   self->pc = pc;
+   self->icount = icount;
+   return;
+}
+
+/********************************************************************************
+* sim_next_limit: Returnerar antalet instruktioner då nästa händelse inträffar,
+*                 dvs. nästa schemalagda insignal, nästa avbrott från
+*                 intervalltimern eller UART:en eller maximalt antal
+*                 instruktioner.
+*
+*                 - self: Referens till simulatorn.
+********************************************************************************/
+static uint64_t sim_next_limit(const struct sim* self)
+{
+   uint64_t limit = self->max_icount ? self->max_icount : UINT64_MAX;
+   if (self->next_event < self->num_events && self->events[self->next_event].time < limit)
+   {
+      limit = self->events[self->next_event].time;
+   }
+   if (sim_timer_next(self) < limit) limit = sim_timer_next(self);
+   if (sim_uart_next(self) < limit) limit = sim_uart_next(self);
+   return limit;
+}
+
+/********************************************************************************
+* sim_run: Exekverar programmet tills det avslutas via en tom loop utan
+*          väntande händelser, ett fel uppstår eller maximalt antal
+*          instruktioner har exekverats. Mellan varje del kontrolleras
+*          schemalagda insignaler samt avbrott.
+*
+*          - self: Referens till simulatorn.
+********************************************************************************/
+static void sim_run(struct sim* self)
+{
+   while (!self->halted)
+   {
+      while (self->next_event < self->num_events &&
+             self->events[self->next_event].time <= self->icount)
+      {
+         const struct sim_event* event = &self->events[self->next_event++];
+         sim_pio_set_input(&self->pio[event->index], event->value);
+      }
+      if (self->max_icount && self->icount >= self->max_icount) break;
+      sim_timer_update(self);
+      sim_take_interrupt(self);
+      sim_run_chunk(self, sim_next_limit(self));
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_init: Initierar simulatorn med angiven minnesstorlek. Samtliga
+*           tryckknappar är uppsläppta och samtliga slide-switchar är nollställda.
+*
+*           - self    : Referens till simulatorn.
+*           - ram_size: Minnets storlek i byte.
+********************************************************************************/
+static bool sim_init(struct sim* self,
+                     const uint32_t ram_size)
+{
+   memset(self, 0, sizeof(*self));
+   self->ram_size = ram_size;
+   self->ram = calloc(ram_size, 1);
+   self->cache = calloc(ram_size / 4 + 1, sizeof(struct sim_insn));
+   self->fuse = true;
+   self->max_icount = SIM_DEFAULT_MAX;
+
+   self->pio[SIM_PIO_LEDS] = (struct sim_pio){ "LEDS", 0, 0, 0, 0, 0x3FF, -1, true };
+   self->pio[SIM_PIO_SWITCHES] = (struct sim_pio){ "SWITCHES", 0, 0, 0, 0, 0x3FF, SIM_SWITCHES_IRQ, false };
+   self->pio[SIM_PIO_BUTTONS] = (struct sim_pio){ "BUTTONS", 0, 0, 0, 0, 0xF, SIM_BUTTONS_IRQ, false };
+   return self->ram && self->cache;
+}
+
+/********************************************************************************
+* sim_add_event: Schemalägger en ändring av insignaler på formen
+*                TID:sw=VÄRDE eller TID:key=MASK, där MASK anger nedtryckta
+*                tryckknappar. Händelserna hålls sorterade efter tid.
+*
+*                - self: Referens till simulatorn.
+*                - spec: Händelsen som ska schemaläggas.
+********************************************************************************/
+static bool sim_add_event(struct sim* self,
+                          const char* spec)
+{
+   char* end = 0;
+   struct sim_event event;
+   event.time = strtoull(spec, &end, 0);
+
+   if (*end != ':' || self->num_events == SIM_MAX_EVENTS) return false;
+   if (!strncmp(end + 1, "sw=", 3)) event.index = SIM_PIO_SWITCHES;
+   else if (!strncmp(end + 1, "key=", 4)) event.index = SIM_PIO_BUTTONS;
+   else return false;
+   event.value = (uint32_t)strtoul(strchr(end, '=') + 1, 0, 0);
+
+   int i = self->num_events++;
+   while (i > 0 && self->events[i - 1].time > event.time)
+   {
+      self->events[i] = self->events[i - 1];
+      --i;
+   }
+   self->events[i] = event;
+   return true;
+}
+
+/********************************************************************************
+* sim_print_leds: Skriver ut lysdiodernas tillstånd, där tända lysdioder
+*                 markeras med * och släckta med punkt (LED9 först).
+*
+*                 - self: Referens till simulatorn.
+********************************************************************************/
+static void sim_print_leds(const struct sim* self)
+{
+   const uint32_t leds = self->pio[SIM_PIO_LEDS].data;
+   printf("LEDS: 0x%03x [", leds);
+   for (int i = 9; i >= 0; --i) putchar(leds & (1u << i) ? '*' : '.');
+   printf("]\n");
+   return;
+}
+
+/********************************************************************************
+* sim_profile_print: Skriver ut tabellen profile_regions från profile.s i
+*                    samma format som profile_print i profile.h, dvs. antal
+*                    mätningar samt kortaste, genomsnittlig och längsta tid
+*                    per region med minst en mätning, följt av regionens fack
+*                    i histogrammet som inte är tomma. Returnerar false ifall
+*                    programmet saknar tabellen, exempelvis då det inte har
+*                    assemblerats med symbolen PROFILE.
+*
+*                    - self   : Referens till simulatorn.
+*                    - symbols: Referens till assemblern, NULL för ELF-filer.
+********************************************************************************/
+static bool sim_profile_print(const struct sim* self,
+                              struct assembler* symbols)
+{
+   const struct asm_symbol* table = symbols ? asm_lookup(symbols, "profile_regions", false) : 0;
+   const struct asm_symbol* regions = symbols ? asm_lookup(symbols, "PROFILE_REGIONS", false) : 0;
+   const struct asm_symbol* size = symbols ? asm_lookup(symbols, "PROFILE_REGION_SIZE", false) : 0;
+   const struct asm_symbol* bins = symbols ? asm_lookup(symbols, "PROFILE_BINS", false) : 0;
+
+   if (!table || table->pass < 0 || !regions || !size || !bins) return false;
+   printf("Region    Antal        Min      Medel        Max (klockpulser)\n");
+
+   for (uint32_t i = 0; i < (uint32_t)asm_symbol_value(symbols, regions); ++i)
+   {
+      const uint32_t base = (uint32_t)(asm_symbol_value(symbols, table) + i * asm_symbol_value(symbols, size));
+      const uint32_t count = sim_fetch(self, base + SIM_PROFILE_COUNT);
+      const uint64_t sum = sim_fetch(self, base + SIM_PROFILE_SUM) |
+                           (uint64_t)sim_fetch(self, base + SIM_PROFILE_SUM + 4) << 32;
+      if (!count) continue;
+      printf("%6lu %8lu %10lu %10lu %10lu\n", (unsigned long)i, (unsigned long)count,
+             (unsigned long)sim_fetch(self, base + SIM_PROFILE_MIN), (unsigned long)(sum / count),
+             (unsigned long)sim_fetch(self, base + SIM_PROFILE_MAX));
+
+      for (uint32_t j = 0; j < (uint32_t)asm_symbol_value(symbols, bins); ++j)
+      {
+         const uint32_t hits = sim_fetch(self, base + SIM_PROFILE_HIST + j * 4);
+         if (hits) printf("       < 2^%-2lu %8lu\n", (unsigned long)j, (unsigned long)hits);
+      }
+   }
+   return true;
+}
+
+/********************************************************************************
+* sim_bench_value: Tolkar ett värde vid mätning av subrutiner, som anges som
+*                  ett tal, en symbol eller @ (arbetsminnet), eventuellt
+*                  följt av +N. Returnerar false vid ogiltigt värde.
+*
+*                  - symbols: Referens till assemblern, NULL för ELF-filer.
+*                  - text   : Värdet som ska tolkas.
+*                  - value  : Referens till variabel där värdet lagras.
+********************************************************************************/
+static bool sim_bench_value(struct assembler* symbols,
+                            const char* text,
+                            uint32_t* value)
+{
+   char name[ASM_NAME_LEN];
+   char* end = 0;
+   const char* plus = strchr(text, '+');
+   const size_t len = plus ? (size_t)(plus - text) : strlen(text);
+   snprintf(name, sizeof(name), "%.*s", (int)len, text);
+
+   if (!strcmp(name, "@"))
+   {
+      *value = SIM_BENCH_SCRATCH;
+   }
+   else if (isdigit((unsigned char)name[0]) || name[0] == '-')
+   {
+      *value = (uint32_t)strtoll(name, &end, 0);
+      if (*end) return false;
+   }
+   else
+   {
+      const struct asm_symbol* sym = symbols ? asm_lookup(symbols, name, false) : 0;
+      if (!sym || sym->pass < 0) return false;
+      *value = (uint32_t)asm_symbol_value(symbols, sym);
+   }
+
+   if (plus)
+   {
+      *value += (uint32_t)strtoll(plus + 1, &end, 0);
+      if (*end) return false;
+   }
+   return true;
+}
+
+/********************************************************************************
+* sim_bench_parse: Tolkar en mätning på formen RUTIN[:REG=VÄRDE,...], där
+*                  angivna register tilldelas respektive värde vid varje
+*                  anrop. Returnerar false vid ogiltig mätning.
+*
+*                  - bench  : Referens till mätningen.
+*                  - symbols: Referens till assemblern, NULL för ELF-filer.
+*                  - spec   : Mätningen som angiven på kommandoraden.
+********************************************************************************/
+static bool sim_bench_parse(struct sim_bench* bench,
+                            struct assembler* symbols,
+                            const char* spec)
+{
+   char name[ASM_NAME_LEN];
+   const char* colon = strchr(spec, ':');
+   const char* arg = colon ? colon + 1 : 0;
+   snprintf(name, sizeof(name), "%.*s", colon ? (int)(colon - spec) : (int)strlen(spec), spec);
+   bench->spec = spec;
+   bench->num_args = 0;
+   if (!sim_bench_value(symbols, name, &bench->routine)) return false;
+
+   while (arg && *arg)
+   {
+      char item[2 * ASM_NAME_LEN];
+      const char* comma = strchr(arg, ',');
+      snprintf(item, sizeof(item), "%.*s", comma ? (int)(comma - arg) : (int)strlen(arg), arg);
+      char* eq = strchr(item, '=');
+      if (!eq || bench->num_args == SIM_BENCH_ARGS) return false;
+      *eq = '\0';
+
+      const int reg = asm_reg(item);
+      if (reg <= 0 || !sim_bench_value(symbols, eq + 1, &bench->values[bench->num_args])) return false;
+      bench->regs[bench->num_args++] = (uint8_t)reg;
+      arg = comma ? comma + 1 : 0;
+   }
+   return true;
+}
+
+/********************************************************************************
+* sim_bench_run: Anropar subrutinen angivet antal gånger med angivna register,
+*                där stackpekaren sätts till SIM_BENCH_STACK och återhopp
+*                sker till en instruktion break på SIM_BENCH_RETURN. Antalet
+*                instruktioner (exklusive break) samt åtkomster av
+*                I/O-register per anrop lagras i mätningen. Returnerar false
+*                ifall subrutinen inte återvänder till anroparen.
+*
+*                - self : Referens till simulatorn.
+*                - bench: Referens till mätningen.
+*                - calls: Antalet anrop.
+********************************************************************************/
+static bool sim_bench_run(struct sim* self,
+                          struct sim_bench* bench,
+                          const uint32_t calls)
+{
+   const uint64_t icount = self->icount;
+   const uint64_t loads = self->mmio_loads;
+   const uint64_t stores = self->mmio_stores;
+
+   for (uint32_t i = 0; i < calls; ++i)
+   {
+      for (int j = 0; j < bench->num_args; ++j)
+      {
+         self->regs[bench->regs[j]] = bench->values[j];
+      }
+      self->regs[27] = SIM_BENCH_STACK;
+      self->regs[31] = SIM_BENCH_RETURN;
+      self->pc = bench->routine;
+      self->halted = false;
+      self->max_icount = self->icount + SIM_BENCH_LIMIT;
+      sim_run(self);
+
+      if (self->error || self->pc != SIM_BENCH_RETURN)
+      {
+         fprintf(stderr, "nios2sim: %s återvände inte till anroparen\n", bench->spec);
+         return false;
+      }
+   }
+   bench->instructions = (double)(self->icount - icount - calls) / calls;
+   bench->loads = (double)(self->mmio_loads - loads) / calls;
+   bench->stores = (double)(self->mmio_stores - stores) / calls;
+   return true;
+}
+
+/********************************************************************************
+* sim_json_field: Skriver ett fält med en JSON-sträng på formen
+*                 "namn": "värde" till angiven buffert, där citattecken och
+*                 omvända snedstreck i värdet föregås av ett omvänt
+*                 snedstreck.
+*
+*                 - out  : Buffert för fältet.
+*                 - size : Buffertens storlek.
+*                 - name : Fältets namn.
+*                 - value: Fältets värde.
+********************************************************************************/
+static void sim_json_field(char* out,
+                           const size_t size,
+                           const char* name,
+                           const char* value)
+{
+   size_t len = (size_t)snprintf(out, size, "\"%s\": \"", name);
+
+   for (const char* c = value; *c && len + 3 < size; ++c)
+   {
+      if (*c == '"' || *c == '\\') out[len++] = '\\';
+      out[len++] = *c;
+   }
+   if (len + 1 < size) out[len++] = '"';
+   out[len < size ? len : size - 1] = '\0';
+   return;
+}
+
+/********************************************************************************
+* sim_json_number: Returnerar talet i angivet fält på en JSON-rad, eller -1
+*                  om fältet saknas.
+*
+*                  - line: JSON-raden.
+*                  - name: Fältets namn.
+********************************************************************************/
+static double sim_json_number(const char* line,
+                              const char* name)
+{
+   char key[64];
+   snprintf(key, sizeof(key), "\"%s\": ", name);
+   const char* field = strstr(line, key);
+   return field ? strtod(field + strlen(key), 0) : -1;
+}
+
+/********************************************************************************
+* sim_bench_print: Skriver ut en mätning, antingen som text eller som en
+*                  JSON-rad med programmets sökväg, mätningen, antalet
+*                  anrop samt medelvärden per anrop.
+*
+*                  - bench: Referens till mätningen.
+*                  - path : Programmets sökväg.
+*                  - calls: Antalet anrop.
+*                  - json : Indikerar ifall mätningen skrivs ut som JSON.
+********************************************************************************/
+static void sim_bench_print(const struct sim_bench* bench,
+                            const char* path,
+                            const uint32_t calls,
+                            const bool json)
+{
+   const double ns = bench->instructions * 1e9 / SIM_CLOCK_HZ;
+
+   if (json)
+   {
+      char program[512], name[256];
+      sim_json_field(program, sizeof(program), "program", path);
+      sim_json_field(name, sizeof(name), "benchmark", bench->spec);
+      printf("{%s, %s, \"calls\": %u, \"instructions_per_op\": %.3f, \"ns_per_op\": %.1f, "
+             "\"mmio_loads_per_op\": %.3f, \"mmio_stores_per_op\": %.3f}\n",
+             program, name, calls, bench->instructions, ns, bench->loads, bench->stores);
+   }
+   else
+   {
+      printf("%s: %.1f instruktioner (%.0f ns), %.2f läsningar och %.2f skrivningar av I/O per anrop\n",
+             bench->spec, bench->instructions, ns, bench->loads, bench->stores);
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_bench_compare: Jämför mätningarna mot motsvarande rader i angiven
+*                    baslinje, som utgörs av JSON-rader från sim_bench_print.
+*                    Mätningar med fler instruktioner, läsningar eller
+*                    skrivningar per anrop än baslinjen skrivs ut som
+*                    försämringar, vars antal returneras (-1 om baslinjen
+*                    inte kan öppnas). Mätningar som saknas i baslinjen
+*                    skrivs ut men räknas inte som försämringar.
+*
+*                    - benches : Referens till mätningarna.
+*                    - count   : Antalet mätningar.
+*                    - path    : Programmets sökväg.
+*                    - baseline: Baslinjens sökväg.
+********************************************************************************/
+static int sim_bench_compare(const struct sim_bench* benches,
+                             const int count,
+                             const char* path,
+                             const char* baseline)
+{
+   FILE* fp = fopen(baseline, "r");
+   char line[1024], program[512], name[256];
+   bool found[SIM_BENCH_MAX] = { false };
+   int regressions = 0;
+
+   if (!fp)
+   {
+      fprintf(stderr, "nios2sim: kan inte öppna baslinjen '%s'\n", baseline);
+      return -1;
+   }
+   sim_json_field(program, sizeof(program), "program", path);
+
+   while (fgets(line, sizeof(line), fp))
+   {
+      if (!strstr(line, program)) continue;
+
+      for (int i = 0; i < count; ++i)
+      {
+         sim_json_field(name, sizeof(name), "benchmark", benches[i].spec);
+         if (!strstr(line, name)) continue;
+
+         const struct sim_bench* bench = &benches[i];
+         const double instructions = sim_json_number(line, "instructions_per_op");
+         const double loads = sim_json_number(line, "mmio_loads_per_op");
+         const double stores = sim_json_number(line, "mmio_stores_per_op");
+         found[i] = true;
+
+         if (bench->instructions > instructions + 0.0005 || bench->loads > loads + 0.0005 ||
+             bench->stores > stores + 0.0005)
+         {
+            fprintf(stderr, "nios2sim: %s har försämrats: %.3f -> %.3f instruktioner, "
+                    "%.3f -> %.3f läsningar, %.3f -> %.3f skrivningar per anrop\n", bench->spec,
+                    instructions, bench->instructions, loads, bench->loads, stores, bench->stores);
+            ++regressions;
+         }
+         else if (bench->instructions < instructions - 0.0005)
+         {
+            fprintf(stderr, "nios2sim: %s har förbättrats: %.3f -> %.3f instruktioner per anrop\n",
+                    bench->spec, instructions, bench->instructions);
+         }
+      }
+   }
+   fclose(fp);
+
+   for (int i = 0; i < count; ++i)
+   {
+      if (!found[i]) fprintf(stderr, "nios2sim: %s saknas i baslinjen\n", benches[i].spec);
+   }
+   return regressions;
+}
+
+/********************************************************************************
+* sim_stack_code: Indikerar ifall angiven adress ligger i någon av
+*                 kodsektionerna .reset, .exceptions eller .text.
+*
+*                 - symbols: Referens till assemblern.
+*                 - addr   : Adressen som ska kontrolleras.
+********************************************************************************/
+static bool sim_stack_code(const struct assembler* symbols,
+                           const uint32_t addr)
+{
+   for (int i = 0; i < symbols->num_sections; ++i)
+   {
+      const struct asm_section* sec = &symbols->sections[i];
+      if (strcmp(sec->name, ".reset") && strcmp(sec->name, ".exceptions") &&
+          strcmp(sec->name, ".text")) continue;
+      if (addr >= sec->base && addr < sec->base + sec->size) return true;
+   }
+   return false;
+}
+
+/********************************************************************************
+* sim_stack_name: Skriver namnet på etiketten för angiven adress till angiven
+*                 buffert, alternativt adressen ifall etikett saknas.
+*
+*                 - self: Referens till stackanalysen.
+*                 - addr: Adressen vars namn efterfrågas.
+*                 - name: Buffert för namnet.
+*                 - size: Buffertens storlek.
+********************************************************************************/
+static void sim_stack_name(const struct sim_stack* self,
+                           const uint32_t addr,
+                           char* name,
+                           const size_t size)
+{
+   for (int i = 0; i < ASM_HASH_SIZE; ++i)
+   {
+      for (const struct asm_symbol* sym = self->symbols->symtab[i]; sym; sym = sym->next)
+      {
+         if (sym->section < 0 || sym->pass <= 0 || sym->name[0] == '.') continue;
+
+         if ((uint32_t)asm_symbol_value(self->symbols, sym) == addr)
+         {
+            snprintf(name, size, "%s", sym->name);
+            return;
+         }
+      }
+   }
+   snprintf(name, size, "0x%lx", (unsigned long)addr);
+   return;
+}
+
+/********************************************************************************
+* sim_stack_targets: Samlar möjliga mål för indirekta anrop, dvs. adresser i
+*                    kodsektionerna som laddas via movia (movhi följt av addi
+*                    till samma register), exempelvis avbrottsrutiner som
+*                    registreras via irq_register.
+*
+*                    - self: Referens till stackanalysen.
+********************************************************************************/
+static void sim_stack_targets(struct sim_stack* self)
+{
+   for (uint32_t pc = 0; pc + 8 <= self->code_end; pc += 4)
+   {
+      const uint32_t hi = sim_fetch(self->sim, pc);
+      const uint32_t lo = sim_fetch(self->sim, pc + 4);
+      const unsigned reg = (hi >> 22) & 0x1F;
+      if (!sim_stack_code(self->symbols, pc)) continue;
+      if ((hi & 0x3F) != 0x34 || (hi >> 27) != 0 || (lo & 0x3F) != 0x04) continue;
+      if (((lo >> 27) & 0x1F) != reg || ((lo >> 22) & 0x1F) != reg) continue;
+
+      const uint32_t addr = (((hi >> 6) & 0xFFFF) << 16) + (uint32_t)(int16_t)((lo >> 6) & 0xFFFF);
+      bool known = false;
+      if (!sim_stack_code(self->symbols, addr) || (addr & 3)) continue;
+
+      for (int i = 0; i < self->num_targets; ++i)
+      {
+         if (self->targets[i] == addr) known = true;
+      }
+      if (!known && self->num_targets < SIM_STACK_TARGETS) self->targets[self->num_targets++] = addr;
+   }
+   return;
+}
+
+/********************************************************************************
+* sim_stack_warn: Skriver ut en varning vid stackanalysen för angiven adress.
+*
+*                 - self   : Referens till stackanalysen.
+*                 - addr   : Adressen som varningen avser.
+*                 - message: Varningens text.
+********************************************************************************/
+static void sim_stack_warn(struct sim_stack* self,
+                           const uint32_t addr,
+                           const char* message)
+{
+   char name[ASM_NAME_LEN];
+   sim_stack_name(self, addr, name, sizeof(name));
+   fprintf(stderr, "nios2sim: varning: %s (%s)\n", message, name);
+   self->warnings++;
+   return;
+}
+
+/********************************************************************************
+* sim_stack_find: Returnerar en referens till angiven subrutin bland
+*                 analyserade subrutiner, eller NULL om den saknas.
+*
+*                 - self: Referens till stackanalysen.
+*                 - addr: Subrutinens adress.
+********************************************************************************/
+static struct sim_stack_routine* sim_stack_find(struct sim_stack* self,
+                                                const uint32_t addr)
+{
+   for (int i = 0; i < self->num_routines; ++i)
+   {
+      if (self->routines[i].addr == addr) return &self->routines[i];
+   }
+   return 0;
+}
+
+/********************************************************************************
+* sim_stack_push: Lägger till en väg som väntar på analys.
+*
+*                 - self: Referens till stackanalysen.
+*                 - addr: Adressen för subrutinen som analyseras.
+*                 - path: Vägen som ska läggas till.
+********************************************************************************/
+static void sim_stack_push(struct sim_stack* self,
+                           const uint32_t addr,
+                           const struct sim_stack_path path)
+{
+   if (self->num_paths == SIM_STACK_PATHS)
+   {
+      sim_stack_warn(self, addr, "för många vägar");
+      return;
+   }
+   self->paths[self->num_paths++] = path;
+   return;
+}
+
+static int32_t sim_stack_depth(struct sim_stack* self,
+                               const uint32_t addr);
+
+/********************************************************************************
+* sim_stack_indirect: Returnerar värsta fall för ett indirekt anrop, dvs.
+*                     största djupet bland möjliga mål. Mål som redan
+*                     analyseras längre upp i anropskedjan hoppas över, då
+*                     exempelvis en avbrottsrutin inte anropar sig själv via
+*                     sina egna callbackrutiner. Målet med störst djup
+*                     lagras via callee.
+*
+*                     - self  : Referens till stackanalysen.
+*                     - callee: Referens till variabel där målet lagras.
+********************************************************************************/
+static int32_t sim_stack_indirect(struct sim_stack* self,
+                                  uint32_t* callee)
+{
+   int32_t depth = 0;
+   *callee = 0;
+   self->indirect++;
+
+   for (int i = 0; i < self->num_targets; ++i)
+   {
+      const struct sim_stack_routine* routine = sim_stack_find(self, self->targets[i]);
+      if (routine && routine->state == SIM_STACK_ACTIVE) continue;
+      const int32_t target = sim_stack_depth(self, self->targets[i]);
+
+      if (target > depth || !*callee)
+      {
+         depth = target;
+         *callee = self->targets[i];
+      }
+   }
+   self->indirect--;
+   return depth;
+}
+
+/********************************************************************************
+* sim_stack_depth: Returnerar värsta fall i byte för angiven subrutin,
+*                  inklusive anropade subrutiner. Subrutinen följs längs
+*                  samtliga hopp tills ret eller eret påträffas, där
+*                  stackpekaren räknas relativt värdet vid anrop. Varje
+*                  subrutin analyseras endast en gång. Rekursion kan inte
+*                  begränsas statiskt och ger därför en varning, förutom
+*                  via indirekta anrop, där möjliga mål är en överskattning
+*                  och rekursionen därmed antas vara skenbar.
+*
+*                  - self: Referens till stackanalysen.
+*                  - addr: Subrutinens adress.
+********************************************************************************/
+static int32_t sim_stack_depth(struct sim_stack* self,
+                               const uint32_t addr)
+{
+   struct sim_stack_routine* routine = sim_stack_find(self, addr);
+   const int first = self->num_paths;
+
+   if (routine && routine->state == SIM_STACK_DONE) return routine->depth;
+   if (routine)
+   {
+      if (!self->indirect) sim_stack_warn(self, addr, "rekursivt anrop, djupet kan inte begränsas");
+      return 0;
+   }
+   if (self->num_routines == SIM_STACK_ROUTINES)
+   {
+      sim_stack_warn(self, addr, "för många subrutiner");
+      return 0;
+   }
+
+   routine = &self->routines[self->num_routines++];
+   routine->addr = addr;
+   routine->depth = 0;
+   routine->callee = 0;
+   routine->state = SIM_STACK_ACTIVE;
+
+   bool* visited = calloc(self->code_end / 4 + 1, sizeof(bool));
+   if (!visited) exit(1);
+   sim_stack_push(self, addr, (struct sim_stack_path){ addr, 0, 0, false });
+
+   while (self->num_paths > first)
+   {
+      struct sim_stack_path path = self->paths[--self->num_paths];
+      int32_t depth = 0;
+      uint32_t callee = 0;
+      if (path.pc >= self->code_end || !sim_stack_code(self->symbols, path.pc))
+      {
+         sim_stack_warn(self, addr, "hopp utanför programkoden");
+         continue;
+      }
+      if (visited[path.pc / 4]) continue;
+      visited[path.pc / 4] = true;
+
+      const uint32_t w = sim_fetch(self->sim, path.pc);
+      const unsigned op = w & 0x3F, a = (w >> 27) & 0x1F, b = (w >> 22) & 0x1F;
+      const unsigned c = (w >> 17) & 0x1F, opx = (w >> 11) & 0x3F;
+      const int32_t imm = (int16_t)((w >> 6) & 0xFFFF);
+      const uint32_t next = path.pc + 4, target = next + (uint32_t)imm;
+      const bool abs = path.abs;
+      path.abs = false;
+      path.pc = next;
+
+      if (op == 0x3A && (opx == 0x05 || opx == 0x01))
+      {
+         continue;
+      }
+      else if (op == 0x3A && opx == 0x0D)
+      {
+         sim_stack_warn(self, addr, "indirekt hopp via jmp följs inte");
+         continue;
+      }
+      else if (op == 0x3A && opx == 0x1D)
+      {
+         depth = -path.sp + sim_stack_indirect(self, &callee);
+      }
+      else if (op == 0x3A && c == 27)
+      {
+         if (opx == 0x31 && a == 28 && b == 0) path.sp = path.fp;
+         else sim_stack_warn(self, addr, "okänd ändring av stackpekaren");
+      }
+      else if (op == 0x00)
+      {
+         callee = (path.pc & 0xF0000000) | ((w >> 6) << 2);
+         depth = -path.sp + sim_stack_depth(self, callee);
+      }
+      else if (op == 0x01)
+      {
+         path.pc = (path.pc & 0xF0000000) | ((w >> 6) << 2);
+      }
+      else if (op == 0x06)
+      {
+         path.pc = target;
+      }
+      else if (op == 0x26 || op == 0x1E || op == 0x0E || op == 0x2E || op == 0x16 || op == 0x36)
+      {
+         sim_stack_push(self, addr, (struct sim_stack_path){ target, path.sp, path.fp, false });
+      }
+      else if (op == 0x04 && b == 27 && a == 27 && abs)
+      {
+         self->top += (uint32_t)imm;
+      }
+      else if (op == 0x04 && b == 27 && a == 27)
+      {
+         path.sp += imm;
+      }
+      else if (op == 0x04 && b == 27 && a == 28)
+      {
+         path.sp = path.fp + imm;
+      }
+      else if (op == 0x04 && b == 28 && a == 27)
+      {
+         path.fp = path.sp + imm;
+      }
+      else if ((op == 0x04 || op == 0x14 || op == 0x34) && b == 27 && a == 0)
+      {
+         self->top = op == 0x34 ? (uint32_t)((w >> 6) & 0xFFFF) << 16 :
+                     op == 0x14 ? (uint32_t)((w >> 6) & 0xFFFF) : (uint32_t)imm;
+         self->has_top = true;
+         path.sp = 0;
+         path.abs = op == 0x34;
+      }
+      else if (op != 0x3A && b == 27 && (op & 0x07) != 0x05)
+      {
+         sim_stack_warn(self, addr, "okänd ändring av stackpekaren");
+      }
+
+      if (-path.sp > routine->depth) routine->depth = -path.sp;
+      if (depth > routine->depth)
+      {
+         routine->depth = depth;
+         routine->callee = callee;
+      }
+      sim_stack_push(self, addr, path);
+   }
+   free(visited);
+   routine->state = SIM_STACK_DONE;
+   return routine->depth;
+}
+
+/********************************************************************************
+* sim_stack_analyze: Analyserar stackens värsta fall statiskt från
+*                    programmets startadress samt undantagshanteraren och
+*                    skriver ut djupet samt anropskedjan för varje
+*                    ingångspunkt. Undantag antas kunna inträffa vid
+*                    huvudprogrammets värsta fall, varför djupen summeras.
+*                    Returnerar 2 ifall stacken kan skriva över programmet
+*                    eller överskrida symbolen STACK_SIZE, annars 0.
+*
+*                    - sim    : Referens till simulatorn med assemblerad kod.
+*                    - symbols: Referens till assemblern.
+*                    - entry  : Programmets startadress.
+********************************************************************************/
+static int sim_stack_analyze(const struct sim* sim,
+                             struct assembler* symbols,
+                             const uint32_t entry)
+{
+   static struct sim_stack stack;
+   struct sim_stack* self = &stack;
+   const struct asm_symbol* size = asm_lookup(symbols, "STACK_SIZE", false);
+   const uint32_t entries[] = { entry, SIM_EXCEPTION_ADDR };
+   uint32_t end = 0;
+   int32_t total = 0;
+   int result = 0;
+   bool exceptions = false;
+   char name[ASM_NAME_LEN];
+
+   self->sim = sim;
+   self->symbols = symbols;
+
+   for (int i = 0; i < symbols->num_sections; ++i)
+   {
+      const struct asm_section* sec = &symbols->sections[i];
+      if (sec->size && sec->base + sec->size > end) end = sec->base + sec->size;
+      if (sec->size && sim_stack_code(symbols, sec->base) && sec->base + sec->size > self->code_end)
+      {
+         self->code_end = sec->base + sec->size;
+      }
+      if (sec->size && !strcmp(sec->name, ".exceptions")) exceptions = true;
+   }
+   sim_stack_targets(self);
+   printf("Stackens värsta fall per ingångspunkt:\n");
+
+   for (int i = 0; i < (int)(sizeof(entries) / sizeof(entries[0])); ++i)
+   {
+      if (i && (entries[i] == entry || !exceptions)) continue;
+      const int32_t depth = sim_stack_depth(self, entries[i]);
+      total += depth;
+      sim_stack_name(self, entries[i], name, sizeof(name));
+      printf("  %s: %ld byte (%s", name, (long)depth, name);
+
+      for (const struct sim_stack_routine* r = sim_stack_find(self, entries[i]); r && r->callee;
+           r = sim_stack_find(self, r->callee))
+      {
+         sim_stack_name(self, r->callee, name, sizeof(name));
+         printf(" -> %s", name);
+      }
+      printf(")\n");
+   }
+   printf("Totalt: %ld byte\n", (long)total);
+
+   if (self->has_top)
+   {
+      const int64_t margin = (int64_t)self->top - total - end;
+      printf("Stacken växer från 0x%lx ned till 0x%lx, programmet slutar på 0x%lx (%lld byte marginal).\n",
+             (unsigned long)self->top, (unsigned long)(self->top - total), (unsigned long)end,
+             (long long)margin);
+      if (margin < 0) result = 2;
+   }
+   if (size && size->pass >= 0)
+   {
+      const int64_t margin = asm_symbol_value(symbols, size) - total;
+      printf("STACK_SIZE: %lld byte (%lld byte marginal).\n",
+             (long long)asm_symbol_value(symbols, size), (long long)margin);
+      if (margin < 0) result = 2;
+   }
+   if (self->warnings) printf("Analysen är osäker, se %d varningar ovan.\n", self->warnings);
+   return result;
+}
+
+/********************************************************************************
+* usage: Skriver ut hur simulatorn används.
+********************************************************************************/
+static void usage(void)
+{
+   fprintf(stderr,
+           "Användning: nios2sim [flaggor] program.s|program.elf\n"
+           "  -n ANTAL      Avbryt efter angivet antal instruktioner (förval 10^9, 0 = aldrig).\n"
+           "  -s VÄRDE      Startvärde för slide-switchar SW[9:0].\n"
+           "  -k MASK       Nedtryckta tryckknappar KEY[3:0] vid start.\n"
+           "  -e TID:sw=V   Sätt slide-switchar till V efter TID instruktioner.\n"
+           "  -e TID:key=M  Tryck ned tryckknappar enligt M efter TID instruktioner.\n"
+           "  -I KATALOG    Sökväg för inkluderingsfiler (.include).\n"
+           "  -D NAMN=VÄRDE Definiera symbol innan assemblering.\n"
+           "  -t            Skriv ut varje skrivning till lysdioderna.\n"
+           "  -r            Skriv ut registrens innehåll efter körning.\n"
+           "  -x            Slå inte ihop fördröjningsloopar.\n"
+           "  -q            Skriv endast ut lysdiodernas sluttillstånd (utan JTAG UART).\n"
+           "  -p            Skriv ut tabellen profile_regions (profile.s) efter körning.\n"
+           "  -c RUTIN[:REG=V,...]\n"
+           "                Mät subrutinen i stället för att köra programmet, där\n"
+           "                V anges som tal, symbol eller @ (arbetsminne).\n"
+           "  -i ANTAL      Antal anrop per mätt subrutin (förval 1000).\n"
+           "  -j            Skriv ut mätningarna som JSON, en rad per subrutin.\n"
+           "  -b FIL        Jämför mätningarna mot baslinjen i FIL (returkod 2 vid försämring).\n"
+           "  -a            Analysera stackens värsta fall statiskt i stället för att köra programmet.\n");
+   return;
+}
+
+/********************************************************************************
+* main: Tolkar kommandoradens flaggor, assemblerar eller laddar angivet
+*       program och kör det i simulatorn. Efter körning skrivs antalet
+*       exekverade instruktioner, simulerad tid, simuleringshastighet, antal
+*       åtkomster av PIO-enheternas dataregister, antal tecken till JTAG
+*       UART samt lysdiodernas tillstånd ut, eventuellt följt av
+*       profileringens tabell via flaggan -p. Vid mätning av subrutiner via
+*       flaggan -c mäts i stället angivna subrutiner, varefter resultaten
+*       skrivs ut och eventuellt jämförs mot en baslinje. Returkod 0
+*       indikerar felfri körning.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   static struct sim sim;
+   const char* includes[ASM_MAX_INCLUDES];
+   char* defines[64];
+   int num_includes = 0, num_defines = 0;
+   bool quiet = false, dump_regs = false, json = false, analyze = false, profile = false;
+   const char* path = 0;
+   const char* baseline = 0;
+   const char* bench_specs[SIM_BENCH_MAX];
+   static struct sim_bench benches[SIM_BENCH_MAX];
+   struct assembler* symbols = 0;
+   int num_benches = 0;
+   uint32_t entry = 0, calls = SIM_BENCH_CALLS;
+
+   if (!sim_init(&sim, SIM_RAM_SIZE))
+   {
+      fprintf(stderr, "nios2sim: kan inte allokera minne\n");
+      return 1;
+   }
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const char* arg = argv[i];
+      const char* next = i + 1 < argc ? argv[i + 1] : 0;
+
+      if (arg[0] != '-' || !arg[1])
+      {
+         path = arg;
+         continue;
+      }
+      switch (arg[1])
+      {
+         case 'n':
+         case 's':
+         case 'k':
+         case 'I':
+         case 'D':
+         case 'c':
+         case 'i':
+         case 'b':
+            if (!next)
+            {
+               usage();
+               return 1;
+            }
+            if (arg[1] == 'n') sim.max_icount = strtoull(next, 0, 0);
+            else if (arg[1] == 's') sim.pio[SIM_PIO_SWITCHES].data = (uint32_t)strtoul(next, 0, 0) & 0x3FF;
+            else if (arg[1] == 'k') sim.pio[SIM_PIO_BUTTONS].data = (uint32_t)strtoul(next, 0, 0) & 0xF;
+            else if (arg[1] == 'I' && num_includes < ASM_MAX_INCLUDES) includes[num_includes++] = next;
+            else if (arg[1] == 'D' && num_defines < 64) defines[num_defines++] = argv[i + 1];
+            else if (arg[1] == 'c' && num_benches < SIM_BENCH_MAX) bench_specs[num_benches++] = next;
+            else if (arg[1] == 'i') calls = (uint32_t)strtoul(next, 0, 0);
+            else if (arg[1] == 'b') baseline = next;
+            ++i;
+            break;
+         case 'e':
+            if (!next || !sim_add_event(&sim, next))
+            {
+               fprintf(stderr, "nios2sim: ogiltig händelse '%s'\n", next ? next : "");
+               return 1;
+            }
+            ++i;
+            break;
+         case 't': sim.trace = true; break;
+         case 'r': dump_regs = true; break;
+         case 'x': sim.fuse = false; break;
+         case 'q': quiet = true; break;
+         case 'j': json = true; break;
+         case 'a': analyze = true; break;
+         case 'p': profile = true; break;
+         default: usage(); return 1;
+      }
+   }
+   if (!path || !calls)
+   {
+      usage();
+      return 1;
+   }
+
+   if (!sim_load_elf(&sim, path, &entry) &&
+       !asm_assemble(path, includes, num_includes, defines, num_defines, sim.ram, sim.ram_size, &entry,
+                     &symbols))
+   {
+      return 1;
+   }
+   sim.pc = entry;
+
+   if (analyze)
+   {
+      if (!symbols)
+      {
+         fprintf(stderr, "nios2sim: stackanalys kräver en assemblerfil\n");
+         return 1;
+      }
+      return sim_stack_analyze(&sim, symbols, entry);
+   }
+   if (num_benches)
+   {
+      const uint32_t brk = asm_enc_r(0x34, 0, 0, 30, 0);
+      const struct asm_symbol* gp = symbols ? asm_lookup(symbols, "_gp", false) : 0;
+      int regressions = 0;
+      memcpy(sim.ram + SIM_BENCH_RETURN, &brk, 4);
+      if (gp && gp->pass >= 0) sim.regs[26] = (uint32_t)asm_symbol_value(symbols, gp);
+
+      for (int i = 0; i < num_benches; ++i)
+      {
+         if (!sim_bench_parse(&benches[i], symbols, bench_specs[i]))
+         {
+            fprintf(stderr, "nios2sim: ogiltig mätning '%s'\n", bench_specs[i]);
+            return 1;
+         }
+         if (!sim_bench_run(&sim, &benches[i], calls)) return 1;
+         sim_bench_print(&benches[i], path, calls, json);
+      }
+      fflush(stdout);
+      if (baseline) regressions = sim_bench_compare(benches, num_benches, path, baseline);
+      return regressions < 0 ? 1 : regressions > 0 ? 2 : 0;
+   }
+
+   const clock_t start = clock();
+   sim.uart.echo = !quiet;
+   sim_run(&sim);
+   const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   if (!quiet)
+   {
+      printf("Instruktioner: %llu\n", (unsigned long long)sim.icount);
+      printf("Simulerad tid: %.6f s (%lu MHz)\n", (double)sim.icount / SIM_CLOCK_HZ, SIM_CLOCK_HZ / 1000000);
+      printf("Körtid:        %.3f s (%.0f miljoner instruktioner per sekund)\n",
+             seconds, seconds > 0 ? sim.icount / seconds / 1e6 : 0.0);
+      printf("Skrivningar:   %llu till lysdioderna\n", (unsigned long long)sim.led_writes);
+      printf("Avläsningar:   %llu av slide-switchar och tryckknappar\n", (unsigned long long)sim.input_reads);
+      printf("Konsol:        %llu tecken till JTAG UART\n", (unsigned long long)sim.uart.chars);
+      printf("Avslutning:    %s\n", sim.error ? "fel" : sim.halted ? "tom loop" :
+                                       "maximalt antal instruktioner");
+   }
+   sim_print_leds(&sim);
+
+   if (profile && !sim_profile_print(&sim, symbols))
+   {
+      fprintf(stderr, "nios2sim: tabellen profile_regions saknas, assemblera med -D PROFILE=1\n");
+      return 1;
+   }
+   if (dump_regs)
+   {
+      for (int i = 0; i < 32; ++i)
+      {
+         printf("r%-2d = 0x%08x%s", i, sim.regs[i], i % 4 == 3 ? "\n" : "   ");
+      }
+      printf("pc  = 0x%08x   status = 0x%08x   ienable = 0x%08x\n", sim.pc, sim.ctl[0], sim.ctl[3]);
+   }
+   return sim.error ? 1 : 0;
+}
@@ -0,0 +1,322 @@
+/********************************************************************************
+* pattern_gen.c: Genererar mönstertabeller för lysdioderna LED[9:0], så att
+*                varje bildruta är beräknad i förväg och lagras i läsbart
+*                minne. Programmen behöver därmed varken beräkna mönstren
+*                vid start eller lagra dem i RAM, utan varje bildruta matas
+*                ut via en enda läsning följd av en skrivning, se
+*                Drivrutiner/pattern.h samt Drivrutiner/pattern.s.
+*
+*                Följande tabeller genereras, där varje bildruta utgör ett
+*                32-bitars ord, så att tabellerna även kan matas ut via
+*                stream_submit i Drivrutiner/stream.h:
+*                - pattern_counter: Heltalen 0 - 1023 i binär form.
+*                - pattern_gray   : Heltalen 0 - 1023 i Graykod, där endast
+*                                   en lysdiod ändras mellan bildrutorna.
+*                - pattern_bar    : Stapel som fylls och sedan töms.
+*                - pattern_knight : En tänd lysdiod som vandrar fram och
+*                                   tillbaka (Knight Rider).
+*                - pattern_odd    : Udda heltal 1, 3, 5 ... 1023.
+*                - pattern_even   : Jämna heltal 0, 2, 4 ... 1022.
+*
+*                Tabellerna skrivs ut som C (-c) eller som Nios II assembler
+*                (-s). Båda filerna genereras från samma funktioner, så att
+*                C- och assemblerprogrammen spelar upp identiska mönster.
+*                Raderna avslutas med CR LF, i likhet med övriga källfiler,
+*                så att genererade tabeller inte skiljer sig från incheckade.
+*
+*                Kompilera generatorn med följande kommando:
+*                gcc -O2 -o pattern_gen pattern_gen.c
+*
+*                Generera tabellerna på nytt enligt nedan:
+*                ./pattern_gen -c > ../Drivrutiner/pattern_tables.h
+*                ./pattern_gen -s > ../Drivrutiner/pattern_tables.s
+********************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define PATTERN_GEN_LEDS     10 /* Antal lysdioder, LED[9:0]. */
+#define PATTERN_GEN_PER_LINE 8  /* Antal bildrutor per rad i utskriften. */
+
+/********************************************************************************
+* pattern_gen_table: Strukt för en mönstertabell.
+********************************************************************************/
+struct pattern_gen_table
+{
+   const char* name;                    /* Tabellens namn utan prefixet pattern_. */
+   const char* description;             /* Beskrivning av mönstret. */
+   uint32_t size;                       /* Antal bildrutor i tabellen. */
+   uint32_t (*frame)(const uint32_t i); /* Beräknar bildruta i. */
+};
+
+/********************************************************************************
+* pattern_gen_counter: Returnerar heltalet i i binär form.
+*
+*                      - i: Bildrutans index.
+********************************************************************************/
+static uint32_t pattern_gen_counter(const uint32_t i)
+{
+   return i;
+}
+
+/********************************************************************************
+* pattern_gen_gray: Returnerar heltalet i i Graykod.
+*
+*                   - i: Bildrutans index.
+********************************************************************************/
+static uint32_t pattern_gen_gray(const uint32_t i)
+{
+   return i ^ (i >> 1);
+}
+
+/********************************************************************************
+* pattern_gen_bar: Returnerar en stapel om i tända lysdioder då stapeln
+*                  fylls (i = 0 - 10), annars 20 - i tända lysdioder då
+*                  stapeln töms (i = 11 - 19).
+*
+*                  - i: Bildrutans index.
+********************************************************************************/
+static uint32_t pattern_gen_bar(const uint32_t i)
+{
+   const uint32_t lit = i <= PATTERN_GEN_LEDS ? i : 2 * PATTERN_GEN_LEDS - i;
+   return (1UL << lit) - 1;
+}
+
+/********************************************************************************
+* pattern_gen_knight: Returnerar en tänd lysdiod som vandrar från LED0 till
+*                     LED9 (i = 0 - 9) och sedan tillbaka (i = 10 - 17).
+*                     Ändlägena ingår endast en gång per varv, så att
+*                     tabellen kan spelas upp i en slinga utan uppehåll.
+*
+*                     - i: Bildrutans index.
+********************************************************************************/
+static uint32_t pattern_gen_knight(const uint32_t i)
+{
+   const uint32_t led = i < PATTERN_GEN_LEDS ? i : 2 * (PATTERN_GEN_LEDS - 1) - i;
+   return 1UL << led;
+}
+
+/********************************************************************************
+* pattern_gen_odd: Returnerar det udda heltalet 2i + 1.
+*
+*                  - i: Bildrutans index.
+********************************************************************************/
+static uint32_t pattern_gen_odd(const uint32_t i)
+{
+   return 2 * i + 1;
+}
+
+/********************************************************************************
+* pattern_gen_even: Returnerar det jämna heltalet 2i.
+*
+*                   - i: Bildrutans index.
+********************************************************************************/
+static uint32_t pattern_gen_even(const uint32_t i)
+{
+   return 2 * i;
+}
+
+/********************************************************************************
+* Mönstertabeller att generera:
+********************************************************************************/
+static const struct pattern_gen_table pattern_gen_tables[] =
+{
+   { "counter", "Heltalen 0 - 1023 i binär form.",        1024, pattern_gen_counter },
+   { "gray",    "Heltalen 0 - 1023 i Graykod.",            1024, pattern_gen_gray    },
+   { "bar",     "Stapel som fylls och sedan töms.",        20,   pattern_gen_bar     },
+   { "knight",  "Lysdiod som vandrar fram och tillbaka.",  18,   pattern_gen_knight  },
+   { "odd",     "Udda heltal 1, 3, 5 ... 1023.",           512,  pattern_gen_odd     },
+   { "even",    "Jämna heltal 0, 2, 4 ... 1022.",          512,  pattern_gen_even    },
+};
+
+#define PATTERN_GEN_COUNT (sizeof(pattern_gen_tables) / sizeof(pattern_gen_tables[0]))
+
+/********************************************************************************
+* pattern_gen_size_name: Lagrar namnet på angiven tabells storleksmakro,
+*                        exempelvis PATTERN_COUNTER_SIZE, i angiven sträng.
+*
+*                        - dest : Referens till strängen (minst 32 tecken).
+*                        - table: Referens till tabellen.
+********************************************************************************/
+static void pattern_gen_size_name(char* dest,
+                                  const struct pattern_gen_table* table)
+{
+   char* c = dest + sprintf(dest, "PATTERN_");
+
+   for (const char* s = table->name; *s; ++s)
+   {
+      *c++ = *s >= 'a' && *s <= 'z' ? *s - 'a' + 'A' : *s;
+   }
+   strcpy(c, "_SIZE");
+   return;
+}
+
+/********************************************************************************
+* pattern_gen_frames: Skriver ut samtliga bildrutor i angiven tabell,
+*                     PATTERN_GEN_PER_LINE per rad med angivet radprefix.
+*                     Bildrutorna separeras med kommatecken, där raderna i C
+*                     även avslutas med kommatecken (assembler = false).
+*
+*                     - table    : Referens till tabellen.
+*                     - prefix   : Prefix för varje rad.
+*                     - assembler: Indikerar utskrift som assembler.
+********************************************************************************/
+static void pattern_gen_frames(const struct pattern_gen_table* table,
+                               const char* prefix,
+                               const bool assembler)
+{
+   for (uint32_t i = 0; i < table->size; ++i)
+   {
+      const bool first = i % PATTERN_GEN_PER_LINE == 0;
+      const bool last = i % PATTERN_GEN_PER_LINE == PATTERN_GEN_PER_LINE - 1 || i == table->size - 1;
+
+      if (first) printf("%s", prefix);
+      printf("0x%03lX", (unsigned long)table->frame(i));
+      if (!last || !assembler) printf(",");
+      printf(last ? "\r\n" : " ");
+   }
+   return;
+}
+
+/********************************************************************************
+* pattern_gen_c: Skriver ut samtliga tabeller som C, där varje tabell lagras
+*                som en konstant array, som därmed placeras i .rodata.
+********************************************************************************/
+static void pattern_gen_c(void)
+{
+   char size_name[32];
+
+   printf("/********************************************************************************\r\n"
+          "* pattern_tables.h: Mönstertabeller för lysdioderna LED[9:0], genererade via\r\n"
+          "*                   Verktyg/pattern_gen.c. Ändra inte filen manuellt, utan\r\n"
+          "*                   generera den på nytt via följande kommando:\r\n"
+          "*                   ./pattern_gen -c > ../Drivrutiner/pattern_tables.h\r\n"
+          "*\r\n"
+          "*                   Tabellerna är konstanta och placeras därmed i .rodata,\r\n"
+          "*                   så att de varken beräknas vid start eller lagras i RAM.\r\n"
+          "*                   Tabellerna spelas upp via pattern_play, se pattern.h.\r\n"
+          "********************************************************************************/\r\n"
+          "#ifndef PATTERN_TABLES_H_\r\n"
+          "#define PATTERN_TABLES_H_\r\n"
+          "\r\n"
+          "/********************************************************************************\r\n"
+          "* Inkluderingsdirektiv:\r\n"
+          "********************************************************************************/\r\n"
+          "#include <stdint.h>\r\n"
+          "\r\n"
+          "/********************************************************************************\r\n"
+          "* Antal bildrutor per tabell:\r\n"
+          "********************************************************************************/\r\n");
+
+   for (size_t i = 0; i < PATTERN_GEN_COUNT; ++i)
+   {
+      pattern_gen_size_name(size_name, &pattern_gen_tables[i]);
+      printf("#define %-20s %-4lu /* %s */\r\n", size_name,
+             (unsigned long)pattern_gen_tables[i].size, pattern_gen_tables[i].description);
+   }
+
+   for (size_t i = 0; i < PATTERN_GEN_COUNT; ++i)
+   {
+      pattern_gen_size_name(size_name, &pattern_gen_tables[i]);
+      printf("\r\n"
+             "/********************************************************************************\r\n"
+             "* pattern_%s: %s\r\n"
+             "********************************************************************************/\r\n"
+             "static const uint32_t pattern_%s[%s] =\r\n"
+             "{\r\n",
+             pattern_gen_tables[i].name, pattern_gen_tables[i].description,
+             pattern_gen_tables[i].name, size_name);
+      pattern_gen_frames(&pattern_gen_tables[i], "   ", false);
+      printf("};\r\n");
+   }
+   printf("\r\n#endif /* PATTERN_TABLES_H_ */\r\n");
+   return;
+}
+
+/********************************************************************************
+* pattern_gen_asm: Skriver ut samtliga tabeller som Nios II assembler, där
+*                  varje tabell lagras som .word i sektionen .rodata.
+********************************************************************************/
+static void pattern_gen_asm(void)
+{
+   char size_name[32];
+
+   printf("/********************************************************************************\r\n"
+          "* pattern_tables.s: Mönstertabeller för lysdioderna LED[9:0], genererade via\r\n"
+          "*                   Verktyg/pattern_gen.c. Ändra inte filen manuellt, utan\r\n"
+          "*                   generera den på nytt via följande kommando:\r\n"
+          "*                   ./pattern_gen -s > ../Drivrutiner/pattern_tables.s\r\n"
+          "*\r\n"
+          "*                   Tabellerna lagras i sektionen .rodata, så att de varken\r\n"
+          "*                   beräknas vid start eller lagras i RAM. Tabellerna spelas\r\n"
+          "*                   upp via pattern_play, se pattern.s.\r\n"
+          "********************************************************************************/\r\n"
+          ".ifndef PATTERN_TABLES_S_\r\n"
+          ".equ PATTERN_TABLES_S_, 0\r\n"
+          "\r\n"
+          "/********************************************************************************\r\n"
+          "* Antal bildrutor per tabell:\r\n"
+          "********************************************************************************/\r\n");
+
+   for (size_t i = 0; i < PATTERN_GEN_COUNT; ++i)
+   {
+      pattern_gen_size_name(size_name, &pattern_gen_tables[i]);
+      printf(".equ %-20s, %-4lu /* %s */\r\n", size_name,
+             (unsigned long)pattern_gen_tables[i].size, pattern_gen_tables[i].description);
+   }
+
+   printf("\r\n"
+          "/********************************************************************************\r\n"
+          "* .rodata: Datasegment för konstanter, lagringsplats för tabellerna.\r\n"
+          "********************************************************************************/\r\n"
+          ".section .rodata\r\n"
+          ".align 2\r\n");
+
+   for (size_t i = 0; i < PATTERN_GEN_COUNT; ++i)
+   {
+      printf("\r\n"
+             "/********************************************************************************\r\n"
+             "* pattern_%s: %s\r\n"
+             "********************************************************************************/\r\n"
+             "pattern_%s:\r\n",
+             pattern_gen_tables[i].name, pattern_gen_tables[i].description,
+             pattern_gen_tables[i].name);
+      pattern_gen_frames(&pattern_gen_tables[i], "   .word ", true);
+   }
+
+   printf("\r\n"
+          "/********************************************************************************\r\n"
+          "* Återgår till kodsegmentet för efterföljande kod i den inkluderande filen.\r\n"
+          "********************************************************************************/\r\n"
+          ".text\r\n"
+          "\r\n"
+          ".endif /* PATTERN_TABLES_S_ */\r\n");
+   return;
+}
+
+/********************************************************************************
+* main: Skriver ut samtliga tabeller som C (-c) eller som assembler (-s).
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   if (argc == 2 && !strcmp(argv[1], "-c"))
+   {
+      pattern_gen_c();
+   }
+   else if (argc == 2 && !strcmp(argv[1], "-s"))
+   {
+      pattern_gen_asm();
+   }
+   else
+   {
+      fprintf(stderr, "Användning: pattern_gen -c | -s\n"
+                      "  -c  Skriver ut tabellerna som C (pattern_tables.h).\n"
+                      "  -s  Skriver ut tabellerna som assembler (pattern_tables.s).\n");
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,119 @@
+/********************************************************************************
+* profile_test.c: Test av profileraren i profile.h vid kompilering för
+*                 Linux, där fördröjningen från tryckknapp KEY[0] till en
+*                 lysdiod mäts på samma sätt som i lektion 3.
+*
+*                 En uppgift avläser tryckknappen var DEBOUNCE_PERIOD_MS
+*                 tick via schemaläggaren i sched.h och avstudsar den via
+*                 debounce.h. Mätningen startar vid den avläsning där
+*                 tryckknappen först skiljer sig från avstudsat tillstånd
+*                 och avslutas när lysdioden har skrivits efter
+*                 avstudsningen. En nedtryckning samt ett uppsläpp simuleras
+*                 om PROFILE_TEST_TICKS tick vardera, varefter tabellen
+*                 skrivs ut. Båda flankerna ska ha mätts med en fördröjning
+*                 om tre avläsningsperioder, eftersom klockpulserna via
+*                 sched_cycles enbart räknas upp per simulerat tick. Vid fel
+*                 returneras felkod 1.
+*
+*                 Kompilera och kör testet med följande kommando:
+*                 gcc -O2 -o profile_test profile_test.c && ./profile_test
+********************************************************************************/
+#define NIOS2_HOST
+#define PROFILE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "../Drivrutiner/sched.h"
+#include "../Drivrutiner/debounce.h"
+
+#define PROFILE_REGIONS 1 /* Antal regioner som mäts via profile.h. */
+#include "../Drivrutiner/profile.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define PROFILE_TEST_BUTTON 0  /* Tryckknapp ansluten till KEY[0]. */
+#define PROFILE_TEST_REGION 0  /* Region för fördröjningen från KEY[0] till lysdioden. */
+#define PROFILE_TEST_TICKS  50 /* Antal tick per simulerad nedtryckning samt uppsläpp. */
+
+/********************************************************************************
+* Statiska variabler:
+********************************************************************************/
+static uint32_t buttons_host = 0x0F; /* Ersättning för tryckknapparna (aktivt låga). */
+static uint32_t led_host;            /* Ersättning för lysdioden. */
+static struct debounce inputs;       /* Avstudsad tryckknapp. */
+
+/********************************************************************************
+* inputs_task: Uppgift som avläser tryckknappen och tänder lysdioden när den
+*              är nedtryckt, annars hålls lysdioden släckt. Mätningen startar
+*              när tryckknappens räknare har räknats upp en gång och avslutas
+*              när lysdioden har skrivits efter att tryckknappen bytt
+*              tillstånd.
+********************************************************************************/
+static void inputs_task(void)
+{
+   const uint32_t key = DEBOUNCE_KEY(PROFILE_TEST_BUTTON);
+   debounce_update(&inputs, DEBOUNCE_SAMPLE(0, buttons_host));
+   if (inputs.cnt0 & ~inputs.cnt1 & key) PROFILE_BEGIN(PROFILE_TEST_REGION);
+   led_host = (inputs.state & key) ? 1 : 0;
+   if ((inputs.pressed | inputs.released) & key) PROFILE_END(PROFILE_TEST_REGION);
+   return;
+}
+
+/********************************************************************************
+* tasks: Tabell med testets periodiska uppgift.
+********************************************************************************/
+static struct sched_task tasks[] =
+{
+   SCHED_TASK(inputs_task, DEBOUNCE_PERIOD_MS, 0),
+};
+
+/********************************************************************************
+* profile_test_ticks: Simulerar angivet antal tick via avbrott, där
+*                     schemaläggaren körs efter varje tick.
+*
+*                     - count: Antalet tick att simulera.
+********************************************************************************/
+static void profile_test_ticks(const uint32_t count)
+{
+   for (uint32_t i = 0; i < count; ++i)
+   {
+      irq_host_raise(TIMER_IRQ, true);
+      irq_host_raise(TIMER_IRQ, false);
+      sched_run();
+   }
+   return;
+}
+
+/********************************************************************************
+* main: Kör uppgiften en första gång vid tick 0, varefter en nedtryckning
+*       samt ett uppsläpp av tryckknappen simuleras och tabellen skrivs ut.
+*       Lysdioden ska ha tänts och släckts igen, medan båda flankerna ska
+*       ha mätts med förväntad fördröjning. Vid fel returneras felkod 1,
+*       annars 0.
+********************************************************************************/
+int main(void)
+{
+   const struct profile_region* region = &profile_regions[PROFILE_TEST_REGION];
+   const uint32_t expected = 3 * DEBOUNCE_PERIOD_MS * SCHED_TICK_CYCLES;
+   uint32_t errors = 0;
+
+   PROFILE_INIT();
+   debounce_init(&inputs, DEBOUNCE_SAMPLE(0, buttons_host));
+   if (sched_init(tasks, sizeof(tasks) / sizeof(tasks[0]))) return 1;
+   irq_global_enable();
+   sched_run();
+
+   buttons_host = 0x0F & ~(1 << PROFILE_TEST_BUTTON);
+   profile_test_ticks(PROFILE_TEST_TICKS);
+   if (led_host != 1) errors++;
+   buttons_host = 0x0F;
+   profile_test_ticks(PROFILE_TEST_TICKS);
+   if (led_host != 0) errors++;
+   profile_print();
+
+   if (region->count != 2 || region->min != expected || region->max != expected) errors++;
+   printf("Profilering: %lu fel\n", (unsigned long)errors);
+   return errors ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+/********************************************************************************
+* sched_test.c: Test av schemaläggaren i sched.h vid kompilering för Linux,
+*               där intervalltimerns avbrott simuleras via irq_host_raise.
+*
+*               Två uppgifter schemaläggs med samma perioder som i lektion 3,
+*               dvs. en avläsning var DEBOUNCE_PERIOD_MS tick samt en
+*               blinkning var SCHED_TEST_BLINK_PERIOD tick, förskjuten
+*               SCHED_TEST_BLINK_PHASE tick. Först kontrolleras att en
+*               uppgift med perioden 0 avvisas av sched_init. Därefter
+*               simuleras SCHED_TEST_TICKS tick, varefter antalet körningar,
+*               överskridanden samt fördröjningar kontrolleras, både vid
+*               normal drift och efter ett simulerat uppehåll i huvudloopen.
+*               Vid fel returneras felkod 1.
+*
+*               Kompilera och kör testet med följande kommando:
+*               gcc -O2 -o sched_test sched_test.c && ./sched_test
+********************************************************************************/
+#define NIOS2_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "../Drivrutiner/sched.h"
+#include "../Drivrutiner/debounce.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define SCHED_TEST_BLINK_PERIOD 100  /* Tid mellan varje blinkning i tick. */
+#define SCHED_TEST_BLINK_PHASE  2    /* Förskjutning av blinkningen i tick. */
+#define SCHED_TEST_TICKS        1000 /* Antal tick som simuleras vid normal drift. */
+#define SCHED_TEST_STALL        248  /* Längd på simulerat uppehåll i huvudloopen i tick. */
+
+/********************************************************************************
+* sched_test_task: Tom uppgift, där antalet körningar räknas av
+*                  schemaläggaren.
+********************************************************************************/
+static void sched_test_task(void)
+{
+   return;
+}
+
+/********************************************************************************
+* tasks: Tabell med testets periodiska uppgifter, motsvarande lektion 3.
+********************************************************************************/
+static struct sched_task tasks[] =
+{
+   SCHED_TASK(sched_test_task, DEBOUNCE_PERIOD_MS, 0),
+   SCHED_TASK(sched_test_task, SCHED_TEST_BLINK_PERIOD, SCHED_TEST_BLINK_PHASE),
+};
+
+/********************************************************************************
+* sched_test_ticks: Simulerar angivet antal tick via avbrott. Om run är satt
+*                   körs schemaläggaren efter varje tick, annars simuleras
+*                   ett uppehåll i huvudloopen.
+*
+*                   - count: Antalet tick att simulera.
+*                   - run  : Indikerar ifall schemaläggaren ska köras.
+********************************************************************************/
+static void sched_test_ticks(const uint32_t count,
+                             const bool run)
+{
+   for (uint32_t i = 0; i < count; ++i)
+   {
+      irq_host_raise(TIMER_IRQ, true);
+      irq_host_raise(TIMER_IRQ, false);
+      if (run) sched_run();
+   }
+   return;
+}
+
+/********************************************************************************
+* sched_test_check: Skriver ut och kontrollerar en uppgifts räknare mot
+*                   förväntade värden. Vid avvikelse returneras 1, annars 0.
+*
+*                   - name    : Uppgiftens namn.
+*                   - task    : Referens till uppgiften.
+*                   - runs    : Förväntat antal körningar.
+*                   - overruns: Förväntat antal överskridanden.
+*                   - late_max: Förväntad största fördröjning i antal tick.
+********************************************************************************/
+static uint32_t sched_test_check(const char* name,
+                                 const struct sched_task* task,
+                                 const uint32_t runs,
+                                 const uint32_t overruns,
+                                 const uint32_t late_max)
+{
+   const bool ok = task->runs == runs && task->overruns == overruns && task->late_max == late_max;
+   printf("%-9s: %4lu körningar, %3lu överskridanden, max fördröjning %3lu tick%s\n", name,
+          (unsigned long)task->runs, (unsigned long)task->overruns, (unsigned long)task->late_max,
+          ok ? "" : " (fel)");
+   return ok ? 0 : 1;
+}
+
+/********************************************************************************
+* sched_test_period: Kontrollerar att sched_init avvisar en uppgift med
+*                    perioden 0 utan att starta intervalltimern. Vid
+*                    avvikelse returneras 1, annars 0.
+********************************************************************************/
+static uint32_t sched_test_period(void)
+{
+   struct sched_task invalid[] = { SCHED_TASK(sched_test_task, 0, 0) };
+   const bool ok = sched_init(invalid, 1) == 1 && timer_owner == 0;
+   printf("Period 0 : %s\n", ok ? "avvisad" : "accepterad (fel)");
+   return ok ? 0 : 1;
+}
+
+/********************************************************************************
+* sched_test_run: Kör schemaläggaren i SCHED_TEST_TICKS tick, där samtliga
+*                 uppgifter ska köras i tid utan överskridanden. Därefter
+*                 simuleras ett uppehåll i huvudloopen om SCHED_TEST_STALL
+*                 tick, varefter varje uppgift ska köras en gång med
+*                 motsvarande fördröjning, medan missade körningar räknas
+*                 som överskridanden. Uppehållet avslutas mellan två
+*                 körningar av respektive uppgift, så att ingen ordinarie
+*                 körning återstår. Antalet fel returneras.
+********************************************************************************/
+static uint32_t sched_test_run(void)
+{
+   const uint32_t end = SCHED_TEST_TICKS + SCHED_TEST_STALL;
+   const uint32_t inputs_runs = SCHED_TEST_TICKS / DEBOUNCE_PERIOD_MS + 1;
+   const uint32_t blink_runs = (SCHED_TEST_TICKS - SCHED_TEST_BLINK_PHASE) / SCHED_TEST_BLINK_PERIOD + 1;
+   const uint32_t inputs_next = inputs_runs * DEBOUNCE_PERIOD_MS;
+   const uint32_t blink_next = blink_runs * SCHED_TEST_BLINK_PERIOD + SCHED_TEST_BLINK_PHASE;
+   uint32_t errors = 0;
+
+   if (sched_init(tasks, sizeof(tasks) / sizeof(tasks[0])))
+   {
+      printf("sched_init misslyckades (fel)\n");
+      return 1;
+   }
+   irq_global_enable();
+
+   sched_run();
+   sched_test_ticks(SCHED_TEST_TICKS, true);
+   errors += sched_test_check("Avläsning", &tasks[0], inputs_runs, 0, 0);
+   errors += sched_test_check("Blinkning", &tasks[1], blink_runs, 0, 0);
+
+   sched_test_ticks(SCHED_TEST_STALL, false);
+   sched_run();
+   errors += sched_test_check("Avläsning", &tasks[0], inputs_runs + 1,
+                              (end - inputs_next) / DEBOUNCE_PERIOD_MS, end - inputs_next);
+   errors += sched_test_check("Blinkning", &tasks[1], blink_runs + 1,
+                              (end - blink_next) / SCHED_TEST_BLINK_PERIOD, end - blink_next);
+   return errors;
+}
+
+/********************************************************************************
+* main: Kör samtliga test och skriver ut antalet fel. Vid fel returneras
+*       felkod 1, annars 0.
+********************************************************************************/
+int main(void)
+{
+   const uint32_t errors = sched_test_period() + sched_test_run();
+   printf("Schemaläggning: %lu fel\n", (unsigned long)errors);
+   return errors ? 1 : 0;
+}
@@ -0,0 +1,280 @@
+/********************************************************************************
+* trace_decode.c: Avkodar binärfiler med skrivningar till PIO-enheternas
+*                 register, inspelade via Drivrutiner/trace.h, till CSV
+*                 eller till en vågform i formatet VCD (Value Change Dump).
+*
+*                 Posterna är deltakodade, varför tiden samt varje registers
+*                 värde räknas upp post för post. Registrens adresser
+*                 beräknas utifrån lysdiodernas adress i filhuvudet och
+*                 namnges för både CASE GOLD och CPUlator.
+*
+*                 Vid CSV skrivs en rad per skrivning ut med tid i
+*                 nanosekunder, adress, registrets namn samt gammalt och nytt
+*                 värde. Vid VCD (-v) skrivs varje register ut som en
+*                 32-bitars signal, som kan visas i exempelvis GTKWave.
+*
+*                 Kompilera avkodaren med följande kommando:
+*                 gcc -O2 -o trace_decode trace_decode.c
+*
+*                 Avkoda exempelvis en inspelning från lektion 2 enligt nedan:
+*                 ./trace_decode mmio_trace.bin > trace.csv
+*                 ./trace_decode -v mmio_trace.bin > trace.vcd
+********************************************************************************/
+#define MMIO_TRACE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../Drivrutiner/trace.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define TRACE_DECODE_REGS 64 /* Antal register inom 256 byte från lysdioderna. */
+
+/********************************************************************************
+* trace_decode_unit: Strukt för en känd PIO-enhet.
+********************************************************************************/
+struct trace_decode_unit
+{
+   uint32_t address; /* PIO-enhetens basadress. */
+   const char* name; /* PIO-enhetens namn. */
+};
+
+/********************************************************************************
+* Kända PIO-enheter för CASE GOLD samt CPUlator:
+********************************************************************************/
+static const struct trace_decode_unit trace_decode_units[] =
+{
+   { 0x8091740,  "LEDS"     },
+   { 0x8091750,  "SWITCHES" },
+   { 0x8091760,  "BUTTONS"  },
+   { 0xFF200000, "LEDS"     },
+   { 0xFF200040, "SWITCHES" },
+   { 0xFF200050, "BUTTONS"  },
+};
+
+/********************************************************************************
+* Namn på PIO-enheternas register i ordning efter index:
+********************************************************************************/
+static const char* const trace_decode_regs[] = { "data", "direction", "interruptmask", "edgecapture" };
+
+/********************************************************************************
+* trace_decode_name: Skriver registrets namn för angiven adress till angiven
+*                    buffert, exempelvis LEDS.data. För okända adresser
+*                    skrivs adressen ut i stället.
+*
+*                    - name   : Buffert för namnet.
+*                    - size   : Buffertens storlek.
+*                    - address: Registrets adress.
+********************************************************************************/
+static void trace_decode_name(char* name,
+                              const size_t size,
+                              const uint32_t address)
+{
+   for (size_t i = 0; i < sizeof(trace_decode_units) / sizeof(trace_decode_units[0]); ++i)
+   {
+      const uint32_t offset = address - trace_decode_units[i].address;
+
+      if (offset < 16 && !(offset & 3))
+      {
+         snprintf(name, size, "%s.%s", trace_decode_units[i].name, trace_decode_regs[offset >> 2]);
+         return;
+      }
+   }
+   snprintf(name, size, "reg_%08lx", (unsigned long)address);
+   return;
+}
+
+/********************************************************************************
+* trace_decode_read: Läser in filhuvudet samt samtliga poster från angiven
+*                    fil. Vid fel skrivs ett felmeddelande ut och 0
+*                    returneras, annars en referens till posterna, vars
+*                    antal lagras via count.
+*
+*                    - path  : Filens sökväg.
+*                    - header: Referens till filhuvudet.
+*                    - count : Referens till antalet poster.
+********************************************************************************/
+static struct trace_entry* trace_decode_read(const char* path,
+                                             struct trace_header* header,
+                                             size_t* count)
+{
+   FILE* file = fopen(path, "rb");
+   struct trace_entry* entries = 0;
+   size_t capacity = 0;
+   *count = 0;
+
+   if (!file)
+   {
+      fprintf(stderr, "trace_decode: kan inte öppna %s\n", path);
+      return 0;
+   }
+   if (fread(header, sizeof(*header), 1, file) != 1 || header->magic != TRACE_MAGIC)
+   {
+      fprintf(stderr, "trace_decode: %s är inte en inspelning från trace.h\n", path);
+      fclose(file);
+      return 0;
+   }
+
+   while (1)
+   {
+      if (*count == capacity)
+      {
+         struct trace_entry* grown;
+         capacity = capacity ? capacity * 2 : TRACE_ENTRIES;
+         grown = realloc(entries, capacity * sizeof(struct trace_entry));
+
+         if (!grown)
+         {
+            free(entries);
+            entries = 0;
+            break;
+         }
+         entries = grown;
+      }
+      const size_t read = fread(&entries[*count], sizeof(struct trace_entry), capacity - *count, file);
+      *count += read;
+      if (*count < capacity) break;
+   }
+   fclose(file);
+   if (!entries) fprintf(stderr, "trace_decode: minnet räcker inte till\n");
+   return entries;
+}
+
+/********************************************************************************
+* trace_decode_vcd_id: Returnerar VCD-identifieraren för angivet register,
+*                      som utgörs av ett skrivbart ASCII-tecken.
+*
+*                      - reg: Registrets index relativt lysdioderna.
+********************************************************************************/
+static inline char trace_decode_vcd_id(const uint32_t reg)
+{
+   return (char)('!' + reg);
+}
+
+/********************************************************************************
+* trace_decode_vcd_value: Skriver ut ett registers värde i VCD-format.
+*
+*                         - reg  : Registrets index relativt lysdioderna.
+*                         - value: Registrets värde.
+********************************************************************************/
+static void trace_decode_vcd_value(const uint32_t reg,
+                                   const uint32_t value)
+{
+   char bits[33];
+
+   for (uint8_t i = 0; i < 32; ++i)
+   {
+      bits[i] = (value & (1UL << (31 - i))) ? '1' : '0';
+   }
+   bits[32] = '\0';
+   printf("b%s %c\n", bits, trace_decode_vcd_id(reg));
+   return;
+}
+
+/********************************************************************************
+* trace_decode: Avkodar angivna poster och skriver ut samtliga skrivningar
+*               som CSV eller VCD. Vid VCD deklareras först samtliga
+*               register som förekommer bland posterna, varefter varje
+*               ändring skrivs ut vid sin tidpunkt.
+*
+*               - header : Referens till filhuvudet.
+*               - entries: Referens till posterna.
+*               - count  : Antalet poster.
+*               - vcd    : Indikerar ifall VCD ska skrivas ut i stället för CSV.
+********************************************************************************/
+static void trace_decode(const struct trace_header* header,
+                         const struct trace_entry* entries,
+                         const size_t count,
+                         const bool vcd)
+{
+   uint32_t shadow[TRACE_DECODE_REGS] = { 0 };
+   uint64_t time = 0;
+   char name[32];
+
+   if (vcd)
+   {
+      bool used[TRACE_DECODE_REGS] = { false };
+      printf("$timescale 1 ns $end\n$scope module pio $end\n");
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         used[entries[i].offset >> 2] = true;
+      }
+      for (uint32_t reg = 0; reg < TRACE_DECODE_REGS; ++reg)
+      {
+         if (!used[reg]) continue;
+         trace_decode_name(name, sizeof(name), header->address + reg * 4);
+         printf("$var wire 32 %c %s $end\n", trace_decode_vcd_id(reg), name);
+      }
+      printf("$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+
+      for (uint32_t reg = 0; reg < TRACE_DECODE_REGS; ++reg)
+      {
+         if (used[reg]) trace_decode_vcd_value(reg, 0);
+      }
+      printf("$end\n");
+   }
+   else
+   {
+      printf("time_ns,address,register,old,new\n");
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      const struct trace_entry* entry = &entries[i];
+      const uint32_t reg = entry->offset >> 2;
+      time += entry->delta;
+
+      if (entry->kind == TRACE_KIND_TIME)
+      {
+         time += entry->value;
+      }
+      else
+      {
+         const uint32_t old = shadow[reg];
+         shadow[reg] ^= entry->value;
+
+         if (vcd)
+         {
+            printf("#%llu\n", (unsigned long long)(time * header->time_ns));
+            trace_decode_vcd_value(reg, shadow[reg]);
+         }
+         else
+         {
+            trace_decode_name(name, sizeof(name), header->address + entry->offset);
+            printf("%llu,0x%08lx,%s,0x%08lx,0x%08lx\n", (unsigned long long)(time * header->time_ns),
+                   (unsigned long)(header->address + entry->offset), name, (unsigned long)old,
+                   (unsigned long)shadow[reg]);
+         }
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* main: Läser in angiven fil och skriver ut dess skrivningar som CSV, eller
+*       som VCD vid flaggan -v. Vid fel returneras felkod 1, annars 0.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   const bool vcd = argc == 3 && !strcmp(argv[1], "-v");
+   struct trace_header header;
+   size_t count;
+
+   if (argc != 2 && !vcd)
+   {
+      fprintf(stderr, "Användning: trace_decode [-v] fil\n"
+                      "  -v  Skriver ut en vågform i formatet VCD i stället för CSV.\n");
+      return 1;
+   }
+
+   struct trace_entry* entries = trace_decode_read(argv[argc - 1], &header, &count);
+   if (!entries) return 1;
+   trace_decode(&header, entries, count, vcd);
+   free(entries);
+   return 0;
+}